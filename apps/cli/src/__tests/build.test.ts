@@ -0,0 +1,213 @@
+import { afterEach, beforeEach, describe, expect, it } from "bun:test";
+import { mkdtemp, rm } from "node:fs/promises";
+import { tmpdir } from "node:os";
+import { join } from "node:path";
+import { build, type BuildOptions } from "../build.ts";
+import { createJob, type JobResult } from "../jobs.ts";
+import { BuildManifest, sourceFingerprint } from "../manifest.ts";
+
+const scd = (name: string) =>
+  JSON.stringify({
+    contractName: name,
+    activationAmount: "1_0000_0000",
+    pragmas: { maxAuxVars: 3, verboseAssembly: false, version: "2.3.0" },
+    methods: [
+      { name: "deposit", code: "1", args: [{ name: "amount", type: "amount" }] },
+    ],
+    variables: [{ name: "total", type: "long" }],
+    maps: [],
+    transactions: [],
+  });
+
+const TokenSource = `#program name Token
+#program activationAmount 1_0000_0000
+#pragma version 2.3.0
+
+long total;
+
+void main() {
+    long txId;
+    while ((txId = getNextTx()) != 0) {
+        total += getAmount(txId);
+    }
+}
+`;
+
+describe("build", () => {
+  let sourceDir: string;
+  let options: BuildOptions;
+
+  const write = (path: string, content: string) =>
+    Bun.write(join(sourceDir, path), content);
+  const statuses = (results: JobResult[]) =>
+    Object.fromEntries(results.map((r) => [r.input, r.status]));
+
+  beforeEach(async () => {
+    sourceDir = await mkdtemp(join(tmpdir(), "scd-cli-"));
+    options = {
+      sourceDir,
+      outDir: join(sourceDir, "build"),
+      workers: 2,
+      force: false,
+      validateOnly: false,
+    };
+    // the token SCD is implemented by its SmartC file, the stub SCD is compiled
+    await write("token/token.scd.json", scd("Token"));
+    await write("token/token.smart.c", TokenSource);
+    await write("stub.scd.json", scd("Stub"));
+  });
+
+  afterEach(() => rm(sourceDir, { recursive: true, force: true }));
+
+  it("should build all inputs, then skip the unchanged ones", async () => {
+    const first = await build(options);
+    expect(statuses(first.results)).toEqual({
+      "stub.scd.json": "built",
+      "token/token.scd.json": "built",
+      "token/token.smart.c": "built",
+    });
+    const byInput = new Map(first.results.map((r) => [r.input, r]));
+    const out = options.outDir;
+    // a SmartC file of the same name replaces the generated stub
+    expect(byInput.get("token/token.scd.json")!.artifacts).toEqual([
+      join(out, "token/token.smart.c"),
+    ]);
+    expect(byInput.get("stub.scd.json")!.artifacts.sort()).toEqual(
+      [".asm", ".deployment.json", ".machine.json", ".smart.c"].map(
+        (extension) => join(out, "stub" + extension),
+      ),
+    );
+    for (const result of first.results) {
+      for (const artifact of result.artifacts) {
+        expect(await Bun.file(artifact).exists()).toBe(true);
+      }
+    }
+
+    const second = await build(options);
+    expect(second.summary).toEqual({
+      built: 0,
+      validated: 0,
+      skipped: 3,
+      failed: 0,
+    });
+    expect(second.results.map((r) => r.artifacts)).toEqual(
+      first.results.map((r) => r.artifacts),
+    );
+
+    expect((await build({ ...options, force: true })).summary.built).toBe(3);
+  });
+
+  it("should rebuild on changed sources, traces and missing artifacts", async () => {
+    await build(options);
+
+    await write("token/token.smart.c", TokenSource + "\n// changed\n");
+    expect(statuses((await build(options)).results)).toEqual({
+      "stub.scd.json": "skipped",
+      "token/token.scd.json": "skipped",
+      "token/token.smart.c": "built",
+    });
+
+    await write(
+      "stub.trace.json",
+      JSON.stringify([{ sender: "1", amount: "100000000", message: ["1"] }]),
+    );
+    const traced = await build(options);
+    expect(statuses(traced.results)["stub.scd.json"]).toBe("built");
+    const stub = traced.results.find((r) => r.input === "stub.scd.json")!;
+    expect(stub.deployment!.advice).toBeDefined();
+
+    await rm(join(options.outDir, "token/token.asm"));
+    expect(statuses((await build(options)).results)).toEqual({
+      "stub.scd.json": "skipped",
+      "token/token.scd.json": "skipped",
+      "token/token.smart.c": "built",
+    });
+  });
+
+  it("should not keep failed inputs in the manifest", async () => {
+    await write("broken.smart.c", "void main() { undefinedCall(); }");
+    const first = await build(options);
+    expect(statuses(first.results)["broken.smart.c"]).toBe("failed");
+    const broken = first.results.find((r) => r.input === "broken.smart.c");
+    expect(broken!.error).toBeDefined();
+    expect(statuses((await build(options)).results)["broken.smart.c"]).toBe(
+      "failed",
+    );
+  });
+});
+
+describe("BuildManifest", () => {
+  const inputs = new Set(["token.scd.json", "token.smart.c"]);
+  const job = (input: string, source = "{}") =>
+    createJob(input, source, "/out", inputs, false);
+
+  it("should hash everything the artifacts depend on", () => {
+    const hash = BuildManifest.hash(job("token.scd.json"));
+    expect(BuildManifest.hash(job("token.scd.json"))).toBe(hash);
+    expect(BuildManifest.hash(job("token.scd.json", "{ }"))).not.toBe(hash);
+    // the sibling SmartC file decides whether the stub is compiled
+    expect(job("token.scd.json").hasSmartC).toBe(true);
+    expect(job("other.scd.json").hasSmartC).toBe(false);
+    expect(job("token.smart.c").hasSmartC).toBe(false);
+    expect(
+      BuildManifest.hash({ ...job("token.scd.json"), hasSmartC: false }),
+    ).not.toBe(hash);
+    expect(
+      BuildManifest.hash({ ...job("token.scd.json"), trace: "[]" }),
+    ).not.toBe(hash);
+  });
+
+  it("should be up to date only with the same hash and all artifacts", async () => {
+    const dir = await mkdtemp(join(tmpdir(), "scd-manifest-"));
+    try {
+      const artifact = join(dir, "token.smart.c");
+      await Bun.write(artifact, "");
+      const manifest = await BuildManifest.load(dir);
+      const tokenJob = job("token.scd.json");
+      const hash = BuildManifest.hash(tokenJob);
+      expect(await manifest.isUpToDate(tokenJob, hash)).toBe(false);
+
+      manifest.set(tokenJob.input, { hash, artifacts: [artifact] });
+      await manifest.save();
+      const loaded = await BuildManifest.load(dir);
+      expect(await loaded.isUpToDate(tokenJob, hash)).toBe(true);
+      expect(await loaded.isUpToDate(tokenJob, "other")).toBe(false);
+
+      await rm(artifact);
+      expect(await loaded.isUpToDate(tokenJob, hash)).toBe(false);
+    } finally {
+      await rm(dir, { recursive: true, force: true });
+    }
+  });
+
+  it("should invalidate all entries on changed core sources", async () => {
+    const dir = await mkdtemp(join(tmpdir(), "scd-manifest-"));
+    try {
+      const coreDir = join(dir, "core");
+      const template = join(coreDir, "generator/templates/smartc.eta.ts");
+      await Bun.write(template, "export default `void main() {}`;");
+      const test = join(coreDir, "generator/__tests/smartc.test.ts");
+      await Bun.write(test, "");
+      const artifact = join(dir, "token.smart.c");
+      await Bun.write(artifact, "");
+      const tokenJob = job("token.scd.json");
+      const hash = BuildManifest.hash(tokenJob);
+      const manifest = await BuildManifest.load(dir, coreDir);
+      manifest.set(tokenJob.input, { hash, artifacts: [artifact] });
+      await manifest.save();
+
+      // the tests don't shape the artifacts
+      const fingerprint = await sourceFingerprint(coreDir);
+      await Bun.write(test, "// changed");
+      expect(await sourceFingerprint(coreDir)).toBe(fingerprint);
+      const unchanged = await BuildManifest.load(dir, coreDir);
+      expect(await unchanged.isUpToDate(tokenJob, hash)).toBe(true);
+
+      await Bun.write(template, "export default `void main() { }`;");
+      const changed = await BuildManifest.load(dir, coreDir);
+      expect(await changed.isUpToDate(tokenJob, hash)).toBe(false);
+    } finally {
+      await rm(dir, { recursive: true, force: true });
+    }
+  });
+});
@@ -0,0 +1,131 @@
+import { afterAll, beforeAll, describe, expect, it } from "bun:test";
+import { mkdtemp, rm } from "node:fs/promises";
+import { tmpdir } from "node:os";
+import { join } from "node:path";
+import { SmartC } from "smartc-signum-compiler";
+import { simulate, type SimulationScenario } from "../simulate.ts";
+
+// forwards 1 Signa to the contract in the first long of each message
+const RelaySource = `#program name Relay
+#program activationAmount 0
+
+long message[4];
+
+void main() {
+    long txId;
+    while ((txId = getNextTx()) != 0) {
+        readMessage(txId, 0, message);
+        sendAmount(100000000, message[0]);
+    }
+}
+`;
+
+// counts the incoming transactions and pays 0.1 Signa to the payee for each
+const SinkSource = `#program name Sink
+#program activationAmount 0
+
+long payee;
+long count;
+
+void main() {
+    long txId;
+    while ((txId = getNextTx()) != 0) {
+        count++;
+        sendAmount(10000000, payee);
+    }
+}
+`;
+
+function machineData(sourceCode: string) {
+  const compiler = new SmartC({ language: "C", sourceCode });
+  compiler.compile();
+  return JSON.stringify(compiler.getMachineCode());
+}
+
+describe("simulate", () => {
+  let dir: string;
+  let scenarioFile: string;
+
+  beforeAll(async () => {
+    dir = await mkdtemp(join(tmpdir(), "scd-simulate-"));
+    await Bun.write(join(dir, "relay.machine.json"), machineData(RelaySource));
+    await Bun.write(join(dir, "sink.machine.json"), machineData(SinkSource));
+    // the sinks are only known from the messages, so they may be hosted by another shard
+    const scenario: SimulationScenario = {
+      blocks: 5,
+      contracts: [
+        {
+          name: "relay",
+          machine: "relay.machine.json",
+          instances: 3,
+          // hand-written scenarios may group the digits
+          balance: "100_0000_0000",
+        },
+        {
+          name: "sink",
+          machine: "sink.machine.json",
+          instances: 3,
+          balance: "10000000000",
+          variables: { payee: "99" },
+        },
+      ],
+      transactions: [
+        {
+          sender: "1",
+          recipient: "@relay",
+          amount: "2_0000_0000",
+          message: ["@sink"],
+          every: 1,
+          count: 2,
+        },
+      ],
+    };
+    scenarioFile = join(dir, "network.sim.json");
+    await Bun.write(scenarioFile, JSON.stringify(scenario));
+  });
+
+  afterAll(() => rm(dir, { recursive: true, force: true }));
+
+  it("should run the shards on the workers like a single shard", async () => {
+    const single = await simulate({ scenarioFile, workers: 1 });
+    expect(single.shards).toBe(1);
+    expect(single.contracts).toBe(6);
+    expect(single.blocks.map((b) => b.transactions)).toEqual([3, 6, 3, 0, 0]);
+    expect(single.blocks.every((b) => b.exchanged === 0)).toBe(true);
+    expect(single.totals.errors).toBe(0);
+    expect(single.totals.paidOutNQT).toBe(6n * 10000000n);
+
+    const onBlock: number[] = [];
+    const sharded = await simulate({
+      scenarioFile,
+      workers: 2,
+      onBlock: (block) => onBlock.push(block.height),
+    });
+    expect(sharded.shards).toBe(2);
+    expect(onBlock).toEqual([1, 2, 3, 4, 5]);
+    expect(sharded.blocks.some((b) => b.exchanged > 0)).toBe(true);
+    const results = (report: typeof single) =>
+      report.blocks.map(({ exchanged, durationMs, ...block }) => block);
+    expect(results(sharded)).toEqual(results(single));
+    expect(sharded.totals).toEqual(single.totals);
+  });
+
+  it("should stop at the given number of blocks", async () => {
+    const report = await simulate({ scenarioFile, workers: 2, blocks: 2 });
+    expect(report.blocks.map((b) => b.height)).toEqual([1, 2]);
+  });
+
+  it("should report the errors of the workers", async () => {
+    const broken = join(dir, "broken.sim.json");
+    await Bun.write(
+      broken,
+      JSON.stringify({
+        contracts: [{ name: "relay", machine: "relay.machine.json" }],
+        transactions: [{ sender: "1", recipient: "@unknown" }],
+      }),
+    );
+    await expect(
+      simulate({ scenarioFile: broken, workers: 1 }),
+    ).rejects.toThrow("Unknown contract: @unknown");
+  });
+});
@@ -0,0 +1,120 @@
+import { mkdir } from "node:fs/promises";
+import { dirname } from "node:path";
+import { SmartC } from "smartc-signum-compiler";
+import { SCD } from "@signum-smartc-scd/core/parser";
+import { SmartCGenerator } from "@signum-smartc-scd/core/generator";
+import {
+  advisePages,
+  deploymentCost,
+  parseTrace,
+} from "@signum-smartc-scd/core/analysis";
+import type {
+  BuildJob,
+  DeploymentReport,
+  JobResult,
+  StepTimings,
+} from "./jobs.ts";
+
+function timed<T>(timings: StepTimings, step: keyof StepTimings, fn: () => T) {
+  const start = performance.now();
+  try {
+    return fn();
+  } finally {
+    timings[step] = (timings[step] ?? 0) + performance.now() - start;
+  }
+}
+
+function compile(language: "C" | "Assembly", sourceCode: string) {
+  const compiler = new SmartC({ language, sourceCode });
+  compiler.compile();
+  return {
+    assembly: language === "C" ? compiler.getAssemblyCode() : sourceCode,
+    machineData: compiler.getMachineCode(),
+  };
+}
+
+function deploymentReport(
+  machineData: ReturnType<typeof compile>["machineData"],
+  trace?: string,
+): DeploymentReport {
+  const { pages, feeNQT } = deploymentCost(machineData);
+  const report: DeploymentReport = { pages, feeNQT: feeNQT.toString() };
+  if (trace !== undefined) {
+    const advice = advisePages(machineData, [parseTrace(trace)]);
+    report.advice = {
+      maxDepth: advice.maxDepth,
+      pragmas: advice.pragmas,
+      recommendedFeeNQT: advice.recommended.feeNQT.toString(),
+      savedNQT: advice.savedNQT.toString(),
+      runtimeErrors: advice.errors.length,
+      warnings: advice.warnings,
+    };
+  }
+  return report;
+}
+
+/**
+ * Runs the pipeline for a single input:
+ * SCD → SmartC (→ assembly → machine data, unless a SmartC file of the same name exists),
+ * SmartC → assembly → machine data, and assembly → machine data.
+ * Compiled contracts get their deployment pages and fee, with a `x.trace.json` also the advised stack sizes.
+ * Errors are returned in the result and never thrown.
+ */
+export async function buildFile(job: BuildJob): Promise<JobResult> {
+  const start = performance.now();
+  const timings: StepTimings = {};
+  const outputs = new Map<string, string>();
+  const result: JobResult = {
+    input: job.input,
+    kind: job.kind,
+    status: job.validateOnly ? "validated" : "built",
+    artifacts: [],
+    timings,
+    durationMs: 0,
+  };
+
+  try {
+    let smartC: string | null = null;
+    if (job.kind === "scd") {
+      const scd = timed(timings, "parse", () => SCD.parse(JSON.parse(job.source)));
+      const code = timed(timings, "generate", () =>
+        new SmartCGenerator(scd).generateContract(),
+      );
+      outputs.set(".smart.c", code);
+      if (!job.hasSmartC) smartC = code;
+    } else if (job.kind === "smartc") {
+      smartC = job.source;
+    }
+
+    if (smartC !== null || job.kind === "asm") {
+      const language = smartC !== null ? "C" : "Assembly";
+      const sourceCode = smartC ?? job.source;
+      const { assembly, machineData } = timed(timings, "compile", () =>
+        compile(language, sourceCode),
+      );
+      if (job.kind !== "asm") outputs.set(".asm", assembly);
+      outputs.set(".machine.json", JSON.stringify(machineData, null, 2));
+      result.deployment = deploymentReport(machineData, job.trace);
+      outputs.set(".deployment.json", JSON.stringify(result.deployment, null, 2));
+    }
+
+    if (!job.validateOnly) {
+      const writeStart = performance.now();
+      await mkdir(dirname(job.outBase), { recursive: true });
+      await Promise.all(
+        [...outputs].map(([extension, content]) => {
+          const path = job.outBase + extension;
+          result.artifacts.push(path);
+          return Bun.write(path, content);
+        }),
+      );
+      timings.write = performance.now() - writeStart;
+    }
+  } catch (e: any) {
+    result.status = "failed";
+    result.error = e?.message ?? String(e);
+  }
+
+  result.durationMs = performance.now() - start;
+  return result;
+}
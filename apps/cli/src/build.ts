@@ -0,0 +1,110 @@
+import { mkdir } from "node:fs/promises";
+import { join, resolve } from "node:path";
+import {
+  createJob,
+  InputPattern,
+  isInside,
+  type JobResult,
+  type JobStatus,
+  traceOf,
+} from "./jobs.ts";
+import { BuildManifest } from "./manifest.ts";
+import { WorkerPool } from "./worker-pool.ts";
+
+export interface BuildOptions {
+  sourceDir: string;
+  outDir: string;
+  workers: number;
+  /** Rebuild unchanged inputs */
+  force: boolean;
+  validateOnly: boolean;
+  onResult?: (result: JobResult) => void;
+}
+
+export interface BuildReport {
+  sourceDir: string;
+  outDir: string;
+  startedAt: string;
+  durationMs: number;
+  workers: number;
+  summary: Record<JobStatus, number>;
+  results: JobResult[];
+}
+
+async function findInputs(sourceDir: string, outDir: string) {
+  const inputs: string[] = [];
+  for await (const path of new Bun.Glob(InputPattern).scan({ cwd: sourceDir })) {
+    if (!isInside(join(sourceDir, path), outDir)) inputs.push(path);
+  }
+  return inputs.sort();
+}
+
+/**
+ * Builds (or validates) all inputs of the source directory in parallel
+ */
+export async function build(options: BuildOptions): Promise<BuildReport> {
+  const startedAt = new Date();
+  const start = performance.now();
+  const sourceDir = resolve(options.sourceDir);
+  const outDir = resolve(options.outDir);
+  const inputs = await findInputs(sourceDir, outDir);
+  const inputSet = new Set(inputs);
+
+  if (!options.validateOnly) await mkdir(outDir, { recursive: true });
+  const manifest = options.validateOnly
+    ? null
+    : await BuildManifest.load(outDir);
+  const pool = new WorkerPool(Math.max(1, Math.min(options.workers, inputs.length)));
+
+  const results = await Promise.all(
+    inputs.map(async (input) => {
+      const source = await Bun.file(join(sourceDir, input)).text();
+      const job = createJob(input, source, outDir, inputSet, options.validateOnly);
+      const trace = Bun.file(join(sourceDir, traceOf(input)));
+      if (await trace.exists()) job.trace = await trace.text();
+      const hash = BuildManifest.hash(job);
+
+      let result: JobResult;
+      if (!options.force && (await manifest?.isUpToDate(job, hash))) {
+        result = {
+          input,
+          kind: job.kind,
+          status: "skipped",
+          artifacts: manifest!.getArtifacts(input),
+          timings: {},
+          durationMs: 0,
+        };
+      } else {
+        result = await pool.run(job);
+        if (result.status === "built") {
+          manifest?.set(input, { hash, artifacts: result.artifacts });
+        } else {
+          manifest?.delete(input);
+        }
+      }
+      options.onResult?.(result);
+      return result;
+    }),
+  );
+
+  pool.terminate();
+  await manifest?.save();
+
+  const summary: Record<JobStatus, number> = {
+    built: 0,
+    validated: 0,
+    skipped: 0,
+    failed: 0,
+  };
+  for (const { status } of results) summary[status]++;
+
+  return {
+    sourceDir,
+    outDir,
+    startedAt: startedAt.toISOString(),
+    durationMs: performance.now() - start,
+    workers: pool.size,
+    summary,
+    results,
+  };
+}
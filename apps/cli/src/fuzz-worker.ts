@@ -0,0 +1,14 @@
+/// <reference lib="webworker" />
+import { Fuzzer } from "@signum-smartc-scd/core/analysis";
+import { SCD } from "@signum-smartc-scd/core/parser";
+import type { FuzzJob } from "./fuzz.ts";
+
+self.onmessage = (event: MessageEvent<FuzzJob>) => {
+  const { scd, machineData, seed, iterations } = event.data;
+  const fuzzer = new Fuzzer(
+    SCD.parse(JSON.parse(scd)),
+    JSON.parse(machineData),
+    { seed },
+  );
+  self.postMessage(fuzzer.run(iterations));
+};
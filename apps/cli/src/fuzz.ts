@@ -0,0 +1,172 @@
+import { mkdir } from "node:fs/promises";
+import { basename, dirname, join, resolve } from "node:path";
+import {
+  type FuzzReport,
+  mergeFuzzReports,
+  stringifyTrace,
+} from "@signum-smartc-scd/core/analysis";
+import { isInside } from "./jobs.ts";
+
+const ScdExtension = ".scd.json";
+
+export interface FuzzOptions {
+  sourceDir: string;
+  /** Build output with the machine data of the contracts */
+  outDir: string;
+  workers: number;
+  /** Sequences per contract, split over the workers */
+  iterations: number;
+  /** Seed of the first worker, the others use the following ones */
+  seed: number;
+  onResult?: (result: FuzzResult) => void;
+}
+
+export interface FuzzJob {
+  scd: string;
+  machineData: string;
+  seed: number;
+  iterations: number;
+}
+
+export interface FuzzResult {
+  input: string;
+  status: "fuzzed" | "failed";
+  artifacts: string[];
+  durationMs: number;
+  /** Instruction and branch outcome coverage, 0..1 */
+  coverage?: { instructions: number; branches: number };
+  /** Steps and fee of the worst call per method */
+  worst?: { method: string; steps: number; feeNQT: string }[];
+  runtimeErrors?: string[];
+  error?: string;
+}
+
+const share = (covered: number, total: number) => (total ? covered / total : 1);
+
+function runWorker(job: FuzzJob) {
+  return new Promise<FuzzReport>((resolve, reject) => {
+    const worker = new Worker(new URL("./fuzz-worker.ts", import.meta.url));
+    worker.onmessage = (event: MessageEvent<FuzzReport>) => {
+      worker.terminate();
+      resolve(event.data);
+    };
+    worker.onerror = (event) => {
+      worker.terminate();
+      reject(new Error(`Worker crashed: ${event.message}`));
+    };
+    worker.postMessage(job);
+  });
+}
+
+/**
+ * Fuzzes a built contract on all workers, each with its own seed, and writes the merged report and
+ * the minimized worst case trace per method to `<out>/x.fuzz/`
+ */
+async function fuzzContract(
+  input: string,
+  options: FuzzOptions,
+): Promise<FuzzResult> {
+  const start = performance.now();
+  const result: FuzzResult = {
+    input,
+    status: "fuzzed",
+    artifacts: [],
+    durationMs: 0,
+  };
+  try {
+    const outBase = join(
+      options.outDir,
+      dirname(input),
+      basename(input, ScdExtension),
+    );
+    const machineFile = Bun.file(`${outBase}.machine.json`);
+    if (!(await machineFile.exists())) {
+      throw new Error("No machine data - run the build first");
+    }
+    const scd = await Bun.file(join(options.sourceDir, input)).text();
+    const machineData = await machineFile.text();
+    const iterations = Math.ceil(options.iterations / options.workers);
+    const report = mergeFuzzReports(
+      await Promise.all(
+        Array.from({ length: options.workers }, (_, i) =>
+          runWorker({ scd, machineData, seed: options.seed + i, iterations }),
+        ),
+      ),
+    );
+
+    const { coverage } = report;
+    result.coverage = {
+      instructions: share(
+        coverage.instructions.length,
+        coverage.totalInstructions,
+      ),
+      branches: share(
+        coverage.branchOutcomes.length,
+        coverage.totalBranchOutcomes,
+      ),
+    };
+    result.worst = report.worst.map(({ method, steps, feeNQT }) => ({
+      method,
+      steps,
+      feeNQT: feeNQT.toString(),
+    }));
+    result.runtimeErrors = report.errors.map((e) => `${e.method}: ${e.error}`);
+
+    const outputs = new Map<string, string>();
+    for (const { method, trace } of report.worst) {
+      outputs.set(`${method}.trace.json`, stringifyTrace(trace));
+    }
+    report.errors.forEach(({ trace }, i) => {
+      outputs.set(`error-${i + 1}.trace.json`, stringifyTrace(trace));
+    });
+    outputs.set(
+      "report.json",
+      JSON.stringify(
+        {
+          iterations: report.iterations,
+          coverage: result.coverage,
+          worst: result.worst,
+          errors: report.errors.map(({ method, error }) => ({ method, error })),
+        },
+        null,
+        2,
+      ),
+    );
+    const fuzzDir = `${outBase}.fuzz`;
+    await mkdir(fuzzDir, { recursive: true });
+    await Promise.all(
+      [...outputs].map(([name, content]) => {
+        const path = join(fuzzDir, name);
+        result.artifacts.push(path);
+        return Bun.write(path, content);
+      }),
+    );
+  } catch (e: any) {
+    result.status = "failed";
+    result.error = e?.message ?? String(e);
+  }
+  result.durationMs = performance.now() - start;
+  return result;
+}
+
+/**
+ * Fuzzes the built contracts of all SCDs in the source directory, one after another
+ */
+export async function fuzz(options: FuzzOptions): Promise<FuzzResult[]> {
+  const sourceDir = resolve(options.sourceDir);
+  const outDir = resolve(options.outDir);
+  const inputs: string[] = [];
+  for await (const path of new Bun.Glob(`**/*${ScdExtension}`).scan({
+    cwd: sourceDir,
+  })) {
+    if (!isInside(join(sourceDir, path), outDir)) inputs.push(path);
+  }
+
+  const results: FuzzResult[] = [];
+  for (const input of inputs.sort()) {
+    const result = await fuzzContract(input, { ...options, sourceDir, outDir });
+    options.onResult?.(result);
+    results.push(result);
+  }
+  return results;
+}
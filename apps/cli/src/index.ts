@@ -0,0 +1,209 @@
+#!/usr/bin/env bun
+import { availableParallelism } from "node:os";
+import { join, relative } from "node:path";
+import { parseArgs } from "node:util";
+import { build } from "./build.ts";
+import { fuzz, type FuzzResult } from "./fuzz.ts";
+import type { JobResult } from "./jobs.ts";
+import { simulate } from "./simulate.ts";
+
+const Usage = `Usage: scd <build|validate|fuzz> <directory> [options]
+       scd simulate <scenario.json> [options]
+
+Processes all .scd.json, .smart.c and .asm files of the directory (recursively):
+  .scd.json  validate, generate SmartC and - unless a .smart.c of the same name exists - compile it
+  .smart.c   compile to assembly and machine data
+  .asm       assemble to machine data
+  .trace.json  transactions of the contract of the same name - advises the stack pages
+
+fuzz searches the most expensive calls of every built .scd.json contract and writes
+the worst case trace per method to <out>/x.fuzz/
+
+simulate runs the contract instances of a scenario block by block, the independent
+ones in parallel, and writes the per block throughput and fees to <scenario>.report.json
+
+Options:
+  -o, --out <dir>       output directory (default: <directory>/build)
+  -w, --workers <n>     number of worker threads (default: number of CPUs)
+  -n, --iterations <n>  fuzz: transaction sequences per contract (default: 10000)
+  -s, --seed <n>        fuzz: seed of the first worker (default: 1)
+  -b, --blocks <n>      simulate: number of blocks (default: from the scenario, or 100)
+  -f, --force           rebuild unchanged inputs
+  -r, --report <file>   JSON report (default: <out>/scd-report.json)
+  -q, --quiet           only print failures and the summary
+  -h, --help`;
+
+function fail(message: string): never {
+  console.error(`${message}\n\n${Usage}`);
+  process.exit(2);
+}
+
+const { values, positionals } = parseArgs({
+  args: Bun.argv.slice(2),
+  allowPositionals: true,
+  options: {
+    out: { type: "string", short: "o" },
+    workers: { type: "string", short: "w" },
+    iterations: { type: "string", short: "n" },
+    seed: { type: "string", short: "s" },
+    blocks: { type: "string", short: "b" },
+    force: { type: "boolean", short: "f", default: false },
+    report: { type: "string", short: "r" },
+    quiet: { type: "boolean", short: "q", default: false },
+    help: { type: "boolean", short: "h", default: false },
+  },
+});
+
+if (values.help) {
+  console.log(Usage);
+  process.exit(0);
+}
+
+const [command, sourceDir] = positionals;
+if (
+  command !== "build" &&
+  command !== "validate" &&
+  command !== "fuzz" &&
+  command !== "simulate"
+) {
+  fail(`Unknown command: ${command ?? "(none)"}`);
+}
+if (!sourceDir) {
+  fail(command === "simulate" ? "Missing scenario" : "Missing directory");
+}
+
+const workers = values.workers
+  ? Number.parseInt(values.workers, 10)
+  : availableParallelism();
+if (!Number.isInteger(workers) || workers < 1) {
+  fail(`Invalid number of workers: ${values.workers}`);
+}
+
+if (command === "simulate") {
+  const blocks = values.blocks ? Number.parseInt(values.blocks, 10) : undefined;
+  if (blocks !== undefined && (!Number.isInteger(blocks) || blocks < 1)) {
+    fail(`Invalid number of blocks: ${values.blocks}`);
+  }
+
+  const report = await simulate({
+    scenarioFile: sourceDir,
+    workers,
+    blocks,
+    onBlock: (block) => {
+      if (values.quiet && !block.errors.length) return;
+      console.log(
+        `#${block.height}: ${block.executed} executed, ${block.transactions} transactions, ${block.steps} steps, ${block.feeNQT} NQT (${block.durationMs.toFixed(1)} ms)`,
+      );
+      for (const { contractId, error } of block.errors) {
+        console.error(`  ✗ contract ${contractId}: ${error}`);
+      }
+    },
+  });
+
+  const reportFile =
+    values.report ?? `${sourceDir.replace(/\.json$/, "")}.report.json`;
+  await Bun.write(
+    reportFile,
+    JSON.stringify(
+      report,
+      (_, value) => (typeof value === "bigint" ? value.toString() : value),
+      2,
+    ),
+  );
+
+  const { totals } = report;
+  console.log(`
+${report.blocks.length} blocks, ${report.contracts} contracts on ${report.shards} shards - ${report.durationMs.toFixed(0)} ms
+${report.blocksPerSecond.toFixed(1)} blocks/s, ${report.transactionsPerSecond.toFixed(0)} transactions/s
+${totals.transactions} transactions, ${totals.steps} steps, fees ${totals.feeNQT} NQT, paid out ${totals.paidOutNQT} NQT`);
+  if (totals.remoteReads) {
+    console.log(
+      `${totals.remoteReads} lookups of contracts on other shards were answered with zero - link the contracts to keep them together`,
+    );
+  }
+  console.log(`Report: ${relative(process.cwd(), reportFile)}`);
+  process.exit(totals.errors ? 1 : 0);
+}
+
+const outDir = values.out ?? join(sourceDir, "build");
+
+if (command === "fuzz") {
+  const iterations = Number.parseInt(values.iterations ?? "10000", 10);
+  const seed = Number.parseInt(values.seed ?? "1", 10);
+  if (!Number.isInteger(iterations) || iterations < 1) {
+    fail(`Invalid number of iterations: ${values.iterations}`);
+  }
+  if (!Number.isInteger(seed)) fail(`Invalid seed: ${values.seed}`);
+
+  const printFuzzResult = (result: FuzzResult) => {
+    if (result.status === "failed") {
+      console.error(`✗ ${result.input}: ${result.error}`);
+      return;
+    }
+    const { instructions, branches } = result.coverage!;
+    console.log(
+      `✓ ${result.input} (${result.durationMs.toFixed(0)} ms) - coverage: ${(instructions * 100).toFixed(0)}% instructions, ${(branches * 100).toFixed(0)}% branches`,
+    );
+    if (values.quiet) return;
+    for (const { method, steps, feeNQT } of result.worst!) {
+      console.log(`  ${method}: ${steps} steps, ${feeNQT} NQT`);
+    }
+    for (const error of result.runtimeErrors!) {
+      console.log(`  runtime error in ${error}`);
+    }
+  };
+
+  const results = await fuzz({
+    sourceDir,
+    outDir,
+    workers,
+    iterations,
+    seed,
+    onResult: printFuzzResult,
+  });
+  const failed = results.filter((r) => r.status === "failed").length;
+  console.log(`
+${results.length - failed} fuzzed, ${failed} failed`);
+  process.exit(failed ? 1 : 0);
+}
+const printResult = (result: JobResult) => {
+  if (result.status === "failed") {
+    console.error(`✗ ${result.input}: ${result.error}`);
+  } else if (!values.quiet) {
+    console.log(
+      `${result.status === "skipped" ? "=" : "✓"} ${result.input} (${result.durationMs.toFixed(0)} ms)`,
+    );
+    const advice = result.deployment?.advice;
+    if (advice && advice.savedNQT !== "0") {
+      console.log(
+        `  stack pages: codeStackPages ${advice.pragmas.codeStackPages}, userStackPages ${advice.pragmas.userStackPages} (saves ${advice.savedNQT} NQT)`,
+      );
+    }
+    for (const warning of advice?.warnings ?? []) {
+      console.log(`  ⚠ ${warning}`);
+    }
+  }
+};
+
+const report = await build({
+  sourceDir,
+  outDir,
+  workers,
+  force: values.force,
+  validateOnly: command === "validate",
+  onResult: printResult,
+});
+
+const reportFile = values.report ?? join(outDir, "scd-report.json");
+if (command === "build" || values.report) {
+  await Bun.write(reportFile, JSON.stringify(report, null, 2));
+}
+
+const { built, validated, skipped, failed } = report.summary;
+console.log(
+  `\n${built + validated} ${command === "build" ? "built" : "valid"}, ${skipped} unchanged, ${failed} failed - ${report.durationMs.toFixed(0)} ms with ${report.workers} workers`,
+);
+if (command === "build" || values.report) {
+  console.log(`Report: ${relative(process.cwd(), reportFile)}`);
+}
+process.exit(failed ? 1 : 0);
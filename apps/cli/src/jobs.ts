@@ -0,0 +1,102 @@
+import { basename, dirname, join, relative } from "node:path";
+import type { PageAdvice, PageCounts } from "@signum-smartc-scd/core/analysis";
+
+export type InputKind = "scd" | "smartc" | "asm";
+
+const Extensions: [extension: string, kind: InputKind][] = [
+  [".scd.json", "scd"],
+  [".smart.c", "smartc"],
+  [".asm", "asm"],
+];
+
+export const InputPattern = "**/*.{scd.json,smart.c,asm}";
+
+const TraceExtension = ".trace.json";
+
+export interface BuildJob {
+  /** Path relative to the source directory - identifies the job in the report and the manifest */
+  input: string;
+  kind: InputKind;
+  source: string;
+  /** Output path without extension, e.g. `build/token/token` */
+  outBase: string;
+  /** SCD only: a SmartC file of the same name exists, so the generated stub is not compiled */
+  hasSmartC: boolean;
+  /** Only check the inputs, without writing artifacts */
+  validateOnly: boolean;
+  /** Content of the sibling `x.trace.json` - the transactions the stack sizes are advised for */
+  trace?: string;
+}
+
+export interface StepTimings {
+  parse?: number;
+  generate?: number;
+  compile?: number;
+  write?: number;
+}
+
+export interface DeploymentReport {
+  pages: PageCounts;
+  feeNQT: string;
+  /** Only with a trace */
+  advice?: {
+    maxDepth: PageAdvice["maxDepth"];
+    pragmas: PageAdvice["pragmas"];
+    recommendedFeeNQT: string;
+    savedNQT: string;
+    runtimeErrors: number;
+    warnings: string[];
+  };
+}
+
+export type JobStatus = "built" | "validated" | "skipped" | "failed";
+
+export interface JobResult {
+  input: string;
+  kind: InputKind;
+  status: JobStatus;
+  artifacts: string[];
+  /** Milliseconds per step */
+  timings: StepTimings;
+  durationMs: number;
+  /** Pages and fee of the compiled contract */
+  deployment?: DeploymentReport;
+  error?: string;
+}
+
+export function kindOf(path: string) {
+  return Extensions.find(([extension]) => path.endsWith(extension));
+}
+
+/**
+ * Path of the trace belonging to the input, e.g. `token/token.trace.json` for `token/token.smart.c`
+ */
+export function traceOf(input: string) {
+  const [extension] = kindOf(input)!;
+  return join(dirname(input), basename(input, extension) + TraceExtension);
+}
+
+export function createJob(
+  input: string,
+  source: string,
+  outDir: string,
+  inputs: Set<string>,
+  validateOnly: boolean,
+): BuildJob {
+  const [extension, kind] = kindOf(input)!;
+  const name = basename(input, extension);
+  const siblingBase = join(dirname(input), name);
+  return {
+    input,
+    kind,
+    source,
+    outBase: join(outDir, siblingBase),
+    hasSmartC: kind === "scd" && inputs.has(siblingBase + ".smart.c"),
+    validateOnly,
+  };
+}
+
+export function isInside(path: string, directory: string) {
+  const rel = relative(directory, path);
+  return !rel.startsWith("..") && rel !== path;
+}
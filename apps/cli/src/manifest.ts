@@ -0,0 +1,109 @@
+import { dirname, join } from "node:path";
+import type { BuildJob } from "./jobs.ts";
+import packageJson from "../package.json";
+import compilerPackageJson from "smartc-signum-compiler/package.json";
+
+// the installed compiler - another version invalidates all manifest entries
+const CompilerVersion = `${compilerPackageJson.name}@${compilerPackageJson.version}`;
+
+// sources of the core package - its generator templates, parser and analysis shape the artifacts
+const CoreSourceDir = dirname(
+  dirname(
+    Bun.resolveSync("@signum-smartc-scd/core/generator", import.meta.dir),
+  ),
+);
+
+const ManifestFile = ".scd-build.json";
+
+/**
+ * Hash over the sources in the directory, tests excluded - a changed template invalidates all
+ * manifest entries, like another compiler version
+ */
+export async function sourceFingerprint(dir: string) {
+  const paths: string[] = [];
+  for await (const path of new Bun.Glob("**/*.{ts,json}").scan({ cwd: dir })) {
+    if (!path.split(/[\\/]/).includes("__tests")) paths.push(path);
+  }
+  const hasher = new Bun.CryptoHasher("sha256");
+  for (const path of paths.sort()) {
+    hasher.update(`${path}\n`).update(await Bun.file(join(dir, path)).text());
+  }
+  return hasher.digest("hex").slice(0, 16);
+}
+
+interface ManifestEntry {
+  hash: string;
+  artifacts: string[];
+}
+
+interface ManifestData {
+  version: string;
+  entries: Record<string, ManifestEntry>;
+}
+
+/**
+ * Remembers the input hashes of the last successful builds in the output directory,
+ * such that unchanged inputs with existing artifacts are skipped.
+ */
+export class BuildManifest {
+  private constructor(
+    private readonly path: string,
+    private readonly data: ManifestData,
+  ) {}
+
+  /**
+   * @param coreDir Sources the generated artifacts depend on - default: the core package
+   */
+  static async load(outDir: string, coreDir = CoreSourceDir) {
+    const path = join(outDir, ManifestFile);
+    const core = await sourceFingerprint(coreDir);
+    const version = `${packageJson.name}@${packageJson.version}+${CompilerVersion}+core:${core}`;
+    const file = Bun.file(path);
+    let data: ManifestData = { version, entries: {} };
+    if (await file.exists()) {
+      try {
+        const stored = (await file.json()) as ManifestData;
+        if (stored.version === version) data = stored;
+      } catch {
+        // corrupt manifest - rebuild everything
+      }
+    }
+    return new BuildManifest(path, data);
+  }
+
+  /**
+   * The hash covers the content and everything that changes the artifacts of the job
+   */
+  static hash(job: BuildJob) {
+    return new Bun.CryptoHasher("sha256")
+      .update(`${job.kind}:${job.hasSmartC}:${job.outBase}\n`)
+      .update(job.source)
+      .update(job.trace ? `\ntrace:${job.trace}` : "")
+      .digest("hex");
+  }
+
+  async isUpToDate(job: BuildJob, hash: string) {
+    const entry = this.data.entries[job.input];
+    if (!entry || entry.hash !== hash) return false;
+    const exists = await Promise.all(
+      entry.artifacts.map((artifact) => Bun.file(artifact).exists()),
+    );
+    return exists.every(Boolean);
+  }
+
+  getArtifacts(input: string) {
+    return this.data.entries[input]?.artifacts ?? [];
+  }
+
+  set(input: string, entry: ManifestEntry) {
+    this.data.entries[input] = entry;
+  }
+
+  delete(input: string) {
+    delete this.data.entries[input];
+  }
+
+  save() {
+    return Bun.write(this.path, JSON.stringify(this.data, null, 2));
+  }
+}
@@ -0,0 +1,28 @@
+/// <reference lib="webworker" />
+import { BlockSimulator } from "@signum-smartc-scd/core/vm";
+import {
+  deployScenario,
+  type SimulationRequest,
+  type SimulationResponse,
+} from "./simulate.ts";
+
+let simulator: BlockSimulator | undefined;
+
+const respond = (response: SimulationResponse) => self.postMessage(response);
+
+self.onmessage = (event: MessageEvent<SimulationRequest>) => {
+  const request = event.data;
+  try {
+    if (request.type === "start") {
+      const { scenario, machines, shard } = request.job;
+      simulator = new BlockSimulator({ shard });
+      deployScenario(simulator, scenario, machines);
+      respond({ type: "started", contracts: simulator.contractIds });
+    } else {
+      simulator!.deliver(request.deliveries);
+      respond({ type: "block", block: simulator!.runBlock() });
+    }
+  } catch (e: any) {
+    respond({ type: "failed", error: e?.message ?? String(e) });
+  }
+};
@@ -0,0 +1,285 @@
+import { dirname, resolve } from "node:path";
+import {
+  type BlockSimulator,
+  type MachineCode,
+  mergeSimulatedBlocks,
+  type RoutedTransaction,
+  type SimulatedBlock,
+} from "@signum-smartc-scd/core/vm";
+import { parseLong } from "@signum-smartc-scd/core/parser";
+
+/** Longs as strings, e.g. "1_0000_0000" - `@name` refers to a contract of the scenario */
+type Value = string;
+
+export interface SimulationScenario {
+  /** Number of blocks - overridden by `--blocks` */
+  blocks?: number;
+  contracts: {
+    name: string;
+    /** Machine data, relative to the scenario file */
+    machine: string;
+    /** Number of instances - default: 1 */
+    instances?: number;
+    creator?: Value;
+    balance?: Value;
+    activationAmount?: Value;
+    /**
+     * Initial values - `@name` is the instance of that contract with the same index, modulo its
+     * number of instances
+     */
+    variables?: Record<string, Value>;
+  }[];
+  transactions?: {
+    sender: Value;
+    /** `@name` sends the transaction to every instance */
+    recipient: Value;
+    amount?: Value;
+    message?: Value[];
+    height?: number;
+    every?: number;
+    count?: number;
+  }[];
+}
+
+export interface SimulationJob {
+  scenario: SimulationScenario;
+  machines: Record<string, MachineCode>;
+  shard: { index: number; count: number };
+}
+
+export type SimulationRequest =
+  | { type: "start"; job: SimulationJob }
+  | { type: "block"; deliveries: RoutedTransaction[] };
+
+export type SimulationResponse =
+  | { type: "started"; contracts: bigint[] }
+  | { type: "block"; block: SimulatedBlock }
+  | { type: "failed"; error: string };
+
+export interface SimulateOptions {
+  scenarioFile: string;
+  workers: number;
+  blocks?: number;
+  onBlock?: (block: BlockSummary) => void;
+}
+
+export interface BlockSummary extends Omit<SimulatedBlock, "remote"> {
+  /** Transactions exchanged between the shards */
+  exchanged: number;
+  durationMs: number;
+}
+
+export interface SimulationReport {
+  scenario: string;
+  contracts: number;
+  shards: number;
+  blocks: BlockSummary[];
+  totals: {
+    transactions: number;
+    steps: number;
+    feeNQT: bigint;
+    paidOutNQT: bigint;
+    errors: number;
+    remoteReads: number;
+  };
+  durationMs: number;
+  blocksPerSecond: number;
+  transactionsPerSecond: number;
+}
+
+/**
+ * Deploys the contracts and schedules the transactions of the scenario - the same on every shard
+ */
+export function deployScenario(
+  simulator: BlockSimulator,
+  scenario: SimulationScenario,
+  machines: Record<string, MachineCode>,
+) {
+  const ids = new Map<string, bigint[]>();
+  let nextId = 1_000_000n;
+  for (const { name, instances = 1 } of scenario.contracts) {
+    if (ids.has(name)) throw new Error(`Duplicate contract name: ${name}`);
+    ids.set(name, Array.from({ length: instances }, () => nextId++));
+  }
+  const resolveValue = (value: Value, index: number) => {
+    if (!value.startsWith("@")) return parseLong(value);
+    const instances = ids.get(value.slice(1));
+    if (!instances) throw new Error(`Unknown contract: ${value}`);
+    return instances[index % instances.length]!;
+  };
+  const optional = (value: Value | undefined) =>
+    value === undefined ? undefined : parseLong(value);
+
+  for (const contract of scenario.contracts) {
+    ids.get(contract.name)!.forEach((contractId, index) => {
+      simulator.deploy(machines[contract.machine]!, {
+        contractId,
+        creator: optional(contract.creator),
+        balance: optional(contract.balance),
+        activationAmount: optional(contract.activationAmount),
+        variables: Object.fromEntries(
+          Object.entries(contract.variables ?? {}).map(([name, value]) => [
+            name,
+            resolveValue(value, index),
+          ]),
+        ),
+      });
+    });
+  }
+
+  for (const tx of scenario.transactions ?? []) {
+    const recipients = tx.recipient.startsWith("@")
+      ? ids.get(tx.recipient.slice(1))
+      : [parseLong(tx.recipient)];
+    if (!recipients) throw new Error(`Unknown contract: ${tx.recipient}`);
+    recipients.forEach((recipient, index) => {
+      simulator.schedule({
+        sender: parseLong(tx.sender),
+        recipient,
+        amount: optional(tx.amount),
+        message: tx.message?.map((value) => resolveValue(value, index)),
+        height: tx.height,
+        every: tx.every,
+        count: tx.count,
+      });
+    });
+  }
+  return ids;
+}
+
+// one shard per worker, answering one request at a time
+class Shard {
+  private readonly worker = new Worker(
+    new URL("./simulate-worker.ts", import.meta.url),
+  );
+  private pending?: {
+    resolve: (response: SimulationResponse) => void;
+    reject: (error: Error) => void;
+  };
+
+  constructor() {
+    this.worker.onmessage = (event: MessageEvent<SimulationResponse>) => {
+      const { data } = event;
+      if (data.type === "failed") this.pending?.reject(new Error(data.error));
+      else this.pending?.resolve(data);
+    };
+    this.worker.onerror = (event) => {
+      this.pending?.reject(new Error(`Worker crashed: ${event.message}`));
+    };
+  }
+
+  request<T extends SimulationResponse>(request: SimulationRequest) {
+    return new Promise<T>((resolve, reject) => {
+      this.pending = {
+        resolve: resolve as (response: SimulationResponse) => void,
+        reject,
+      };
+      this.worker.postMessage(request);
+    });
+  }
+
+  terminate() {
+    this.worker.terminate();
+  }
+}
+
+/**
+ * Runs the scenario block by block, the shards in parallel on the workers. After each block, the
+ * transactions between contracts of different shards are delivered to the recipients' shard.
+ */
+export async function simulate(
+  options: SimulateOptions,
+): Promise<SimulationReport> {
+  const scenarioFile = resolve(options.scenarioFile);
+  const scenario: SimulationScenario = await Bun.file(scenarioFile).json();
+  const machines: Record<string, MachineCode> = {};
+  for (const { machine } of scenario.contracts) {
+    machines[machine] ??= await Bun.file(
+      resolve(dirname(scenarioFile), machine),
+    ).json();
+  }
+  const contracts = scenario.contracts.reduce(
+    (sum, { instances = 1 }) => sum + instances,
+    0,
+  );
+  const blockCount = options.blocks ?? scenario.blocks ?? 100;
+  const count = Math.max(1, Math.min(options.workers, contracts));
+
+  const shards = Array.from({ length: count }, () => new Shard());
+  try {
+    const owners = new Map<bigint, Shard>();
+    await Promise.all(
+      shards.map(async (shard, index) => {
+        const { contracts } = await shard.request<
+          Extract<SimulationResponse, { type: "started" }>
+        >({
+          type: "start",
+          job: { scenario, machines, shard: { index, count } },
+        });
+        for (const id of contracts) owners.set(id, shard);
+      }),
+    );
+
+    const blocks: BlockSummary[] = [];
+    let deliveries = new Map<Shard, RoutedTransaction[]>();
+    const start = performance.now();
+    for (let i = 0; i < blockCount; i++) {
+      const blockStart = performance.now();
+      const results = await Promise.all(
+        shards.map((shard) =>
+          shard.request<Extract<SimulationResponse, { type: "block" }>>({
+            type: "block",
+            deliveries: deliveries.get(shard) ?? [],
+          }),
+        ),
+      );
+      const { remote, ...block } = mergeSimulatedBlocks(
+        results.map((r) => r.block),
+      );
+      deliveries = new Map();
+      for (const tx of remote) {
+        const owner = owners.get(tx.recipient)!;
+        const txs = deliveries.get(owner);
+        if (txs) txs.push(tx);
+        else deliveries.set(owner, [tx]);
+      }
+      const summary: BlockSummary = {
+        ...block,
+        exchanged: remote.length,
+        durationMs: performance.now() - blockStart,
+      };
+      blocks.push(summary);
+      options.onBlock?.(summary);
+    }
+    const durationMs = performance.now() - start;
+
+    const totals = {
+      transactions: 0,
+      steps: 0,
+      feeNQT: 0n,
+      paidOutNQT: 0n,
+      errors: 0,
+      remoteReads: 0,
+    };
+    for (const block of blocks) {
+      totals.transactions += block.transactions;
+      totals.steps += block.steps;
+      totals.feeNQT += block.feeNQT;
+      totals.paidOutNQT += block.paidOutNQT;
+      totals.errors += block.errors.length;
+      totals.remoteReads += block.remoteReads;
+    }
+    return {
+      scenario: options.scenarioFile,
+      contracts,
+      shards: count,
+      blocks,
+      totals,
+      durationMs,
+      blocksPerSecond: (blocks.length * 1000) / durationMs,
+      transactionsPerSecond: (totals.transactions * 1000) / durationMs,
+    };
+  } finally {
+    shards.forEach((shard) => shard.terminate());
+  }
+}
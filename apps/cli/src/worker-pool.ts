@@ -0,0 +1,79 @@
+import type { BuildJob, JobResult } from "./jobs.ts";
+
+interface PendingJob {
+  id: number;
+  job: BuildJob;
+  resolve: (result: JobResult) => void;
+}
+
+/**
+ * Up to `size` Bun workers, each building one file at a time. Workers are started on demand,
+ * such that fully incremental builds do not start any.
+ * A worker which crashes fails its current job and is replaced.
+ */
+export class WorkerPool {
+  private readonly idle: Worker[] = [];
+  private readonly busy = new Map<Worker, PendingJob>();
+  private readonly queue: PendingJob[] = [];
+  private nextId = 0;
+
+  constructor(readonly size: number) {}
+
+  run(job: BuildJob) {
+    return new Promise<JobResult>((resolve) => {
+      this.queue.push({ id: this.nextId++, job, resolve });
+      this.dispatch();
+    });
+  }
+
+  terminate() {
+    for (const worker of [...this.idle, ...this.busy.keys()]) {
+      worker.terminate();
+    }
+  }
+
+  private spawn() {
+    const worker = new Worker(new URL("./worker.ts", import.meta.url));
+    worker.onmessage = (event: MessageEvent<{ result: JobResult }>) => {
+      this.release(worker)?.resolve(event.data.result);
+    };
+    worker.onerror = (event) => {
+      const pending = this.release(worker, false);
+      worker.terminate();
+      pending?.resolve({
+        input: pending.job.input,
+        kind: pending.job.kind,
+        status: "failed",
+        artifacts: [],
+        timings: {},
+        durationMs: 0,
+        error: `Worker crashed: ${event.message}`,
+      });
+      this.dispatch();
+    };
+    return worker;
+  }
+
+  private release(worker: Worker, reuse = true) {
+    const pending = this.busy.get(worker);
+    this.busy.delete(worker);
+    if (reuse) {
+      this.idle.push(worker);
+      this.dispatch();
+    }
+    return pending;
+  }
+
+  private dispatch() {
+    while (this.queue.length) {
+      let worker = this.idle.pop();
+      if (!worker) {
+        if (this.busy.size >= this.size) return;
+        worker = this.spawn();
+      }
+      const pending = this.queue.shift()!;
+      this.busy.set(worker, pending);
+      worker.postMessage({ id: pending.id, job: pending.job });
+    }
+  }
+}
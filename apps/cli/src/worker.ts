@@ -0,0 +1,8 @@
+/// <reference lib="webworker" />
+import { buildFile } from "./build-file.ts";
+import type { BuildJob } from "./jobs.ts";
+
+self.onmessage = async (event: MessageEvent<{ id: number; job: BuildJob }>) => {
+  const { id, job } = event.data;
+  self.postMessage({ id, result: await buildFile(job) });
+};
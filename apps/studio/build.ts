@@ -4,6 +4,7 @@ import plugin from "bun-plugin-tailwind";
 import { existsSync } from "fs";
 import { rm } from "fs/promises";
 import path from "path";
+import { brotliCompressSync, constants } from "zlib";
 
 // Print help text if requested
 if (process.argv.includes("--help") || process.argv.includes("-h")) {
@@ -164,13 +165,72 @@ const result = await build({
 // Print the results
 const end = performance.now();
 
-const outputTable = result.outputs.map((output) => ({
-  File: path.relative(process.cwd(), output.path),
-  Type: output.kind,
-  Size: formatFileSize(output.size),
-}));
+// Precompress the text assets for serve.ts - the original is served to clients without support
+const Compressible = /\.(js|css|html|svg|json|wasm)$/;
+
+const precompress = async (file: string) => {
+  if (!Compressible.test(file)) return undefined;
+  const content = await Bun.file(file).bytes();
+  const brotli = brotliCompressSync(content, {
+    params: { [constants.BROTLI_PARAM_QUALITY]: 11 },
+  });
+  const gzip = Bun.gzipSync(content, { level: 9 });
+  await Promise.all([
+    Bun.write(`${file}.br`, brotli),
+    Bun.write(`${file}.gz`, gzip),
+  ]);
+  return { brotli: brotli.length, gzip: gzip.length };
+};
+
+const compressed = new Map(
+  await Promise.all(
+    result.outputs.map(
+      async (output) => [output.path, await precompress(output.path)] as const,
+    ),
+  ),
+);
+
+const outputTable = result.outputs.map((output) => {
+  const sizes = compressed.get(output.path);
+  return {
+    File: path.relative(process.cwd(), output.path),
+    Type: output.kind,
+    Size: formatFileSize(output.size),
+    Gzip: sizes ? formatFileSize(sizes.gzip) : "-",
+    Brotli: sizes ? formatFileSize(sizes.brotli) : "-",
+  };
+});
 
 console.table(outputTable);
 const buildTime = (end - start).toFixed(2);
 
+// What a first visit transfers: the pages and the assets they reference - the editors load on demand
+const transferSize = (file: string) =>
+  compressed.get(file)?.brotli ??
+  result.outputs.find((output) => output.path === file)?.size ??
+  0;
+
+const initialFiles = new Set<string>();
+for (const output of result.outputs) {
+  if (!output.path.endsWith(".html")) continue;
+  initialFiles.add(output.path);
+  const html = await Bun.file(output.path).text();
+  for (const [, reference] of html.matchAll(/(?:src|href)="([^"]+)"/g)) {
+    const file = path.resolve(outdir, reference.replace(/^\.?\//, ""));
+    if (result.outputs.some((output) => output.path === file)) {
+      initialFiles.add(file);
+    }
+  }
+}
+const initialBytes = [...initialFiles].reduce(
+  (sum, file) => sum + transferSize(file),
+  0,
+);
+const totalBytes = result.outputs
+  .filter((output) => !output.path.endsWith(".map"))
+  .reduce((sum, output) => sum + transferSize(output.path), 0);
+
+console.log(
+  `\n📦 Initial load ${formatFileSize(initialBytes)} of ${formatFileSize(totalBytes)} (brotli, ${initialFiles.size} files)`,
+);
 console.log(`\n✅ Build completed in ${buildTime}ms\n`);
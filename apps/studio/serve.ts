@@ -1,11 +1,73 @@
 import { serve } from "bun";
+import { existsSync } from "fs";
+import path from "path";
 import index from "./src/index.html";
 
+const isProduction = process.env.NODE_ENV === "production";
+const distDir = path.join(import.meta.dir, "dist");
+
+// named with a content hash by the bundler, so these never change
+const HashedAsset = /-[a-z0-9]{8,}\.\w+$/;
+const ImmutableCache = "public, max-age=31536000, immutable";
+
+// precompressed by build.ts, in order of preference
+const Encodings = [
+  ["br", ".br"],
+  ["gzip", ".gz"],
+] as const;
+
+async function serveBuild(request: Request) {
+  const { pathname } = new URL(request.url);
+  let decoded: string;
+  try {
+    decoded = decodeURIComponent(pathname);
+  } catch {
+    return new Response("Bad Request", { status: 400 });
+  }
+  let filePath = path.join(distDir, decoded);
+  // e.g. `/..%2fdist-other/x` - a sibling directory is outside, even if its name starts alike
+  const relative = path.relative(distDir, filePath);
+  if (
+    relative === ".." ||
+    relative.startsWith(`..${path.sep}`) ||
+    path.isAbsolute(relative)
+  ) {
+    return new Response("Not Found", { status: 404 });
+  }
+  if (pathname.endsWith("/") || !(await Bun.file(filePath).exists())) {
+    // client side routes get the app, missing assets a 404
+    if (path.extname(pathname)) {
+      return new Response("Not Found", { status: 404 });
+    }
+    filePath = path.join(distDir, "index.html");
+  }
+
+  const file = Bun.file(filePath);
+  const headers = new Headers({
+    "Content-Type": file.type,
+    "Cache-Control": HashedAsset.test(filePath) ? ImmutableCache : "no-cache",
+    Vary: "Accept-Encoding",
+  });
+  const accepted = request.headers.get("Accept-Encoding") ?? "";
+  for (const [encoding, extension] of Encodings) {
+    if (!accepted.includes(encoding)) continue;
+    const compressed = Bun.file(filePath + extension);
+    if (await compressed.exists()) {
+      headers.set("Content-Encoding", encoding);
+      return new Response(compressed, { headers });
+    }
+  }
+  return new Response(file, { headers });
+}
+
+// production serves the output of `bun run build`, if there is one
+const servesBuild = isProduction && existsSync(path.join(distDir, "index.html"));
+
 const server = serve({
-  routes: {
-    "/*": index,
-  },
-  development: process.env.NODE_ENV !== "production",
+  ...(servesBuild ? { fetch: serveBuild } : { routes: { "/*": index } }),
+  development: !isProduction,
 });
 
-console.log(`🚀 Server running at ${server.url}`);
+console.log(
+  `🚀 Server running at ${server.url}${servesBuild ? ` (serving ${distDir})` : ""}`,
+);
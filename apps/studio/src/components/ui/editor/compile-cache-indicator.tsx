@@ -0,0 +1,33 @@
+import { DatabaseIcon } from "lucide-react";
+import {
+  Tooltip,
+  TooltipContent,
+  TooltipTrigger,
+} from "@/components/ui/tooltip.tsx";
+import { useCompileCacheStats } from "@/hooks/use-compile-cache-stats.ts";
+
+function formatMegaBytes(bytes: number) {
+  return (bytes / (1024 * 1024)).toFixed(1);
+}
+
+export function CompileCacheIndicator() {
+  const { hits, misses, entries, sizeBytes, budgetBytes } =
+    useCompileCacheStats();
+
+  return (
+    <Tooltip>
+      <TooltipTrigger asChild>
+        <div className="flex items-center gap-1 text-xs opacity-70">
+          <DatabaseIcon className="h-3 w-3" />
+          <span>
+            {hits}/{hits + misses}
+          </span>
+        </div>
+      </TooltipTrigger>
+      <TooltipContent>
+        Compile Cache: {hits} hits, {misses} misses - {entries} entries (
+        {formatMegaBytes(sizeBytes)} of {formatMegaBytes(budgetBytes)} MB)
+      </TooltipContent>
+    </Tooltip>
+  );
+}
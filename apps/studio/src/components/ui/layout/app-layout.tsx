@@ -1,4 +1,3 @@
-import { OutputFileType } from "typescript";
 import {
   ResizableHandle,
   ResizablePanel,
@@ -0,0 +1,87 @@
+import {
+  type ReactNode,
+  type Ref,
+  useImperativeHandle,
+  useRef,
+  useState,
+} from "react";
+import { cn } from "@/lib/utils";
+
+export interface VirtualListHandle {
+  scrollToIndex: (index: number) => void;
+}
+
+interface Props {
+  count: number;
+  rowHeight: number;
+  height: number;
+  renderRow: (index: number) => ReactNode;
+  /** Rows rendered above and below the visible ones */
+  overscan?: number;
+  className?: string;
+  ref?: Ref<VirtualListHandle>;
+}
+
+/**
+ * Scrollable list of fixed height rows, which renders only the visible rows.
+ * Use it for lists with thousands of entries, where rendering all rows at once makes the UI sluggish.
+ */
+export function VirtualList({
+  count,
+  rowHeight,
+  height,
+  renderRow,
+  overscan = 8,
+  className,
+  ref,
+}: Props) {
+  const containerRef = useRef<HTMLDivElement>(null);
+  const [scrollTop, setScrollTop] = useState(0);
+
+  useImperativeHandle(
+    ref,
+    () => ({
+      scrollToIndex(index: number) {
+        const container = containerRef.current;
+        if (!container) return;
+        // centers the row, unless it is near the start or end
+        container.scrollTop = Math.max(
+          0,
+          index * rowHeight - (height - rowHeight) / 2,
+        );
+      },
+    }),
+    [rowHeight, height],
+  );
+
+  const first = Math.max(0, Math.floor(scrollTop / rowHeight) - overscan);
+  const last = Math.min(
+    count,
+    Math.ceil((scrollTop + height) / rowHeight) + overscan,
+  );
+  const rows: ReactNode[] = [];
+  for (let index = first; index < last; index++) {
+    rows.push(
+      <div
+        key={index}
+        className="absolute left-0 right-0"
+        style={{ top: index * rowHeight, height: rowHeight }}
+      >
+        {renderRow(index)}
+      </div>,
+    );
+  }
+
+  return (
+    <div
+      ref={containerRef}
+      className={cn("relative overflow-auto", className)}
+      style={{ height }}
+      onScroll={(e) => setScrollTop(e.currentTarget.scrollTop)}
+    >
+      <div className="relative" style={{ height: count * rowHeight }}>
+        {rows}
+      </div>
+    </div>
+  );
+}
@@ -5,7 +5,9 @@ import {
   TabsTrigger,
 } from "@/components/ui/tabs.tsx";
 import { type File } from "@/lib/file-system";
-import { useEffect, useState } from "react";
+import { CompileCancelledError } from "@/lib/compiler";
+import { useEffect, useMemo, useState } from "react";
+import { mapToSource } from "@signum-smartc-scd/core/analysis";
 import AsmCodeEditor from "./code-editor/asm-code-editor.tsx";
 import type { MachineData } from "./machine-data.ts";
 import { tryAssemble } from "@/features/asm-editor/lib/try-assemble.ts";
@@ -15,6 +17,11 @@ import { useSearchParams } from "react-router";
 
 type ViewType = "editor" | "metadata" | "deployment";
 
+interface Assembled {
+  assembly: string;
+  machineData: MachineData;
+}
+
 interface Props {
   file: File;
 }
@@ -22,12 +29,32 @@ interface Props {
 export function AsmEditor({ file }: Props) {
   const [searchParams, setSearchParams] = useSearchParams();
   const [isValid, setIsValid] = useState(true);
-  const [machineData, setMachineData] = useState<MachineData | undefined>(
+  const [assembled, setAssembled] = useState<Assembled | undefined>(
     undefined,
   );
-  const handleOnSave = (isValid: boolean, machineCode?: MachineData) => {
+  // re-created on every navigation, such that the same target can be shown again
+  const [asmLineTarget, setAsmLineTarget] = useState<{ line: number }>();
+  const [offsetTarget, setOffsetTarget] = useState<{ offset: number }>();
+  const machineData = assembled?.machineData;
+  const sourceMap = useMemo(
+    () =>
+      assembled
+        ? mapToSource(assembled.assembly, assembled.machineData.ByteCode)
+        : undefined,
+    [assembled],
+  );
+
+  const handleOnSave = (
+    isValid: boolean,
+    machineCode?: MachineData,
+    assembly?: string,
+  ) => {
     setIsValid(isValid);
-    setMachineData(machineCode);
+    setAssembled(
+      machineCode && assembly !== undefined
+        ? { assembly, machineData: machineCode }
+        : undefined,
+    );
   };
 
   const handleViewChange = (view: ViewType) => {
@@ -37,14 +64,34 @@ export function AsmEditor({ file }: Props) {
     });
   };
 
+  const showAsmLine = (line: number) => {
+    setAsmLineTarget({ line });
+    handleViewChange("editor");
+  };
+
+  const showOffset = (offset: number) => {
+    setOffsetTarget({ offset });
+    handleViewChange("metadata");
+  };
+
   useEffect(() => {
-    try {
-      setMachineData(undefined);
-      setMachineData(tryAssemble(file.content as string));
-      setIsValid(true);
-    } catch (e) {
-      setIsValid(false);
-    }
+    let isCurrent = true;
+    setAssembled(undefined);
+    const assembly = file.content as string;
+    // the save assembles on its own channel, so neither cancels the other
+    tryAssemble(assembly, `${file.metadata.id}:view`)
+      .then((data) => {
+        if (!isCurrent) return;
+        setAssembled({ assembly, machineData: data });
+        setIsValid(true);
+      })
+      .catch((e) => {
+        if (!isCurrent || e instanceof CompileCancelledError) return;
+        setIsValid(false);
+      });
+    return () => {
+      isCurrent = false;
+    };
   }, [file]);
 
   return (
@@ -64,14 +111,28 @@ export function AsmEditor({ file }: Props) {
           </TabsList>
 
         <TabsContent value="editor" className="flex-1 p-0 m-0 overflow-hidden">
-          <AsmCodeEditor file={file} onSave={handleOnSave} />
+          <AsmCodeEditor
+            file={file}
+            onSave={handleOnSave}
+            assembly={assembled?.assembly}
+            sourceMap={sourceMap}
+            revealTarget={asmLineTarget}
+            onShowOffset={showOffset}
+          />
         </TabsContent>
 
         <TabsContent
           value="metadata"
           className="flex-1 p-0 m-0 overflow-hidden"
         >
-          {machineData && <MetaDataView machineData={machineData} />}
+          {machineData && (
+            <MetaDataView
+              machineData={machineData}
+              sourceMap={sourceMap}
+              focusTarget={offsetTarget}
+              onShowAsmLine={showAsmLine}
+            />
+          )}
         </TabsContent>
 
         <TabsContent value="deploy" className="flex-1 p-4 m-0 overflow-auto">
@@ -1,5 +1,6 @@
 import { useCallback, useEffect, useRef, useState } from "react";
 import Editor, { type BeforeMount, type OnMount } from "@monaco-editor/react";
+import type * as Monaco from "monaco-editor";
 import { FileWarning, SaveIcon } from "lucide-react";
 import {
   Tooltip,
@@ -8,6 +9,7 @@ import {
 } from "@/components/ui/tooltip";
 import { useTheme } from "next-themes";
 import { EditorActionButton } from "@/components/ui/editor/actionButton.tsx";
+import { CompileCacheIndicator } from "@/components/ui/editor/compile-cache-indicator.tsx";
 import { toast } from "sonner";
 import { ConfirmationDialog } from "@/components/ui/confirmation-dialog.tsx";
 import { registerAsmLanguage } from "./language-definitions/asm-language-definitions.ts";
@@ -15,6 +17,8 @@ import { type File } from "@/lib/file-system";
 import { useFileSystem } from "@/hooks/use-file-system.ts";
 import type { MachineData } from "@/features/asm-editor/machine-data.ts";
 import { tryAssemble } from "../lib/try-assemble.ts";
+import type { SourceMap } from "@signum-smartc-scd/core/analysis";
+import { formatOffset } from "../meta-data-view/hex-view.ts";
 
 const preventDefaultSave = (e: KeyboardEvent) => {
   if ((e.ctrlKey || e.metaKey) && e.key === "s") {
@@ -24,10 +28,23 @@ const preventDefaultSave = (e: KeyboardEvent) => {
 
 interface Props {
   file: File;
-  onSave: (isValid: boolean, machineCode?: MachineData) => void;
+  onSave: (isValid: boolean, machineCode?: MachineData, assembly?: string) => void;
+  /** The assembly the source map was created from - navigation is only offered while the code is unchanged */
+  assembly?: string;
+  sourceMap?: SourceMap;
+  /** Line to reveal */
+  revealTarget?: { line: number };
+  onShowOffset?: (offset: number) => void;
 }
 
-function AsmCodeEditor({ file, onSave }: Props) {
+function AsmCodeEditor({
+  file,
+  onSave,
+  assembly,
+  sourceMap,
+  revealTarget,
+  onShowOffset,
+}: Props) {
   const fs = useFileSystem();
   const [code, setCode] = useState(file.content as string);
   const [isDirty, setIsDirty] = useState(false);
@@ -37,6 +54,10 @@ function AsmCodeEditor({ file, onSave }: Props) {
   const [editorHeight, setEditorHeight] = useState("calc(100vh)"); // Initial height
   const [showConfirmDialog, setShowConfirmDialog] = useState(false);
   const isValid = !validationError;
+  const editorRef = useRef<Monaco.editor.IStandaloneCodeEditor | null>(null);
+  // read by the editor's providers and actions, which are registered once on mount
+  const navigationRef = useRef({ assembly, sourceMap, onShowOffset });
+  navigationRef.current = { assembly, sourceMap, onShowOffset };
 
   useEffect(() => {
     const calculateEditorHeight = () => {
@@ -75,10 +96,10 @@ function AsmCodeEditor({ file, onSave }: Props) {
         toast.warning("Cannot save file! Please fix the errors first");
         return;
       }
-      const machineCode = tryAssemble(code);
+      const machineCode = await tryAssemble(code, `${file.metadata.id}:save`);
       await fs.saveFile(file.metadata.id, code);
       setIsDirty(false);
-      onSave(true, machineCode);
+      onSave(true, machineCode, code);
       toast.success("File saved successfully!");
     } catch (e) {
       toast.error("Could not save file: " + e.message);
@@ -103,7 +124,65 @@ function AsmCodeEditor({ file, onSave }: Props) {
     setValidationError(error ?? "");
   };
 
+  const revealLine = (line: number) => {
+    editorRef.current?.revealLineInCenter(line);
+    editorRef.current?.setPosition({ lineNumber: line, column: 1 });
+    editorRef.current?.focus();
+  };
+
+  useEffect(() => {
+    if (revealTarget) revealLine(revealTarget.line);
+  }, [revealTarget]);
+
+  // code addresses of the line, if the source map matches the current code
+  const offsetsOfLine = (model: Monaco.editor.ITextModel, line: number) => {
+    const { assembly, sourceMap } = navigationRef.current;
+    if (!sourceMap || model.getValue() !== assembly) return [];
+    return sourceMap.offsetsOfAsmLine(line);
+  };
+
   const handleEditorDidMount: OnMount = (editor, monaco) => {
+    editorRef.current = editor;
+    if (revealTarget) revealLine(revealTarget.line);
+
+    const hoverProvider = monaco.languages.registerHoverProvider("asm", {
+      provideHover(model, position) {
+        if (model !== editor.getModel()) return null;
+        const { sourceMap } = navigationRef.current;
+        const offsets = offsetsOfLine(model, position.lineNumber);
+        if (!sourceMap || !offsets.length) return null;
+        return {
+          contents: offsets.map((offset) => {
+            const { instruction, line } = sourceMap.at(offset)!;
+            const { mnemonic, size } = instruction.info;
+            // more than one instruction, if the assembler expanded the line
+            return {
+              value: `\`${formatOffset(offset)}\` ${mnemonic} - ${size} bytes${line ? `, SmartC line ${line}` : ""}`,
+            };
+          }),
+        };
+      },
+    });
+    editor.onDidDispose(() => hoverProvider.dispose());
+
+    editor.addAction({
+      id: "show-in-hex-view",
+      label: "Show in Hex View",
+      contextMenuGroupId: "navigation",
+      contextMenuOrder: 1.6,
+      run: (ed) => {
+        const model = ed.getModel();
+        const line = ed.getPosition()?.lineNumber;
+        if (!model || !line) return;
+        const [offset] = offsetsOfLine(model, line);
+        if (offset === undefined) {
+          toast.info("No bytecode for this line - save to assemble the current code");
+          return;
+        }
+        navigationRef.current.onShowOffset?.(offset);
+      },
+    });
+
     editor.addAction({
       id: "save-content",
       label: "Save Content",
@@ -138,7 +217,8 @@ function AsmCodeEditor({ file, onSave }: Props) {
         <div>
           <small className="font-medium opacity-70">Change this file only if you know what you are doing!</small>
         </div>
-        <div>
+        <div className="flex items-center gap-2">
+          <CompileCacheIndicator />
           <EditorActionButton
             tooltip={isDirty ? "Unsaved changes" : "All Saved"}
             disabled={!isValid}
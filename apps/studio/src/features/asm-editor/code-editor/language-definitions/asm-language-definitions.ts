@@ -1,13 +1,28 @@
 // asm-language-definitions.ts
 import { AsmKeywords } from "./keywords.ts";
 import type { Monaco } from "@monaco-editor/react";
+import type { editor, Position } from "monaco-editor";
 import {
   createApiFunctionCompletionItems,
   createFunctionCallCompletionItems,
 } from "./functions.ts";
 import { AsmDirectives, createDirectiveCompletionItems } from "./directives.ts";
+import { scanAsmLine } from "./asm-symbols.ts";
+import {
+  CompletionIndex,
+  symbolCompletionItem,
+  symbolHover,
+  symbolIndexOf,
+  symbolRange,
+} from "@/lib/editor";
+
+// monaco is a global instance - the editor mounts once per opened file
+let hasRegisteredAlready = false;
 
 export function registerAsmLanguage(monaco: Monaco) {
+  if (hasRegisteredAlready) return;
+  hasRegisteredAlready = true;
+
   // Register a new language
   monaco.languages.register({ id: "asm" });
 
@@ -141,6 +156,66 @@ export function registerAsmLanguage(monaco: Monaco) {
     },
   });
 
+  // built once, only the range differs per request
+  const functionCallCompletions = new CompletionIndex(
+    createFunctionCallCompletionItems(undefined, monaco),
+  );
+  const directiveCompletions = new CompletionIndex(
+    createDirectiveCompletionItems(monaco),
+  );
+  const completions = new CompletionIndex([
+    ...createCompletionItems(
+      AsmDirectives.map(({ label }) => label),
+      monaco.languages.CompletionItemKind.Snippet,
+      "Directive",
+    ),
+
+    // Program Flow Operations
+    ...createCompletionItems(
+      AsmKeywords.programFlow,
+      monaco.languages.CompletionItemKind.Keyword,
+      "Program Flow Operation",
+    ),
+
+    // Stack Operations
+    ...createCompletionItems(
+      AsmKeywords.stackOperations,
+      monaco.languages.CompletionItemKind.Keyword,
+      "Stack Operation",
+    ),
+
+    // Arithmetic Operations
+    ...createCompletionItems(
+      AsmKeywords.arithmeticOperations,
+      monaco.languages.CompletionItemKind.Operator,
+      "Arithmetic Operation",
+    ),
+
+    // API Calls
+    ...createCompletionItems(
+      AsmKeywords.apiCalls,
+      monaco.languages.CompletionItemKind.Function,
+      "API Call",
+    ),
+
+    // Memory Operations
+    ...createCompletionItems(
+      AsmKeywords.memoryOperations,
+      monaco.languages.CompletionItemKind.Method,
+      "Memory Operation",
+    ),
+
+    // Data Types
+    ...createCompletionItems(
+      AsmKeywords.dataTypes,
+      monaco.languages.CompletionItemKind.TypeParameter,
+      "Data Type",
+    ),
+
+    // API function names (keeping the existing ones)
+    ...createApiFunctionCompletionItems(undefined, monaco),
+  ]);
+
   // Register a completion item provider for the language
   monaco.languages.registerCompletionItemProvider("asm", {
     provideCompletionItems: (model: any, position: any) => {
@@ -159,7 +234,7 @@ export function registerAsmLanguage(monaco: Monaco) {
 
       if (beforeCursor.endsWith("FUN") || beforeCursor.endsWith("API")) {
         return {
-          suggestions: createFunctionCallCompletionItems(range, monaco),
+          suggestions: functionCallCompletions.suggest(word.word, range),
         };
       }
 
@@ -177,76 +252,49 @@ export function registerAsmLanguage(monaco: Monaco) {
         };
 
         return {
-          suggestions: createDirectiveCompletionItems(monaco, caretRange),
+          suggestions: directiveCompletions.suggest("", caretRange),
         };
       }
 
-      const completions = [
-
-        ...createCompletionItems(AsmDirectives.map(({label}) => label),
-          monaco.languages.CompletionItemKind.Snippet,
-          range,
-          'Directive',
-          ),
-
-        // Program Flow Operations
-        ...createCompletionItems(
-          AsmKeywords.programFlow,
-          monaco.languages.CompletionItemKind.Keyword,
-          range,
-          "Program Flow Operation",
-        ),
-
-        // Stack Operations
-        ...createCompletionItems(
-          AsmKeywords.stackOperations,
-          monaco.languages.CompletionItemKind.Keyword,
-          range,
-          "Stack Operation",
-        ),
-
-        // Arithmetic Operations
-        ...createCompletionItems(
-          AsmKeywords.arithmeticOperations,
-          monaco.languages.CompletionItemKind.Operator,
-          range,
-          "Arithmetic Operation",
-        ),
-
-        // API Calls
-        ...createCompletionItems(
-          AsmKeywords.apiCalls,
-          monaco.languages.CompletionItemKind.Function,
-          range,
-          "API Call",
-        ),
-
-        // Memory Operations
-        ...createCompletionItems(
-          AsmKeywords.memoryOperations,
-          monaco.languages.CompletionItemKind.Method,
-          range,
-          "Memory Operation",
-        ),
+      // labels after `:`, variables after `@` or `$`
+      const prefix = lineContent.charAt(word.startColumn - 2);
+      const symbols = symbolIndexOf(model, scanAsmLine)
+        .symbols()
+        .filter(({ kind }) =>
+          prefix === ":"
+            ? kind === "label"
+            : prefix === "@" || prefix === "$"
+              ? kind !== "label"
+              : true,
+        )
+        .map((symbol) => symbolCompletionItem(monaco, symbol, range));
+      if (prefix === ":" || prefix === "@" || prefix === "$") {
+        return { suggestions: symbols };
+      }
 
-        // Data Types
-        ...createCompletionItems(
-          AsmKeywords.dataTypes,
-          monaco.languages.CompletionItemKind.TypeParameter,
-          range,
-          "Data Type",
-        ),
+      return {
+        suggestions: [...completions.suggest(word.word, range), ...symbols],
+      };
+    },
+  });
 
-        // Directives
-        // ...createCompletionItems(AsmKeywords.directives, monaco.languages.CompletionItemKind.Snippet, range, 'Directive'),
+  const declarationAt = (model: editor.ITextModel, position: Position) => {
+    const word = model.getWordAtPosition(position);
+    if (!word) return undefined;
+    return symbolIndexOf(model, scanAsmLine).lookup(word.word)[0];
+  };
 
-        // API function names (keeping the existing ones)
-        ...createApiFunctionCompletionItems(range, monaco),
-      ];
+  monaco.languages.registerDefinitionProvider("asm", {
+    provideDefinition: (model, position) => {
+      const symbol = declarationAt(model, position);
+      return symbol ? { uri: model.uri, range: symbolRange(symbol) } : null;
+    },
+  });
 
-      return {
-        suggestions: completions,
-      };
+  monaco.languages.registerHoverProvider("asm", {
+    provideHover: (model, position) => {
+      const symbol = declarationAt(model, position);
+      return symbol ? symbolHover(symbol) : null;
     },
   });
 
@@ -386,18 +434,16 @@ export function registerAsmLanguage(monaco: Monaco) {
   });
 }
 
-// Helper function to create completion items (unchanged)
+// Helper function to create completion items
 function createCompletionItems(
   items: string[],
   kind: any,
-  range: any,
   detail: string,
 ) {
   return items.map((item) => ({
     label: item,
     kind: kind,
     insertText: item,
-    range: range,
     detail: detail,
     documentation: `${detail}: ${item}`,
   }));
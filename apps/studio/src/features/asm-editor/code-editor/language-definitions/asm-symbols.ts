@@ -0,0 +1,47 @@
+import {
+  type EditorSymbol,
+  type LineScanner,
+  stripComments,
+} from "@/lib/editor";
+
+const LabelPattern = /^\s*([a-zA-Z_$][\w$]*):/;
+const DeclarePattern = /^\s*\^declare\s+([a-zA-Z_][\w$]*)/;
+const ConstPattern = /^\s*\^const\s+SET\s+@([a-zA-Z_][\w$]*)\s+(#\w*)/;
+
+/**
+ * Scans a line of assembly for labels, declared variables and constants. The state tracks open
+ * block comments.
+ */
+export const scanAsmLine: LineScanner = (text, state) => {
+  const { code, inComment } = stripComments(text, state === "*");
+  const symbols: EditorSymbol[] = [];
+  const label = LabelPattern.exec(code);
+  const declare = DeclarePattern.exec(code);
+  const constant = ConstPattern.exec(code);
+  if (label) {
+    const name = label[1]!;
+    symbols.push({
+      name,
+      kind: "label",
+      column: code.indexOf(name) + 1,
+      detail: `${name}:`,
+    });
+  } else if (declare) {
+    const name = declare[1]!;
+    symbols.push({
+      name,
+      kind: "variable",
+      column: code.indexOf(name, code.indexOf("^declare") + 8) + 1,
+      detail: `^declare ${name}`,
+    });
+  } else if (constant) {
+    const [, name, value] = constant;
+    symbols.push({
+      name: name!,
+      kind: "define",
+      column: code.indexOf(`@${name}`) + 2,
+      detail: `^const SET @${name} ${value}`,
+    });
+  }
+  return { symbols, state: inComment ? "*" : "" };
+};
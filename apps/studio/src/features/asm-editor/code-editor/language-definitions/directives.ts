@@ -62,7 +62,7 @@ type Args = {
   detail: string;
   documentation: string;
   monaco: any;
-  range: Range;
+  range?: Range;
 };
 
 function createSuggestionItem({ range, monaco, ...rest }: Args) {
@@ -75,7 +75,8 @@ function createSuggestionItem({ range, monaco, ...rest }: Args) {
   };
 }
 
-export function createDirectiveCompletionItems(monaco: any, range: Range) {
+// without a range, the items are templates for a completion index
+export function createDirectiveCompletionItems(monaco: any, range?: Range) {
   return AsmDirectives.map((suggestion) =>
     createSuggestionItem({
       monaco,
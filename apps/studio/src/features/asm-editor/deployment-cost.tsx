@@ -0,0 +1,157 @@
+import { useMemo, useState } from "react";
+import {
+  advisePages,
+  deploymentCost,
+  type PageAdvice,
+  type PageCounts,
+  parseTrace,
+} from "@signum-smartc-scd/core/analysis";
+import {
+  Card,
+  CardContent,
+  CardDescription,
+  CardHeader,
+  CardTitle,
+} from "@/components/ui/card";
+import { Button } from "@/components/ui/button.tsx";
+import { Textarea } from "@/components/ui/textarea.tsx";
+import { Separator } from "@/components/ui/separator";
+import { Amount } from "@/components/ui/amount.tsx";
+import { GaugeIcon } from "lucide-react";
+import type { MachineData } from "./machine-data.ts";
+
+const ExampleTrace = `[
+  { "sender": "1", "amount": "100000000", "message": ["1"] }
+]`;
+
+const PageRows: { key: keyof PageCounts; label: string }[] = [
+  { key: "code", label: "Code" },
+  { key: "data", label: "Data" },
+  { key: "codeStack", label: "Code Stack" },
+  { key: "userStack", label: "User Stack" },
+  { key: "total", label: "Total" },
+];
+
+function PageTable({
+  current,
+  recommended,
+}: {
+  current: PageCounts;
+  recommended?: PageCounts;
+}) {
+  return (
+    <table className="w-full text-sm">
+      <thead>
+        <tr className="text-left text-muted-foreground">
+          <th className="font-normal">Pages</th>
+          <th className="font-normal">Current</th>
+          {recommended && <th className="font-normal">Recommended</th>}
+        </tr>
+      </thead>
+      <tbody className="tabular-nums">
+        {PageRows.map(({ key, label }) => (
+          <tr key={key} className={key === "total" ? "font-medium" : ""}>
+            <td>{label}</td>
+            <td>{current[key]}</td>
+            {recommended && <td>{recommended[key]}</td>}
+          </tr>
+        ))}
+      </tbody>
+    </table>
+  );
+}
+
+/**
+ * Page breakdown and fee of the deployment, and the stack sizes recommended for a transaction trace
+ */
+export function DeploymentCost({ data }: { data: MachineData }) {
+  const cost = useMemo(() => deploymentCost(data), [data]);
+  const [trace, setTrace] = useState(ExampleTrace);
+  const [advice, setAdvice] = useState<PageAdvice>();
+  const [error, setError] = useState<string>();
+
+  const analyze = () => {
+    try {
+      setAdvice(advisePages(data, [parseTrace(trace)]));
+      setError(undefined);
+    } catch (e) {
+      setAdvice(undefined);
+      setError(e.message);
+    }
+  };
+
+  return (
+    <Card>
+      <CardHeader>
+        <CardTitle className="text-lg">Deployment Cost</CardTitle>
+        <CardDescription>
+          Every code, data and stack page adds to the deployment fee
+        </CardDescription>
+      </CardHeader>
+      <CardContent>
+        <div className="space-y-4">
+          <PageTable current={cost.pages} recommended={advice?.recommended.pages} />
+          <div className="flex justify-between items-baseline">
+            <span className="text-sm text-muted-foreground">Deployment Fee</span>
+            <Amount amount={cost.feeNQT.toString()} isAtomic />
+          </div>
+
+          <Separator />
+
+          <div className="space-y-2">
+            <div className="flex items-center justify-between">
+              <h4 className="text-sm font-medium">Stack Size Advisor</h4>
+              <Button size="sm" onClick={analyze}>
+                <GaugeIcon className="h-4 w-4 mr-2" />
+                Analyze Trace
+              </Button>
+            </div>
+            <p className="text-xs text-muted-foreground">
+              Replays the transactions and measures the deepest stack use - the
+              trace should cover the most nested calls.
+            </p>
+            <Textarea
+              className="font-mono text-xs"
+              rows={4}
+              value={trace}
+              onChange={(e) => setTrace(e.target.value)}
+            />
+            {error && <p className="text-xs text-destructive">{error}</p>}
+            {advice && (
+              <div className="text-sm space-y-1">
+                <p>
+                  Max. depth: {advice.maxDepth.codeStack} code stack,{" "}
+                  {advice.maxDepth.userStack} user stack entries
+                  {advice.errors.length > 0 &&
+                    ` - ${advice.errors.length} runtime errors, first: ${advice.errors[0].error}`}
+                </p>
+                {advice.warnings.map((warning) => (
+                  <p key={warning} className="text-xs text-destructive">
+                    {warning}
+                  </p>
+                ))}
+                <p className="font-mono text-xs">
+                  #pragma codeStackPages {advice.pragmas.codeStackPages}
+                  <br />
+                  #pragma userStackPages {advice.pragmas.userStackPages}
+                </p>
+                <div className="flex justify-between items-baseline">
+                  <span className="text-muted-foreground">
+                    {advice.savedNQT >= 0n ? "Fee Saved" : "Additional Fee"}
+                  </span>
+                  <Amount
+                    amount={(advice.savedNQT >= 0n
+                      ? advice.savedNQT
+                      : -advice.savedNQT
+                    ).toString()}
+                    isAtomic
+                  />
+                </div>
+              </div>
+            )}
+          </div>
+        </div>
+      </CardContent>
+    </Card>
+  );
+}
@@ -23,6 +23,7 @@ import { Badge } from "@/components/ui/badge";
 import type { MachineData } from "./machine-data.ts";
 import { Amount } from "@/components/ui/amount.tsx";
 import { AdaptiveScrollArea } from "@/components/ui/adaptive-scroll-area.tsx";
+import { DeploymentCost } from "./deployment-cost.tsx";
 
 export function DeploymentView({ data }: { data: MachineData }) {
   const [isConnecting, setIsConnecting] = useState(false);
@@ -103,6 +104,8 @@ export function DeploymentView({ data }: { data: MachineData }) {
             </CardContent>
           </Card>
 
+          <DeploymentCost data={data} />
+
           <Card>
             <CardHeader>
               <CardTitle className="text-lg">Deployment Settings</CardTitle>
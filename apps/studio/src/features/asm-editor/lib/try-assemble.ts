@@ -1,16 +1,20 @@
-import { SmartC } from "smartc-signum-compiler";
 import type { MachineData } from "../machine-data.ts";
+import { CompilerService } from "@/lib/compiler";
 
 /**
- * Tries to assemble the given assembly code.
+ * Tries to assemble the given assembly code (off the main thread).
  * @param asmCode
+ * @param channel optional channel - a newer call on the same channel supersedes this one
  * @returns the machine data
- * @throws Error when assembly fails
+ * @throws Error when assembly fails or got superseded
  */
-export function tryAssemble(asmCode: string): MachineData {
-  const compiler = new SmartC({
-    language: "Assembly",
-    sourceCode: asmCode
-  });
-  return compiler.compile().getMachineCode();
+export async function tryAssemble(
+  asmCode: string,
+  channel?: string,
+): Promise<MachineData> {
+  const result = await CompilerService.getInstance().assemble(asmCode, channel);
+  if (!result.ok || !result.machineData) {
+    throw new Error(result.error ?? "Assembly failed");
+  }
+  return result.machineData;
 }
@@ -7,29 +7,147 @@ import {
 } from "@/components/ui/card";
 import { Tabs, TabsContent, TabsList, TabsTrigger } from "@/components/ui/tabs";
 import { Badge } from "@/components/ui/badge";
-import { ScrollArea } from "@/components/ui/scroll-area";
+import { Input } from "@/components/ui/input";
+import { Button } from "@/components/ui/button";
+import {
+  VirtualList,
+  type VirtualListHandle,
+} from "@/components/ui/virtual-list.tsx";
 import type { MachineData } from "../machine-data.ts";
-import { useMemo } from "react";
-
-function formatHexView(hexString: string) {
-  if(!hexString) return "";
-  if (hexString.length % 2 !== 0) {
-    return "Invalid hex string"
-  }
-  let formatted = "";
-  for (let i = 0; i < hexString.length; i += 2) {
-    formatted +=
-      `${hexString[i]}${hexString[i + 1]}` + (i % 32 === 0 ? "\n" : " ");
-  }
-  return formatted;
+import { useDeferredValue, useEffect, useMemo, useRef, useState } from "react";
+import type { SourceMap } from "@signum-smartc-scd/core/analysis";
+import { formatInstruction } from "@signum-smartc-scd/core/vm";
+import { cn } from "@/lib/utils";
+import {
+  BytesPerRow,
+  formatOffset,
+  formatRow,
+  hexToBytes,
+  parseOffset,
+  rowCount,
+} from "./hex-view.ts";
+
+const ListHeight = 600;
+const EntryHeight = 36;
+const HexRowHeight = 24;
+
+interface Label {
+  label: string;
+  address: number;
+}
+
+// indices of the entries containing the search term
+function search<T>(items: T[], term: string, text: (item: T) => string) {
+  const needle = term.trim().toLowerCase();
+  const indices: number[] = [];
+  items.forEach((item, index) => {
+    if (!needle || text(item).toLowerCase().includes(needle)) {
+      indices.push(index);
+    }
+  });
+  return indices;
 }
 
-export function BytecodeVisualizer({ data }: { data: MachineData }) {
+interface Props {
+  data: MachineData;
+  /** Relates the bytes to the assembly - enables the instruction info and navigation */
+  sourceMap?: SourceMap;
+  /** Offset to show in the hex view */
+  focusTarget?: { offset: number };
+  onShowAsmLine?: (line: number) => void;
+}
+
+export function BytecodeVisualizer({
+  data,
+  sourceMap,
+  focusTarget,
+  onShowAsmLine,
+}: Props) {
+  const [tab, setTab] = useState("memory");
+  const [memorySearch, setMemorySearch] = useState("");
+  const [labelSearch, setLabelSearch] = useState("");
+  const [offsetInput, setOffsetInput] = useState("");
+  const [selectedOffset, setSelectedOffset] = useState<number | null>(null);
+  const [hoveredOffset, setHoveredOffset] = useState<number | null>(null);
+  const hexListRef = useRef<VirtualListHandle>(null);
+
+  const bytes = useMemo(() => hexToBytes(data.ByteCode ?? ""), [data]);
+  const labels = data.Labels as Label[];
+  const labelsByAddress = useMemo(
+    () => new Map(labels.map((l) => [l.address, l.label])),
+    [labels],
+  );
+
+  const deferredMemorySearch = useDeferredValue(memorySearch);
+  const memoryIndices = useMemo(
+    () => search(data.Memory, deferredMemorySearch, (item) => item),
+    [data, deferredMemorySearch],
+  );
+  const deferredLabelSearch = useDeferredValue(labelSearch);
+  const labelIndices = useMemo(
+    () => search(labels, deferredLabelSearch, (item) => item.label),
+    [labels, deferredLabelSearch],
+  );
+
+  const offsetInvalid =
+    offsetInput !== "" &&
+    (parseOffset(offsetInput) === null ||
+      parseOffset(offsetInput)! >= (bytes?.length ?? 0));
+
+  const jumpToOffset = (offset: number) => {
+    if (!bytes || offset < 0 || offset >= bytes.length) return;
+    setSelectedOffset(offset);
+    setTab("hexview");
+    // the list is mounted only once its tab is shown
+    requestAnimationFrame(() =>
+      hexListRef.current?.scrollToIndex(Math.floor(offset / BytesPerRow)),
+    );
+  };
+
+  useEffect(() => {
+    if (focusTarget) jumpToOffset(focusTarget.offset);
+  }, [focusTarget]);
+
+  // instruction under the mouse, otherwise the selected one
+  const inspectedOffset = hoveredOffset ?? selectedOffset;
+  const inspected =
+    inspectedOffset !== null ? sourceMap?.at(inspectedOffset) : undefined;
+  const inspectedEnd = inspected
+    ? inspected.instruction.offset + inspected.instruction.info.size
+    : -1;
 
-  const formattedByteCode = useMemo(() => formatHexView(data.ByteCode), [data])
+  const renderHexRow = (row: number) => {
+    const start = row * BytesPerRow;
+    const isInspected = (offset: number) =>
+      !!inspected &&
+      offset >= inspected.instruction.offset &&
+      offset < inspectedEnd;
+    return (
+      <div className="flex font-mono text-sm leading-6 whitespace-pre">
+        <span className="text-muted-foreground mr-4">{formatOffset(start)}</span>
+        {formatRow(bytes!, row).map((cell, i) => (
+          <span
+            key={i}
+            className={cn(
+              "px-[3px] cursor-pointer",
+              i === BytesPerRow / 2 && "ml-2",
+              isInspected(start + i) && "bg-muted",
+              start + i === selectedOffset &&
+                "bg-primary text-primary-foreground rounded-sm",
+            )}
+            onMouseEnter={() => setHoveredOffset(start + i)}
+            onMouseLeave={() => setHoveredOffset(null)}
+            onClick={() => setSelectedOffset(start + i)}
+          >
+            {cell}
+          </span>
+        ))}
+      </div>
+    );
+  };
 
   return (
-    <Tabs defaultValue="memory">
+    <Tabs value={tab} onValueChange={setTab}>
       <TabsList>
         <TabsTrigger value="memory">Memory Map</TabsTrigger>
         <TabsTrigger value="labels">Labels</TabsTrigger>
@@ -41,22 +159,33 @@ export function BytecodeVisualizer({ data }: { data: MachineData }) {
           <CardHeader className="pb-2">
             <CardTitle className="text-sm">Memory Layout</CardTitle>
             <CardDescription>
-              Variables and registers used in the contract
+              Variables and registers used in the contract ({data.Memory.length})
             </CardDescription>
+            <Input
+              placeholder="Search variables..."
+              value={memorySearch}
+              onChange={(e) => setMemorySearch(e.target.value)}
+            />
           </CardHeader>
           <CardContent>
-            <ScrollArea className="h-[600px]">
-              <div className="grid grid-cols-1 gap-1">
-                {data.Memory.map((item, index) => (
-                  <div key={item} className="flex items-center p-2 rounded-md">
+            <VirtualList
+              count={memoryIndices.length}
+              rowHeight={EntryHeight}
+              height={ListHeight}
+              renderRow={(i) => {
+                const index = memoryIndices[i]!;
+                return (
+                  <div className="flex items-center p-2 rounded-md">
                     <Badge variant="outline" className="mr-2 w-8 text-center">
                       {index}
                     </Badge>
-                    <span className="font-mono text-sm">{item}</span>
+                    <span className="font-mono text-sm">
+                      {data.Memory[index]}
+                    </span>
                   </div>
-                ))}
-              </div>
-            </ScrollArea>
+                );
+              }}
+            />
           </CardContent>
         </Card>
       </TabsContent>
@@ -65,20 +194,33 @@ export function BytecodeVisualizer({ data }: { data: MachineData }) {
         <Card>
           <CardHeader className="pb-2">
             <CardTitle className="text-sm">Code Labels</CardTitle>
-            <CardDescription>Jump targets in the bytecode</CardDescription>
+            <CardDescription>
+              Jump targets in the bytecode - click to show in the hex view
+            </CardDescription>
+            <Input
+              placeholder="Search labels..."
+              value={labelSearch}
+              onChange={(e) => setLabelSearch(e.target.value)}
+            />
           </CardHeader>
           <CardContent>
-            <div className="grid grid-cols-1 gap-1">
-              {data.Labels.map((item: any, index: number) => (
-                <div
-                  key={index}
-                  className="flex items-center justify-between p-2 rounded-md"
-                >
-                  <span className="font-mono text-sm">{item.label}</span>
-                  <Badge variant="secondary">Address: {item.address}</Badge>
-                </div>
-              ))}
-            </div>
+            <VirtualList
+              count={labelIndices.length}
+              rowHeight={EntryHeight}
+              height={ListHeight}
+              renderRow={(i) => {
+                const item = labels[labelIndices[i]!]!;
+                return (
+                  <button
+                    className="flex w-full items-center justify-between p-2 rounded-md hover:bg-muted"
+                    onClick={() => jumpToOffset(item.address)}
+                  >
+                    <span className="font-mono text-sm">{item.label}</span>
+                    <Badge variant="secondary">Address: {item.address}</Badge>
+                  </button>
+                );
+              }}
+            />
           </CardContent>
         </Card>
       </TabsContent>
@@ -88,17 +230,69 @@ export function BytecodeVisualizer({ data }: { data: MachineData }) {
           <CardHeader className="pb-2">
             <CardTitle className="text-sm">Bytecode Hex View</CardTitle>
             <CardDescription>
-              Hexadecimal representation of the bytecode ({data.ByteCode.length/2} bytes)
+              Hexadecimal representation of the bytecode ({bytes?.length ?? 0} bytes)
             </CardDescription>
+            <Input
+              placeholder="Jump to offset, e.g. 0x1a0 or 416"
+              value={offsetInput}
+              aria-invalid={offsetInvalid}
+              onChange={(e) => setOffsetInput(e.target.value)}
+              onKeyDown={(e) => {
+                const offset = parseOffset(offsetInput);
+                if (e.key === "Enter" && offset !== null) jumpToOffset(offset);
+              }}
+            />
+            {sourceMap && (
+              <div className="flex items-center justify-between gap-2 h-8 font-mono text-xs">
+                {inspected ? (
+                  <>
+                    <span className="truncate">
+                      {formatOffset(inspected.instruction.offset)}:{" "}
+                      {formatInstruction(inspected.instruction, {
+                        memory: data.Memory,
+                        labels: labelsByAddress,
+                      })}
+                      {inspected.line > 0 && (
+                        <span className="text-muted-foreground">
+                          {" "}
+                          - SmartC line {inspected.line}
+                        </span>
+                      )}
+                    </span>
+                    {inspected.asmLine > 0 && onShowAsmLine && (
+                      <Button
+                        variant="ghost"
+                        size="sm"
+                        onClick={() => onShowAsmLine(inspected.asmLine)}
+                      >
+                        Go to line {inspected.asmLine}
+                      </Button>
+                    )}
+                  </>
+                ) : (
+                  <span className="text-muted-foreground">
+                    Hover or click a byte to inspect its instruction
+                  </span>
+                )}
+              </div>
+            )}
           </CardHeader>
           <CardContent>
-            <div className="rounded-md font-mono text-sm overflow-x-auto">
-              {formattedByteCode}
-            </div>
+            {bytes ? (
+              <VirtualList
+                ref={hexListRef}
+                count={rowCount(bytes)}
+                rowHeight={HexRowHeight}
+                height={ListHeight}
+                renderRow={renderHexRow}
+                className="rounded-md"
+              />
+            ) : (
+              <div className="font-mono text-sm">Invalid hex string</div>
+            )}
           </CardContent>
         </Card>
       </TabsContent>
     </Tabs>
   );
 }
-
@@ -0,0 +1,48 @@
+export const BytesPerRow = 16;
+
+const HexBytes = Array.from({ length: 256 }, (_, b) =>
+  b.toString(16).padStart(2, "0"),
+);
+
+/**
+ * Decodes the machine data's hex string, or returns null if it is not valid hex
+ */
+export function hexToBytes(hex: string): Uint8Array | null {
+  if (hex.length % 2 !== 0 || !/^[0-9a-f]*$/i.test(hex)) return null;
+  const bytes = new Uint8Array(hex.length / 2);
+  for (let i = 0; i < bytes.length; i++) {
+    bytes[i] = Number.parseInt(hex.slice(i * 2, i * 2 + 2), 16);
+  }
+  return bytes;
+}
+
+export function rowCount(bytes: Uint8Array) {
+  return Math.ceil(bytes.length / BytesPerRow);
+}
+
+/**
+ * Hex strings of the bytes in the given row - decoded on demand, such that only visible rows cost anything
+ */
+export function formatRow(bytes: Uint8Array, row: number): string[] {
+  const start = row * BytesPerRow;
+  const end = Math.min(bytes.length, start + BytesPerRow);
+  const cells: string[] = [];
+  for (let i = start; i < end; i++) {
+    cells.push(HexBytes[bytes[i]!]!);
+  }
+  return cells;
+}
+
+export function formatOffset(offset: number) {
+  return offset.toString(16).padStart(4, "0");
+}
+
+/**
+ * Parses "0x1a0" as hex and "416" as decimal offset
+ */
+export function parseOffset(input: string): number | null {
+  const value = input.trim().toLowerCase();
+  if (/^0x[0-9a-f]+$/.test(value)) return Number.parseInt(value.slice(2), 16);
+  if (/^\d+$/.test(value)) return Number.parseInt(value, 10);
+  return null;
+}
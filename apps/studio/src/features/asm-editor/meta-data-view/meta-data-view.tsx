@@ -4,12 +4,16 @@ import { Button } from "@/components/ui/button.tsx";
 import { BytecodeVisualizer } from "./bytecode-visualizer.tsx";
 import type { MachineData } from "@/features/asm-editor/machine-data.ts";
 import { ContractMetadata } from "./contract-meta-data.tsx";
+import type { SourceMap } from "@signum-smartc-scd/core/analysis";
 
 interface Props {
   machineData: MachineData
+  sourceMap?: SourceMap
+  focusTarget?: { offset: number }
+  onShowAsmLine?: (line: number) => void
 }
 
-export function MetaDataView({machineData}:Props) {
+export function MetaDataView({machineData, sourceMap, focusTarget, onShowAsmLine}:Props) {
   return (
     <div className="grid grid-cols-2 h-full">
       <div className="border-r overflow-auto">
@@ -30,7 +34,14 @@ export function MetaDataView({machineData}:Props) {
           <h3 className="text-lg font-medium mb-4">
             ByteCode Visualization
           </h3>
-          {machineData && <BytecodeVisualizer data={machineData} />}
+          {machineData && (
+            <BytecodeVisualizer
+              data={machineData}
+              sourceMap={sourceMap}
+              focusTarget={focusTarget}
+              onShowAsmLine={onShowAsmLine}
+            />
+          )}
         </div>
       </div>
     </div>
@@ -39,12 +39,15 @@ export function NewProjectDialog({ close }: Props) {
   const handleCreateClicked = async () => {
     if (!canSubmit) return;
 
-    const folderId = await fs.createFolder("/", name);
     const fileName = replaceWhitespace(name);
 
-    if (projectType === "create") {
-      await fs.addFile(folderId, `${fileName.toLowerCase()}.scd.json`, FileTypes.SCD, null )
-    }
+    // folder and file are committed together
+    await fs.batch(async () => {
+      const folderId = await fs.createFolder("/", name);
+      if (projectType === "create") {
+        await fs.addFile(folderId, `${fileName.toLowerCase()}.scd.json`, FileTypes.SCD, null )
+      }
+    });
 
     close();
   };
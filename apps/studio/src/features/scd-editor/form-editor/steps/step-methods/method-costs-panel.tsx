@@ -0,0 +1,148 @@
+import type { SCDType } from "@signum-smartc-scd/core/parser";
+import type {
+  CostCurve,
+  ExecutionCost,
+} from "@signum-smartc-scd/core/analysis";
+import { Amount } from "@signumjs/util";
+import { GaugeIcon, TriangleAlertIcon } from "lucide-react";
+import { LoadingSpinner } from "@/components/ui/loading-spinner.tsx";
+import {
+  Tooltip,
+  TooltipContent,
+  TooltipTrigger,
+} from "@/components/ui/tooltip.tsx";
+import { useMethodCosts } from "../../../hooks/use-method-costs.ts";
+
+function formatFee(feeNQT: bigint) {
+  return Amount.fromPlanck(feeNQT.toString()).getSigna();
+}
+
+function Cost({ cost }: { cost: ExecutionCost }) {
+  return (
+    <Tooltip>
+      <TooltipTrigger asChild>
+        <span className="tabular-nums">
+          {cost.steps}
+          <small className="opacity-70"> ({formatFee(cost.feeNQT)})</small>
+        </span>
+      </TooltipTrigger>
+      <TooltipContent>
+        {cost.instructions} instructions, {cost.apiCalls} API calls ={" "}
+        {cost.steps} steps - {formatFee(cost.feeNQT)} SIGNA
+      </TooltipContent>
+    </Tooltip>
+  );
+}
+
+function CurveSparkline({ curve }: { curve: CostCurve }) {
+  const width = 80;
+  const height = 20;
+  const maxX = Math.max(...curve.points.map((p) => p.x), 1);
+  const maxY = Math.max(...curve.points.map((p) => p.steps), 1);
+  const path = curve.points
+    .map(
+      (p, i) =>
+        `${i ? "L" : "M"}${((p.x / maxX) * width).toFixed(1)},${(height - (p.steps / maxY) * height).toFixed(1)}`,
+    )
+    .join(" ");
+
+  return (
+    <Tooltip>
+      <TooltipTrigger asChild>
+        <div className="flex items-center gap-1 text-xs">
+          <svg width={width} height={height} className="stroke-current">
+            <path d={path} fill="none" strokeWidth={1.5} />
+          </svg>
+          <span className="opacity-70">
+            ~{curve.slope.toFixed(1)} steps / {curve.parameter}
+          </span>
+        </div>
+      </TooltipTrigger>
+      <TooltipContent>
+        {curve.points.map((p) => (
+          <div key={p.x}>
+            {curve.parameter} = {p.x}: {p.steps} steps
+          </div>
+        ))}
+      </TooltipContent>
+    </Tooltip>
+  );
+}
+
+export function MethodCostsPanel({ data }: { data: SCDType }) {
+  const { report, error, isLoading } = useMethodCosts(data);
+
+  return (
+    <section className="border rounded-lg p-4 space-y-2">
+      <div className="flex items-center gap-2 font-medium">
+        <GaugeIcon className="h-4 w-4" />
+        Execution Costs
+        {isLoading && <LoadingSpinner />}
+      </div>
+      <p className="text-xs opacity-70">
+        Steps (and fees in SIGNA) per call, measured by running synthetic
+        messages through the AT emulator.
+      </p>
+      {error && <p className="text-sm text-destructive">{error}</p>}
+      {report && (
+        <table className="w-full text-sm">
+          <thead>
+            <tr className="text-left opacity-70">
+              <th className="font-normal">Method</th>
+              <th className="font-normal">Min</th>
+              <th className="font-normal">Typical</th>
+              <th className="font-normal">Worst</th>
+              <th className="font-normal">Scaling</th>
+            </tr>
+          </thead>
+          <tbody>
+            {report.methods.map((method) => (
+              <tr key={method.code} className="border-t">
+                <td className="py-1">
+                  <div className="flex items-center gap-1">
+                    {method.name}
+                    {method.errors.length > 0 && (
+                      <Tooltip>
+                        <TooltipTrigger asChild>
+                          <TriangleAlertIcon className="h-3 w-3 text-destructive" />
+                        </TooltipTrigger>
+                        <TooltipContent>
+                          {method.errors.join(", ")}
+                        </TooltipContent>
+                      </Tooltip>
+                    )}
+                  </div>
+                </td>
+                <td>
+                  <Cost cost={method.min} />
+                </td>
+                <td>
+                  <Cost cost={method.typical} />
+                </td>
+                <td>
+                  <Cost cost={method.worst} />
+                </td>
+                <td>
+                  {method.curves.length ? (
+                    method.curves.map((curve) => (
+                      <CurveSparkline key={curve.parameter} curve={curve} />
+                    ))
+                  ) : (
+                    <span className="opacity-70">constant</span>
+                  )}
+                </td>
+              </tr>
+            ))}
+            <tr className="border-t opacity-70">
+              <td className="py-1">No method (dispatch only)</td>
+              <td colSpan={3}>
+                <Cost cost={report.dispatch} />
+              </td>
+              <td />
+            </tr>
+          </tbody>
+        </table>
+      )}
+    </section>
+  );
+}
@@ -10,6 +10,7 @@ import {
   AccordionTrigger,
 } from "@/components/ui/accordion";
 import { useState } from "react";
+import { MethodCostsPanel } from "./method-costs-panel";
 
 export function StepMethods({ updateData, data, setCanProceed }: StepProps) {
   const [openItem, setOpenItem] = useState<string>("");
@@ -74,6 +75,7 @@ export function StepMethods({ updateData, data, setCanProceed }: StepProps) {
           </Accordion>
         </div>
       </section>
+      {data.methods?.length > 0 && <MethodCostsPanel data={data} />}
     </div>
   );
 }
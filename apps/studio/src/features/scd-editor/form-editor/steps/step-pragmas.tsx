@@ -1,5 +1,6 @@
 import { Input } from "@/components/ui/input";
 import { FieldLabel } from "@/components/ui/field-label";
+import { Checkbox } from "@/components/ui/checkbox";
 import type { StepProps } from "./step-props";
 
 export function StepPragmas({ updateData, data }: StepProps) {
@@ -39,6 +40,18 @@ export function StepPragmas({ updateData, data }: StepProps) {
           step={1}
         />
       </section>
+      <section className="flex gap-x-2 items-center">
+        <Checkbox
+          checked={data.packedLayout ?? false}
+          onCheckedChange={(checked) => {
+            updateData("packedLayout", Boolean(checked));
+          }}
+        />
+        <FieldLabel
+          text="Packed Layout"
+          tooltip="Packs boolean and enum variables bitwise into shared longs, accessed by get_<name>() and set_<name>(value) macros. Fewer data pages make the deployment cheaper."
+        />
+      </section>
     </div>
   );
 }
@@ -28,6 +28,18 @@ const transactionKindOptions = [
   { value: "sendQuantityAndAmount", label: "Send Token and Signa" },
 ];
 
+const deliveryOptions = [
+  { value: "none", label: "None - no code generated" },
+  { value: "immediate", label: "Immediate" },
+  { value: "batched", label: "Batched per activation" },
+];
+
+const aggregationOptions = [
+  { value: "sum", label: "Sum" },
+  { value: "last", label: "Last" },
+  { value: "perRecipient", label: "Sum per recipient" },
+];
+
 export function TransactionForm({ transaction, onUpdate, onDelete }: Props) {
   return (
     <div className="border p-4 rounded-lg">
@@ -93,6 +105,66 @@ export function TransactionForm({ transaction, onUpdate, onDelete }: Props) {
             </SelectContent>
           </Select>
         </div>
+
+        <div>
+          <FieldLabel
+            text="Delivery"
+            tooltip="Generates <name>_send(...). Batched transactions are merged during the activation and sent once after all incoming transactions are processed, which saves their fees."
+          />
+          <Select
+            value={transaction.delivery ?? "none"}
+            onValueChange={(delivery) =>
+              onUpdate({
+                ...transaction,
+                delivery:
+                  delivery === "none"
+                    ? undefined
+                    : (delivery as TransactionDefinition["delivery"]),
+              })
+            }
+          >
+            <SelectTrigger>
+              <SelectValue placeholder="Select Delivery" />
+            </SelectTrigger>
+            <SelectContent>
+              {deliveryOptions.map((option) => (
+                <SelectItem key={option.value} value={option.value}>
+                  {option.label}
+                </SelectItem>
+              ))}
+            </SelectContent>
+          </Select>
+        </div>
+
+        {transaction.delivery === "batched" && (
+          <div>
+            <FieldLabel
+              text="Aggregation"
+              tooltip="Sum adds up the quantity and the amount - with a message its first long. Last keeps the last call only. Calls to another recipient send the pending transaction, except with sum per recipient."
+            />
+            <Select
+              value={transaction.aggregation ?? "sum"}
+              onValueChange={(aggregation) =>
+                onUpdate({
+                  ...transaction,
+                  aggregation:
+                    aggregation as TransactionDefinition["aggregation"],
+                })
+              }
+            >
+              <SelectTrigger>
+                <SelectValue placeholder="Select Aggregation" />
+              </SelectTrigger>
+              <SelectContent>
+                {aggregationOptions.map((option) => (
+                  <SelectItem key={option.value} value={option.value}>
+                    {option.label}
+                  </SelectItem>
+                ))}
+              </SelectContent>
+            </Select>
+          </div>
+        )}
       </section>
     </div>
   );
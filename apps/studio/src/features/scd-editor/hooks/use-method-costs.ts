@@ -0,0 +1,94 @@
+import { useEffect, useState } from "react";
+import { useAtomValue } from "jotai";
+import type { SCDType } from "@signum-smartc-scd/core/parser";
+import type { CostReport } from "@signum-smartc-scd/core/analysis";
+import { scdFileIdAtom } from "../stores/scd-data-atoms.ts";
+import { useFileSystem } from "@/hooks/use-file-system.ts";
+import {
+  CompileCancelledError,
+  CompilerService,
+  CostEstimationService,
+} from "@/lib/compiler";
+import { FileTypes } from "@/features/project/filetype-icons.tsx";
+
+const EstimationDelay = 1_000;
+
+interface MethodCostsState {
+  report: CostReport | null;
+  error?: string;
+  isLoading: boolean;
+}
+
+/**
+ * Compiles the SmartC file of the same name next to the current SCD file and estimates the method costs
+ * with the emulator, in a worker.
+ */
+export function useMethodCosts(scdData: SCDType | null) {
+  const fileId = useAtomValue(scdFileIdAtom);
+  const fs = useFileSystem();
+  const [state, setState] = useState<MethodCostsState>({
+    report: null,
+    isLoading: false,
+  });
+
+  useEffect(() => {
+    if (!scdData || !fileId) return;
+
+    let isCurrent = true;
+    const estimate = async () => {
+      const folderId = fs.getFolderIdOfFile(fileId);
+      const baseName = fs.getFileMetadata(fileId)?.name.split(".")[0];
+      const smartCFile = fs
+        .listFolderContents(folderId ?? undefined)
+        .files.find(
+          (f) =>
+            f.metadata.type === FileTypes.SmartC &&
+            f.metadata.name.split(".")[0] === baseName,
+        );
+      if (!smartCFile) {
+        return setState({
+          report: null,
+          isLoading: false,
+          error: "Generate the SmartC code to see the method costs",
+        });
+      }
+
+      setState((prev) => ({ ...prev, isLoading: true }));
+      const { content } = await fs.loadFile<string>(smartCFile.id);
+      const result = await CompilerService.getInstance().compileSmartC(
+        content,
+        `method-costs:${fileId}`,
+      );
+      if (!isCurrent) return;
+      if (!result.ok || !result.machineData) {
+        return setState({
+          report: null,
+          isLoading: false,
+          error: `${smartCFile.metadata.name} does not compile: ${result.error}`,
+        });
+      }
+
+      const report = await CostEstimationService.getInstance().estimate({
+        scd: scdData,
+        machineData: result.machineData,
+        channel: `method-costs:${fileId}`,
+      });
+      if (!isCurrent) return;
+      setState({ report, isLoading: false });
+    };
+
+    const timeout = setTimeout(() => {
+      estimate().catch((e) => {
+        if (e instanceof CompileCancelledError || !isCurrent) return;
+        setState({ report: null, isLoading: false, error: e.message });
+      });
+    }, EstimationDelay);
+
+    return () => {
+      isCurrent = false;
+      clearTimeout(timeout);
+    };
+  }, [scdData, fileId, fs]);
+
+  return state;
+}
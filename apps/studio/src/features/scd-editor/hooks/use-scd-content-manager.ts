@@ -1,17 +1,28 @@
-import { useAtom } from "jotai";
+import { useAtom, useAtomValue } from "jotai";
 import {
   scdDataAtom, scdFileIdAtom,
-  scdValidationAtom
+  scdValidationAtom, scdValidatorAtom
 } from "../stores/scd-data-atoms.ts";
-import { useCallback } from "react";
-import { SCD, type SCDType } from "@signum-smartc-scd/core/parser";
+import { useCallback, useMemo } from "react";
+import {
+  SCD,
+  type SCDType,
+  type SCDValidationError,
+} from "@signum-smartc-scd/core/parser";
 import debounce from "lodash.debounce";
 import { useFileSystem } from "@/hooks/use-file-system.ts";
 
+// validation is incremental and immediate, the debounce only coalesces the saves while typing
+const SaveDebounceMs = 300;
+
+const formatError = ({ instancePath, message }: SCDValidationError) =>
+  `Invalid SCD: ${instancePath || "/"} ${message}`;
+
 export function useScdContentManager() {
   const [scdData, setSCDData] = useAtom(scdDataAtom);
   const [validation, setValidation] = useAtom(scdValidationAtom);
   const [currentFileId, setCurrentFileId] = useAtom(scdFileIdAtom)
+  const validator = useAtomValue(scdValidatorAtom);
   const fs = useFileSystem();
 
   const updateScdData = useCallback(
@@ -23,15 +34,16 @@ export function useScdContentManager() {
 
         const scd = SCD.parse(json);
         const newData = scd.raw;
+        // e.g. a loaded file - the next edits are validated against it
+        validator.sync(newData);
         setSCDData((prev) => ({ ...prev, data: newData }));
         setValidation({ isValid: true, lastValidData: newData });
         if(!currentFileId) {
           console.debug("FileId is not provided yet - use setCurrentFileId()");
           return;
         }
-        const file = await fs.loadFile<SCDType>(currentFileId);
-        // Auto-save if valid
-        if (file) {
+        // Auto-save if valid - repeated saves are coalesced by the file system
+        if (fs.exists(currentFileId)) {
           await fs.saveFile(currentFileId, newData);
           // Update originalData after save
           setSCDData((prev) => ({ ...prev, originalData: newData }));
@@ -45,13 +57,34 @@ export function useScdContentManager() {
         throw e;
       }
     },
-    [setSCDData, setValidation, fs],
+    [setSCDData, setValidation, fs, validator],
   );
 
-  const requestUpdateScdData: (data: string|object|SCDType, onUpdated?: () => void) => void = useCallback(debounce(
-    (data: string, onUpdated = () => {}) => {
+  const saveDebounced = useMemo(() => debounce(
+    (data: object, onUpdated: () => void) => {
     updateScdData(data).then(onUpdated)
-  }, 2_000), [updateScdData]);
+  }, SaveDebounceMs), [updateScdData]);
+
+  // validates only the changed parts right away, and saves once the edit is valid
+  const requestUpdateScdData: (data: string|object|SCDType, onUpdated?: () => void) => void = useCallback(
+    (data, onUpdated = () => {}) => {
+      let json: object;
+      try {
+        json = typeof data === "string" ? JSON.parse(data) : data;
+      } catch (e) {
+        saveDebounced.cancel();
+        setValidation({ isValid: false, errorMessage: e.message });
+        return;
+      }
+      const [error] = validator.sync(json);
+      if (error) {
+        saveDebounced.cancel();
+        setValidation({ isValid: false, errorMessage: formatError(error) });
+        return;
+      }
+      setValidation({ isValid: true, lastValidData: json as SCDType });
+      saveDebounced(json, onUpdated);
+  }, [validator, saveDebounced, setValidation]);
 
   return {
     scdData: scdData.data,
@@ -1,7 +1,10 @@
 
 // File editing state atoms
 import { atom } from "jotai";
-import type { SCDType } from "@signum-smartc-scd/core/parser";
+import {
+  IncrementalValidator,
+  type SCDType,
+} from "@signum-smartc-scd/core/parser";
 import type { FileId } from "@/stores/project-atoms.ts";
 
 
@@ -22,6 +25,9 @@ export const scdValidationAtom = atom<{
   isValid: false,
 });
 
+// Validates the edits incrementally - shared by the form and the JSON editor
+export const scdValidatorAtom = atom(() => new IncrementalValidator());
+
 // // Track save state
 // export const scdSaveStateAtom = atom((get) => {
 //   const { data, originalData } = get(scdDataAtom);
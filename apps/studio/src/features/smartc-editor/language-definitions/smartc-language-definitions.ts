@@ -1,12 +1,22 @@
 import type * as Monaco from "monaco-editor";
 import { SmartCKeywords } from "./keywords.ts";
 import { SmartCFunctions } from "./functions.ts";
-import { SmartC } from "smartc-signum-compiler";
+import { scanSmartCLine } from "./smartc-symbols.ts";
+import { CompilerService, CompileCancelledError } from "@/lib/compiler";
+import {
+  CompletionIndex,
+  nearestSymbol,
+  symbolCompletionItem,
+  symbolHover,
+  symbolIndexOf,
+  symbolRange,
+} from "@/lib/editor";
 
 // so, monaco is a global instance apparently and though we need to avoid multiple extensions
 let hasExtendedAlready = false;
-const SmartCErrorPattern =
-  /At line: (?<line>\d+):(?<column>\d+)\.\s+(?<message>.*)/;
+
+// `stats.` or `stats[i]->`
+const MemberAccessPattern = /([A-Za-z_]\w*)\s*(?:\[[^\]]*\])?\s*(?:\.|->)\s*$/;
 
 
 
@@ -16,33 +26,37 @@ export function extendCLangWithSmartC(monaco: typeof Monaco) {
   if (hasExtendedAlready) return;
   hasExtendedAlready = true;
 
-  const validateModel = (model: Monaco.editor.ITextModel) => {
+  const validateModel = async (model: Monaco.editor.ITextModel) => {
     if (model.getLanguageId() !== "c") {
       return;
     }
 
-    const markers: Monaco.editor.IMarkerData[] = [];
-    const sourceCode = model.getValue();
+    const versionId = model.getVersionId();
     try {
-      const compiler = new SmartC({ language: "C", sourceCode });
-      compiler.compile();
-    } catch (e) {
-      const result = SmartCErrorPattern.exec(e.message);
-      if (result) {
-        // @ts-ignore
-        const { line, column, message } = result.groups;
-        console.log(line, column, message);
-        markers.push({
+      const { diagnostics } = await CompilerService.getInstance().compileSmartC(
+        model.getValue(),
+        model.uri.toString(),
+      );
+      // model changed or disposed meanwhile - a newer validation is on its way
+      if (model.isDisposed() || model.getVersionId() !== versionId) {
+        return;
+      }
+      const markers: Monaco.editor.IMarkerData[] = diagnostics.map(
+        ({ line, column, message }) => ({
           severity: monaco.MarkerSeverity.Error,
-          message: message,
-          startLineNumber: parseInt(line),
-          startColumn: parseInt(column),
-          endLineNumber: parseInt(line),
-          endColumn: parseInt(column),
-        });
+          message,
+          startLineNumber: line,
+          startColumn: column,
+          endLineNumber: line,
+          endColumn: column,
+        }),
+      );
+      monaco.editor.setModelMarkers(model, "smartc", markers);
+    } catch (e) {
+      if (!(e instanceof CompileCancelledError)) {
+        console.error("SmartC validation failed", e);
       }
     }
-    monaco.editor.setModelMarkers(model, "smartc", markers);
   }
 
     // Process any existing models that might have been created before the listener was registered
@@ -65,7 +79,76 @@ export function extendCLangWithSmartC(monaco: typeof Monaco) {
   //   validateModel(model)
   // });
 
+  // built once, only the range differs per request
+  const completions = new CompletionIndex([
+    ...Object.entries(SmartCKeywords).map(([keyword, info]) => ({
+      label: keyword,
+      kind: monaco.languages.CompletionItemKind.Keyword,
+      insertText: keyword,
+      detail: info.detail,
+      documentation: info.documentation,
+    })),
+    ...Object.entries(SmartCFunctions).map(([funcName, info]) => {
+      // Create snippet with parameter placeholders
+      let snippetText = funcName + "(";
+
+      if (info.params && info.params.length > 0) {
+        snippetText += info.params
+          .map((param, index) => `\${${index + 1}:${param.name}}`)
+          .join(", ");
+      }
+
+      snippetText += ")";
+
+      return {
+        label: funcName,
+        kind: monaco.languages.CompletionItemKind.Function,
+        detail: info.detail,
+        documentation: {
+          value: info.documentation,
+          isTrusted: true,
+        },
+        insertText: snippetText,
+        insertTextRules:
+          monaco.languages.CompletionItemInsertTextRule.InsertAsSnippet,
+      };
+    }),
+  ]);
+
+  // fields of the struct variable in front of `.` or `->`, undefined if it's no member access
+  const membersAt = (
+    model: Monaco.editor.ITextModel,
+    lineNumber: number,
+    wordStart: number,
+  ) => {
+    const before = model.getLineContent(lineNumber).slice(0, wordStart - 1);
+    if (!/(\.|->)\s*$/.test(before)) return undefined;
+    const access = MemberAccessPattern.exec(before);
+    if (!access) return [];
+    const symbols = symbolIndexOf(model, scanSmartCLine);
+    const variable = nearestSymbol(
+      symbols.lookup(access[1]!).filter((symbol) => symbol.type),
+      lineNumber,
+    );
+    return variable ? symbols.fieldsOf(variable.type!) : [];
+  };
+
+  // the user's declaration of the word - fields are resolved by the variable in front of them
+  const declarationAt = (
+    model: Monaco.editor.ITextModel,
+    position: Monaco.Position,
+  ) => {
+    const word = model.getWordAtPosition(position);
+    if (!word) return undefined;
+    const members = membersAt(model, position.lineNumber, word.startColumn);
+    const symbols =
+      members?.filter(({ name }) => name === word.word) ??
+      symbolIndexOf(model, scanSmartCLine).lookup(word.word);
+    return nearestSymbol(symbols, position.lineNumber);
+  };
+
   monaco.languages.registerCompletionItemProvider("c", {
+    triggerCharacters: ["."],
     provideCompletionItems: (
       model,
       position,
@@ -78,49 +161,32 @@ export function extendCLangWithSmartC(monaco: typeof Monaco) {
         endColumn: word.endColumn,
       };
 
-      // SmartC-specific keywords suggestions
-      const keywordSuggestions = Object.entries(SmartCKeywords).map(
-        ([keyword, info]) =>
-          ({
-            label: keyword,
-            kind: monaco.languages.CompletionItemKind.Keyword,
-            insertText: keyword,
-            detail: info.detail,
-            documentation: info.documentation,
-            range,
-          }) as Monaco.languages.CompletionItem,
-      );
-
-      const functionSuggestions = Object.entries(SmartCFunctions).map(
-        ([funcName, info]) => {
-          // Create snippet with parameter placeholders
-          let snippetText = funcName + "(";
+      const members = membersAt(model, position.lineNumber, word.startColumn);
+      if (members) {
+        return {
+          suggestions: members.map((field) =>
+            symbolCompletionItem(monaco, field, range),
+          ),
+        };
+      }
 
-          if (info.params && info.params.length > 0) {
-            snippetText += info.params
-              .map((param, index) => `\${${index + 1}:${param.name}}`)
-              .join(", ");
-          }
+      const userSuggestions = symbolIndexOf(model, scanSmartCLine)
+        .symbols()
+        .map((symbol) => symbolCompletionItem(monaco, symbol, range));
 
-          snippetText += ")";
-
-          return {
-            label: funcName,
-            kind: monaco.languages.CompletionItemKind.Function,
-            detail: info.detail,
-            documentation: {
-              value: info.documentation,
-              isTrusted: true,
-            },
-            insertText: snippetText,
-            insertTextRules:
-              monaco.languages.CompletionItemInsertTextRule.InsertAsSnippet,
-            range,
-          };
-        },
-      );
+      return {
+        suggestions: [
+          ...completions.suggest(word.word, range),
+          ...userSuggestions,
+        ],
+      };
+    },
+  });
 
-      return { suggestions: [...keywordSuggestions, ...functionSuggestions] };
+  monaco.languages.registerDefinitionProvider("c", {
+    provideDefinition: (model, position) => {
+      const symbol = declarationAt(model, position);
+      return symbol ? { uri: model.uri, range: symbolRange(symbol) } : null;
     },
   });
 
@@ -151,7 +217,8 @@ export function extendCLangWithSmartC(monaco: typeof Monaco) {
         };
       }
 
-      return null;
+      const symbol = declarationAt(model, position);
+      return symbol ? symbolHover(symbol) : null;
     },
   });
 
@@ -0,0 +1,140 @@
+import {
+  type EditorSymbol,
+  type LineScanner,
+  stripComments,
+} from "@/lib/editor";
+
+const TypeKeywords = new Set(["long", "fixed", "void", "struct"]);
+
+const DefinePattern = /^\s*#define\s+([A-Za-z_]\w*)(.*)$/;
+const StructPattern = /^\s*struct\s+([A-Za-z_]\w*)\s*(\{|$)/;
+const DeclarationPattern =
+  /(^|[;{}(,])\s*(?:(?:static|const|register)\s+)*(long|fixed|void|struct\s+([A-Za-z_]\w*))\b/g;
+const NamePattern = /\s*\*?\s*([A-Za-z_]\w*)/y;
+
+// index of the closing bracket, or the end of the code
+function skipBrackets(code: string, from: number) {
+  let depth = 0;
+  for (let i = from; i < code.length; i++) {
+    const char = code[i]!;
+    if (char === "(" || char === "[") depth++;
+    else if (char === ")" || char === "]") {
+      if (--depth === 0) return i;
+    }
+  }
+  return code.length;
+}
+
+// declarators of a declaration - `long a = f(1, 2), *b, c[3];` has a, b and c
+function scanDeclarators(
+  code: string,
+  from: number,
+  type: string,
+  symbol: Omit<EditorSymbol, "name" | "column" | "detail">,
+  symbols: EditorSymbol[],
+) {
+  let i = from;
+  while (i < code.length) {
+    NamePattern.lastIndex = i;
+    const match = NamePattern.exec(code);
+    if (!match || TypeKeywords.has(match[1]!)) return;
+    const name = match[1]!;
+    const column = match.index + match[0].length - name.length + 1;
+    i = NamePattern.lastIndex;
+    while (/\s/.test(code[i] ?? "")) i++;
+    if (code[i] === "(" && symbol.kind !== "field") {
+      const end = skipBrackets(code, i);
+      symbols.push({
+        ...symbol,
+        kind: "function",
+        name,
+        column,
+        detail: `${type} ${code.slice(column - 1, end + 1).trim()}`,
+      });
+      return;
+    }
+    symbols.push({ ...symbol, name, column, detail: `${type} ${name}` });
+    // on to the next declarator
+    for (; i < code.length; i++) {
+      const char = code[i]!;
+      if (char === "(" || char === "[") i = skipBrackets(code, i);
+      else if (char === ",") break;
+      else if (char === ";" || char === ")" || char === "{") return;
+    }
+    i++;
+  }
+}
+
+function scanDeclarations(
+  code: string,
+  symbols: EditorSymbol[],
+  container?: string,
+) {
+  for (const match of code.matchAll(DeclarationPattern)) {
+    const type = match[2]!.replace(/\s+/g, " ");
+    scanDeclarators(
+      code,
+      match.index + match[0].length,
+      type,
+      {
+        kind: container === undefined ? "variable" : "field",
+        type: match[3],
+        container,
+      },
+      symbols,
+    );
+  }
+}
+
+function parseState(state: string) {
+  const inComment = state.startsWith("*");
+  const struct = inComment ? state.slice(1) : state;
+  return { inComment, struct: struct || undefined };
+}
+
+/**
+ * Scans a line of SmartC for defines, structs and their fields, functions and variables. The
+ * state tracks open block comments and struct bodies.
+ */
+export const scanSmartCLine: LineScanner = (text, state) => {
+  const parsed = parseState(state);
+  const { code, inComment } = stripComments(text, parsed.inComment);
+  let struct = parsed.struct;
+  const symbols: EditorSymbol[] = [];
+
+  const define = DefinePattern.exec(code);
+  if (define) {
+    const [, name, value] = define;
+    symbols.push({
+      name: name!,
+      kind: "define",
+      column: code.indexOf(name!, code.indexOf("define") + 6) + 1,
+      detail: `#define ${name} ${value!.trim()}`.trim(),
+    });
+  } else if (struct !== undefined) {
+    const end = code.indexOf("}");
+    scanDeclarations(end === -1 ? code : code.slice(0, end), symbols, struct);
+    if (end !== -1) struct = undefined;
+  } else {
+    const header = StructPattern.exec(code);
+    if (header) {
+      struct = header[1]!;
+      symbols.push({
+        name: struct,
+        kind: "struct",
+        column: code.indexOf(struct, code.indexOf("struct") + 6) + 1,
+        detail: `struct ${struct}`,
+      });
+      // the rest of the line, blanking the header to keep the columns
+      const start = header.index + header[0].length;
+      const end = code.indexOf("}", start);
+      const body =
+        " ".repeat(start) + code.slice(start, end === -1 ? undefined : end);
+      scanDeclarations(body, symbols, struct);
+      if (end !== -1) struct = undefined;
+    } else {
+      scanDeclarations(code, symbols);
+    }
+  }
+  return { symbols, state: `${inComment ? "*" : ""}${struct ?? ""}` };
+};
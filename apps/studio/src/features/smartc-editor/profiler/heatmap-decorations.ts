@@ -0,0 +1,41 @@
+import type * as Monaco from "monaco-editor";
+import type { ExecutionProfile } from "@signum-smartc-scd/core/analysis";
+import { Amount } from "@signumjs/util";
+
+const HeatLevels = 5;
+
+export function formatShare(share: number) {
+  return `${(share * 100).toFixed(1)}%`;
+}
+
+export function formatFee(feeNQT: bigint) {
+  return Amount.fromPlanck(feeNQT.toString()).getSigna();
+}
+
+/**
+ * Colors the executed lines by their share of the hottest line - styles are in index.css
+ */
+export function toHeatmapDecorations(
+  profile: ExecutionProfile,
+): Monaco.editor.IModelDeltaDecoration[] {
+  const hottest = profile.lines[0]?.steps ?? 0;
+  return profile.lines.map((line) => {
+    const level = Math.max(1, Math.ceil((line.steps / hottest) * HeatLevels));
+    return {
+      range: {
+        startLineNumber: line.line,
+        startColumn: 1,
+        endLineNumber: line.line,
+        endColumn: 1,
+      },
+      options: {
+        isWholeLine: true,
+        className: `smartc-heat-${level}`,
+        glyphMarginClassName: `smartc-heat-glyph smartc-heat-${level}`,
+        glyphMarginHoverMessage: {
+          value: `**${line.steps} steps** (${formatShare(line.share)}) - ${line.instructions} instructions - ${formatFee(line.feeNQT)} SIGNA`,
+        },
+      },
+    };
+  });
+}
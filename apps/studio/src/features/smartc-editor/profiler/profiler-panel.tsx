@@ -0,0 +1,131 @@
+import type { ExecutionProfile } from "@signum-smartc-scd/core/analysis";
+import { FlameIcon, PlayIcon, XIcon } from "lucide-react";
+import { Button } from "@/components/ui/button.tsx";
+import { Textarea } from "@/components/ui/textarea.tsx";
+import { formatFee, formatShare } from "./heatmap-decorations.ts";
+
+const HottestEntries = 10;
+
+interface Props {
+  profile: ExecutionProfile | null;
+  error?: string;
+  isRunning: boolean;
+  trace: string;
+  onTraceChange: (trace: string) => void;
+  onRun: () => void;
+  onClear: () => void;
+  onRevealLine: (line: number) => void;
+}
+
+function Share({ share }: { share: number }) {
+  return (
+    <div className="flex items-center gap-1">
+      <div className="h-2 w-16 bg-muted rounded-xs">
+        <div
+          className="h-2 bg-orange-500 rounded-xs"
+          style={{ width: formatShare(share) }}
+        />
+      </div>
+      <span className="tabular-nums">{formatShare(share)}</span>
+    </div>
+  );
+}
+
+export function ProfilerPanel({
+  profile,
+  error,
+  isRunning,
+  trace,
+  onTraceChange,
+  onRun,
+  onClear,
+  onRevealLine,
+}: Props) {
+  return (
+    <section className="grid grid-cols-3 gap-4 p-2 border-t text-xs h-[280px] overflow-auto">
+      <div className="space-y-2">
+        <div className="flex items-center justify-between font-medium">
+          <span className="flex items-center gap-1">
+            <FlameIcon className="h-4 w-4" />
+            Transaction Trace
+          </span>
+          <div className="flex gap-1">
+            <Button size="sm" variant="ghost" onClick={onClear}>
+              <XIcon className="h-4 w-4" />
+            </Button>
+            <Button size="sm" onClick={onRun} disabled={isRunning}>
+              <PlayIcon className="h-4 w-4" />
+              Profile
+            </Button>
+          </div>
+        </div>
+        <Textarea
+          className="font-mono text-xs"
+          rows={6}
+          value={trace}
+          onChange={(e) => onTraceChange(e.target.value)}
+        />
+        {error && <p className="text-destructive">{error}</p>}
+        {profile && (
+          <p className="opacity-70">
+            {profile.transactions} transactions in {profile.blocks} blocks:{" "}
+            {profile.total.steps} steps - {formatFee(profile.total.feeNQT)}{" "}
+            SIGNA
+            {profile.errors.length > 0 &&
+              ` - ${profile.errors.length} runtime errors, first: ${profile.errors[0].error}`}
+          </p>
+        )}
+      </div>
+      {profile && (
+        <>
+          <table className="w-full h-fit">
+            <thead>
+              <tr className="text-left opacity-70">
+                <th className="font-normal">Hottest Lines</th>
+                <th className="font-normal">Steps</th>
+                <th className="font-normal">Share</th>
+              </tr>
+            </thead>
+            <tbody>
+              {profile.lines.slice(0, HottestEntries).map((line) => (
+                <tr
+                  key={line.line}
+                  className="border-t cursor-pointer hover:bg-muted"
+                  onClick={() => onRevealLine(line.line)}
+                >
+                  <td className="py-0.5">Line {line.line}</td>
+                  <td className="tabular-nums">{line.steps}</td>
+                  <td>
+                    <Share share={line.share} />
+                  </td>
+                </tr>
+              ))}
+            </tbody>
+          </table>
+          <table className="w-full h-fit">
+            <thead>
+              <tr className="text-left opacity-70">
+                <th className="font-normal">Functions</th>
+                <th className="font-normal">Steps</th>
+                <th className="font-normal">Fee (SIGNA)</th>
+                <th className="font-normal">Share</th>
+              </tr>
+            </thead>
+            <tbody>
+              {profile.functions.slice(0, HottestEntries).map((fn) => (
+                <tr key={fn.name} className="border-t">
+                  <td className="py-0.5">{fn.name}</td>
+                  <td className="tabular-nums">{fn.steps}</td>
+                  <td className="tabular-nums">{formatFee(fn.feeNQT)}</td>
+                  <td>
+                    <Share share={fn.share} />
+                  </td>
+                </tr>
+              ))}
+            </tbody>
+          </table>
+        </>
+      )}
+    </section>
+  );
+}
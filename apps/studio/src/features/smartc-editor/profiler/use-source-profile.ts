@@ -0,0 +1,75 @@
+import { useCallback, useState } from "react";
+import {
+  type ExecutionProfile,
+  parseTrace,
+  Profiler,
+} from "@signum-smartc-scd/core/analysis";
+import { CompileCancelledError, CompilerService } from "@/lib/compiler";
+
+const TraceStorageKeyPrefix = "smartc-profiler-trace:";
+
+export const ExampleTrace = `[
+  { "sender": "1", "amount": "100000000", "message": ["1"], "repeat": 10 }
+]`;
+
+interface SourceProfileState {
+  profile: ExecutionProfile | null;
+  error?: string;
+  isRunning: boolean;
+}
+
+/**
+ * Compiles the SmartC code and profiles a transaction trace on the emulator.
+ * The trace is kept per file in the local storage.
+ */
+export function useSourceProfile(fileId: string) {
+  const storageKey = TraceStorageKeyPrefix + fileId;
+  const [trace, setTraceState] = useState(
+    () => localStorage.getItem(storageKey) ?? ExampleTrace,
+  );
+  const [state, setState] = useState<SourceProfileState>({
+    profile: null,
+    isRunning: false,
+  });
+
+  const setTrace = useCallback(
+    (value: string) => {
+      setTraceState(value);
+      localStorage.setItem(storageKey, value);
+    },
+    [storageKey],
+  );
+
+  const run = useCallback(
+    async (code: string) => {
+      setState((prev) => ({ ...prev, error: undefined, isRunning: true }));
+      try {
+        const transactions = parseTrace(trace);
+        const result = await CompilerService.getInstance().compileSmartC(
+          code,
+          `profile:${fileId}`,
+        );
+        if (!result.ok || !result.machineData || !result.assembly) {
+          throw new Error(`Code does not compile: ${result.error}`);
+        }
+        const profiler = new Profiler(result.machineData, result.assembly);
+        if (!profiler.hasSourceLines) {
+          throw new Error(
+            "No source lines in the assembly - add '#pragma verboseAssembly true'",
+          );
+        }
+        setState({ profile: profiler.profile(transactions), isRunning: false });
+      } catch (e) {
+        if (e instanceof CompileCancelledError) return;
+        setState({ profile: null, isRunning: false, error: e.message });
+      }
+    },
+    [trace, fileId],
+  );
+
+  const clear = useCallback(() => {
+    setState({ profile: null, isRunning: false });
+  }, []);
+
+  return { ...state, trace, setTrace, run, clear };
+}
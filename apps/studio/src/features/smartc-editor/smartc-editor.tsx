@@ -1,6 +1,7 @@
 import { useCallback, useEffect, useMemo, useRef, useState } from "react";
 import Editor, { type OnMount } from "@monaco-editor/react";
-import { SaveIcon, FileWarning, Code2 } from "lucide-react";
+import type * as Monaco from "monaco-editor";
+import { SaveIcon, FileWarning, Code2, FlameIcon } from "lucide-react";
 import {
   Tooltip,
   TooltipContent,
@@ -9,13 +10,27 @@ import {
 import { useTheme } from "next-themes";
 import { extendCLangWithSmartC } from "./language-definitions/smartc-language-definitions.ts";
 import { EditorActionButton } from "@/components/ui/editor/actionButton.tsx";
+import { CompileCacheIndicator } from "@/components/ui/editor/compile-cache-indicator.tsx";
 import { usePageHeaderActions } from "@/hooks/use-page-header-actions.ts";
 import { toast } from "sonner";
-import { SmartC } from "smartc-signum-compiler";
+import { CompilerService } from "@/lib/compiler";
 import { ConfirmationDialog } from "@/components/ui/confirmation-dialog.tsx";
 import { useFileSystem } from "@/hooks/use-file-system.ts";
 import { type File, FileSystem } from "@/lib/file-system";
 import { FileTypes } from "@/features/project/filetype-icons.tsx";
+import { useSourceProfile } from "./profiler/use-source-profile.ts";
+import { ProfilerPanel } from "./profiler/profiler-panel.tsx";
+import { toHeatmapDecorations } from "./profiler/heatmap-decorations.ts";
+
+const ProfilerPanelHeight = "280px";
+
+async function compileToAssembly(code: string) {
+  const result = await CompilerService.getInstance().compileSmartC(code);
+  if (!result.ok || result.assembly === undefined) {
+    throw new Error(result.error ?? "Compilation failed");
+  }
+  return result.assembly;
+}
 
 async function createAssemblyFile(
   folderId: string,
@@ -28,12 +43,7 @@ async function createAssemblyFile(
     if (!folder) {
       throw new Error("Could not find folder:" + folderId);
     }
-    const compiler = new SmartC({
-      language: "C",
-      sourceCode: code,
-    });
-    compiler.compile();
-    const assembly = compiler.getAssemblyCode();
+    const assembly = await compileToAssembly(code);
     await fs.addFile(folderId, fileName, FileTypes.ASM, assembly);
     toast.success(
       "Smart Contract compiled successfully - Assembly file created!",
@@ -53,12 +63,7 @@ async function updateAssemblyFile(fileId: string, code: string) {
     if (fs.getFileMetadata(fileId)?.type !== FileTypes.ASM) {
       throw new Error("Existing File is not an Assembly file");
     }
-    const compiler = new SmartC({
-      language: "C",
-      sourceCode: code,
-    });
-    compiler.compile();
-    const assembly = compiler.getAssemblyCode();
+    const assembly = await compileToAssembly(code);
     await fs.saveFile(fileId, assembly);
     toast.success(
       "Smart Contract compiled successfully - Assembly file updated!",
@@ -109,6 +114,12 @@ function SmartCEditor({ file }: Props) {
   const containerRef = useRef<HTMLDivElement>(null);
   const [editorHeight, setEditorHeight] = useState("calc(100vh)"); // Initial height
   const [showConfirmDialog, setShowConfirmDialog] = useState(false);
+  const [showProfiler, setShowProfiler] = useState(false);
+  const sourceProfile = useSourceProfile(file.metadata.id);
+  const editorRef = useRef<Monaco.editor.IStandaloneCodeEditor | null>(null);
+  const heatmapRef = useRef<Monaco.editor.IEditorDecorationsCollection | null>(
+    null,
+  );
   const isValid = !validationError;
 
   useEffect(() => {
@@ -210,8 +221,28 @@ function SmartCEditor({ file }: Props) {
     return removeAllSaveHandlers;
   }, [saveSmartCFile]);
 
+  useEffect(() => {
+    const { profile } = sourceProfile;
+    heatmapRef.current?.set(profile ? toHeatmapDecorations(profile) : []);
+  }, [sourceProfile.profile]);
+
+  const toggleProfiler = () => {
+    if (showProfiler) {
+      sourceProfile.clear();
+    }
+    setShowProfiler(!showProfiler);
+  };
+
+  const revealLine = (line: number) => {
+    editorRef.current?.revealLineInCenter(line);
+    editorRef.current?.setPosition({ lineNumber: line, column: 1 });
+    editorRef.current?.focus();
+  };
+
   const handleEditorDidMount: OnMount = (editor, monaco) => {
     extendCLangWithSmartC(monaco);
+    editorRef.current = editor;
+    heatmapRef.current = editor.createDecorationsCollection();
     editor.addAction({
       id: ActionType.Compile,
       // TODO: this is not good... we need to use events
@@ -259,7 +290,14 @@ function SmartCEditor({ file }: Props) {
             </span>
           )}
         </div>
-        <div>
+        <div className="flex items-center gap-2">
+          <CompileCacheIndicator />
+          <EditorActionButton
+            tooltip="Profile a transaction trace"
+            onClick={toggleProfiler}
+          >
+            <FlameIcon className={showProfiler ? "text-orange-500" : ""} />
+          </EditorActionButton>
           <EditorActionButton
             tooltip={isDirty ? "Unsaved changes" : "All Saved"}
             disabled={!isValid}
@@ -271,7 +309,11 @@ function SmartCEditor({ file }: Props) {
       </section>
       <div className="flex-1 rounded h-full">
         <Editor
-          height={editorHeight}
+          height={
+            showProfiler
+              ? `calc(${editorHeight} - ${ProfilerPanelHeight})`
+              : editorHeight
+          }
           defaultLanguage="c"
           value={code}
           theme={theme === "dark" ? "vs-dark" : "light"}
@@ -294,6 +336,18 @@ function SmartCEditor({ file }: Props) {
           }}
         />
       </div>
+      {showProfiler && (
+        <ProfilerPanel
+          profile={sourceProfile.profile}
+          error={sourceProfile.error}
+          isRunning={sourceProfile.isRunning}
+          trace={sourceProfile.trace}
+          onTraceChange={sourceProfile.setTrace}
+          onRun={() => sourceProfile.run(code)}
+          onClear={sourceProfile.clear}
+          onRevealLine={revealLine}
+        />
+      )}
       <ConfirmationDialog
         open={showConfirmDialog}
         onOpenChange={setShowConfirmDialog}
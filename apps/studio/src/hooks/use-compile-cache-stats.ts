@@ -0,0 +1,19 @@
+import { useEffect, useState } from "react";
+import { CompilerService, type CompileCacheStats } from "@/lib/compiler";
+
+export const useCompileCacheStats = () => {
+  const cache = CompilerService.getInstance().cache;
+  const [stats, setStats] = useState<CompileCacheStats>(cache.stats);
+
+  useEffect(() => {
+    const handleStats = (e: Event) => {
+      setStats((e as CustomEvent<CompileCacheStats>).detail);
+    };
+    cache.addEventListener("stats", handleStats);
+    return () => {
+      cache.removeEventListener("stats", handleStats);
+    };
+  }, [cache]);
+
+  return stats;
+};
@@ -8,6 +8,9 @@
 import { createRoot } from "react-dom/client";
 import { StrictMode } from "react";
 import { App } from "./App";
+import { FileSystem } from "./lib/file-system";
+import { measureStartup } from "./lib/startup-metrics";
+import { prefetchFileEditors } from "./pages/files/file-editors";
 
 const elem = document.getElementById("root")!;
 const app = (
@@ -16,11 +19,21 @@ const app = (
   </StrictMode>
 );
 
-if (import.meta.hot) {
-  // With hot module reloading, `import.meta.hot.data` is persisted.
-  const root = (import.meta.hot.data.root ??= createRoot(elem));
-  root.render(app);
-} else {
-  // The hot module reloading API is not available in production.
-  createRoot(elem).render(app);
+function render() {
+  if (import.meta.hot) {
+    // With hot module reloading, `import.meta.hot.data` is persisted.
+    const root = (import.meta.hot.data.root ??= createRoot(elem));
+    root.render(app);
+  } else {
+    // The hot module reloading API is not available in production.
+    createRoot(elem).render(app);
+  }
 }
+
+// the file system metadata is read synchronously while rendering
+FileSystem.getInstance()
+  .ready.catch((e) => console.error("Cannot load file system:", e))
+  .then(render)
+  .then(measureStartup)
+  // after the measurement, not to count the prefetched editors
+  .then(prefetchFileEditors);
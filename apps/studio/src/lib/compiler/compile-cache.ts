@@ -0,0 +1,225 @@
+import { IdbStores, openFileSystemDb } from "@/lib/file-system";
+import { name, version } from "smartc-signum-compiler/package.json";
+import type { CompileLanguage, CompileResult } from "./compiler-types.ts";
+
+// the bundled compiler - another version invalidates all cached results
+export const CompilerVersion = `${name}@${version}`;
+
+const DefaultBudgetBytes = 32 * 1024 * 1024;
+const MemoryEntries = 16;
+
+const PragmaPattern = /^\s*(#pragma|#program|\^program)\b.*$/gm;
+
+interface CacheEntry {
+  key: string;
+  language: CompileLanguage;
+  result: CompileResult;
+  size: number;
+  lastAccess: number;
+}
+
+export interface CompileCacheStats {
+  hits: number;
+  misses: number;
+  entries: number;
+  sizeBytes: number;
+  budgetBytes: number;
+}
+
+async function sha256(text: string) {
+  const digest = await crypto.subtle.digest(
+    "SHA-256",
+    new TextEncoder().encode(text),
+  );
+  return Array.from(new Uint8Array(digest), (b) =>
+    b.toString(16).padStart(2, "0"),
+  ).join("");
+}
+
+function estimateSize(result: CompileResult) {
+  // UTF-16 - good enough for budgeting
+  return JSON.stringify(result).length * 2;
+}
+
+/**
+ * Content-addressed cache for compile and assemble results, persisted in the file system's IndexedDB.
+ *
+ * Entries are keyed by a hash over compiler version, language, pragmas and source text and evicted
+ * least-recently-used first once the size budget is exceeded. A small in-memory layer keeps tab switches instant.
+ * Emits a `stats` event whenever the counters change.
+ */
+export class CompileCache extends EventTarget {
+  private hits = 0;
+  private misses = 0;
+  private readonly memory = new Map<string, CompileResult>();
+  // key -> [size, lastAccess] of all persisted entries, loaded lazily
+  private index: Map<string, { size: number; lastAccess: number }> | null =
+    null;
+  private totalSize = 0;
+
+  constructor(private readonly budgetBytes = DefaultBudgetBytes) {
+    super();
+  }
+
+  static async createKey(language: CompileLanguage, sourceCode: string) {
+    const pragmas = (sourceCode.match(PragmaPattern) ?? [])
+      .map((p) => p.trim())
+      .join("\n");
+    return sha256(
+      `${CompilerVersion}\n${language}\n${pragmas}\n\n${sourceCode}`,
+    );
+  }
+
+  get stats(): CompileCacheStats {
+    return {
+      hits: this.hits,
+      misses: this.misses,
+      entries: this.index?.size ?? this.memory.size,
+      sizeBytes: this.totalSize,
+      budgetBytes: this.budgetBytes,
+    };
+  }
+
+  async get(key: string): Promise<CompileResult | undefined> {
+    const inMemory = this.memory.get(key);
+    if (inMemory) {
+      this.remember(key, inMemory);
+      this.touch(key);
+      this.count(true);
+      return inMemory;
+    }
+
+    const db = await this.getDb();
+    const entry = (await db?.get(IdbStores.CompileCache, key)) as
+      | CacheEntry
+      | undefined;
+    if (!entry) {
+      this.count(false);
+      return undefined;
+    }
+    this.remember(key, entry.result);
+    this.touch(key);
+    this.count(true);
+    return entry.result;
+  }
+
+  async put(key: string, language: CompileLanguage, result: CompileResult) {
+    this.remember(key, result);
+    const db = await this.getDb();
+    if (!db || !this.index) return;
+
+    const entry: CacheEntry = {
+      key,
+      language,
+      result,
+      size: estimateSize(result),
+      lastAccess: Date.now(),
+    };
+    if (entry.size > this.budgetBytes) return;
+
+    const previous = this.index.get(key);
+    this.totalSize += entry.size - (previous?.size ?? 0);
+    this.index.set(key, { size: entry.size, lastAccess: entry.lastAccess });
+    await db.put(IdbStores.CompileCache, entry);
+    await this.evict();
+    this.emitStats();
+  }
+
+  async clear() {
+    this.memory.clear();
+    this.index?.clear();
+    this.totalSize = 0;
+    const db = await this.getDb();
+    await db?.clear(IdbStores.CompileCache);
+    this.emitStats();
+  }
+
+  private remember(key: string, result: CompileResult) {
+    // Map keeps insertion order - re-inserting moves the key to the most recent position
+    this.memory.delete(key);
+    this.memory.set(key, result);
+    if (this.memory.size > MemoryEntries) {
+      this.memory.delete(this.memory.keys().next().value!);
+    }
+  }
+
+  private touch(key: string) {
+    const meta = this.index?.get(key);
+    if (!meta) return;
+    meta.lastAccess = Date.now();
+    // fire and forget - access time is only relevant for eviction order
+    this.getDb()
+      .then(async (db) => {
+        if (!db) return;
+        const tx = db.transaction(IdbStores.CompileCache, "readwrite");
+        const entry = (await tx.store.get(key)) as CacheEntry | undefined;
+        if (entry) {
+          entry.lastAccess = meta.lastAccess;
+          await tx.store.put(entry);
+        }
+        await tx.done;
+      })
+      .catch(() => {
+        // a lost access time only makes the entry evicted earlier
+      });
+  }
+
+  private async evict() {
+    if (!this.index || this.totalSize <= this.budgetBytes) return;
+    const db = await this.getDb();
+    if (!db) return;
+
+    const byAge = [...this.index.entries()].sort(
+      ([, a], [, b]) => a.lastAccess - b.lastAccess,
+    );
+    const tx = db.transaction(IdbStores.CompileCache, "readwrite");
+    for (const [key, { size }] of byAge) {
+      if (this.totalSize <= this.budgetBytes) break;
+      this.index.delete(key);
+      this.memory.delete(key);
+      this.totalSize -= size;
+      tx.store.delete(key);
+    }
+    await tx.done;
+  }
+
+  private async getDb() {
+    if (typeof indexedDB === "undefined") return null;
+    const db = await openFileSystemDb();
+    if (!this.index) {
+      const index = new Map<string, { size: number; lastAccess: number }>();
+      let totalSize = 0;
+      let cursor = await db
+        .transaction(IdbStores.CompileCache)
+        .store.index("lastAccess")
+        .openCursor();
+      while (cursor) {
+        const { key, size, lastAccess } = cursor.value as CacheEntry;
+        index.set(key, { size, lastAccess });
+        totalSize += size;
+        cursor = await cursor.continue();
+      }
+      // another call might have loaded the index concurrently
+      if (!this.index) {
+        this.index = index;
+        this.totalSize = totalSize;
+      }
+    }
+    return db;
+  }
+
+  private count(hit: boolean) {
+    if (hit) {
+      this.hits++;
+    } else {
+      this.misses++;
+    }
+    this.emitStats();
+  }
+
+  private emitStats() {
+    this.dispatchEvent(
+      new CustomEvent<CompileCacheStats>("stats", { detail: this.stats }),
+    );
+  }
+}
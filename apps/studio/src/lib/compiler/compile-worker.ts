@@ -0,0 +1,16 @@
+/// <reference lib="webworker" />
+import { compileSource } from "./compile.ts";
+import type {
+  CompileWorkerRequest,
+  CompileWorkerResponse,
+} from "./compiler-types.ts";
+
+// Runs in a Web Worker (browser) or a Bun Worker (headless) - same API in both
+self.onmessage = (event: MessageEvent<CompileWorkerRequest>) => {
+  const { jobId, language, sourceCode } = event.data;
+  const response: CompileWorkerResponse = {
+    jobId,
+    result: compileSource(language, sourceCode),
+  };
+  self.postMessage(response);
+};
@@ -0,0 +1,53 @@
+import { SmartC } from "smartc-signum-compiler";
+import type {
+  CompileDiagnostic,
+  CompileLanguage,
+  CompileResult,
+} from "./compiler-types.ts";
+
+const SmartCErrorPattern =
+  /At line: (?<line>\d+):(?<column>\d+)\.\s+(?<message>.*)/;
+
+function parseDiagnostics(errorMessage: string): CompileDiagnostic[] {
+  const result = SmartCErrorPattern.exec(errorMessage);
+  if (!result?.groups) {
+    return [];
+  }
+  const { line, column, message } = result.groups;
+  return [
+    {
+      line: parseInt(line),
+      column: parseInt(column),
+      message,
+    },
+  ];
+}
+
+/**
+ * Compiles (or assembles) the given source synchronously.
+ * This is what runs inside the compile workers, but it can be called directly where no worker is available.
+ * Compilation errors are returned as diagnostics and never thrown.
+ */
+export function compileSource(
+  language: CompileLanguage,
+  sourceCode: string,
+): CompileResult {
+  try {
+    const compiler = new SmartC({ language, sourceCode });
+    compiler.compile();
+    return {
+      ok: true,
+      assembly:
+        language === "C" ? compiler.getAssemblyCode() : sourceCode,
+      machineData: compiler.getMachineCode(),
+      diagnostics: [],
+    };
+  } catch (e: any) {
+    const message = e?.message ?? String(e);
+    return {
+      ok: false,
+      error: message,
+      diagnostics: parseDiagnostics(message),
+    };
+  }
+}
@@ -0,0 +1,264 @@
+import { CompileCache } from "./compile-cache.ts";
+import {
+  CompileCancelledError,
+  type CompileLanguage,
+  type CompileRequest,
+  type CompileResult,
+  type CompileWorkerResponse,
+} from "./compiler-types.ts";
+
+interface JobWaiter {
+  channel?: string;
+  resolve: (result: CompileResult) => void;
+  reject: (reason: Error) => void;
+}
+
+interface CompileJob {
+  id: number;
+  key: string;
+  language: CompileLanguage;
+  sourceCode: string;
+  waiters: JobWaiter[];
+  slot?: WorkerSlot;
+}
+
+interface WorkerSlot {
+  worker: Worker | null;
+  job: CompileJob | null;
+}
+
+const MaxPoolSize = 4;
+
+function jobKey(language: CompileLanguage, sourceCode: string) {
+  return `${language}:${sourceCode}`;
+}
+
+/**
+ * Compiles SmartC and assembles ASM code off the main thread using a small worker pool.
+ *
+ * - results are served from the persistent content-addressed `CompileCache` where possible
+ * - jobs with identical source share the same in-flight result
+ * - a newer job on the same channel supersedes (cancels) the older ones
+ * - falls back to in-thread compilation where no `Worker` is available
+ */
+export class CompilerService {
+  static instance = new CompilerService();
+
+  /**
+   * Retrieves the singleton instance of the CompilerService class.
+   */
+  static getInstance(): CompilerService {
+    if (!CompilerService.instance) {
+      CompilerService.instance = new CompilerService();
+    }
+    return CompilerService.instance;
+  }
+
+  readonly cache = new CompileCache();
+  private nextJobId = 1;
+  private readonly channelSequence = new Map<string, number>();
+  private readonly queue: CompileJob[] = [];
+  private readonly inFlight = new Map<string, CompileJob>();
+  private readonly slots: WorkerSlot[];
+
+  private constructor(
+    poolSize = Math.max(
+      1,
+      Math.min(MaxPoolSize, (globalThis.navigator?.hardwareConcurrency ?? 2) - 1),
+    ),
+  ) {
+    this.slots = Array.from({ length: poolSize }, () => ({
+      worker: null,
+      job: null,
+    }));
+  }
+
+  /**
+   * Compiles (or assembles) the given source.
+   * Compilation errors are reported in the result, not thrown.
+   *
+   * @throws {CompileCancelledError} if the job was superseded by a newer job on the same channel
+   */
+  async compile({
+    language,
+    sourceCode,
+    channel,
+  }: CompileRequest): Promise<CompileResult> {
+    const key = jobKey(language, sourceCode);
+    const existing = this.inFlight.get(key);
+    let sequence = 0;
+    if (channel) {
+      this.cancelChannel(channel, existing);
+      sequence = (this.channelSequence.get(channel) ?? 0) + 1;
+      this.channelSequence.set(channel, sequence);
+    }
+
+    if (!existing) {
+      const cacheKey = await CompileCache.createKey(language, sourceCode);
+      const cached = await this.cache.get(cacheKey);
+      if (channel && this.channelSequence.get(channel) !== sequence) {
+        throw new CompileCancelledError();
+      }
+      if (cached) {
+        return cached;
+      }
+      const result = await this.enqueue(key, language, sourceCode, channel);
+      // a crashed worker has no diagnostics - that's retried, not cached
+      if (result.ok || result.diagnostics.length) {
+        this.cacheResult(cacheKey, language, result).catch((e) => {
+          console.warn("Could not cache compile result", e);
+        });
+      }
+      return result;
+    }
+
+    return this.enqueue(key, language, sourceCode, channel);
+  }
+
+  private enqueue(
+    key: string,
+    language: CompileLanguage,
+    sourceCode: string,
+    channel?: string,
+  ): Promise<CompileResult> {
+    return new Promise<CompileResult>((resolve, reject) => {
+      const waiter: JobWaiter = { channel, resolve, reject };
+      // re-check: an identical job might have been started while we were looking up the cache
+      const existing = this.inFlight.get(key);
+      if (existing) {
+        existing.waiters.push(waiter);
+        return;
+      }
+
+      const job: CompileJob = {
+        id: this.nextJobId++,
+        key,
+        language,
+        sourceCode,
+        waiters: [waiter],
+      };
+      this.inFlight.set(key, job);
+      this.queue.push(job);
+      this.schedule();
+    });
+  }
+
+  private async cacheResult(
+    cacheKey: string,
+    language: CompileLanguage,
+    result: CompileResult,
+  ) {
+    await this.cache.put(cacheKey, language, result);
+    // the generated assembly assembles to the very same machine code - opening the .asm file is then free
+    if (language === "C" && result.ok && result.assembly) {
+      const asmKey = await CompileCache.createKey("Assembly", result.assembly);
+      await this.cache.put(asmKey, "Assembly", result);
+    }
+  }
+
+  compileSmartC(sourceCode: string, channel?: string) {
+    return this.compile({ language: "C", sourceCode, channel });
+  }
+
+  assemble(asmCode: string, channel?: string) {
+    return this.compile({ language: "Assembly", sourceCode: asmCode, channel });
+  }
+
+  private cancelChannel(channel: string, except?: CompileJob) {
+    for (const job of this.inFlight.values()) {
+      if (job === except) continue;
+      const superseded = job.waiters.filter((w) => w.channel === channel);
+      if (!superseded.length) continue;
+
+      job.waiters = job.waiters.filter((w) => w.channel !== channel);
+      superseded.forEach((w) => w.reject(new CompileCancelledError()));
+
+      if (job.waiters.length === 0) {
+        this.dropJob(job);
+      }
+    }
+  }
+
+  private dropJob(job: CompileJob) {
+    this.inFlight.delete(job.key);
+    const index = this.queue.indexOf(job);
+    if (index !== -1) {
+      this.queue.splice(index, 1);
+      return;
+    }
+    // running job nobody waits for anymore: free the slot for newer work
+    if (job.slot) {
+      job.slot.worker?.terminate();
+      job.slot.worker = null;
+      job.slot.job = null;
+      job.slot = undefined;
+      this.schedule();
+    }
+  }
+
+  private schedule() {
+    for (const slot of this.slots) {
+      if (slot.job) continue;
+      const job = this.queue.shift();
+      if (!job) return;
+      this.run(slot, job);
+    }
+  }
+
+  private run(slot: WorkerSlot, job: CompileJob) {
+    slot.job = job;
+    job.slot = slot;
+
+    const worker = this.getWorker(slot);
+    if (!worker) {
+      // no worker support - the compiler is loaded on demand, as it's in the workers' chunk otherwise
+      import("./compile.ts").then(({ compileSource }) => {
+        if (slot.job !== job) return;
+        this.finish(slot, job, compileSource(job.language, job.sourceCode));
+      });
+      return;
+    }
+
+    worker.postMessage({
+      jobId: job.id,
+      language: job.language,
+      sourceCode: job.sourceCode,
+    });
+  }
+
+  private getWorker(slot: WorkerSlot): Worker | null {
+    if (slot.worker) return slot.worker;
+    if (typeof Worker === "undefined") return null;
+
+    const worker = new Worker(new URL("./compile-worker.ts", import.meta.url), {
+      type: "module",
+    });
+    worker.onmessage = (event: MessageEvent<CompileWorkerResponse>) => {
+      const job = slot.job;
+      if (!job || job.id !== event.data.jobId) return;
+      this.finish(slot, job, event.data.result);
+    };
+    worker.onerror = (event) => {
+      const job = slot.job;
+      slot.worker?.terminate();
+      slot.worker = null;
+      if (job) {
+        this.finish(slot, job, {
+          ok: false,
+          error: event.message || "Compile worker crashed",
+          diagnostics: [],
+        });
+      }
+    };
+    slot.worker = worker;
+    return worker;
+  }
+
+  private finish(slot: WorkerSlot, job: CompileJob, result: CompileResult) {
+    slot.job = null;
+    job.slot = undefined;
+    this.inFlight.delete(job.key);
+    job.waiters.forEach((w) => w.resolve(result));
+    this.schedule();
+  }
+}
@@ -0,0 +1,45 @@
+import type { MACHINE_OBJECT } from "smartc-signum-compiler/dist/typings/contractTypes";
+
+export type CompileLanguage = "C" | "Assembly";
+
+export interface CompileRequest {
+  language: CompileLanguage;
+  sourceCode: string;
+  /**
+   * Jobs sharing the same channel supersede each other, i.e. a newer job cancels the
+   * older one (e.g. the Monaco model uri for diagnostics)
+   */
+  channel?: string;
+}
+
+export interface CompileDiagnostic {
+  line: number;
+  column: number;
+  message: string;
+}
+
+export interface CompileResult {
+  ok: boolean;
+  assembly?: string;
+  machineData?: MACHINE_OBJECT;
+  diagnostics: CompileDiagnostic[];
+  error?: string;
+}
+
+export interface CompileWorkerRequest {
+  jobId: number;
+  language: CompileLanguage;
+  sourceCode: string;
+}
+
+export interface CompileWorkerResponse {
+  jobId: number;
+  result: CompileResult;
+}
+
+export class CompileCancelledError extends Error {
+  constructor() {
+    super("Compile job superseded");
+    this.name = "CompileCancelledError";
+  }
+}
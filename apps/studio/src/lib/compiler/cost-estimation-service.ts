@@ -0,0 +1,127 @@
+import type { CostReport } from "@signum-smartc-scd/core/analysis";
+import { CompileCancelledError } from "./compiler-types.ts";
+import type {
+  CostEstimationRequest,
+  CostEstimationWorkerResponse,
+} from "./cost-estimation-types.ts";
+
+interface EstimationJob {
+  id: number;
+  request: CostEstimationRequest;
+  resolve: (report: CostReport) => void;
+  reject: (reason: Error) => void;
+}
+
+/**
+ * Estimates the method costs of compiled contracts off the main thread, one at a time on a
+ * dedicated worker.
+ *
+ * - a newer estimation on the same channel supersedes (cancels) the older one - a running one
+ *   terminates the worker
+ * - falls back to in-thread estimation where no `Worker` is available
+ */
+export class CostEstimationService {
+  static instance = new CostEstimationService();
+
+  /**
+   * Retrieves the singleton instance of the CostEstimationService class.
+   */
+  static getInstance(): CostEstimationService {
+    if (!CostEstimationService.instance) {
+      CostEstimationService.instance = new CostEstimationService();
+    }
+    return CostEstimationService.instance;
+  }
+
+  private nextJobId = 1;
+  private readonly queue: EstimationJob[] = [];
+  private running: EstimationJob | null = null;
+  private worker: Worker | null = null;
+
+  private constructor() {}
+
+  /**
+   * @throws {CompileCancelledError} if the estimation was superseded by a newer one on the same channel
+   */
+  estimate(request: CostEstimationRequest): Promise<CostReport> {
+    if (request.channel) this.cancelChannel(request.channel);
+    return new Promise<CostReport>((resolve, reject) => {
+      this.queue.push({ id: this.nextJobId++, request, resolve, reject });
+      this.schedule();
+    });
+  }
+
+  private cancelChannel(channel: string) {
+    for (const job of this.queue.filter((j) => j.request.channel === channel)) {
+      this.queue.splice(this.queue.indexOf(job), 1);
+      job.reject(new CompileCancelledError());
+    }
+    if (this.running?.request.channel === channel) {
+      // nobody waits for the running estimation anymore: free the worker for newer work
+      this.running.reject(new CompileCancelledError());
+      this.running = null;
+      this.worker?.terminate();
+      this.worker = null;
+    }
+  }
+
+  private schedule() {
+    if (this.running) return;
+    const job = this.queue.shift();
+    if (!job) return;
+    this.running = job;
+
+    const { scd, machineData } = job.request;
+    const worker = this.getWorker();
+    if (!worker) {
+      // no worker support - the emulator is loaded on demand, as it's in the worker's chunk otherwise
+      import("./estimate.ts")
+        .then(({ estimateCosts }) => ({
+          jobId: job.id,
+          report: estimateCosts(scd, machineData),
+        }))
+        .catch((e) => ({ jobId: job.id, error: e?.message ?? String(e) }))
+        .then((response) => this.finish(job, response));
+      return;
+    }
+    worker.postMessage({ jobId: job.id, scd, machineData });
+  }
+
+  private getWorker(): Worker | null {
+    if (this.worker) return this.worker;
+    if (typeof Worker === "undefined") return null;
+
+    const worker = new Worker(new URL("./estimate-worker.ts", import.meta.url), {
+      type: "module",
+    });
+    worker.onmessage = (event: MessageEvent<CostEstimationWorkerResponse>) => {
+      const job = this.running;
+      if (!job || job.id !== event.data.jobId) return;
+      this.finish(job, event.data);
+    };
+    worker.onerror = (event) => {
+      const job = this.running;
+      this.worker?.terminate();
+      this.worker = null;
+      if (job) {
+        this.finish(job, {
+          jobId: job.id,
+          error: event.message || "Estimation worker crashed",
+        });
+      }
+    };
+    this.worker = worker;
+    return worker;
+  }
+
+  private finish(job: EstimationJob, response: CostEstimationWorkerResponse) {
+    if (this.running !== job) return;
+    this.running = null;
+    if ("report" in response) {
+      job.resolve(response.report);
+    } else {
+      job.reject(new Error(response.error));
+    }
+    this.schedule();
+  }
+}
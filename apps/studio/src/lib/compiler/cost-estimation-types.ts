@@ -0,0 +1,20 @@
+import type { SCDType } from "@signum-smartc-scd/core/parser";
+import type { CostReport } from "@signum-smartc-scd/core/analysis";
+import type { MACHINE_OBJECT } from "smartc-signum-compiler/dist/typings/contractTypes";
+
+export interface CostEstimationRequest {
+  scd: SCDType;
+  machineData: MACHINE_OBJECT;
+  /** Estimations sharing the same channel supersede each other, like compile jobs */
+  channel?: string;
+}
+
+export interface CostEstimationWorkerRequest {
+  jobId: number;
+  scd: SCDType;
+  machineData: MACHINE_OBJECT;
+}
+
+export type CostEstimationWorkerResponse =
+  | { jobId: number; report: CostReport }
+  | { jobId: number; error: string };
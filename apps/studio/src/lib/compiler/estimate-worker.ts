@@ -0,0 +1,18 @@
+/// <reference lib="webworker" />
+import { estimateCosts } from "./estimate.ts";
+import type {
+  CostEstimationWorkerRequest,
+  CostEstimationWorkerResponse,
+} from "./cost-estimation-types.ts";
+
+// Runs in a Web Worker - the report is posted back by structured clone, bigints included
+self.onmessage = (event: MessageEvent<CostEstimationWorkerRequest>) => {
+  const { jobId, scd, machineData } = event.data;
+  let response: CostEstimationWorkerResponse;
+  try {
+    response = { jobId, report: estimateCosts(scd, machineData) };
+  } catch (e: any) {
+    response = { jobId, error: e?.message ?? String(e) };
+  }
+  self.postMessage(response);
+};
@@ -0,0 +1,17 @@
+import { SCD, type SCDType } from "@signum-smartc-scd/core/parser";
+import {
+  CostEstimator,
+  type CostReport,
+} from "@signum-smartc-scd/core/analysis";
+import type { MACHINE_OBJECT } from "smartc-signum-compiler/dist/typings/contractTypes";
+
+/**
+ * Runs every method of the contract over several argument samples on the emulator.
+ * This is what runs inside the estimation worker, but it can be called directly where no worker is available.
+ */
+export function estimateCosts(
+  scd: SCDType,
+  machineData: MACHINE_OBJECT,
+): CostReport {
+  return new CostEstimator(SCD.parse(scd), machineData).estimate();
+}
@@ -0,0 +1,5 @@
+export * from "./compiler-service.ts";
+export * from "./compiler-types.ts";
+export * from "./compile-cache.ts";
+export * from "./cost-estimation-service.ts";
+export * from "./cost-estimation-types.ts";
@@ -0,0 +1,56 @@
+import type * as Monaco from "monaco-editor";
+
+export type CompletionTemplate = Omit<Monaco.languages.CompletionItem, "range">;
+
+// first letters of the label and its word parts - `get_A1` has the parts get and A1, `getNextTx` get, Next and Tx
+function wordPartStarts(label: string) {
+  const starts = new Set<string>(label ? [label[0]!.toLowerCase()] : []);
+  for (let i = 0; i < label.length; i++) {
+    const char = label[i]!;
+    const previous = label[i - 1];
+    if (!/[A-Za-z0-9]/.test(char)) continue;
+    if (
+      previous === undefined ||
+      !/[A-Za-z0-9]/.test(previous) ||
+      (/[A-Z]/.test(char) && /[a-z0-9]/.test(previous))
+    ) {
+      starts.add(char.toLowerCase());
+    }
+  }
+  return starts;
+}
+
+/**
+ * Completion items that are built once and looked up by the typed prefix.
+ *
+ * The suggest widget matches the first typed character only at the start of a word part, so the
+ * items are bucketed by these characters - the widget filters the rest of the prefix by itself.
+ */
+export class CompletionIndex {
+  private readonly buckets = new Map<string, CompletionTemplate[]>();
+
+  constructor(private readonly templates: CompletionTemplate[]) {
+    for (const template of templates) {
+      const label =
+        typeof template.label === "string"
+          ? template.label
+          : template.label.label;
+      for (const start of wordPartStarts(template.filterText ?? label)) {
+        let bucket = this.buckets.get(start);
+        if (!bucket) {
+          bucket = [];
+          this.buckets.set(start, bucket);
+        }
+        bucket.push(template);
+      }
+    }
+  }
+
+  suggest(prefix: string, range: Monaco.IRange): Monaco.languages.CompletionItem[] {
+    const templates = prefix
+      ? (this.buckets.get(prefix[0]!.toLowerCase()) ?? [])
+      : this.templates;
+    // monaco sets the range of items without one, so the templates are never handed out directly
+    return templates.map((template) => ({ ...template, range }));
+  }
+}
@@ -0,0 +1,2 @@
+export * from "./completion-index.ts";
+export * from "./symbol-index.ts";
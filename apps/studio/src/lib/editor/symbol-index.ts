@@ -0,0 +1,294 @@
+import type * as Monaco from "monaco-editor";
+
+export type SymbolKind =
+  | "define"
+  | "struct"
+  | "field"
+  | "function"
+  | "variable"
+  | "label";
+
+export interface EditorSymbol {
+  name: string;
+  kind: SymbolKind;
+  /** The declaration as written, shown on hover */
+  detail: string;
+  /** 1-based column of the name */
+  column: number;
+  /** Struct type of variables and fields */
+  type?: string;
+  /** Struct of fields */
+  container?: string;
+}
+
+export interface LocatedSymbol extends EditorSymbol {
+  line: number;
+}
+
+/**
+ * Scans a single line. The state carries the context of multi line constructs, like comments or
+ * struct bodies, to the next line - it must be a primitive, so it can be compared
+ */
+export type LineScanner = (
+  text: string,
+  state: string,
+) => { symbols: EditorSymbol[]; state: string };
+
+interface ScannedLine {
+  symbols: EditorSymbol[];
+  before: string;
+  after: string;
+}
+
+interface LineSource {
+  getLineCount(): number;
+  getLineContent(lineNumber: number): string;
+}
+
+const InitialState = "";
+
+/**
+ * Blanks out comments and string literals, keeping the columns intact
+ *
+ * @return The code and whether the line ends inside a block comment
+ */
+export function stripComments(text: string, inComment: boolean) {
+  let code = "";
+  let i = 0;
+  while (i < text.length) {
+    if (inComment) {
+      const end = text.indexOf("*/", i);
+      const stop = end === -1 ? text.length : end + 2;
+      code += " ".repeat(stop - i);
+      inComment = end === -1;
+      i = stop;
+      continue;
+    }
+    const char = text[i]!;
+    if (char === "/" && text[i + 1] === "/") {
+      code += " ".repeat(text.length - i);
+      break;
+    }
+    if (char === "/" && text[i + 1] === "*") {
+      inComment = true;
+      code += "  ";
+      i += 2;
+      continue;
+    }
+    if (char === '"' || char === "'") {
+      let end = i + 1;
+      while (end < text.length && text[end] !== char) {
+        end += text[end] === "\\" ? 2 : 1;
+      }
+      const stop = Math.min(end + 1, text.length);
+      code += " ".repeat(stop - i);
+      i = stop;
+      continue;
+    }
+    code += char;
+    i++;
+  }
+  return { code, inComment };
+}
+
+/**
+ * The symbols of a model, kept per line.
+ *
+ * Content changes rescan the changed lines only, plus the following lines whose start state
+ * changed - like opening a block comment. Lookups by name are built lazily after a change.
+ */
+export class SymbolIndex {
+  private lines: ScannedLine[] = [];
+  private byName: Map<string, LocatedSymbol[]> | null = null;
+  private fields: Map<string, LocatedSymbol[]> | null = null;
+
+  constructor(
+    private readonly scan: LineScanner,
+    source: LineSource,
+  ) {
+    this.reset(source);
+  }
+
+  reset(source: LineSource) {
+    this.lines = this.scanLines(source, 1, source.getLineCount(), InitialState);
+    this.invalidate();
+  }
+
+  /**
+   * Applies the changes of a content change event, the source has the changed content already
+   */
+  update(
+    source: LineSource,
+    changes: readonly { range: Monaco.IRange }[],
+  ) {
+    if (!changes.length) return;
+    const oldCount = this.lines.length;
+    const newCount = source.getLineCount();
+    let first = Infinity;
+    let lastOld = 0;
+    for (const { range } of changes) {
+      first = Math.min(first, range.startLineNumber);
+      lastOld = Math.max(lastOld, range.endLineNumber);
+    }
+    // the lines after the last change are unchanged, only shifted
+    const lastNew = newCount - (oldCount - lastOld);
+    const scanned = this.scanLines(
+      source,
+      first,
+      lastNew,
+      this.stateAfter(first - 1),
+    );
+    this.lines.splice(first - 1, lastOld - first + 1, ...scanned);
+
+    for (let line = lastNew + 1; line <= newCount; line++) {
+      const state = this.stateAfter(line - 1);
+      if (this.lines[line - 1]!.before === state) break;
+      this.lines[line - 1] = this.scanLine(source.getLineContent(line), state);
+    }
+    this.invalidate();
+  }
+
+  lookup(name: string): LocatedSymbol[] {
+    return this.build().byName.get(name) ?? [];
+  }
+
+  /** The first declaration of each name, without struct fields */
+  symbols(): LocatedSymbol[] {
+    const symbols: LocatedSymbol[] = [];
+    for (const [, [first]] of this.build().byName) {
+      if (first) symbols.push(first);
+    }
+    return symbols;
+  }
+
+  fieldsOf(struct: string): LocatedSymbol[] {
+    return this.build().fields.get(struct) ?? [];
+  }
+
+  private stateAfter(line: number) {
+    return line < 1 ? InitialState : this.lines[line - 1]!.after;
+  }
+
+  private scanLine(text: string, before: string): ScannedLine {
+    const { symbols, state } = this.scan(text, before);
+    return { symbols, before, after: state };
+  }
+
+  private scanLines(
+    source: LineSource,
+    from: number,
+    to: number,
+    state: string,
+  ) {
+    const scanned: ScannedLine[] = [];
+    for (let line = from; line <= to; line++) {
+      const next = this.scanLine(source.getLineContent(line), state);
+      scanned.push(next);
+      state = next.after;
+    }
+    return scanned;
+  }
+
+  private invalidate() {
+    this.byName = null;
+    this.fields = null;
+  }
+
+  private build() {
+    if (!this.byName || !this.fields) {
+      const byName = new Map<string, LocatedSymbol[]>();
+      const fields = new Map<string, LocatedSymbol[]>();
+      this.lines.forEach(({ symbols }, i) => {
+        for (const symbol of symbols) {
+          const located = { ...symbol, line: i + 1 };
+          const [map, key] =
+            symbol.kind === "field"
+              ? [fields, symbol.container ?? ""]
+              : [byName, symbol.name];
+          const entries = map.get(key);
+          if (entries) entries.push(located);
+          else map.set(key, [located]);
+        }
+      });
+      this.byName = byName;
+      this.fields = fields;
+    }
+    return { byName: this.byName, fields: this.fields };
+  }
+}
+
+const indexes = new WeakMap<Monaco.editor.ITextModel, SymbolIndex>();
+
+/**
+ * The symbol index of the model - created on first use and kept up to date with its content
+ */
+export function symbolIndexOf(
+  model: Monaco.editor.ITextModel,
+  scan: LineScanner,
+) {
+  let index = indexes.get(model);
+  if (!index) {
+    const created = new SymbolIndex(scan, model);
+    model.onDidChangeContent((event) => {
+      if (event.isFlush) created.reset(model);
+      else created.update(model, event.changes);
+    });
+    indexes.set(model, created);
+    index = created;
+  }
+  return index;
+}
+
+/** The declaration closest above the line, as locals may be declared more than once */
+export function nearestSymbol(symbols: LocatedSymbol[], line: number) {
+  let nearest = symbols[0];
+  for (const symbol of symbols) {
+    if (symbol.line <= line) nearest = symbol;
+  }
+  return nearest;
+}
+
+export function symbolRange({
+  line,
+  column,
+  name,
+}: LocatedSymbol): Monaco.IRange {
+  return {
+    startLineNumber: line,
+    startColumn: column,
+    endLineNumber: line,
+    endColumn: column + name.length,
+  };
+}
+
+/** The declaration of a symbol as hover content */
+export function symbolHover({ detail, kind, line }: LocatedSymbol) {
+  return {
+    contents: [{ value: `\`${detail}\` - **${kind}**, line ${line}` }],
+  };
+}
+
+export function symbolCompletionItem(
+  monaco: typeof Monaco,
+  symbol: LocatedSymbol,
+  range: Monaco.IRange,
+): Monaco.languages.CompletionItem {
+  const { CompletionItemKind } = monaco.languages;
+  const kinds: Record<SymbolKind, Monaco.languages.CompletionItemKind> = {
+    define: CompletionItemKind.Constant,
+    struct: CompletionItemKind.Struct,
+    field: CompletionItemKind.Field,
+    function: CompletionItemKind.Function,
+    variable: CompletionItemKind.Variable,
+    label: CompletionItemKind.Reference,
+  };
+  return {
+    label: symbol.name,
+    kind: kinds[symbol.kind],
+    insertText: symbol.name,
+    detail: symbol.detail,
+    // after the built-in items of the same name
+    sortText: `~${symbol.name}`,
+    range,
+  };
+}
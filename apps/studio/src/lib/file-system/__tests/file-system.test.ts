@@ -0,0 +1,100 @@
+import { beforeEach, describe, expect, mock, test } from "bun:test";
+import * as fileSystemDb from "../file-system-db.ts";
+import type { FolderMetadata } from "../file-system-types.ts";
+
+// an in-memory stand-in of the database - the next `failures` write transactions abort
+const stored = new Map<string, Map<string, unknown>>();
+let failures = 0;
+let transactions = 0;
+
+function storeOf(name: string) {
+  let records = stored.get(name);
+  if (!records) {
+    records = new Map();
+    stored.set(name, records);
+  }
+  return records;
+}
+
+const db = {
+  async put(name: string, value: { id: string }) {
+    storeOf(name).set(value.id, value);
+  },
+  transaction(_names: string[], mode = "readonly") {
+    const fail = mode === "readwrite" && failures > 0;
+    if (fail) failures--;
+    if (mode === "readwrite") transactions++;
+    const changes: [string, string, unknown][] = [];
+    return {
+      objectStore(name: string) {
+        const keyPath =
+          name === fileSystemDb.IdbStores.FileContent ? null : "id";
+        return {
+          keyPath,
+          getAll: async () => [...storeOf(name).values()],
+          put(value: any, key?: string) {
+            changes.push([name, key ?? value[keyPath!], value]);
+          },
+          delete(key: string) {
+            changes.push([name, key, undefined]);
+          },
+        };
+      },
+      get done() {
+        if (fail) return Promise.reject(new Error("Transaction aborted"));
+        for (const [name, key, value] of changes) {
+          if (value === undefined) storeOf(name).delete(key);
+          else storeOf(name).set(key, value);
+        }
+        return Promise.resolve();
+      },
+    };
+  },
+};
+
+globalThis.localStorage ??= { removeItem() {} } as unknown as Storage;
+mock.module("../file-system-db.ts", () => ({
+  ...fileSystemDb,
+  openFileSystemDb: async () => db,
+}));
+const { FileSystem } = await import("../file-system.ts");
+
+const storedFolder = (name: string) =>
+  [...storeOf(fileSystemDb.IdbStores.FolderMetadata).values()].find(
+    (folder) => (folder as FolderMetadata).name === name,
+  );
+
+describe("FileSystem", () => {
+  beforeEach(() => {
+    failures = 0;
+    transactions = 0;
+  });
+
+  test("should commit the writes", async () => {
+    const fs = FileSystem.getInstance();
+    await fs.createFolder("/", "committed");
+    expect(storedFolder("committed")).toBeDefined();
+    expect(transactions).toBe(1);
+  });
+
+  test("should retry the writes of a failed transaction", async () => {
+    const fs = FileSystem.getInstance();
+    await fs.ready;
+    failures = 1;
+    const errors = console.error;
+    console.error = () => {};
+    try {
+      await expect(fs.createFolder("/", "retried")).rejects.toThrow(
+        "Transaction aborted",
+      );
+      expect(storedFolder("retried")).toBeUndefined();
+
+      // committed by the retry, without another write
+      await Bun.sleep(1_500);
+      expect(storedFolder("retried")).toBeDefined();
+      expect(transactions).toBe(2);
+    } finally {
+      console.error = errors;
+    }
+  });
+});
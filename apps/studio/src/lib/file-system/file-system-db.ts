@@ -0,0 +1,94 @@
+import { openDB, type IDBPDatabase, type IDBPTransaction } from "idb";
+import type { FileMetadata, FolderMetadata } from "./file-system-types.ts";
+
+const DB_NAME = "signum-studio-scd";
+const DB_VERSION = 3;
+
+// metadata was kept as a single JSON blob in localStorage up to DB version 2
+export const LegacyMetadataKey = "scd:fs-metadata";
+
+export enum IdbStores {
+  FileContent = "fs-content",
+  FileMetadata = "fs-files",
+  FolderMetadata = "fs-folders",
+  CompileCache = "compile-cache",
+}
+
+export enum IdbIndexes {
+  FolderId = "folderId",
+  ParentId = "parentId",
+  Path = "path",
+}
+
+interface LegacyMetadata {
+  files: Record<string, FileMetadata>;
+  folders: Record<string, FolderMetadata>;
+  folderContents: Record<string, { files: string[]; folders: string[] }>;
+  rootFolder: string;
+}
+
+function migrateLegacyMetadata(
+  tx: IDBPTransaction<unknown, string[], "versionchange">,
+) {
+  const stored = localStorage.getItem(LegacyMetadataKey);
+  if (!stored) return;
+
+  const legacy = JSON.parse(stored) as LegacyMetadata;
+  const files = tx.objectStore(IdbStores.FileMetadata);
+  const folders = tx.objectStore(IdbStores.FolderMetadata);
+  // folderContents is authoritative - moved files kept their old folderId
+  for (const [folderId, contents] of Object.entries(legacy.folderContents)) {
+    for (const fileId of contents.files) {
+      const file = legacy.files[fileId];
+      if (file) files.put({ ...file, folderId });
+    }
+    for (const subFolderId of contents.folders) {
+      const folder = legacy.folders[subFolderId];
+      if (folder) folders.put({ ...folder, parentId: folderId });
+    }
+  }
+  const root = legacy.folders[legacy.rootFolder];
+  if (root) folders.put(root);
+}
+
+let dbPromise: Promise<IDBPDatabase> | null = null;
+
+/**
+ * Opens (and upgrades) the IndexedDB database backing the file system.
+ * The connection is shared by all consumers, i.e. FileSystem and the compile cache.
+ */
+export function openFileSystemDb(): Promise<IDBPDatabase> {
+  if (!dbPromise) {
+    dbPromise = openDB(DB_NAME, DB_VERSION, {
+      upgrade(db, oldVersion, _newVersion, tx) {
+        if (!db.objectStoreNames.contains(IdbStores.FileContent)) {
+          db.createObjectStore(IdbStores.FileContent);
+        }
+        if (!db.objectStoreNames.contains(IdbStores.CompileCache)) {
+          const store = db.createObjectStore(IdbStores.CompileCache, {
+            keyPath: "key",
+          });
+          store.createIndex("lastAccess", "lastAccess");
+        }
+        if (!db.objectStoreNames.contains(IdbStores.FileMetadata)) {
+          const store = db.createObjectStore(IdbStores.FileMetadata, {
+            keyPath: "id",
+          });
+          store.createIndex(IdbIndexes.FolderId, "folderId");
+          store.createIndex(IdbIndexes.Path, "path");
+        }
+        if (!db.objectStoreNames.contains(IdbStores.FolderMetadata)) {
+          const store = db.createObjectStore(IdbStores.FolderMetadata, {
+            keyPath: "id",
+          });
+          store.createIndex(IdbIndexes.ParentId, "parentId");
+          store.createIndex(IdbIndexes.Path, "path");
+        }
+        if (oldVersion < 3) {
+          migrateLegacyMetadata(tx);
+        }
+      },
+    });
+  }
+  return dbPromise;
+}
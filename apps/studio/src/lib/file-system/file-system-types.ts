@@ -2,6 +2,8 @@ export interface FolderMetadata {
   id: string;
   name: string;
   path: string;
+  /** Id of the parent folder - not set for the root folder */
+  parentId?: string;
   createdAt: number;
   lastModified: number;
 
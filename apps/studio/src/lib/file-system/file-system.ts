@@ -1,4 +1,9 @@
-import { openDB, type IDBPDatabase } from "idb";
+import { type IDBPDatabase } from "idb";
+import {
+  IdbStores,
+  LegacyMetadataKey,
+  openFileSystemDb,
+} from "./file-system-db.ts";
 import type {
   FileSystemEvent,
   FileMetadata,
@@ -7,31 +12,37 @@ import type {
   File
 } from "./file-system-types.ts";
 
-// Constants
-const LS_METADATA_KEY = "scd:fs-metadata";
-const DB_NAME = "signum-studio-scd";
-const DB_VERSION = 1;
+// Marks a pending delete in the write queue
+const Deleted = Symbol("deleted");
+// Pending writes are committed once the browser is idle, but at the latest after this time
+const FlushTimeoutMs = 1_000;
+// A failed commit is retried after this time, doubled on every further failure up to the maximum
+const RetryDelayMs = 1_000;
+const MaxRetryDelayMs = 60_000;
 
-enum IdbStores {
-  FileContent = "fs-content",
+type PendingWrites = Map<IdbStores, Map<string, unknown>>;
+
+interface PendingFlush {
+  promise: Promise<void>;
+  resolve: () => void;
+  reject: (reason: unknown) => void;
 }
 
-// Type for the metadata structure stored in localStorage
-interface FileSystemMetadata {
-  files: Record<string, FileMetadata>;
-  folders: Record<string, FolderMetadata>;
-  folderContents: Record<
-    string,
-    {
-      files: string[];
-      folders: string[];
-    }
-  >;
-  rootFolder: string;
+// Ids of the direct children of a folder - derived from the folderId/parentId of the records
+interface FolderContents {
+  files: Set<string>;
+  folders: Set<string>;
 }
 
 /**
  * Class representing a browser-based file system.
+ *
+ * File and folder metadata are stored per record in IndexedDB (indexed by folder and path) and mirrored
+ * in memory, such that all lookups are synchronous. Use `ready` before reading the metadata.
+ *
+ * Writes are applied to memory immediately and written behind: repeated writes of the same record are
+ * coalesced and all pending writes are committed in a single transaction when the browser is idle,
+ * the page gets hidden, or a `batch()` completes.
  */
 export class FileSystem extends EventTarget {
   static instance = new FileSystem();
@@ -51,39 +62,37 @@ export class FileSystem extends EventTarget {
   }
 
   private db: IDBPDatabase | null = null;
-  private readonly metadata: FileSystemMetadata;
+  private readonly files = new Map<string, FileMetadata>();
+  private readonly folders = new Map<string, FolderMetadata>();
+  private readonly folderContents = new Map<string, FolderContents>();
+  // path -> id
+  private readonly filePaths = new Map<string, string>();
+  private readonly folderPaths = new Map<string, string>();
+  private rootFolder = "";
+
+  private pendingWrites: PendingWrites = new Map();
+  private pendingFlush: PendingFlush | null = null;
+  private lastFlush: Promise<void> = Promise.resolve();
+  private cancelScheduledFlush: (() => void) | null = null;
+  private retryDelay = RetryDelayMs;
+  private retryScheduled = false;
+  private batchDepth = 0;
+
+  /**
+   * Resolves once the metadata is loaded from IndexedDB
+   */
+  readonly ready: Promise<void>;
 
   private constructor() {
     super();
-    const storedMetadata = localStorage.getItem(LS_METADATA_KEY);
-
-    if (storedMetadata) {
-      this.metadata = JSON.parse(storedMetadata);
-    } else {
-      // Create initial structure with root folder
-      const rootFolderId = this.generateId();
-
-      this.metadata = {
-        files: {},
-        folders: {
-          [rootFolderId]: {
-            id: rootFolderId,
-            name: "@@Root",
-            path: "/",
-            createdAt: Date.now(),
-            lastModified: Date.now()
-          }
-        },
-        folderContents: {
-          [rootFolderId]: {
-            files: [],
-            folders: []
-          }
-        },
-        rootFolder: rootFolderId
-      };
+    this.ready = this.loadMetadata();
 
-      this.saveMetadata();
+    if (typeof document !== "undefined") {
+      document.addEventListener("visibilitychange", () => {
+        if (document.visibilityState === "hidden") {
+          this.flushInBackground();
+        }
+      });
     }
   }
 
@@ -130,19 +139,229 @@ export class FileSystem extends EventTarget {
   private async initDb(): Promise<IDBPDatabase> {
     if (this.db) return this.db;
 
-    this.db = await openDB(DB_NAME, DB_VERSION, {
-      upgrade(db) {
-        if (!db.objectStoreNames.contains(IdbStores.FileContent)) {
-          db.createObjectStore(IdbStores.FileContent);
+    this.db = await openFileSystemDb();
+    return this.db;
+  }
+
+  private async loadMetadata(): Promise<void> {
+    const db = await this.initDb();
+    // the upgrade to the metadata stores has taken over the legacy blob
+    localStorage.removeItem(LegacyMetadataKey);
+
+    const tx = db.transaction([IdbStores.FolderMetadata, IdbStores.FileMetadata]);
+    const [folders, files] = await Promise.all([
+      tx.objectStore(IdbStores.FolderMetadata).getAll() as Promise<FolderMetadata[]>,
+      tx.objectStore(IdbStores.FileMetadata).getAll() as Promise<FileMetadata[]>,
+    ]);
+
+    // records come in key (i.e. random id) order
+    folders.sort((a, b) => a.createdAt - b.createdAt);
+    files.sort((a, b) => a.name.localeCompare(b.name));
+    for (const folder of folders) {
+      this.indexFolder(folder);
+      if (!folder.parentId) this.rootFolder = folder.id;
+    }
+    for (const file of files) {
+      this.indexFile(file);
+    }
+
+    if (!this.rootFolder) {
+      // Create initial structure with root folder
+      const root: FolderMetadata = {
+        id: this.generateId(),
+        name: "@@Root",
+        path: "/",
+        createdAt: Date.now(),
+        lastModified: Date.now()
+      };
+      await db.put(IdbStores.FolderMetadata, root);
+      this.indexFolder(root);
+      this.rootFolder = root.id;
+    }
+  }
+
+  private write(store: IdbStores, key: string, value: unknown): void {
+    let records = this.pendingWrites.get(store);
+    if (!records) {
+      records = new Map();
+      this.pendingWrites.set(store, records);
+    }
+    records.set(key, value);
+  }
+
+  /**
+   * Resolves once the queued writes are committed - or immediately inside a batch, which commits them on completion.
+   */
+  private persist(): Promise<void> {
+    if (!this.pendingFlush) {
+      let resolve!: () => void;
+      let reject!: (reason: unknown) => void;
+      const promise = new Promise<void>((res, rej) => {
+        resolve = res;
+        reject = rej;
+      });
+      // failures are reported to the awaiting callers, if any
+      promise.catch(() => {});
+      this.pendingFlush = { promise, resolve, reject };
+    }
+    if (this.batchDepth > 0) {
+      return Promise.resolve();
+    }
+    if (!this.cancelScheduledFlush) {
+      if (typeof requestIdleCallback === "function") {
+        const handle = requestIdleCallback(() => this.flushInBackground(), {
+          timeout: FlushTimeoutMs
+        });
+        this.cancelScheduledFlush = () => cancelIdleCallback(handle);
+      } else {
+        const handle = setTimeout(() => this.flushInBackground(), 0);
+        this.cancelScheduledFlush = () => clearTimeout(handle);
+      }
+    }
+    return this.pendingFlush.promise;
+  }
+
+  private flushInBackground(): void {
+    this.flush().catch((e) =>
+      console.error("Cannot write file system changes:", e)
+    );
+  }
+
+  /**
+   * Commits all pending writes in one transaction.
+   *
+   * @return {Promise<void>} Resolves once all writes issued so far are committed.
+   */
+  flush(): Promise<void> {
+    this.cancelScheduledFlush?.();
+    this.cancelScheduledFlush = null;
+    const pendingFlush = this.pendingFlush;
+    this.pendingFlush = null;
+    if (!this.pendingWrites.size) {
+      pendingFlush?.resolve();
+      return this.lastFlush;
+    }
+
+    const writes = this.pendingWrites;
+    this.pendingWrites = new Map();
+
+    // the transaction is created synchronously, so later reads and writes are ordered after it
+    const tx = this.db!.transaction([...writes.keys()], "readwrite");
+    for (const [storeName, records] of writes) {
+      const store = tx.objectStore(storeName);
+      for (const [key, value] of records) {
+        if (value === Deleted) {
+          store.delete(key);
+        } else if (store.keyPath) {
+          store.put(value);
+        } else {
+          store.put(value, key);
+        }
+      }
+    }
+
+    const committed = tx.done.then(
+      () => {
+        this.retryDelay = RetryDelayMs;
+      },
+      (e) => {
+        // keep the writes for the next flush, unless superseded meanwhile
+        for (const [store, records] of writes) {
+          for (const [key, value] of records) {
+            if (!this.pendingWrites.get(store)?.has(key)) {
+              this.write(store, key, value);
+            }
+          }
         }
+        this.scheduleRetry();
+        throw e;
       }
-    });
+    );
+    const flushed = Promise.all([this.lastFlush, committed]).then(
+      () => pendingFlush?.resolve(),
+      (e) => {
+        pendingFlush?.reject(e);
+        throw e;
+      }
+    );
+    this.lastFlush = flushed.catch(() => {});
+    return flushed;
+  }
 
-    return this.db;
+  // no caller waits for the kept writes anymore, so they are committed by a later flush
+  private scheduleRetry(): void {
+    if (this.retryScheduled) return;
+    this.retryScheduled = true;
+    setTimeout(() => {
+      this.retryScheduled = false;
+      if (this.pendingWrites.size) this.persist();
+    }, this.retryDelay);
+    this.retryDelay = Math.min(this.retryDelay * 2, MaxRetryDelayMs);
+  }
+
+  /**
+   * Runs the given operations and commits all their writes in a single transaction.
+   * File operations inside the batch resolve without waiting for the storage.
+   *
+   * @param {() => Promise<T> | T} operations - The file system operations to group.
+   * @return {Promise<T>} Resolves with the result of `operations` once all writes are committed.
+   */
+  async batch<T>(operations: () => Promise<T> | T): Promise<T> {
+    await this.ready;
+    this.batchDepth++;
+    let result: T;
+    try {
+      result = await operations();
+    } finally {
+      this.batchDepth--;
+    }
+    if (this.batchDepth === 0) {
+      await this.flush();
+    }
+    return result;
+  }
+
+  private contentsOf(folderId: string): FolderContents {
+    let contents = this.folderContents.get(folderId);
+    if (!contents) {
+      contents = { files: new Set(), folders: new Set() };
+      this.folderContents.set(folderId, contents);
+    }
+    return contents;
   }
 
-  private saveMetadata(): void {
-    localStorage.setItem(LS_METADATA_KEY, JSON.stringify(this.metadata));
+  private indexFile(metadata: FileMetadata): void {
+    this.files.set(metadata.id, metadata);
+    this.filePaths.set(metadata.path, metadata.id);
+    this.contentsOf(metadata.folderId).files.add(metadata.id);
+  }
+
+  private unindexFile(metadata: FileMetadata): void {
+    this.files.delete(metadata.id);
+    if (this.filePaths.get(metadata.path) === metadata.id) {
+      this.filePaths.delete(metadata.path);
+    }
+    this.folderContents.get(metadata.folderId)?.files.delete(metadata.id);
+  }
+
+  private indexFolder(metadata: FolderMetadata): void {
+    this.folders.set(metadata.id, metadata);
+    this.folderPaths.set(metadata.path, metadata.id);
+    this.contentsOf(metadata.id);
+    if (metadata.parentId) {
+      this.contentsOf(metadata.parentId).folders.add(metadata.id);
+    }
+  }
+
+  private unindexFolder(metadata: FolderMetadata): void {
+    this.folders.delete(metadata.id);
+    if (this.folderPaths.get(metadata.path) === metadata.id) {
+      this.folderPaths.delete(metadata.path);
+    }
+    this.folderContents.delete(metadata.id);
+    if (metadata.parentId) {
+      this.folderContents.get(metadata.parentId)?.folders.delete(metadata.id);
+    }
   }
 
   private generateId(): string {
@@ -157,13 +376,19 @@ export class FileSystem extends EventTarget {
    * @throws {Error} Throws an error if the file metadata is not found.
    */
   async loadFile<T>(fileId: string): Promise<File<T>> {
-    const fileMetadata = this.metadata.files[fileId];
+    await this.ready;
+    const fileMetadata = this.files.get(fileId);
     if (!fileMetadata) {
       throw new Error(`File not found: ${fileId}`);
     }
 
-    const db = await this.initDb();
-    const content = (await db.get(IdbStores.FileContent, fileId)) as T;
+    // not yet committed writes take precedence
+    const pending = this.pendingWrites.get(IdbStores.FileContent);
+    const content = (
+      pending?.has(fileId)
+        ? pending.get(fileId)
+        : await this.db!.get(IdbStores.FileContent, fileId)
+    ) as T;
 
     return {
       content,
@@ -178,51 +403,29 @@ export class FileSystem extends EventTarget {
    * @return {boolean} True if the file exists, otherwise false.
    */
   exists(fileId: string): boolean {
-    return !!this.metadata.files[fileId];
+    return this.files.has(fileId);
   }
 
   /**
-   * Checks if the given path exists in the folderContents metadata.
+   * Checks if a file or folder with the given path exists.
    *
    * @param {string} path - The file path to check for existence.
    * @return {boolean} Returns true if the path exists, otherwise false.
    */
   existPath(path: string): boolean {
-    for (const contents of Object.values(
-      this.metadata.folderContents
-    )) {
-      console.log("existPath", path, contents.files,);
-      if (contents.files.includes(path)) {
-        return true;
-      }
-    }
-    return false;
+    return this.filePaths.has(path) || this.folderPaths.has(path);
   }
 
   getFileMetadata(fileId: string): FileMetadata | null {
-    return this.metadata.files[fileId] || null;
+    return this.files.get(fileId) || null;
   }
 
   getFileIdByPath(path: string): string | null {
-    for (const [fileId, contents] of Object.entries(
-      this.metadata.files
-    )) {
-      if (contents.path === path) {
-        return fileId;
-      }
-    }
-    return null;
+    return this.filePaths.get(path) ?? null;
   }
 
   getFolderIdOfFile(fileId: string): string | null {
-    for (const [folderId, contents] of Object.entries(
-      this.metadata.folderContents
-    )) {
-      if (contents.files.includes(fileId)) {
-        return folderId;
-      }
-    }
-    return null;
+    return this.files.get(fileId)?.folderId ?? null;
   }
 
   /**
@@ -234,67 +437,49 @@ export class FileSystem extends EventTarget {
    * @throws {Error} If the file with the given fileId does not exist in the metadata.
    */
   async saveFile<T>(fileId: string, content: T): Promise<void> {
-    if (!this.metadata.files[fileId]) {
+    await this.ready;
+    const fileMetadata = this.files.get(fileId);
+    if (!fileMetadata) {
       throw new Error(`File not found: ${fileId}`);
     }
 
-    // Update content in IndexedDB
-    const db = await this.initDb();
-    await db.put(IdbStores.FileContent, content, fileId);
+    const metadata = { ...fileMetadata, lastModified: Date.now() };
 
-    // Update metadata
-    this.metadata.files[fileId].lastModified = Date.now();
-    this.saveMetadata();
+    this.files.set(fileId, metadata);
+    this.write(IdbStores.FileContent, fileId, content);
+    this.write(IdbStores.FileMetadata, fileId, metadata);
 
     this.emitEvent({
       type: "file:updated",
       id: fileId,
-      metadata: this.metadata.files[fileId]
+      metadata
     });
+
+    await this.persist();
   }
 
   async deleteFile(fileId: string): Promise<void> {
-    const fileMetadata = this.metadata.files[fileId];
+    await this.ready;
+    const fileMetadata = this.files.get(fileId);
     if (!fileMetadata) {
       throw new Error(`File not found: ${fileId}`);
     }
 
-    // Find the folder containing this file
-    let parentFolderId: string | null = null;
-
-    for (const [folderId, contents] of Object.entries(
-      this.metadata.folderContents
-    )) {
-      if (contents.files.includes(fileId)) {
-        parentFolderId = folderId;
-        break;
-      }
-    }
-
-    if (!parentFolderId) {
+    if (!this.folders.has(fileMetadata.folderId)) {
       throw new Error(`File not associated with any folder: ${fileId}`);
     }
 
-    const metadata = { ...fileMetadata };
-
-    // Delete from IndexedDB
-    const db = await this.initDb();
-    await db.delete(IdbStores.FileContent, fileId);
-
-    // Update metadata
-    delete this.metadata.files[fileId];
-    this.metadata.folderContents[parentFolderId].files =
-      this.metadata.folderContents[parentFolderId].files.filter(
-        (id) => id !== fileId
-      );
+    this.unindexFile(fileMetadata);
+    this.write(IdbStores.FileContent, fileId, Deleted);
+    this.write(IdbStores.FileMetadata, fileId, Deleted);
 
     this.emitEvent({
       type: "file:deleted",
       id: fileId,
-      metadata
+      metadata: fileMetadata
     });
 
-    this.saveMetadata();
+    await this.persist();
   }
 
   /**
@@ -313,17 +498,16 @@ export class FileSystem extends EventTarget {
     type: string,
     content: T
   ): Promise<string> {
-    if (!this.metadata.folders[folderId]) {
+    await this.ready;
+    const folder = this.folders.get(folderId);
+    if (!folder) {
       throw new Error(`Folder not found: ${folderId}`);
     }
 
     // Generate a new file ID
     const fileId = this.generateId();
-    const folderPath = this.metadata.folders[folderId].path;
-    const filePath = `${folderPath === "/" ? "" : folderPath}/${name}`;
-
-    // Add file metadata
-    this.metadata.files[fileId] = {
+    const filePath = `${folder.path === "/" ? "" : folder.path}/${name}`;
+    const metadata: FileMetadata = {
       id: fileId,
       folderId,
       name,
@@ -332,21 +516,19 @@ export class FileSystem extends EventTarget {
       lastModified: Date.now()
     };
 
-    // Add to folder contents
-    this.metadata.folderContents[folderId].files.push(fileId);
-    this.saveMetadata();
-
-    // Save content to IndexedDB
-    const db = await this.initDb();
-    await db.put(IdbStores.FileContent, content, fileId);
+    this.indexFile(metadata);
+    this.write(IdbStores.FileContent, fileId, content);
+    this.write(IdbStores.FileMetadata, fileId, metadata);
 
     this.emitEvent({
       type: "file:added",
       id: fileId,
-      metadata: this.metadata.files[fileId],
+      metadata,
       relatedId: folderId
     });
 
+    await this.persist();
+
     return fileId;
   }
 
@@ -360,57 +542,38 @@ export class FileSystem extends EventTarget {
    * @throws {Error} - Throws an error if the parent folder specified by `parentPath` is not found.
    */
   async createFolder(parentPath: string, name: string): Promise<string> {
-    // Find parent folder ID from path
-    let parentFolderId: string | null = null;
-
-    for (const [folderId, metadata] of Object.entries(this.metadata.folders)) {
-      if (metadata.path === parentPath) {
-        parentFolderId = folderId;
-        break;
-      }
-    }
+    await this.ready;
+    const parentFolderId =
+      parentPath === "/" ? this.rootFolder : this.folderPaths.get(parentPath);
 
-    if (!parentFolderId && parentPath !== "/") {
+    if (!parentFolderId) {
       throw new Error(`Parent folder not found: ${parentPath}`);
     }
 
-    if (parentPath === "/") {
-      parentFolderId = this.metadata.rootFolder;
-    }
-
     // Generate a new folder ID
     const folderId = this.generateId();
     const folderPath = `${parentPath === "/" ? "" : parentPath}/${name}`;
-
-    // Add folder metadata
-    this.metadata.folders[folderId] = {
+    const metadata: FolderMetadata = {
       id: folderId,
       name,
       path: folderPath,
+      parentId: parentFolderId,
       createdAt: Date.now(),
       lastModified: Date.now()
     };
 
-    // Initialize folder contents
-    this.metadata.folderContents[folderId] = {
-      files: [],
-      folders: []
-    };
-
-    // Add to parent folder contents
-    if (parentFolderId) {
-      this.metadata.folderContents[parentFolderId].folders.push(folderId);
-    }
-
-    this.saveMetadata();
+    this.indexFolder(metadata);
+    this.write(IdbStores.FolderMetadata, folderId, metadata);
 
     this.emitEvent({
       type: "folder:created",
       id: folderId,
-      metadata: this.metadata.folders[folderId],
-      relatedId: parentFolderId || undefined
+      metadata,
+      relatedId: parentFolderId
     });
 
+    await this.persist();
+
     return folderId;
   }
 
@@ -423,75 +586,60 @@ export class FileSystem extends EventTarget {
    * @return {Promise<void>} Resolves when the folder has been successfully deleted, or rejects with an error if the operation fails.
    */
   async deleteFolder(folderId: string): Promise<void> {
-    if (!this.metadata.folders[folderId]) {
+    await this.ready;
+    const metadata = this.folders.get(folderId);
+    if (!metadata) {
       throw new Error(`Folder not found: ${folderId}`);
     }
 
-    if (folderId === this.metadata.rootFolder) {
+    if (folderId === this.rootFolder) {
       throw new Error("Cannot delete root folder");
     }
 
-    const metadata = { ...this.metadata.folders[folderId] };
-
-    // Find and update parent folder
-    let parentFolderId: string | null = null;
+    const folders: FolderMetadata[] = [];
+    const files: FileMetadata[] = [];
+    this.collectSubtree(folderId, folders, files);
 
-    for (const [fId, contents] of Object.entries(
-      this.metadata.folderContents
-    )) {
-      if (contents.folders.includes(folderId)) {
-        parentFolderId = fId;
-        break;
-      }
+    // Emit events for each deleted file
+    for (const file of files) {
+      this.unindexFile(file);
+      this.write(IdbStores.FileContent, file.id, Deleted);
+      this.write(IdbStores.FileMetadata, file.id, Deleted);
+      this.emitEvent({
+        type: "file:deleted",
+        id: file.id,
+        metadata: file,
+        relatedId: file.folderId
+      });
     }
-
-    // Recursively delete folder contents
-    await this.recursiveDeleteFolder(folderId);
-
-    if (parentFolderId) {
-      // Remove from parent folder contents
-      this.metadata.folderContents[parentFolderId].folders =
-        this.metadata.folderContents[parentFolderId].folders.filter(
-          (id) => id !== folderId
-        );
+    for (const folder of folders) {
+      this.unindexFolder(folder);
+      this.write(IdbStores.FolderMetadata, folder.id, Deleted);
     }
 
-    this.saveMetadata();
-
     this.emitEvent({
       type: "folder:deleted",
       id: folderId,
       metadata,
-      relatedId: parentFolderId || undefined
+      relatedId: metadata.parentId
     });
-  }
 
-  private async recursiveDeleteFolder(folderId: string): Promise<void> {
-    const contents = this.metadata.folderContents[folderId];
+    await this.persist();
+  }
 
-    // Delete all files in this folder and emit events for each
-    const db = await this.initDb();
+  private collectSubtree(
+    folderId: string,
+    folders: FolderMetadata[],
+    files: FileMetadata[]
+  ): void {
+    const contents = this.contentsOf(folderId);
     for (const fileId of contents.files) {
-      const metadata = { ...this.metadata.files[fileId] };
-      await db.delete(IdbStores.FileContent, fileId);
-      delete this.metadata.files[fileId];
-
-      this.emitEvent({
-        type: "file:deleted",
-        id: fileId,
-        metadata,
-        relatedId: folderId
-      });
+      files.push(this.files.get(fileId)!);
     }
-
-    // Recursively delete all subfolders
     for (const subFolderId of contents.folders) {
-      await this.recursiveDeleteFolder(subFolderId);
+      this.collectSubtree(subFolderId, folders, files);
     }
-
-    // Delete folder metadata
-    delete this.metadata.folders[folderId];
-    delete this.metadata.folderContents[folderId];
+    folders.push(this.folders.get(folderId)!);
   }
 
   /**
@@ -502,59 +650,56 @@ export class FileSystem extends EventTarget {
    * @return {Promise<void>} A promise that resolves when the folder renaming operation is complete or rejects if an error occurs.
    */
   async renameFolder(folderId: string, newName: string): Promise<void> {
-    if (!this.metadata.folders[folderId]) {
+    await this.ready;
+    const folder = this.folders.get(folderId);
+    if (!folder) {
       throw new Error(`Folder not found: ${folderId}`);
     }
 
-    if (folderId === this.metadata.rootFolder) {
+    if (folderId === this.rootFolder) {
       throw new Error("Cannot rename root folder");
     }
 
-    const oldPath = this.metadata.folders[folderId].path;
+    const oldPath = folder.path;
     const parentPath = oldPath.substring(0, oldPath.lastIndexOf("/"));
     const newPath = `${parentPath}/${newName}`;
 
-    // Update folder path
-    this.metadata.folders[folderId].name = newName;
-    this.metadata.folders[folderId].path = newPath;
-    this.metadata.folders[folderId].lastModified = Date.now();
-
-    // Update paths of all files and subfolders
-    await this.updatePathsRecursively(folderId, oldPath, newPath);
+    // Update paths of the folder, all files and subfolders
+    const folders: FolderMetadata[] = [];
+    const files: FileMetadata[] = [];
+    this.collectSubtree(folderId, folders, files);
+    const rebase = (path: string) => newPath + path.slice(oldPath.length);
+    const renamedFolders = folders.map((f) =>
+      f.id === folderId
+        ? { ...f, name: newName, path: newPath, lastModified: Date.now() }
+        : { ...f, path: rebase(f.path) }
+    );
+    const renamedFiles = files.map((f) => ({ ...f, path: rebase(f.path) }));
 
-    this.saveMetadata();
+    for (const f of folders) {
+      if (this.folderPaths.get(f.path) === f.id) this.folderPaths.delete(f.path);
+    }
+    for (const f of files) {
+      if (this.filePaths.get(f.path) === f.id) this.filePaths.delete(f.path);
+    }
+    for (const f of renamedFolders) {
+      this.folders.set(f.id, f);
+      this.folderPaths.set(f.path, f.id);
+      this.write(IdbStores.FolderMetadata, f.id, f);
+    }
+    for (const f of renamedFiles) {
+      this.files.set(f.id, f);
+      this.filePaths.set(f.path, f.id);
+      this.write(IdbStores.FileMetadata, f.id, f);
+    }
 
     this.emitEvent({
       type: "folder:renamed",
       id: folderId,
-      metadata: this.metadata.folders[folderId]
+      metadata: this.folders.get(folderId)
     });
-  }
-
-  private async updatePathsRecursively(
-    folderId: string,
-    oldBasePath: string,
-    newBasePath: string
-  ): Promise<void> {
-    const contents = this.metadata.folderContents[folderId];
 
-    // Update file paths
-    for (const fileId of contents.files) {
-      const fileMeta = this.metadata.files[fileId];
-      fileMeta.path = fileMeta.path.replace(oldBasePath, newBasePath);
-    }
-
-    // Update subfolder paths
-    for (const subFolderId of contents.folders) {
-      const folderMeta = this.metadata.folders[subFolderId];
-      const oldSubPath = folderMeta.path;
-      const newSubPath = oldSubPath.replace(oldBasePath, newBasePath);
-
-      folderMeta.path = newSubPath;
-
-      // Recursive update for subfolders
-      await this.updatePathsRecursively(subFolderId, oldSubPath, newSubPath);
-    }
+    await this.persist();
   }
 
   /**
@@ -566,58 +711,44 @@ export class FileSystem extends EventTarget {
    * if the file, target folder, or source folder cannot be found.
    */
   async moveFile(fileId: string, targetFolderId: string): Promise<void> {
-    if (!this.metadata.files[fileId]) {
+    await this.ready;
+    const fileMetadata = this.files.get(fileId);
+    if (!fileMetadata) {
       throw new Error(`File not found: ${fileId}`);
     }
 
-    if (!this.metadata.folders[targetFolderId]) {
+    const targetFolder = this.folders.get(targetFolderId);
+    if (!targetFolder) {
       throw new Error(`Target folder not found: ${targetFolderId}`);
     }
 
-    // Find current parent folder
-    let sourceFolderId: string | null = null;
-
-    for (const [folderId, contents] of Object.entries(
-      this.metadata.folderContents
-    )) {
-      if (contents.files.includes(fileId)) {
-        sourceFolderId = folderId;
-        break;
-      }
-    }
-
-    if (!sourceFolderId) {
+    if (!this.folders.has(fileMetadata.folderId)) {
       throw new Error(`File not associated with any folder: ${fileId}`);
     }
 
-    if (sourceFolderId === targetFolderId) {
+    if (fileMetadata.folderId === targetFolderId) {
       return; // Already in the target folder
     }
 
-    // Update file path
-    const fileName = this.metadata.files[fileId].name;
-    const targetFolderPath = this.metadata.folders[targetFolderId].path;
-    this.metadata.files[fileId].path =
-      `${targetFolderPath === "/" ? "" : targetFolderPath}/${fileName}`;
-    this.metadata.files[fileId].lastModified = Date.now();
-
-    // Remove from source folder
-    this.metadata.folderContents[sourceFolderId].files =
-      this.metadata.folderContents[sourceFolderId].files.filter(
-        (id) => id !== fileId
-      );
-
-    // Add to target folder
-    this.metadata.folderContents[targetFolderId].files.push(fileId);
+    const metadata: FileMetadata = {
+      ...fileMetadata,
+      folderId: targetFolderId,
+      path: `${targetFolder.path === "/" ? "" : targetFolder.path}/${fileMetadata.name}`,
+      lastModified: Date.now()
+    };
 
-    this.saveMetadata();
+    this.unindexFile(fileMetadata);
+    this.indexFile(metadata);
+    this.write(IdbStores.FileMetadata, fileId, metadata);
 
     this.emitEvent({
       type: "file:moved",
       id: fileId,
-      metadata: this.metadata.files[fileId],
+      metadata,
       relatedId: targetFolderId
     });
+
+    await this.persist();
   }
 
   // Browsing operations
@@ -637,22 +768,21 @@ export class FileSystem extends EventTarget {
     files: { id: string; metadata: FileMetadata }[];
   } {
 
-    const folderIdToUse = folderId ?? this.metadata.rootFolder;
+    const folderIdToUse = folderId ?? this.rootFolder;
 
-    if (!this.metadata.folderContents[folderIdToUse]) {
+    const contents = this.folderContents.get(folderIdToUse);
+    if (!contents) {
       throw new Error(`Folder not found: ${folderIdToUse}`);
     }
 
-    const contents = this.metadata.folderContents[folderIdToUse];
-
     return {
-      folders: contents.folders.map((id) => ({
+      folders: Array.from(contents.folders, (id) => ({
         id,
-        metadata: this.metadata.folders[id]
+        metadata: this.folders.get(id)!
       })),
-      files: contents.files.map((id) => ({
+      files: Array.from(contents.files, (id) => ({
         id,
-        metadata: this.metadata.files[id]
+        metadata: this.files.get(id)!
       }))
     };
   }
@@ -665,10 +795,11 @@ export class FileSystem extends EventTarget {
    * @throws {Error} If the folder with the specified ID is not found.
    */
   getFolder(folderId: string): FolderMetadata {
-    if (!this.metadata.folders[folderId]) {
+    const folder = this.folders.get(folderId);
+    if (!folder) {
       throw new Error(`Folder not found: ${folderId}`);
     }
-    return this.metadata.folders[folderId];
+    return folder;
   };
 
 }
@@ -1,2 +1,3 @@
 export * from './file-system';
 export * from './file-system-types.ts'
+export * from './file-system-db.ts'
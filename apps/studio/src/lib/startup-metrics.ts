@@ -0,0 +1,67 @@
+export interface StartupMetrics {
+  /** From navigation start until the main thread is idle after the first render */
+  timeToInteractiveMs: number;
+  /** Over the network until then, compressed - cached resources count zero */
+  transferredBytes: number;
+  /** Decoded size of the documents, scripts and styles loaded until then */
+  decodedBytes: number;
+  resources: number;
+  recordedAt: string;
+}
+
+const HistoryKey = "studio:startup-metrics";
+const HistorySize = 20;
+
+/** The recorded startups of this browser, the latest last */
+export function getStartupHistory(): StartupMetrics[] {
+  try {
+    return JSON.parse(localStorage.getItem(HistoryKey) ?? "[]");
+  } catch {
+    return [];
+  }
+}
+
+function collect(interactive: number): StartupMetrics {
+  const entries = [
+    ...performance.getEntriesByType("navigation"),
+    ...performance.getEntriesByType("resource"),
+  ] as PerformanceResourceTiming[];
+  const loaded = entries.filter((entry) => entry.startTime <= interactive);
+  return {
+    timeToInteractiveMs: Math.round(interactive),
+    transferredBytes: loaded.reduce((sum, e) => sum + e.transferSize, 0),
+    decodedBytes: loaded.reduce((sum, e) => sum + e.decodedBodySize, 0),
+    resources: loaded.length,
+    recordedAt: new Date().toISOString(),
+  };
+}
+
+/**
+ * Measures the startup, once the app has rendered and the main thread is idle. The measure shows
+ * up as `studio:startup` in the performance tools, the metrics are kept in the local storage to
+ * compare them over builds.
+ */
+export function measureStartup(): Promise<StartupMetrics> {
+  return new Promise((resolve) => {
+    const done = () => {
+      const mark = performance.mark("studio:interactive");
+      performance.measure("studio:startup", { start: 0, end: mark.startTime });
+      const metrics = collect(mark.startTime);
+      try {
+        localStorage.setItem(
+          HistoryKey,
+          JSON.stringify([...getStartupHistory(), metrics].slice(-HistorySize)),
+        );
+      } catch {
+        // storage disabled or full - the metrics are logged anyway
+      }
+      console.info("Startup metrics:", metrics);
+      resolve(metrics);
+    };
+    if (typeof requestIdleCallback === "function") {
+      requestIdleCallback(done, { timeout: 10000 });
+    } else {
+      setTimeout(done, 0);
+    }
+  });
+}
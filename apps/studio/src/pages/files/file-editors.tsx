@@ -0,0 +1,41 @@
+import { lazy } from "react";
+
+// each editor is a chunk of its own, with its share of Monaco, the compiler and the SCD parser
+const loaders = {
+  scd: () => import("@/features/scd-editor/scd-file-editor.tsx"),
+  smartC: () => import("@/features/smartc-editor/smartc-file-editor.tsx"),
+  asm: () => import("@/features/asm-editor/asm-file-editor.tsx"),
+};
+
+export const SCDFileEditor = lazy(() =>
+  loaders.scd().then((m) => ({ default: m.SCDFileEditor })),
+);
+
+export const SmartCFileEditor = lazy(() =>
+  loaders.smartC().then((m) => ({ default: m.SmartCFileEditor })),
+);
+
+export const AsmFileEditor = lazy(() =>
+  loaders.asm().then((m) => ({ default: m.AsmFileEditor })),
+);
+
+const onIdle = (callback: () => void) =>
+  typeof requestIdleCallback === "function"
+    ? requestIdleCallback(callback, { timeout: 5000 })
+    : setTimeout(callback, 1000);
+
+/**
+ * Loads the editor chunks one by one while the browser is idle, so opening a file doesn't wait for
+ * the network. The loaders are cached by the module system - the lazy components reuse them.
+ */
+export function prefetchFileEditors() {
+  const pending = Object.values(loaders);
+  const next = () => {
+    const load = pending.shift();
+    if (!load) return;
+    load()
+      .catch((e) => console.warn("Cannot prefetch editor:", e))
+      .finally(() => onIdle(next));
+  };
+  onIdle(next);
+}
@@ -3,13 +3,15 @@ import { Page, PageContent, PageHeader } from "@/components/ui/page";
 import { Navigate, useParams } from "react-router";
 import { toast } from "sonner";
 import { usePageHeaderActions } from "@/hooks/use-page-header-actions.ts";
-import { SCDFileEditor } from "@/features/scd-editor/scd-file-editor.tsx";
-import { useEffect, useState } from "react";
+import { Suspense, useEffect, useState } from "react";
 import { useFileSystem } from "@/hooks/use-file-system.ts";
 import type {File} from "@/lib/file-system"
-import { SmartCFileEditor } from "@/features/smartc-editor/smartc-file-editor.tsx";
 import { FileTypes } from "@/features/project/filetype-icons.tsx";
-import { AsmFileEditor } from "@/features/asm-editor/asm-file-editor.tsx";
+import {
+  AsmFileEditor,
+  SCDFileEditor,
+  SmartCFileEditor,
+} from "./file-editors.tsx";
 
 type FilesPageParams = {
   projectId: string;
@@ -62,13 +64,15 @@ export function FilesPage() {
       </PageHeader>
       <PageContent className="overflow-hidden">
         <div className="flex-1">
-          {type === FileTypes.SCD && <SCDFileEditor key={id} file={file!} />}
-          {type === FileTypes.SmartC && (
-            <SmartCFileEditor key={id} file={file!} />
-          )}
-          {type === FileTypes.ASM && (
-            <AsmFileEditor key={id} file={file!} />
-          )}
+          <Suspense fallback={<div>Loading editor...</div>}>
+            {type === FileTypes.SCD && <SCDFileEditor key={id} file={file!} />}
+            {type === FileTypes.SmartC && (
+              <SmartCFileEditor key={id} file={file!} />
+            )}
+            {type === FileTypes.ASM && (
+              <AsmFileEditor key={id} file={file!} />
+            )}
+          </Suspense>
         </div>
       </PageContent>
     </Page>
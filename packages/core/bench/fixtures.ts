@@ -0,0 +1,50 @@
+import type { DataType, SCDType } from "../src/parser";
+
+const ArgumentTypes: DataType[] = ["long", "amount", "address", "boolean"];
+
+/**
+ * Synthetic SCD of the given size - names and codes are unique
+ */
+export function syntheticSCD({
+  methods,
+  variables,
+  maps,
+}: {
+  methods: number;
+  variables: number;
+  maps: number;
+}): SCDType {
+  return {
+    contractName: "Synthetic",
+    description: `${methods} methods, ${variables} variables, ${maps} maps`,
+    activationAmount: "1_0000_0000",
+    pragmas: { maxAuxVars: 3, verboseAssembly: false, version: "2.3.0" },
+    methods: Array.from({ length: methods }, (_, i) => ({
+      name: `method${i}`,
+      code: String(i + 1),
+      args: Array.from({ length: i % 4 }, (_, a) => ({
+        name: `arg${a}`,
+        type: ArgumentTypes[a]!,
+      })),
+    })),
+    variables: Array.from({ length: variables }, (_, i) =>
+      i % 10 === 0
+        ? {
+            name: `struct${i}`,
+            type: "struct" as const,
+            fields: [
+              { name: "a", type: "long" as const },
+              { name: "b", type: "amount" as const },
+            ],
+          }
+        : { name: `var${i}`, type: "long" as const },
+    ),
+    maps: Array.from({ length: maps }, (_, i) => ({
+      name: `map${i}`,
+      key1: { name: `key${i}`, constant: true, value: String(i + 1) },
+      key2: { name: "account", type: "address" as const },
+      value: { name: "value", type: "amount" as const },
+    })),
+    transactions: [],
+  };
+}
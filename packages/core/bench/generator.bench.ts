@@ -0,0 +1,54 @@
+/**
+ * Compares the generation throughput of the precompiled template with `renderString`, which
+ * compiles the template on every call (the former implementation), on the snapshot fixture.
+ *
+ *   bun bench/generator.bench.ts
+ */
+import { Eta } from "eta";
+import { SCD } from "../src/parser";
+import { SmartCGenerator } from "../src/generator";
+import { SmartCTemplate } from "../src/generator/templates/smartc.eta";
+import { mockSCD } from "../src/generator/__tests/mock-scd";
+
+const Iterations = 5_000;
+
+const scd = SCD.parse(mockSCD);
+const generator = new SmartCGenerator(scd);
+const eta = new Eta();
+
+function renderStringOnEveryCall() {
+  const info = scd.getContractInfo();
+  return eta.renderString(SmartCTemplate, {
+    contractName: info.name,
+    description: info.description,
+    activationAmount: info.activationAmount,
+    pragmas: info.pragmas,
+    methods: scd.getMethods(),
+    dispatchMethods: scd.getMethods(),
+    variables: scd.getVariables(),
+    structs: scd.getStructs(),
+    packedWords: [],
+    maps: scd.getMaps(),
+    collections: [],
+  });
+}
+
+function rate(fn: () => unknown) {
+  for (let i = 0; i < 100; i++) fn(); // warm up
+  const start = performance.now();
+  for (let i = 0; i < Iterations; i++) fn();
+  return Math.round((Iterations / (performance.now() - start)) * 1000);
+}
+
+if (renderStringOnEveryCall() !== generator.generateContract()) {
+  throw new Error("Precompiled output differs from renderString");
+}
+
+const sink = { write: (_chunk: string) => {} };
+console.table({
+  "renderString (before)": { "contracts/s": rate(renderStringOnEveryCall) },
+  "generateContract": { "contracts/s": rate(() => generator.generateContract()) },
+  "writeContract (sink)": {
+    "contracts/s": rate(() => generator.writeContract(sink)),
+  },
+});
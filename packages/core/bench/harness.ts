@@ -0,0 +1,63 @@
+export interface BenchCase {
+  name: string;
+  fn: () => unknown;
+  /** Minimum measuring time - default: 500ms */
+  minTimeMs?: number;
+}
+
+export interface BenchResult {
+  name: string;
+  samples: number;
+  /** Calls per sample - fast functions are batched to get measurable samples */
+  batch: number;
+  meanMs: number;
+  medianMs: number;
+  p95Ms: number;
+  opsPerSec: number;
+}
+
+const MinSamples = 10;
+const MaxSamples = 10_000;
+const MinSampleMs = 1;
+
+function percentile(sorted: number[], p: number) {
+  return sorted[Math.min(sorted.length - 1, Math.floor(sorted.length * p))]!;
+}
+
+/**
+ * Measures the time per call of `fn`. Times are per call, i.e. divided by the batch size.
+ */
+export function measure({ name, fn, minTimeMs = 500 }: BenchCase): BenchResult {
+  // warm up and find a batch size for which a sample takes at least 1ms
+  let batch = 1;
+  for (;;) {
+    const start = performance.now();
+    for (let i = 0; i < batch; i++) fn();
+    if (performance.now() - start >= MinSampleMs) break;
+    batch *= 2;
+  }
+
+  const samples: number[] = [];
+  const end = performance.now() + minTimeMs;
+  while (
+    samples.length < MinSamples ||
+    (performance.now() < end && samples.length < MaxSamples)
+  ) {
+    const start = performance.now();
+    for (let i = 0; i < batch; i++) fn();
+    samples.push((performance.now() - start) / batch);
+  }
+
+  const sorted = [...samples].sort((a, b) => a - b);
+  const meanMs = samples.reduce((sum, s) => sum + s, 0) / samples.length;
+  const medianMs = percentile(sorted, 0.5);
+  return {
+    name,
+    samples: samples.length,
+    batch,
+    meanMs,
+    medianMs,
+    p95Ms: percentile(sorted, 0.95),
+    opsPerSec: 1000 / medianMs,
+  };
+}
@@ -0,0 +1,171 @@
+/**
+ * Runs the benchmark suites, writes the results as JSON and compares them with the committed
+ * baseline - a missing baseline, or a case missing in it, fails the run; `--update-baseline`
+ * creates it.
+ *
+ *   bun run bench                      # all suites, fails on regressions
+ *   bun run bench --only generate      # only cases containing "generate"
+ *   bun run bench --update-baseline    # accept the current results as baseline
+ *   bun run bench --threshold 0.5      # allowed slowdown of the median, overrides thresholds.json
+ */
+import { mkdirSync } from "node:fs";
+import { cpus, platform } from "node:os";
+import { dirname, resolve } from "node:path";
+import { parseArgs } from "node:util";
+import { type BenchResult, measure } from "./harness";
+import { Suites } from "./suites";
+
+interface Environment {
+  runtime: string;
+  platform: string;
+  cpu: string;
+}
+
+interface ResultsFile {
+  createdAt: string;
+  environment: Environment;
+  results: Record<string, BenchResult>;
+}
+
+interface Thresholds {
+  /** Allowed relative slowdown of the median, e.g. 0.25 = 25% */
+  default: number;
+  cases?: Record<string, number>;
+}
+
+const BaselineFile = resolve(import.meta.dir, "baseline.json");
+const ThresholdsFile = resolve(import.meta.dir, "thresholds.json");
+const DefaultResultsFile = resolve(import.meta.dir, "results/latest.json");
+
+const { values } = parseArgs({
+  args: Bun.argv.slice(2),
+  options: {
+    only: { type: "string" },
+    threshold: { type: "string" },
+    out: { type: "string" },
+    "update-baseline": { type: "boolean", default: false },
+  },
+});
+
+const environment: Environment = {
+  runtime: `bun ${Bun.version}`,
+  platform: `${platform()} ${process.arch}`,
+  cpu: cpus()[0]?.model ?? "unknown",
+};
+
+async function readJson<T>(path: string): Promise<T | null> {
+  const file = Bun.file(path);
+  return (await file.exists()) ? ((await file.json()) as T) : null;
+}
+
+function formatMs(ms: number) {
+  return ms >= 1 ? `${ms.toFixed(2)} ms` : `${(ms * 1000).toFixed(1)} µs`;
+}
+
+// without a baseline, nothing would be compared and every run would pass
+const baseline = await readJson<ResultsFile>(BaselineFile);
+if (!baseline && !values["update-baseline"]) {
+  console.error(
+    `✗ No baseline at ${BaselineFile} - create it with: bun run bench --update-baseline`,
+  );
+  process.exit(1);
+}
+
+const results: Record<string, BenchResult> = {};
+let failures = 0;
+for (const [suite, createCases] of Object.entries(Suites)) {
+  let cases;
+  try {
+    cases = createCases();
+  } catch (e: any) {
+    console.error(`✗ suite ${suite}: ${e?.message ?? e}`);
+    failures++;
+    continue;
+  }
+  for (const benchCase of cases) {
+    if (values.only && !benchCase.name.includes(values.only)) continue;
+    try {
+      const result = measure(benchCase);
+      results[result.name] = result;
+      console.log(`  ${result.name}: ${formatMs(result.medianMs)}`);
+    } catch (e: any) {
+      console.error(`✗ ${benchCase.name}: ${e?.message ?? e}`);
+      failures++;
+    }
+  }
+}
+
+const output: ResultsFile = {
+  createdAt: new Date().toISOString(),
+  environment,
+  results,
+};
+const resultsFile = values.out ? resolve(values.out) : DefaultResultsFile;
+mkdirSync(dirname(resultsFile), { recursive: true });
+await Bun.write(resultsFile, JSON.stringify(output, null, 2));
+
+if (values["update-baseline"]) {
+  // a filtered run only replaces its own cases
+  const merged = values.only
+    ? { ...output, results: { ...baseline?.results, ...results } }
+    : output;
+  await Bun.write(BaselineFile, JSON.stringify(merged, null, 2) + "\n");
+  console.log(`\nBaseline updated: ${Object.keys(results).length} cases`);
+  process.exit(failures ? 1 : 0);
+}
+
+const thresholds = (await readJson<Thresholds>(ThresholdsFile)) ?? {
+  default: 0.25,
+};
+const { environment: measuredOn } = baseline!;
+if (JSON.stringify(measuredOn) !== JSON.stringify(environment)) {
+  console.warn(
+    `\nBaseline was measured on ${measuredOn.cpu} (${measuredOn.runtime}) - comparisons are indicative only`,
+  );
+}
+
+let regressions = 0;
+// an unmeasured case could regress unnoticed - e.g. the compiler cases of a baseline without them
+const unmeasured: string[] = [];
+const comparison = Object.values(results).map((result) => {
+  const reference = baseline!.results[result.name];
+  const threshold = values.threshold
+    ? Number(values.threshold)
+    : (thresholds.cases?.[result.name] ?? thresholds.default);
+  if (!reference) {
+    unmeasured.push(result.name);
+    return {
+      case: result.name,
+      median: formatMs(result.medianMs),
+      status: "MISSING in the baseline",
+    };
+  }
+  const change = result.medianMs / reference.medianMs - 1;
+  const regressed = change > threshold;
+  if (regressed) regressions++;
+  return {
+    case: result.name,
+    median: formatMs(result.medianMs),
+    baseline: formatMs(reference.medianMs),
+    change: `${change >= 0 ? "+" : ""}${(change * 100).toFixed(1)}%`,
+    status: regressed
+      ? `REGRESSION (> ${threshold * 100}%)`
+      : change < -threshold
+        ? "faster"
+        : "ok",
+  };
+});
+console.table(comparison);
+console.log(`Results: ${resultsFile}`);
+
+if (unmeasured.length) {
+  console.error(
+    `\n✗ ${unmeasured.length} cases not in the baseline - add them with: bun run bench --update-baseline --only <case>`,
+  );
+}
+if (regressions || failures || unmeasured.length) {
+  console.error(
+    `\n${regressions} regressions, ${failures} failures, ${unmeasured.length} missing in the baseline`,
+  );
+  process.exit(1);
+}
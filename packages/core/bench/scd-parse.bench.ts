@@ -0,0 +1,101 @@
+/**
+ * Compares the precompiled SCD validator with the Ajv compiled schema:
+ * cold start (first parse, including the schema compilation), SCD.parse throughput and browser bundle size.
+ *
+ *   bun bench/scd-parse.bench.ts
+ */
+import { mkdtempSync, rmSync, writeFileSync } from "node:fs";
+import { tmpdir } from "node:os";
+import { join, resolve } from "node:path";
+import { SCD } from "../src/parser";
+import { createAjvValidator } from "../src/parser/ajv-validator";
+
+const Iterations = 100_000;
+
+const scd = {
+  contractName: "Bench",
+  activationAmount: "1_0000_0000",
+  pragmas: { maxAuxVars: 3, verboseAssembly: false, version: "2.3.0" },
+  methods: Array.from({ length: 10 }, (_, i) => ({
+    name: `method${i}`,
+    code: String(i + 1),
+    args: [
+      { name: "amount", type: "amount" },
+      { name: "recipient", type: "address" },
+    ],
+  })),
+  variables: Array.from({ length: 10 }, (_, i) => ({
+    name: `var${i}`,
+    type: "long",
+  })),
+  maps: [
+    {
+      name: "balances",
+      key1: { name: "account", type: "address" },
+      key2: { name: "token", type: "long" },
+      value: { name: "balance", type: "amount" },
+    },
+  ],
+  transactions: [],
+};
+
+function time(fn: () => void) {
+  const start = performance.now();
+  fn();
+  return performance.now() - start;
+}
+
+function parseRate() {
+  for (let i = 0; i < 1000; i++) SCD.parse(scd); // warm up
+  const elapsed = time(() => {
+    for (let i = 0; i < Iterations; i++) SCD.parse(scd);
+  });
+  return Math.round((Iterations / elapsed) * 1000);
+}
+
+async function bundleSize(source: string) {
+  const dir = mkdtempSync(join(tmpdir(), "scd-bench-"));
+  try {
+    const entry = join(dir, "entry.ts");
+    writeFileSync(entry, source);
+    const { outputs } = await Bun.build({
+      entrypoints: [entry],
+      target: "browser",
+      minify: true,
+    });
+    return outputs.reduce((sum, output) => sum + output.size, 0);
+  } finally {
+    rmSync(dir, { recursive: true, force: true });
+  }
+}
+
+const parser = resolve(import.meta.dir, "../src/parser");
+const [precompiledBytes, ajvBytes] = await Promise.all([
+  bundleSize(
+    `import { SCD } from "${parser}/index.ts"; console.log(SCD.parse({}));`,
+  ),
+  bundleSize(
+    `import { SCD } from "${parser}/index.ts"; import { createAjvValidator } from "${parser}/ajv-validator.ts"; SCD.useValidator(createAjvValidator()); console.log(SCD.parse({}));`,
+  ),
+]);
+
+const precompiledFirst = time(() => SCD.parse(scd));
+const precompiledRate = parseRate();
+const ajvFirst = time(() => {
+  SCD.useValidator(createAjvValidator());
+  SCD.parse(scd);
+});
+const ajvRate = parseRate();
+
+console.table({
+  precompiled: {
+    "first parse (ms)": precompiledFirst.toFixed(2),
+    "SCD.parse (ops/s)": precompiledRate,
+    "bundle (KiB)": (precompiledBytes / 1024).toFixed(1),
+  },
+  ajv: {
+    "first parse (ms)": ajvFirst.toFixed(2),
+    "SCD.parse (ops/s)": ajvRate,
+    "bundle (KiB)": (ajvBytes / 1024).toFixed(1),
+  },
+});
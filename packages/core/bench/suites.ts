@@ -0,0 +1,86 @@
+import { readdirSync, readFileSync } from "node:fs";
+import { join, resolve } from "node:path";
+import { SmartC } from "smartc-signum-compiler";
+import { IncrementalValidator, SCD } from "../src/parser";
+import { SmartCGenerator } from "../src/generator";
+import { mockSCD } from "../src/generator/__tests/mock-scd";
+import { syntheticSCD } from "./fixtures";
+import type { BenchCase } from "./harness";
+
+const ExamplesDir = resolve(import.meta.dir, "../../../examples");
+
+const Large = { methods: 2000, variables: 2000, maps: 1000 };
+
+function compile(language: "C" | "Assembly", sourceCode: string) {
+  const compiler = new SmartC({ language, sourceCode });
+  compiler.compile();
+  return compiler;
+}
+
+function parserCases(): BenchCase[] {
+  const large = syntheticSCD(Large);
+  const largeJson = JSON.stringify(large);
+  const parsed = SCD.parse(large);
+  const validator = new IncrementalValidator(large);
+  let edited = false;
+  return [
+    { name: "SCD.parse snapshot fixture", fn: () => SCD.parse(mockSCD) },
+    { name: "SCD.parse large", fn: () => SCD.parse(large) },
+    {
+      name: "SCD.parse large from JSON",
+      fn: () => SCD.parse(JSON.parse(largeJson)),
+    },
+    { name: "getVariablesLayout large", fn: () => parsed.getVariablesLayout() },
+    {
+      name: "IncrementalValidator.update large",
+      fn: () =>
+        validator.update("/methods/0/code", (edited = !edited) ? "0" : "1"),
+    },
+  ];
+}
+
+function generatorCases(): BenchCase[] {
+  const small = new SmartCGenerator(SCD.parse(mockSCD));
+  const large = new SmartCGenerator(SCD.parse(syntheticSCD(Large)));
+  return [
+    {
+      name: "generateContract snapshot fixture",
+      fn: () => small.generateContract(),
+    },
+    { name: "generateContract large", fn: () => large.generateContract() },
+  ];
+}
+
+function compilerCases(): BenchCase[] {
+  return readdirSync(ExamplesDir)
+    .filter((file) => file.endsWith(".smart.c"))
+    .flatMap((file) => {
+      // the examples pin older compiler versions, which the current compiler refuses
+      const source = readFileSync(join(ExamplesDir, file), "utf8").replace(
+        /^#pragma version .*$/m,
+        "",
+      );
+      // compiled on the first (warm up) call, such that a broken example only fails its own cases
+      let assembly: string | undefined;
+      return [
+        { name: `compile examples/${file}`, fn: () => compile("C", source) },
+        {
+          name: `assemble examples/${file}`,
+          fn: () =>
+            compile(
+              "Assembly",
+              (assembly ??= compile("C", source).getAssemblyCode()),
+            ),
+        },
+      ];
+    });
+}
+
+/**
+ * All benchmark suites - created lazily, such that a failing setup only fails its suite
+ */
+export const Suites: Record<string, () => BenchCase[]> = {
+  parser: parserCases,
+  generator: generatorCases,
+  compiler: compilerCases,
+};
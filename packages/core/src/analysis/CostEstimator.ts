@@ -0,0 +1,271 @@
+import {
+  type DataType,
+  type MethodDefinition,
+  parseLong,
+  type SCD,
+} from "../parser";
+import {
+  AtMachine,
+  type AtMachineOptions,
+  type BlockResult,
+  type IncomingTransaction,
+  type MachineCode,
+} from "../vm";
+
+export interface ExecutionCost {
+  instructions: number;
+  /** Fee relevant steps, i.e. API calls are weighted */
+  steps: number;
+  apiCalls: number;
+  feeNQT: bigint;
+}
+
+export interface CostCurvePoint extends ExecutionCost {
+  x: number;
+}
+
+/**
+ * Cost as a function of a single parameter.
+ * `slope` and `intercept` are the least squares fit of `steps = slope * x + intercept`
+ */
+export interface CostCurve {
+  parameter: string;
+  points: CostCurvePoint[];
+  slope: number;
+  intercept: number;
+}
+
+export interface MethodCost {
+  name: string;
+  code: string;
+  min: ExecutionCost;
+  typical: ExecutionCost;
+  worst: ExecutionCost;
+  samples: number;
+  curves: CostCurve[];
+  errors: string[];
+}
+
+export interface CostReport {
+  /** Cost of a transaction which does not match any method - the baseline of every call */
+  dispatch: ExecutionCost;
+  methods: MethodCost[];
+}
+
+export interface CurveRequest {
+  /** Name shown for the parameter */
+  parameter: string;
+  values: number[];
+  /** Arguments of the call, may depend on the parameter value */
+  args?: (x: number) => bigint[];
+  /** Transactions executed before the call, e.g. to fill a list of n entries */
+  setup?: (x: number) => IncomingTransaction[];
+}
+
+export interface CostEstimatorOptions {
+  machine?: AtMachineOptions;
+  /** Sender of the synthetic messages - default: the contract creator */
+  sender?: bigint;
+  /** Transactions executed once before measuring, e.g. to set up state */
+  setup?: IncomingTransaction[];
+  /** Argument values tried per data type, the first is the typical one */
+  argumentSamples?: Partial<Record<DataType, bigint[]>>;
+  /** Argument values for the cost curves of numeric arguments */
+  curveValues?: number[];
+}
+
+const DefaultCreator = 1000n;
+const DefaultBalance = 1_000_000_0000_0000n;
+const DefaultCurveValues = [0, 1, 2, 4, 8, 16, 32, 64, 128];
+const DefaultSamples: Record<"long" | "amount" | "boolean", bigint[]> = {
+  long: [1n, 0n, 10n, 100n, 1000n],
+  amount: [1_0000_0000n, 0n, 100_0000_0000n],
+  boolean: [1n, 0n],
+};
+
+function toCost({
+  instructions,
+  steps,
+  apiCalls,
+  feeNQT,
+}: BlockResult): ExecutionCost {
+  return { instructions, steps, apiCalls, feeNQT };
+}
+
+function fitLinear(points: CostCurvePoint[]) {
+  const n = points.length;
+  const meanX = points.reduce((s, p) => s + p.x, 0) / n;
+  const meanY = points.reduce((s, p) => s + p.steps, 0) / n;
+  let numerator = 0;
+  let denominator = 0;
+  for (const p of points) {
+    numerator += (p.x - meanX) * (p.steps - meanY);
+    denominator += (p.x - meanX) ** 2;
+  }
+  const slope = denominator ? numerator / denominator : 0;
+  return { slope, intercept: meanY - slope * meanX };
+}
+
+/**
+ * Estimates the execution costs of the SCD methods by driving synthetic messages through the AT emulator.
+ *
+ * Every method is called with the typical argument values and with each argument varied on its own.
+ * Numeric arguments which change the costs, e.g. the number of loop iterations, get a cost curve.
+ * Costs depending on the contract state can be measured with `estimateCurve` and a setup per parameter value.
+ */
+export class CostEstimator {
+  private readonly sender: bigint;
+  private readonly activationAmount: bigint;
+  private base: AtMachine | null = null;
+
+  constructor(
+    private readonly scd: SCD,
+    private readonly machineCode: MachineCode,
+    private readonly options: CostEstimatorOptions = {},
+  ) {
+    this.sender = options.sender ?? options.machine?.creator ?? DefaultCreator;
+    this.activationAmount = parseLong(scd.getContractInfo().activationAmount);
+  }
+
+  estimate(): CostReport {
+    return {
+      dispatch: toCost(this.call(this.getBase(), [0n])),
+      methods: this.scd.getMethods().map((m) => this.estimateMethod(m)),
+    };
+  }
+
+  estimateMethod(method: MethodDefinition): MethodCost {
+    const variants = this.argumentVariants(method);
+    const errors = new Set<string>();
+    const costs: ExecutionCost[] = [];
+    for (const args of variants) {
+      const result = this.callMethod(this.getBase(), method, args);
+      if (result.error) errors.add(result.error);
+      costs.push(toCost(result));
+    }
+
+    const curves: CostCurve[] = [];
+    const typicalArgs = variants[0];
+    method.args.forEach((arg, index) => {
+      if (arg.type !== "long" && arg.type !== "amount") return;
+      const curve = this.estimateCurve(method, {
+        parameter: arg.name,
+        values: this.options.curveValues ?? DefaultCurveValues,
+        args: (x) => typicalArgs.map((a, i) => (i === index ? BigInt(x) : a)),
+      });
+      if (curve.points.some((p) => p.steps !== curve.points[0].steps)) {
+        curves.push(curve);
+      }
+    });
+
+    const bySteps = [...costs].sort((a, b) => a.steps - b.steps);
+    return {
+      name: method.name,
+      code: method.code,
+      min: bySteps[0],
+      typical: costs[0],
+      worst: bySteps[bySteps.length - 1],
+      samples: costs.length,
+      curves,
+      errors: [...errors],
+    };
+  }
+
+  /**
+   * Measures the costs of a method over a range of parameter values
+   */
+  estimateCurve(
+    method: MethodDefinition | string,
+    { parameter, values, args, setup }: CurveRequest,
+  ): CostCurve {
+    const definition =
+      typeof method === "string"
+        ? this.scd.getMethods().find((m) => m.name === method)
+        : method;
+    if (!definition) {
+      throw new Error(`Unknown method: ${method}`);
+    }
+
+    const points = values.map((x) => {
+      let machine = this.getBase();
+      if (setup) {
+        machine = machine.clone();
+        machine.replay(setup(x));
+      }
+      const callArgs = args?.(x) ?? this.argumentVariants(definition)[0];
+      return { x, ...toCost(this.callMethod(machine, definition, callArgs)) };
+    });
+    return { parameter, points, ...fitLinear(points) };
+  }
+
+  private argumentVariants(method: MethodDefinition) {
+    const samples = method.args.map((arg) => this.samplesFor(arg.type));
+    const typical = samples.map((s) => s[0]);
+    const variants = [typical];
+    samples.forEach((values, index) => {
+      for (const value of values.slice(1)) {
+        variants.push(typical.map((t, i) => (i === index ? value : t)));
+      }
+    });
+    return variants;
+  }
+
+  private samplesFor(type: DataType): bigint[] {
+    const custom = this.options.argumentSamples?.[type];
+    if (custom?.length) return custom;
+    switch (type) {
+      case "amount":
+      case "boolean":
+        return DefaultSamples[type];
+      case "address":
+        return [this.sender, 0n, this.sender + 1n];
+      case "txId":
+        return [1n, 0n];
+      default:
+        return DefaultSamples.long;
+    }
+  }
+
+  private callMethod(
+    machine: AtMachine,
+    method: MethodDefinition,
+    args: bigint[],
+  ) {
+    return this.call(machine, [parseLong(method.code), ...args]);
+  }
+
+  private call(machine: AtMachine, message: bigint[]) {
+    const instance = machine.clone();
+    instance.queueTransaction({
+      sender: this.sender,
+      amount: this.activationAmount,
+      message,
+    });
+    return instance.runBlock();
+  }
+
+  /**
+   * Machine after the initial activation (and setup) - all measurements start from a clone of it
+   */
+  private getBase() {
+    if (!this.base) {
+      const machine = new AtMachine(this.machineCode, {
+        creator: this.sender,
+        balance: DefaultBalance,
+        activationAmount: this.activationAmount,
+        ...this.options.machine,
+      });
+      machine.queueTransaction({
+        sender: this.sender,
+        amount: this.activationAmount,
+        message: [0n],
+      });
+      machine.runBlock();
+      if (this.options.setup?.length) {
+        machine.replay(this.options.setup);
+      }
+      this.base = machine;
+    }
+    return this.base;
+  }
+}
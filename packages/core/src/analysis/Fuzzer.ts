@@ -0,0 +1,540 @@
+import {
+  type DataType,
+  type MethodDefinition,
+  parseLong,
+  type SCD,
+} from "../parser";
+import {
+  AtMachine,
+  type AtMachineOptions,
+  type BlockResult,
+  disassemble,
+  type IncomingTransaction,
+  isBranch,
+  type MachineCode,
+} from "../vm";
+
+export interface FuzzerOptions {
+  machine?: AtMachineOptions;
+  /** Senders of the calls - default: the creator and two other accounts */
+  senders?: bigint[];
+  /** Transactions executed once before fuzzing, e.g. to set up state */
+  setup?: IncomingTransaction[];
+  /** Seed of the random generator - runs with the same seed find the same traces */
+  seed?: number;
+  /** Maximum calls per trace - default: 16 */
+  maxCalls?: number;
+  /** Values tried per data type, in addition to the built-in ones */
+  argumentSamples?: Partial<Record<DataType, bigint[]>>;
+}
+
+export interface FuzzCoverage {
+  /** Addresses of the executed instructions */
+  instructions: number[];
+  totalInstructions: number;
+  /** Covered branch outcomes, `2 * branch + (taken ? 1 : 0)` */
+  branchOutcomes: number[];
+  totalBranchOutcomes: number;
+}
+
+export interface FuzzCase {
+  method: string;
+  /** Of the worst call, which is the last transaction of the trace */
+  steps: number;
+  instructions: number;
+  feeNQT: bigint;
+  trace: IncomingTransaction[];
+}
+
+export interface FuzzError {
+  error: string;
+  method: string;
+  /** The last transaction raises the error */
+  trace: IncomingTransaction[];
+}
+
+export interface FuzzReport {
+  iterations: number;
+  /** Traces kept for finding new coverage or a new worst case */
+  corpus: number;
+  coverage: FuzzCoverage;
+  /** Worst case per method by the steps of a single call, in SCD order */
+  worst: FuzzCase[];
+  errors: FuzzError[];
+}
+
+interface Call {
+  method: number;
+  sender: bigint;
+  amount: bigint;
+  /** Message behind the method code: the arguments, an array argument takes the remaining longs */
+  values: bigint[];
+}
+
+interface Worst {
+  steps: number;
+  instructions: number;
+  feeNQT: bigint;
+  calls: Call[];
+}
+
+const DefaultCreator = 1000n;
+const DefaultBalance = 1_000_000_0000_0000n;
+// a call running into the limit is reported as error, a lower limit keeps the iterations fast
+const DefaultMaxStepsPerBlock = 100_000;
+const DefaultMaxCalls = 16;
+const MaxMessageLongs = 125;
+const ArrayLengths = [0, 1, 2, 3, 4, 5, 8, 16, 31, 32, 33, 64, 124];
+const MinLong = -(2n ** 63n);
+const MaxLong = 2n ** 63n - 1n;
+
+const Samples: Record<"long" | "amount" | "boolean" | "string", bigint[]> = {
+  long: [0n, 1n, 2n, 3n, 4n, 7n, 8n, 16n, 32n, 64n, 100n, 255n, 1000n, -1n],
+  amount: [0n, 1n, 1_0000_0000n, 100_0000_0000n, 1_000_000_0000_0000n],
+  boolean: [0n, 1n, 2n],
+  string: [0n, 0x41n, 0x4847464544434241n],
+};
+
+/** Deterministic pseudo random numbers (mulberry32) */
+function random(seed: number) {
+  let state = seed >>> 0;
+  return () => {
+    state = (state + 0x6d2b79f5) >>> 0;
+    let t = state;
+    t = Math.imul(t ^ (t >>> 15), t | 1);
+    t ^= t + Math.imul(t ^ (t >>> 7), t | 61);
+    return ((t ^ (t >>> 14)) >>> 0) / 4294967296;
+  };
+}
+
+const isArray = (type: DataType) => type.endsWith("[]");
+
+const toWorst = (block: BlockResult, calls: Call[]): Worst => ({
+  steps: block.steps,
+  instructions: block.instructions,
+  feeNQT: block.feeNQT,
+  calls,
+});
+
+/**
+ * Searches transaction sequences for the most expensive calls, e.g. loops over state built up by
+ * earlier calls or over array arguments. Guided by coverage: sequences executing new instructions
+ * or branch outcomes are kept and mutated further, as well as the worst sequence per method.
+ *
+ * ```ts
+ * const report = new Fuzzer(scd, machineData, { seed: 1 }).run(10_000);
+ * const traces = report.worst.map((w) => stringifyTrace(w.trace));
+ * ```
+ *
+ * Runs are deterministic per seed, parallel runs with different seeds are combined with `mergeFuzzReports`.
+ */
+export class Fuzzer {
+  private readonly methods: Readonly<MethodDefinition[]>;
+  private readonly senders: bigint[];
+  private readonly activationAmount: bigint;
+  private readonly maxCalls: number;
+  private readonly next: () => number;
+  private readonly branches: { taken: number; notTaken: number }[] = [];
+  private readonly instructionOffsets: number[] = [];
+  private readonly coveredInstructions: Uint8Array;
+  private readonly coveredOutcomes: Uint8Array;
+  private readonly corpus: Call[][] = [];
+  private readonly worst: (Worst | undefined)[];
+  private readonly errors = new Map<string, FuzzError>();
+  private base: AtMachine | null = null;
+  private firstTxId = 0n;
+  private iterations = 0;
+
+  constructor(
+    scd: SCD,
+    private readonly machineCode: MachineCode,
+    private readonly options: FuzzerOptions = {},
+  ) {
+    this.methods = scd.getMethods();
+    const creator = options.machine?.creator ?? DefaultCreator;
+    this.senders = options.senders ?? [creator, creator + 1n, creator + 2n];
+    this.activationAmount = parseLong(scd.getContractInfo().activationAmount);
+    this.maxCalls = options.maxCalls ?? DefaultMaxCalls;
+    this.next = random(options.seed ?? 1);
+    this.worst = this.methods.map(() => undefined);
+
+    const disassembly = disassemble(machineCode.ByteCode);
+    for (const { offset, info, operands } of disassembly.instructions) {
+      this.instructionOffsets.push(offset);
+      if (isBranch(info.code)) {
+        this.branches.push({
+          taken: operands[operands.length - 1] as number,
+          notTaken: offset + info.size,
+        });
+      }
+    }
+    this.coveredInstructions = new Uint8Array(disassembly.size);
+    this.coveredOutcomes = new Uint8Array(this.branches.length * 2);
+  }
+
+  /**
+   * Runs the given number of sequences, continuing a previous run
+   */
+  run(iterations: number): FuzzReport {
+    if (!this.methods.length) return this.report();
+    if (!this.corpus.length) {
+      this.methods.forEach((_, index) =>
+        this.evaluate([this.randomCall(index)]),
+      );
+    }
+    for (let i = 0; i < iterations; i++) {
+      this.evaluate(this.mutate(this.pick()));
+    }
+    return this.report();
+  }
+
+  /**
+   * Removes the calls, which are not needed to reach the steps of the last call
+   */
+  private minimize(calls: Call[]): Call[] {
+    const target = this.execute(calls).at(-1)!.steps;
+    let minimal = calls;
+    for (let i = minimal.length - 2; i >= 0; i--) {
+      const candidate = minimal.filter((_, index) => index !== i);
+      if (this.execute(candidate).at(-1)!.steps >= target) {
+        minimal = candidate;
+      }
+    }
+    return minimal;
+  }
+
+  report(): FuzzReport {
+    return {
+      iterations: this.iterations,
+      corpus: this.corpus.length,
+      coverage: {
+        instructions: this.instructionOffsets.filter(
+          (offset) => this.coveredInstructions[offset],
+        ),
+        totalInstructions: this.instructionOffsets.length,
+        branchOutcomes: [...this.coveredOutcomes.keys()].filter(
+          (outcome) => this.coveredOutcomes[outcome],
+        ),
+        totalBranchOutcomes: this.coveredOutcomes.length,
+      },
+      worst: this.worst.flatMap((worst, index) => {
+        if (!worst) return [];
+        const calls = this.minimize(worst.calls);
+        return [
+          {
+            method: this.methods[index]!.name,
+            steps: worst.steps,
+            instructions: worst.instructions,
+            feeNQT: worst.feeNQT,
+            trace: calls.map((call) => this.toTransaction(call)),
+          },
+        ];
+      }),
+      errors: [...this.errors.values()],
+    };
+  }
+
+  private evaluate(calls: Call[]) {
+    this.iterations++;
+    const machine = this.getBase().clone();
+    const counts = machine.enableProfiling();
+    const results = calls.map((call) => {
+      machine.queueTransaction(this.toTransaction(call));
+      return machine.runBlock();
+    });
+
+    let interesting = this.cover(counts);
+    results.forEach((block, i) => {
+      const method = calls[i]!.method;
+      const worst = this.worst[method];
+      if (!worst || block.steps > worst.steps) {
+        this.worst[method] = toWorst(block, calls.slice(0, i + 1));
+        interesting = true;
+      }
+      if (block.error && !this.errors.has(block.error)) {
+        this.errors.set(block.error, {
+          error: block.error,
+          method: this.methods[method]!.name,
+          trace: calls.slice(0, i + 1).map((call) => this.toTransaction(call)),
+        });
+      }
+    });
+    if (interesting) this.corpus.push(calls);
+  }
+
+  /**
+   * Marks the executed instructions and branch outcomes as covered
+   * @return true, if any of them was not covered yet
+   */
+  private cover(counts: Uint32Array) {
+    let covered = false;
+    for (const offset of this.instructionOffsets) {
+      if (counts[offset] && !this.coveredInstructions[offset]) {
+        this.coveredInstructions[offset] = 1;
+        covered = true;
+      }
+    }
+    this.branches.forEach(({ taken, notTaken }, i) => {
+      for (const [outcome, offset] of [
+        [i * 2 + 1, taken],
+        [i * 2, notTaken],
+      ] as const) {
+        if (counts[offset] && !this.coveredOutcomes[outcome]) {
+          this.coveredOutcomes[outcome] = 1;
+          covered = true;
+        }
+      }
+    });
+    return covered;
+  }
+
+  private execute(calls: Call[]) {
+    const machine = this.getBase().clone();
+    return calls.map((call) => {
+      machine.queueTransaction(this.toTransaction(call));
+      return machine.runBlock();
+    });
+  }
+
+  /** Worst cases are picked as often as the rest of the corpus */
+  private pick(): Call[] {
+    const worst = this.worst.filter((w) => w !== undefined);
+    if (worst.length && this.next() < 0.5) {
+      return worst[this.int(worst.length)]!.calls;
+    }
+    return this.corpus[this.int(this.corpus.length)]!;
+  }
+
+  private mutate(calls: Call[]): Call[] {
+    const mutated = calls.map((call) => ({
+      ...call,
+      values: [...call.values],
+    }));
+    const index = this.int(mutated.length);
+    const call = mutated[index]!;
+    switch (this.int(7)) {
+      case 0:
+        if (mutated.length < this.maxCalls) {
+          mutated.splice(this.int(mutated.length + 1), 0, this.randomCall());
+        }
+        break;
+      case 1:
+        if (mutated.length > 1) mutated.splice(index, 1);
+        break;
+      case 2: {
+        // repeated calls build up state, e.g. the entries a later call loops over
+        const room = this.maxCalls - mutated.length;
+        if (room > 0) {
+          const copies = 1 + this.int(Math.min(8, room));
+          mutated.splice(index, 0, ...Array(copies).fill(call));
+        }
+        break;
+      }
+      case 3:
+        call.sender = this.choose(this.senders);
+        call.amount = this.choose([
+          this.activationAmount,
+          this.activationAmount * 2n,
+          this.activationAmount + 1_0000_0000n,
+        ]);
+        break;
+      case 4: {
+        const array = this.arrayArgument(call.method);
+        if (array) {
+          const scalars = this.methods[call.method]!.args.length - 1;
+          call.values.length = scalars;
+          for (let i = this.choose(ArrayLengths); i > 0; i--) {
+            if (call.values.length >= MaxMessageLongs - 1) break;
+            call.values.push(this.sample(array));
+          }
+          break;
+        }
+        call.values = this.randomValues(call.method);
+        break;
+      }
+      default:
+        if (call.values.length) {
+          const i = this.int(call.values.length);
+          call.values[i] = this.tweak(call.values[i]!, this.typeOf(call, i));
+        } else {
+          mutated[index] = this.randomCall();
+        }
+    }
+    return mutated;
+  }
+
+  private tweak(value: bigint, type: DataType): bigint {
+    switch (this.int(6)) {
+      case 0:
+        return BigInt.asIntN(64, value + 1n);
+      case 1:
+        return BigInt.asIntN(64, value - 1n);
+      case 2:
+        return BigInt.asIntN(64, value * 2n);
+      case 3:
+        return BigInt.asIntN(64, value ^ (1n << BigInt(this.int(64))));
+      case 4:
+        return this.choose([0n, MinLong, MaxLong]);
+      default:
+        return this.sample(type);
+    }
+  }
+
+  private randomCall(method = this.int(this.methods.length)): Call {
+    return {
+      method,
+      sender: this.senders[0]!,
+      amount: this.activationAmount,
+      values: this.randomValues(method),
+    };
+  }
+
+  private randomValues(method: number) {
+    const values: bigint[] = [];
+    for (const { type } of this.methods[method]!.args) {
+      if (isArray(type)) {
+        const elementType = type.slice(0, -2) as DataType;
+        for (let i = this.choose(ArrayLengths); i > 0; i--) {
+          if (values.length >= MaxMessageLongs - 1) break;
+          values.push(this.sample(elementType));
+        }
+        break;
+      }
+      values.push(this.sample(type));
+    }
+    return values;
+  }
+
+  private arrayArgument(method: number) {
+    const last = this.methods[method]!.args.at(-1);
+    return last && isArray(last.type)
+      ? (last.type.slice(0, -2) as DataType)
+      : undefined;
+  }
+
+  private typeOf(call: Call, index: number): DataType {
+    const args = this.methods[call.method]!.args;
+    const type = args[Math.min(index, args.length - 1)]?.type ?? "long";
+    return isArray(type) ? (type.slice(0, -2) as DataType) : type;
+  }
+
+  private sample(type: DataType): bigint {
+    const custom = this.options.argumentSamples?.[type] ?? [];
+    const samples = ((): bigint[] => {
+      switch (type) {
+        case "address":
+          return [...this.senders, 0n, this.options.machine?.contractId ?? 1n];
+        case "txId":
+          // the ids of the earlier calls, assigned in order by the machine
+          return [
+            0n,
+            ...Array.from(
+              { length: this.maxCalls },
+              (_, i) => this.firstTxId + BigInt(i),
+            ),
+          ];
+        case "amount":
+        case "boolean":
+        case "string":
+          return Samples[type];
+        default:
+          return Samples.long;
+      }
+    })();
+    return this.choose(custom.length && this.next() < 0.5 ? custom : samples);
+  }
+
+  private toTransaction(call: Call): IncomingTransaction {
+    const code = parseLong(this.methods[call.method]!.code);
+    return {
+      sender: call.sender,
+      amount: call.amount,
+      message: [code, ...call.values],
+    };
+  }
+
+  private int(max: number) {
+    return Math.floor(this.next() * max);
+  }
+
+  private choose<T>(values: readonly T[]): T {
+    return values[this.int(values.length)]!;
+  }
+
+  /**
+   * Machine after the initial activation (and setup) - every sequence starts from a clone of it
+   */
+  private getBase() {
+    if (!this.base) {
+      const creator = this.options.machine?.creator ?? DefaultCreator;
+      const machine = new AtMachine(this.machineCode, {
+        creator,
+        balance: DefaultBalance,
+        activationAmount: this.activationAmount,
+        maxStepsPerBlock: DefaultMaxStepsPerBlock,
+        ...this.options.machine,
+      });
+      // the code run on creation counts as covered
+      const counts = machine.enableProfiling();
+      machine.queueTransaction({
+        sender: creator,
+        amount: this.activationAmount,
+        message: [0n],
+      });
+      machine.runBlock();
+      if (this.options.setup?.length) {
+        machine.replay(this.options.setup);
+      }
+      this.cover(counts);
+      this.firstTxId = machine.clone().queueTransaction({ sender: creator });
+      this.base = machine;
+    }
+    return this.base;
+  }
+}
+
+/**
+ * Combines the reports of parallel runs, e.g. with different seeds per worker
+ */
+export function mergeFuzzReports(reports: FuzzReport[]): FuzzReport {
+  const union = (lists: number[][]) =>
+    [...new Set(lists.flat())].sort((a, b) => a - b);
+  const worst = new Map<string, FuzzCase>();
+  const errors = new Map<string, FuzzError>();
+  for (const report of reports) {
+    for (const fuzzCase of report.worst) {
+      const current = worst.get(fuzzCase.method);
+      if (
+        !current ||
+        fuzzCase.steps > current.steps ||
+        (fuzzCase.steps === current.steps &&
+          fuzzCase.trace.length < current.trace.length)
+      ) {
+        worst.set(fuzzCase.method, fuzzCase);
+      }
+    }
+    for (const error of report.errors) {
+      const current = errors.get(error.error);
+      if (!current || error.trace.length < current.trace.length) {
+        errors.set(error.error, error);
+      }
+    }
+  }
+  const [first] = reports;
+  // keeps the method order of the reports
+  const methods = [
+    ...new Set(reports.flatMap((r) => r.worst.map((w) => w.method))),
+  ];
+  return {
+    iterations: reports.reduce((sum, r) => sum + r.iterations, 0),
+    corpus: reports.reduce((sum, r) => sum + r.corpus, 0),
+    coverage: {
+      instructions: union(reports.map((r) => r.coverage.instructions)),
+      totalInstructions: first?.coverage.totalInstructions ?? 0,
+      branchOutcomes: union(reports.map((r) => r.coverage.branchOutcomes)),
+      totalBranchOutcomes: first?.coverage.totalBranchOutcomes ?? 0,
+    },
+    worst: methods.map((method) => worst.get(method)!),
+    errors: [...errors.values()],
+  };
+}
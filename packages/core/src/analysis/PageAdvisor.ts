@@ -0,0 +1,181 @@
+import {
+  AtMachine,
+  type AtMachineOptions,
+  DefaultFeeSchedule,
+  disassemble,
+  type FeeSchedule,
+  type IncomingTransaction,
+  LongsPerPage,
+  type MachineCode,
+  OpCode,
+  type ReplayResult,
+} from "../vm";
+
+const BytesPerPage = LongsPerPage * 8;
+// stack pages of the machine measuring the stack depths - the maximum SmartC accepts
+const MeasuringStackPages = 10;
+const DefaultBalance = 1_000_000_0000_0000n;
+
+export interface PageCounts {
+  code: number;
+  data: number;
+  codeStack: number;
+  userStack: number;
+  total: number;
+}
+
+export interface DeploymentCost {
+  pages: PageCounts;
+  feeNQT: bigint;
+}
+
+export interface StackPages {
+  codeStackPages: number;
+  userStackPages: number;
+}
+
+export interface PageAdvice {
+  current: DeploymentCost;
+  recommended: DeploymentCost;
+  savedNQT: bigint;
+  /** Recommended pragmas, i.e. `#pragma codeStackPages` and `#pragma userStackPages` */
+  pragmas: StackPages;
+  /** Maximum stack depths reached by the traces, in entries (longs) */
+  maxDepth: { codeStack: number; userStack: number };
+  /** Stacks not used by the code at all, i.e. no `JSR` resp. `PSH` - need no pages regardless of the traces */
+  unused: { codeStack: boolean; userStack: boolean };
+  /** Stacks the code uses, but no trace reached - they get a single page, which may not suffice */
+  uncovered: { codeStack: boolean; userStack: boolean };
+  /** e.g. about the uncovered stacks */
+  warnings: string[];
+  traces: number;
+  errors: ReplayResult["errors"];
+}
+
+export interface PageAdvisorOptions {
+  machine?: AtMachineOptions;
+  /** Number of trace transactions put into one block - default: 1 */
+  transactionsPerBlock?: number;
+  /** Pages added to every used stack on top of the measured need - default: 0 */
+  headroomPages?: number;
+}
+
+/**
+ * Counts the pages of the machine code, optionally with other stack sizes
+ */
+export function countPages(
+  machineCode: MachineCode,
+  stacks: Partial<StackPages> = {},
+): PageCounts {
+  const code =
+    machineCode.CodePages ??
+    Math.ceil(machineCode.ByteCode.length / 2 / BytesPerPage);
+  const data = machineCode.DataPages;
+  const codeStack = stacks.codeStackPages ?? machineCode.CodeStackPages;
+  const userStack = stacks.userStackPages ?? machineCode.UserStackPages;
+  return {
+    code,
+    data,
+    codeStack,
+    userStack,
+    total: code + data + codeStack + userStack,
+  };
+}
+
+/**
+ * Deployment fee of the machine code - every page (code, data and stacks) costs the same
+ */
+export function deploymentCost(
+  machineCode: MachineCode,
+  stacks: Partial<StackPages> = {},
+  fees: FeeSchedule = DefaultFeeSchedule,
+): DeploymentCost {
+  const pages = countPages(machineCode, stacks);
+  return { pages, feeNQT: BigInt(pages.total) * fees.pageFeeNQT };
+}
+
+/**
+ * Recommends the smallest code and user stack sizes, which are sufficient for the given traces.
+ *
+ * Every trace is replayed on a fresh machine with large stacks, recording the deepest stack use.
+ * The recommendation is only as good as the traces, so they should cover the deepest call paths,
+ * e.g. the recursive or most nested methods. Stacks the code never uses get no pages at all, a used
+ * stack at least one page - also if no trace reached it, which is reported in the warnings.
+ *
+ * ```ts
+ * const advice = advisePages(machineData, [parseTrace(json)]);
+ * const optimized = scd.withPragmas(advice.pragmas);
+ * ```
+ */
+export function advisePages(
+  machineCode: MachineCode,
+  traces: IncomingTransaction[][],
+  options: PageAdvisorOptions = {},
+): PageAdvice {
+  const fees = options.machine?.fees ?? DefaultFeeSchedule;
+  const headroom = options.headroomPages ?? 0;
+
+  const instructions = disassemble(machineCode.ByteCode).instructions;
+  const unused = {
+    codeStack: !instructions.some((i) => i.info.code === OpCode.JMP_SUB),
+    userStack: !instructions.some((i) => i.info.code === OpCode.PSH_DAT),
+  };
+
+  const measuring: MachineCode = {
+    ...machineCode,
+    CodeStackPages: Math.max(machineCode.CodeStackPages, MeasuringStackPages),
+    UserStackPages: Math.max(machineCode.UserStackPages, MeasuringStackPages),
+  };
+  const maxDepth = { codeStack: 0, userStack: 0 };
+  const errors: ReplayResult["errors"] = [];
+  for (const trace of traces) {
+    const machine = new AtMachine(measuring, {
+      balance: DefaultBalance,
+      ...options.machine,
+    });
+    const result = machine.replay(trace, {
+      transactionsPerBlock: options.transactionsPerBlock,
+    });
+    errors.push(...result.errors);
+    maxDepth.codeStack = Math.max(maxDepth.codeStack, machine.stackUsage.codeStack);
+    maxDepth.userStack = Math.max(maxDepth.userStack, machine.stackUsage.userStack);
+  }
+
+  const uncovered = {
+    codeStack: !unused.codeStack && maxDepth.codeStack === 0,
+    userStack: !unused.userStack && maxDepth.userStack === 0,
+  };
+  const warnings: string[] = [];
+  if (uncovered.codeStack) {
+    warnings.push(
+      "The code calls subroutines (JSR), but no trace did - the code stack size is a guess",
+    );
+  }
+  if (uncovered.userStack) {
+    warnings.push(
+      "The code pushes values (PSH), but no trace did - the user stack size is a guess",
+    );
+  }
+
+  const pagesFor = (depth: number, isUnused: boolean) =>
+    isUnused ? 0 : Math.max(1, Math.ceil(depth / LongsPerPage)) + headroom;
+  const pragmas: StackPages = {
+    codeStackPages: pagesFor(maxDepth.codeStack, unused.codeStack),
+    userStackPages: pagesFor(maxDepth.userStack, unused.userStack),
+  };
+
+  const current = deploymentCost(machineCode, {}, fees);
+  const recommended = deploymentCost(machineCode, pragmas, fees);
+  return {
+    current,
+    recommended,
+    savedNQT: current.feeNQT - recommended.feeNQT,
+    pragmas,
+    maxDepth,
+    unused,
+    uncovered,
+    warnings,
+    traces: traces.length,
+    errors,
+  };
+}
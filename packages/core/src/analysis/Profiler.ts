@@ -0,0 +1,219 @@
+import {
+  AtMachine,
+  type AtMachineOptions,
+  type FeeSchedule,
+  type IncomingTransaction,
+  isApiCall,
+  type MachineCode,
+  type ReplayResult,
+} from "../vm";
+import { parseLong } from "../parser";
+import { mapToSource, type SourceMap } from "./SourceMap";
+
+export interface ProfileEntry {
+  instructions: number;
+  /** Fee relevant steps, i.e. API calls are weighted */
+  steps: number;
+  feeNQT: bigint;
+  /** Share of the total steps, 0..1 */
+  share: number;
+}
+
+export interface LineProfile extends ProfileEntry {
+  /** 1-based line in the SmartC source */
+  line: number;
+}
+
+export interface FunctionProfile extends ProfileEntry {
+  name: string;
+}
+
+export interface ExecutionProfile {
+  total: ProfileEntry;
+  /** Hottest first */
+  lines: LineProfile[];
+  /** Hottest first */
+  functions: FunctionProfile[];
+  blocks: number;
+  transactions: number;
+  errors: ReplayResult["errors"];
+}
+
+export interface ProfilerOptions {
+  machine?: AtMachineOptions;
+  /** Number of trace transactions put into one block - default: 1 */
+  transactionsPerBlock?: number;
+}
+
+const DefaultBalance = 1_000_000_0000_0000n;
+
+function toEntry(
+  instructions: number,
+  steps: number,
+  totalSteps: number,
+  fees: FeeSchedule,
+): ProfileEntry {
+  return {
+    instructions,
+    steps,
+    feeNQT: BigInt(steps) * fees.stepFeeNQT,
+    share: totalSteps ? steps / totalSteps : 0,
+  };
+}
+
+/**
+ * Executes a transaction trace on the emulator and attributes the executed instructions and fees
+ * to the SmartC source lines and functions.
+ *
+ * ```ts
+ * const profiler = new Profiler(machineData, assemblyCode);
+ * const { lines, functions } = profiler.profile(transactions);
+ * ```
+ */
+export class Profiler {
+  readonly sourceMap: SourceMap;
+
+  constructor(
+    private readonly machineCode: MachineCode,
+    assembly: string,
+    private readonly options: ProfilerOptions = {},
+  ) {
+    this.sourceMap = mapToSource(assembly, machineCode.ByteCode);
+  }
+
+  /**
+   * True, if the assembly carries source line information
+   */
+  get hasSourceLines() {
+    return this.sourceMap.lines.some((line) => line > 0);
+  }
+
+  profile(trace: IncomingTransaction[]): ExecutionProfile {
+    const machine = new AtMachine(this.machineCode, {
+      balance: DefaultBalance,
+      ...this.options.machine,
+    });
+    const counts = machine.enableProfiling();
+    const result = machine.replay(trace, {
+      transactionsPerBlock: this.options.transactionsPerBlock,
+    });
+    return {
+      ...this.summarize(counts, machine.fees),
+      blocks: result.blocks,
+      transactions: result.transactions,
+      errors: result.errors,
+    };
+  }
+
+  /**
+   * Aggregates instruction counts per code address, as collected by `AtMachine.enableProfiling`
+   */
+  summarize(counts: Uint32Array, fees: FeeSchedule) {
+    const { lines, functionIndex, functions, disassembly } = this.sourceMap;
+    const lineTotals = new Map<number, [instructions: number, steps: number]>();
+    const functionTotals = functions.map(() => [0, 0]);
+    let totalInstructions = 0;
+    let totalSteps = 0;
+
+    for (let pc = 0; pc < counts.length; pc++) {
+      const count = counts[pc];
+      if (!count) continue;
+      const op = disassembly.at(pc)?.info.code ?? 0;
+      const steps = isApiCall(op) ? count * fees.apiStepMultiplier : count;
+      totalInstructions += count;
+      totalSteps += steps;
+
+      const fnTotals = functionTotals[functionIndex[pc]];
+      fnTotals[0] += count;
+      fnTotals[1] += steps;
+      if (lines[pc]) {
+        const lineTotal = lineTotals.get(lines[pc]) ?? [0, 0];
+        lineTotal[0] += count;
+        lineTotal[1] += steps;
+        lineTotals.set(lines[pc], lineTotal);
+      }
+    }
+
+    const bySteps = (a: ProfileEntry, b: ProfileEntry) => b.steps - a.steps;
+    return {
+      total: toEntry(totalInstructions, totalSteps, totalSteps, fees),
+      lines: [...lineTotals]
+        .map(([line, [instructions, steps]]) => ({
+          line,
+          ...toEntry(instructions, steps, totalSteps, fees),
+        }))
+        .sort(bySteps),
+      functions: functionTotals
+        .map(([instructions, steps], i) => ({
+          name: functions[i],
+          ...toEntry(instructions, steps, totalSteps, fees),
+        }))
+        .filter((f) => f.instructions > 0)
+        .sort(bySteps),
+    };
+  }
+}
+
+type TraceValue = string | number;
+
+const traceLong = (value: TraceValue) =>
+  typeof value === "string" ? parseLong(value) : BigInt(value);
+
+interface TraceEntry {
+  sender: TraceValue;
+  amount?: TraceValue;
+  message?: TraceValue[];
+  /** Sends the same transaction multiple times */
+  repeat?: number;
+}
+
+/**
+ * Reads a transaction trace from JSON: an array of `{ sender, amount?, message?, repeat? }`,
+ * with the numbers as decimal strings, digits optionally grouped by underscores (or safe integers)
+ */
+export function parseTrace(json: string): IncomingTransaction[] {
+  const entries = JSON.parse(json);
+  if (!Array.isArray(entries)) {
+    throw new Error("Trace must be an array of transactions");
+  }
+  return (entries as TraceEntry[]).flatMap((entry, index) => {
+    if (entry?.sender === undefined) {
+      throw new Error(`Transaction #${index} has no sender`);
+    }
+    const tx: IncomingTransaction = {
+      sender: traceLong(entry.sender),
+      amount: traceLong(entry.amount ?? 0),
+      message: entry.message?.map(traceLong),
+    };
+    return Array.from({ length: entry.repeat ?? 1 }, () => tx);
+  });
+}
+
+const sameTransaction = (a: IncomingTransaction, b: IncomingTransaction) =>
+  a.sender === b.sender &&
+  (a.amount ?? 0n) === (b.amount ?? 0n) &&
+  (a.message ?? []).length === (b.message ?? []).length &&
+  (a.message ?? []).every((value, i) => value === b.message![i]);
+
+/**
+ * Writes a transaction trace as JSON, as read by `parseTrace` - consecutive equal transactions are
+ * written once with `repeat`
+ */
+export function stringifyTrace(transactions: IncomingTransaction[]) {
+  const entries: TraceEntry[] = [];
+  let previous: IncomingTransaction | undefined;
+  for (const tx of transactions) {
+    const last = entries.at(-1);
+    if (last && previous && sameTransaction(previous, tx)) {
+      last.repeat = (last.repeat ?? 1) + 1;
+      continue;
+    }
+    previous = tx;
+    entries.push({
+      sender: tx.sender.toString(),
+      amount: (tx.amount ?? 0n).toString(),
+      message: tx.message && [...tx.message].map((v) => v.toString()),
+    });
+  }
+  return JSON.stringify(entries, null, 2);
+}
@@ -0,0 +1,151 @@
+import { disassemble, type Disassembly, type Instruction } from "../vm";
+
+const GlobalScope = "(global)";
+const FunctionLabelPrefix = "__fn_";
+const SourceLineComment = /^\^comment\s+line\s+(\d+)/;
+
+interface AssemblyInstruction {
+  mnemonic: string;
+  /** 1-based line in the assembly */
+  asmLine: number;
+  line: number;
+  functionIndex: number;
+}
+
+function parseAssembly(assembly: string, functions: string[]) {
+  const instructions: AssemblyInstruction[] = [];
+  let line = 0;
+  let functionIndex = 0;
+  assembly.split("\n").forEach((raw, index) => {
+    const text = raw.trim();
+    if (!text) return;
+    if (text.startsWith("^")) {
+      const match = SourceLineComment.exec(text);
+      if (match) line = Number(match[1]);
+      return;
+    }
+    if (text.endsWith(":")) {
+      const label = text.slice(0, -1);
+      if (label.startsWith(FunctionLabelPrefix)) {
+        functions.push(label.slice(FunctionLabelPrefix.length));
+        functionIndex = functions.length - 1;
+      }
+      return;
+    }
+    instructions.push({
+      mnemonic: text.split(/\s+/)[0]!.toUpperCase(),
+      asmLine: index + 1,
+      line,
+      functionIndex,
+    });
+  });
+  return instructions;
+}
+
+function groupByLine(lines: Uint32Array, disassembly: Disassembly) {
+  const offsets = new Map<number, number[]>();
+  for (const { offset } of disassembly.instructions) {
+    const line = lines[offset]!;
+    if (!line) continue;
+    const group = offsets.get(line);
+    if (group) group.push(offset);
+    else offsets.set(line, [offset]);
+  }
+  return offsets;
+}
+
+/**
+ * Bidirectional relation of the code addresses to the assembly and SmartC source lines.
+ * All lines are 1-based, 0 (line) resp. "(global)" (function) where unknown.
+ */
+export class SourceMap {
+  private asmOffsets: Map<number, number[]> | null = null;
+  private sourceOffsets: Map<number, number[]> | null = null;
+
+  /**
+   * @param disassembly The decoded bytecode
+   * @param asmLines Assembly line per code address - set for all bytes of an instruction
+   * @param lines SmartC line per code address
+   * @param functionIndex Index into `functions` per code address
+   * @param functions Function names, the first one is the global scope
+   */
+  constructor(
+    readonly disassembly: Disassembly,
+    readonly asmLines: Uint32Array,
+    readonly lines: Uint32Array,
+    readonly functionIndex: Uint16Array,
+    readonly functions: string[],
+  ) {}
+
+  /**
+   * The instruction covering the code address together with its lines
+   */
+  at(offset: number):
+    | { instruction: Instruction; asmLine: number; line: number; function: string }
+    | undefined {
+    const instruction = this.disassembly.at(offset);
+    if (!instruction) return undefined;
+    return {
+      instruction,
+      asmLine: this.asmLines[offset]!,
+      line: this.lines[offset]!,
+      function: this.functions[this.functionIndex[offset]!]!,
+    };
+  }
+
+  /**
+   * Code addresses of the instructions assembled from the assembly line - more than one, if the
+   * assembler expanded it
+   */
+  offsetsOfAsmLine(asmLine: number): number[] {
+    this.asmOffsets ??= groupByLine(this.asmLines, this.disassembly);
+    return this.asmOffsets.get(asmLine) ?? [];
+  }
+
+  /**
+   * Code addresses of the instructions compiled from the SmartC line
+   */
+  offsetsOfSourceLine(line: number): number[] {
+    this.sourceOffsets ??= groupByLine(this.lines, this.disassembly);
+    return this.sourceOffsets.get(line) ?? [];
+  }
+}
+
+/**
+ * Maps the bytecode addresses to the assembly lines, and via the `^comment line` markers of the
+ * verbose assembly (`#pragma verboseAssembly`) to the SmartC source lines and - by the `__fn_` labels - functions.
+ *
+ * Bytecode and assembly are walked side by side. Instructions the assembler emits additionally,
+ * e.g. the jump of a branch which is out of range, are attributed to the preceding assembly line.
+ */
+export function mapToSource(
+  assembly: string,
+  byteCode: string | Uint8Array,
+): SourceMap {
+  const disassembly = disassemble(byteCode);
+  const functions = [GlobalScope];
+  const instructions = parseAssembly(assembly, functions);
+  const size = disassembly.size;
+  const asmLines = new Uint32Array(size);
+  const lines = new Uint32Array(size);
+  const functionIndex = new Uint16Array(size);
+
+  let cursor = 0;
+  for (const { offset, info } of disassembly.instructions) {
+    if (!instructions.length) break;
+
+    const mnemonic = info.mnemonic;
+    let current = instructions[Math.min(cursor, instructions.length - 1)]!;
+    if (cursor < instructions.length && current.mnemonic === mnemonic) {
+      cursor++;
+    } else if (instructions[cursor + 1]?.mnemonic === mnemonic) {
+      current = instructions[cursor + 1]!;
+      cursor += 2;
+    }
+    const end = offset + info.size;
+    asmLines.fill(current.asmLine, offset, end);
+    lines.fill(current.line, offset, end);
+    functionIndex.fill(current.functionIndex, offset, end);
+  }
+  return new SourceMap(disassembly, asmLines, lines, functionIndex, functions);
+}
@@ -0,0 +1,135 @@
+import { describe, expect, it } from "bun:test";
+import { CostEstimator } from "../CostEstimator";
+import { SCD } from "../../parser";
+import { ApiFunction as Fun, OpCode } from "../../vm";
+import { type Line, machineCode } from "../../vm/__tests/assemble";
+
+const Memory = ["counter", "tx", "code", "arg", "i", "acc", "one", "two"];
+const [counter, tx, code, arg, i, acc, one, two] = Memory.keys();
+
+// dispatches message[0] to `increment` (1) or `repeat` (2), which loops message[1] times
+const Contract: Line[] = [
+  [OpCode.SET_VAL, one, 1n],
+  [OpCode.SET_VAL, two, 2n],
+  [OpCode.SET_PCS],
+  "loop:",
+  [OpCode.EXT_FUN_DAT, Fun.A_to_Tx_after_Timestamp, counter],
+  [OpCode.EXT_FUN_RET, Fun.get_A1, tx],
+  [OpCode.BZR_DAT, tx, "end"],
+  [OpCode.EXT_FUN_RET, Fun.get_Timestamp_for_Tx_in_A, counter],
+  [OpCode.EXT_FUN, Fun.message_from_Tx_in_A_to_B],
+  [OpCode.EXT_FUN_RET, Fun.get_B1, code],
+  [OpCode.EXT_FUN_RET, Fun.get_B2, arg],
+  [OpCode.BNE_DAT, code, one, "notOne"],
+  [OpCode.JMP_SUB, "increment"],
+  "notOne:",
+  [OpCode.BNE_DAT, code, two, "next"],
+  [OpCode.JMP_SUB, "repeat"],
+  "next:",
+  [OpCode.JMP_ADR, "loop"],
+  "end:",
+  [OpCode.FIN_IMD],
+  "increment:",
+  [OpCode.INC_DAT, acc],
+  [OpCode.RET_SUB],
+  "repeat:",
+  [OpCode.CLR_DAT, i],
+  "repeatLoop:",
+  [OpCode.BGE_DAT, i, arg, "repeatEnd"],
+  [OpCode.INC_DAT, acc],
+  [OpCode.INC_DAT, i],
+  [OpCode.JMP_ADR, "repeatLoop"],
+  "repeatEnd:",
+  [OpCode.RET_SUB],
+];
+
+const scd = SCD.parse({
+  contractName: "Counter",
+  activationAmount: "10000000",
+  pragmas: { maxAuxVars: 3, verboseAssembly: false, version: "2.3.0" },
+  methods: [
+    { name: "increment", code: "1", args: [] },
+    {
+      name: "repeat",
+      code: "2",
+      args: [{ name: "times", type: "long" }],
+    },
+  ],
+  variables: [],
+  maps: [],
+  transactions: [],
+});
+
+describe("CostEstimator", () => {
+  const estimator = new CostEstimator(scd, machineCode(Contract, Memory));
+  const report = estimator.estimate();
+
+  it("should measure the dispatch baseline", () => {
+    expect(report.dispatch.instructions).toBeGreaterThan(0);
+    // one iteration reading the message, another finding no further transaction
+    expect(report.dispatch.apiCalls).toBe(8);
+    expect(report.methods).toHaveLength(2);
+  });
+
+  it("should report constant costs for methods without loops", () => {
+    const increment = report.methods[0];
+    expect(increment.name).toBe("increment");
+    expect(increment.errors).toHaveLength(0);
+    expect(increment.min).toEqual(increment.worst);
+    expect(increment.typical.instructions).toBe(
+      report.dispatch.instructions + 3,
+    );
+    expect(increment.curves).toHaveLength(0);
+  });
+
+  it("should report min/typical/worst and cost curves for loops", () => {
+    const repeat = report.methods[1];
+    expect(repeat.samples).toBe(5);
+    expect(repeat.min.steps).toBeLessThan(repeat.typical.steps);
+    expect(repeat.typical.steps).toBeLessThan(repeat.worst.steps);
+    expect(repeat.worst.feeNQT).toBeGreaterThan(repeat.min.feeNQT);
+
+    expect(repeat.curves).toHaveLength(1);
+    const [curve] = repeat.curves;
+    expect(curve.parameter).toBe("times");
+    // BGE, INC, INC, JMP per iteration
+    expect(curve.slope).toBeCloseTo(4, 6);
+  });
+
+  it("should measure state dependent curves with a setup", () => {
+    const curve = estimator.estimateCurve("increment", {
+      parameter: "previous calls",
+      values: [0, 5],
+      setup: (x) =>
+        Array.from({ length: x }, () => ({
+          sender: 1n,
+          amount: 10000000n,
+          message: [1n],
+        })),
+    });
+    expect(curve.slope).toBe(0);
+    expect(() => estimator.estimateCurve("unknown", curve)).toThrow(
+      "Unknown method: unknown",
+    );
+  });
+
+  it("should accept longs with underscores", () => {
+    const underscored = SCD.parse({
+      contractName: "Counter",
+      activationAmount: "1_000_0000",
+      pragmas: { maxAuxVars: 3, verboseAssembly: false, version: "2.3.0" },
+      methods: [{ name: "increment", code: "0_1", args: [] }],
+      variables: [],
+      maps: [],
+      transactions: [],
+    });
+    const [increment] = new CostEstimator(
+      underscored,
+      machineCode(Contract, Memory),
+    ).estimate().methods;
+    expect(increment.errors).toHaveLength(0);
+    expect(increment.typical.instructions).toBe(
+      report.dispatch.instructions + 3,
+    );
+  });
+});
@@ -0,0 +1,160 @@
+import { describe, expect, it } from "bun:test";
+import { Fuzzer, mergeFuzzReports } from "../Fuzzer";
+import { parseTrace, stringifyTrace } from "../Profiler";
+import { SCD } from "../../parser";
+import { ApiFunction as Fun, OpCode } from "../../vm";
+import { type Line, machineCode } from "../../vm/__tests/assemble";
+
+const Memory = [
+  "counter",
+  "tx",
+  "code",
+  "arg",
+  "i",
+  "count",
+  "acc",
+  "c1",
+  "c2",
+  "c3",
+  "magic",
+];
+const [counter, tx, code, arg, i, count, acc, c1, c2, c3, magic] =
+  Memory.keys();
+
+// `push` (1) adds an entry, `walk` (2) loops over all entries, `check` (3) branches on its argument
+const Contract: Line[] = [
+  [OpCode.SET_VAL, c1, 1n],
+  [OpCode.SET_VAL, c2, 2n],
+  [OpCode.SET_VAL, c3, 3n],
+  [OpCode.SET_VAL, magic, 7n],
+  [OpCode.SET_PCS],
+  "loop:",
+  [OpCode.EXT_FUN_DAT, Fun.A_to_Tx_after_Timestamp, counter],
+  [OpCode.EXT_FUN_RET, Fun.get_A1, tx],
+  [OpCode.BZR_DAT, tx, "end"],
+  [OpCode.EXT_FUN_RET, Fun.get_Timestamp_for_Tx_in_A, counter],
+  [OpCode.EXT_FUN, Fun.message_from_Tx_in_A_to_B],
+  [OpCode.EXT_FUN_RET, Fun.get_B1, code],
+  [OpCode.EXT_FUN_RET, Fun.get_B2, arg],
+  [OpCode.BNE_DAT, code, c1, "notPush"],
+  [OpCode.JMP_SUB, "push"],
+  "notPush:",
+  [OpCode.BNE_DAT, code, c2, "notWalk"],
+  [OpCode.JMP_SUB, "walk"],
+  "notWalk:",
+  [OpCode.BNE_DAT, code, c3, "next"],
+  [OpCode.JMP_SUB, "check"],
+  "next:",
+  [OpCode.JMP_ADR, "loop"],
+  "end:",
+  [OpCode.FIN_IMD],
+  "push:",
+  [OpCode.INC_DAT, count],
+  [OpCode.RET_SUB],
+  "walk:",
+  [OpCode.CLR_DAT, i],
+  "walkLoop:",
+  [OpCode.BGE_DAT, i, count, "walkEnd"],
+  [OpCode.INC_DAT, acc],
+  [OpCode.INC_DAT, i],
+  [OpCode.JMP_ADR, "walkLoop"],
+  "walkEnd:",
+  [OpCode.RET_SUB],
+  "check:",
+  [OpCode.BNE_DAT, arg, magic, "checkEnd"],
+  [OpCode.INC_DAT, acc],
+  "checkEnd:",
+  [OpCode.RET_SUB],
+];
+
+const ActivationAmount = 10000000n;
+
+const scdInput = {
+  contractName: "Entries",
+  activationAmount: ActivationAmount.toString(),
+  pragmas: { maxAuxVars: 3, verboseAssembly: false, version: "2.3.0" },
+  methods: [
+    { name: "push", code: "1", args: [] },
+    { name: "walk", code: "2", args: [] },
+    { name: "check", code: "3", args: [{ name: "value", type: "long" }] },
+  ],
+  variables: [],
+  maps: [],
+  transactions: [],
+};
+const scd = SCD.parse(scdInput);
+
+const fuzz = (seed: number, iterations = 300) =>
+  new Fuzzer(scd, machineCode(Contract, Memory), { seed, maxCalls: 8 }).run(
+    iterations,
+  );
+
+describe("Fuzzer", () => {
+  const report = fuzz(1);
+
+  it("should find state dependent worst cases and minimize their traces", () => {
+    const walk = report.worst.find((w) => w.method === "walk")!;
+    const pushes = walk.trace.slice(0, -1);
+    expect(pushes.length).toBeGreaterThan(1);
+    // only the entries are needed, each adding an iteration of the loop
+    expect(pushes.every((tx) => tx.message![0] === 1n)).toBe(true);
+    expect(walk.trace.at(-1)!.message![0]).toBe(2n);
+    const push = report.worst.find((w) => w.method === "push")!;
+    expect(walk.steps).toBeGreaterThan(push.steps + pushes.length * 3);
+    expect(push.trace).toHaveLength(1);
+  });
+
+  it("should cover the branches", () => {
+    const { coverage } = report;
+    expect(coverage.instructions).toHaveLength(coverage.totalInstructions);
+    expect(coverage.branchOutcomes).toHaveLength(coverage.totalBranchOutcomes);
+    expect(report.errors).toHaveLength(0);
+    expect(report.corpus).toBeGreaterThan(0);
+  });
+
+  it("should be deterministic per seed and merge parallel runs", () => {
+    expect(fuzz(1).worst).toEqual(report.worst);
+    const other = fuzz(2);
+    const merged = mergeFuzzReports([report, other]);
+    expect(merged.iterations).toBe(report.iterations + other.iterations);
+    expect(merged.worst.map((w) => w.method)).toEqual([
+      "push",
+      "walk",
+      "check",
+    ]);
+    expect(merged.worst[1]!.steps).toBe(
+      Math.max(report.worst[1]!.steps, other.worst[1]!.steps),
+    );
+  });
+
+  it("should write the traces as read by parseTrace", () => {
+    const trace = [
+      { sender: 1n, amount: ActivationAmount, message: [1n] },
+      { sender: 1n, amount: ActivationAmount, message: [1n] },
+      { sender: 2n, amount: ActivationAmount, message: [2n] },
+    ];
+    const json = stringifyTrace(trace);
+    expect(JSON.parse(json)).toEqual([
+      { sender: "1", amount: "10000000", message: ["1"], repeat: 2 },
+      { sender: "2", amount: "10000000", message: ["2"] },
+    ]);
+    expect(parseTrace(json)).toEqual(trace);
+  });
+
+  it("should accept longs with underscores", () => {
+    const underscored = SCD.parse({
+      ...scdInput,
+      activationAmount: "1_000_0000",
+      methods: [{ name: "push", code: "0_1", args: [] }],
+    });
+    const { worst, errors } = new Fuzzer(
+      underscored,
+      machineCode(Contract, Memory),
+      { seed: 1, maxCalls: 2 },
+    ).run(20);
+    expect(errors).toHaveLength(0);
+    const [call] = worst[0]!.trace;
+    expect(call!.amount).toBe(ActivationAmount);
+    expect(call!.message).toEqual([1n]);
+  });
+});
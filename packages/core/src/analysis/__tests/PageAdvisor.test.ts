@@ -0,0 +1,99 @@
+import { describe, expect, it } from "bun:test";
+import { advisePages, countPages, deploymentCost } from "../PageAdvisor";
+import { ApiFunction as Fun, DefaultFeeSchedule, OpCode } from "../../vm";
+import { type Line, machineCode } from "../../vm/__tests/assemble";
+
+const Memory = ["counter", "tx", "n"];
+const [counter, tx, n] = Memory.keys();
+
+// recurses message[0] times, pushing the counter on every level
+const Recursive: Line[] = [
+  [OpCode.SET_PCS],
+  "loop:",
+  [OpCode.EXT_FUN_DAT, Fun.A_to_Tx_after_Timestamp, counter],
+  [OpCode.EXT_FUN_RET, Fun.get_A1, tx],
+  [OpCode.BZR_DAT, tx, "end"],
+  [OpCode.EXT_FUN_RET, Fun.get_Timestamp_for_Tx_in_A, counter],
+  [OpCode.EXT_FUN, Fun.message_from_Tx_in_A_to_B],
+  [OpCode.EXT_FUN_RET, Fun.get_B1, n],
+  [OpCode.JMP_SUB, "rec"],
+  [OpCode.JMP_ADR, "loop"],
+  "end:",
+  [OpCode.FIN_IMD],
+  "rec:",
+  [OpCode.BZR_DAT, n, "recEnd"],
+  [OpCode.PSH_DAT, n],
+  [OpCode.DEC_DAT, n],
+  [OpCode.JMP_SUB, "rec"],
+  [OpCode.POP_DAT, n],
+  "recEnd:",
+  [OpCode.RET_SUB],
+];
+
+const Flat: Line[] = [[OpCode.INC_DAT, counter], [OpCode.FIN_IMD]];
+
+const call = (depth: bigint) => ({
+  sender: 1n,
+  amount: 100000000n,
+  message: [depth],
+});
+
+describe("PageAdvisor", () => {
+  it("should count the pages and the deployment fee", () => {
+    const code = machineCode(Recursive, Memory, { DataPages: 2 });
+    const pages = countPages(code);
+    expect(pages).toEqual({
+      code: 1,
+      data: 2,
+      codeStack: 1,
+      userStack: 1,
+      total: 5,
+    });
+    expect(countPages(code, { userStackPages: 0 }).total).toBe(4);
+    expect(deploymentCost(code).feeNQT).toBe(5n * DefaultFeeSchedule.pageFeeNQT);
+  });
+
+  it("should recommend the stack pages reached by the deepest trace", () => {
+    const code = machineCode(Recursive, Memory);
+    const advice = advisePages(code, [[call(3n)], [call(40n), call(5n)]]);
+    expect(advice.errors).toHaveLength(0);
+    expect(advice.maxDepth).toEqual({ codeStack: 41, userStack: 40 });
+    expect(advice.unused).toEqual({ codeStack: false, userStack: false });
+    // 1 page each would overflow
+    expect(advice.pragmas).toEqual({ codeStackPages: 2, userStackPages: 2 });
+    expect(advice.savedNQT).toBe(-2n * DefaultFeeSchedule.pageFeeNQT);
+
+    const shallow = advisePages(code, [[call(3n)]], { headroomPages: 1 });
+    expect(shallow.pragmas).toEqual({ codeStackPages: 2, userStackPages: 2 });
+  });
+
+  it("should drop the stacks the code never uses", () => {
+    const code = machineCode(Flat, ["counter"], {
+      CodeStackPages: 2,
+      UserStackPages: 3,
+    });
+    const advice = advisePages(code, []);
+    expect(advice.unused).toEqual({ codeStack: true, userStack: true });
+    expect(advice.pragmas).toEqual({ codeStackPages: 0, userStackPages: 0 });
+    expect(advice.recommended.pages.total).toBe(2);
+    expect(advice.savedNQT).toBe(5n * DefaultFeeSchedule.pageFeeNQT);
+  });
+
+  it("should keep a page for the stacks no trace reached", () => {
+    const code = machineCode(Recursive, Memory, {
+      CodeStackPages: 3,
+      UserStackPages: 3,
+    });
+    // no recursion
+    const advice = advisePages(code, [[call(0n)]]);
+    expect(advice.maxDepth).toEqual({ codeStack: 1, userStack: 0 });
+    expect(advice.uncovered).toEqual({ codeStack: false, userStack: true });
+    expect(advice.pragmas).toEqual({ codeStackPages: 1, userStackPages: 1 });
+    expect(advice.warnings).toHaveLength(1);
+    expect(advice.warnings[0]).toContain("user stack");
+
+    const untraced = advisePages(code, []);
+    expect(untraced.pragmas).toEqual({ codeStackPages: 1, userStackPages: 1 });
+    expect(untraced.warnings).toHaveLength(2);
+  });
+});
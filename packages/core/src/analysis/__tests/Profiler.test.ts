@@ -0,0 +1,133 @@
+import { describe, expect, it } from "bun:test";
+import { parseTrace, Profiler } from "../Profiler";
+import { mapToSource } from "../SourceMap";
+import { OpCode } from "../../vm";
+import { assemble, type Line, machineCode } from "../../vm/__tests/assemble";
+
+const Memory = ["n", "i", "acc"];
+const [n, i, acc] = Memory.keys();
+
+// verbose assembly as emitted by SmartC for
+// 4: void main() {
+// 5:   n = 10;
+// 6:   for (i = 0; i < n; i++) add();
+// 7: }
+// 8: void add() {
+// 9:   acc++;
+// 10: }
+const Assembly = `^program name Loop
+^declare n
+^declare i
+^declare acc
+
+JMP :__fn_main
+
+__fn_main:
+PCS
+^comment line 5 n = 10;
+SET @n #000000000000000a
+^comment line 6 for (i = 0; i < n; i++) add();
+CLR @i
+__loop1_start:
+BGE $i $n :__loop1_end
+JSR :__fn_add
+INC @i
+JMP :__loop1_start
+__loop1_end:
+FIN
+
+__fn_add:
+^comment line 9 acc++;
+INC @acc
+RET
+`;
+
+const Contract: Line[] = [
+  [OpCode.JMP_ADR, "main"],
+  "main:",
+  [OpCode.SET_PCS],
+  [OpCode.SET_VAL, n, 10n],
+  [OpCode.CLR_DAT, i],
+  "start:",
+  [OpCode.BGE_DAT, i, n, "end"],
+  [OpCode.JMP_SUB, "add"],
+  [OpCode.INC_DAT, i],
+  [OpCode.JMP_ADR, "start"],
+  "end:",
+  [OpCode.FIN_IMD],
+  "add:",
+  [OpCode.INC_DAT, acc],
+  [OpCode.RET_SUB],
+];
+
+describe("Profiler", () => {
+  it("should attribute the executed steps to source lines and functions", () => {
+    const profiler = new Profiler(machineCode(Contract, Memory), Assembly);
+    expect(profiler.hasSourceLines).toBeTruthy();
+
+    const profile = profiler.profile([{ sender: 1n, amount: 2_0000_0000n }]);
+
+    expect(profile.errors).toHaveLength(0);
+    expect(profile.total.instructions).toBe(66);
+    // CLR, 11x BGE, 10x JSR, INC, JMP and FIN
+    expect(profile.lines.map((l) => [l.line, l.steps])).toEqual([
+      [6, 43],
+      [9, 20],
+      [5, 1],
+    ]);
+    expect(profile.lines[0].share).toBeCloseTo(43 / 66, 6);
+    expect(profile.functions.map((f) => [f.name, f.instructions])).toEqual([
+      ["main", 45],
+      ["add", 20],
+      ["(global)", 1],
+    ]);
+    expect(profile.total.feeNQT).toBe(
+      profile.lines.reduce((sum, l) => sum + l.feeNQT, 0n) +
+        2n * 73_500n, // JMP and PCS are not on a source line
+    );
+  });
+
+  it("should attribute expanded branches to the assembly line", () => {
+    // the assembler replaces an out of range `BZR` by `BNZ` over a `JMP`
+    const sourceMap = mapToSource(
+      `^comment line 1 if (n) n++;
+BZR $n :__if1_end
+^comment line 2
+INC @n
+__if1_end:
+^comment line 3
+FIN`,
+      assemble([
+        [OpCode.BNZ_DAT, 0, "then"],
+        [OpCode.JMP_ADR, "end"],
+        "then:",
+        [OpCode.INC_DAT, 0],
+        "end:",
+        [OpCode.FIN_IMD],
+      ]),
+    );
+    expect([0, 6, 11, 16].map((pc) => sourceMap.lines[pc])).toEqual([
+      1, 1, 2, 3,
+    ]);
+  });
+
+  it("should parse transaction traces", () => {
+    const trace = parseTrace(
+      '[{"sender": "1", "amount": 100000000, "message": ["2", 3], "repeat": 2}, {"sender": 5}]',
+    );
+    expect(trace).toHaveLength(3);
+    expect(trace[1]).toEqual({ sender: 1n, amount: 1_0000_0000n, message: [2n, 3n] });
+    expect(trace[2]).toEqual({ sender: 5n, amount: 0n, message: undefined });
+    expect(() => parseTrace('{"sender": 1}')).toThrow(
+      "Trace must be an array of transactions",
+    );
+  });
+
+  it("should parse underscore-grouped values of hand-written traces", () => {
+    const [tx] = parseTrace(
+      '[{"sender": "1_000", "amount": "1_0000_0000", "message": ["2_0", 3]}]',
+    );
+    expect(tx).toEqual({ sender: 1000n, amount: 1_0000_0000n, message: [20n, 3n] });
+    expect(() => parseTrace('[{"sender": "1x"}]')).toThrow('Invalid long: "1x"');
+  });
+});
@@ -0,0 +1,52 @@
+import { describe, expect, it } from "bun:test";
+import { mapToSource } from "../SourceMap";
+import { OpCode } from "../../vm";
+import { assemble } from "../../vm/__tests/assemble";
+
+// 1: void main() {
+// 2:   n++;
+// 3:   if (n > m) m = n;
+// 4: }
+const Assembly = `^declare n
+^declare m
+
+__fn_main:
+^comment line 2 n++;
+INC @n
+^comment line 3 if (n > m) m = n;
+BLE $n $m :__if1_endIf
+SET @m $n
+__if1_endIf:
+FIN`;
+
+const ByteCode = assemble([
+  [OpCode.INC_DAT, 0],
+  [OpCode.BLE_DAT, 0, 1, "end"],
+  [OpCode.SET_DAT, 1, 0],
+  "end:",
+  [OpCode.FIN_IMD],
+]);
+
+describe("SourceMap", () => {
+  it("should map code addresses to assembly and source lines", () => {
+    const sourceMap = mapToSource(Assembly, ByteCode);
+
+    expect(sourceMap.at(0)).toMatchObject({ asmLine: 6, line: 2, function: "main" });
+    // operand bytes belong to their instruction
+    expect(sourceMap.at(7)).toMatchObject({ asmLine: 8, line: 3 });
+    expect(sourceMap.at(7)?.instruction.offset).toBe(5);
+    expect(sourceMap.at(15)?.instruction.info.code).toBe(OpCode.SET_DAT);
+    expect(sourceMap.at(24)).toMatchObject({ asmLine: 11, line: 3 });
+    expect(sourceMap.at(25)).toBeUndefined();
+  });
+
+  it("should map assembly and source lines to code addresses", () => {
+    const sourceMap = mapToSource(Assembly, ByteCode);
+
+    expect(sourceMap.offsetsOfAsmLine(8)).toEqual([5]);
+    expect(sourceMap.offsetsOfAsmLine(9)).toEqual([15]);
+    expect(sourceMap.offsetsOfAsmLine(1)).toEqual([]);
+    expect(sourceMap.offsetsOfSourceLine(3)).toEqual([5, 15, 24]);
+    expect(sourceMap.offsetsOfSourceLine(2)).toEqual([0]);
+  });
+});
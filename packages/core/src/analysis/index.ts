@@ -0,0 +1,5 @@
+export * from "./CostEstimator";
+export * from "./Profiler";
+export * from "./SourceMap";
+export * from "./PageAdvisor";
+export * from "./Fuzzer";
@@ -0,0 +1,173 @@
+import {
+  type DataType,
+  type MapDefinition,
+  type MapItemDefinition,
+  type MethodDefinition,
+  parseLong,
+  type SCD,
+} from "../parser";
+import { ClientTemplate } from "./templates/client.eta";
+import { renderTemplate } from "./render";
+
+/** Maximum message size of a transaction */
+export const MaxMessageBytes = 1000;
+const MaxMessageLongs = MaxMessageBytes / 8;
+
+const isArray = (type?: DataType) => !!type?.endsWith("[]");
+
+function toPascalCase(name: string) {
+  const pascal = name
+    .split(/[^A-Za-z0-9]+/)
+    .filter(Boolean)
+    .map((part) => part[0]!.toUpperCase() + part.slice(1))
+    .join("");
+  return /^[0-9]/.test(pascal) ? `_${pascal}` : pascal;
+}
+
+function tsType(type?: DataType) {
+  if (isArray(type)) return "readonly bigint[] | BigInt64Array";
+  if (type === "boolean") return "boolean";
+  if (type === "string") return "string";
+  return "bigint";
+}
+
+/**
+ * Statements writing the arguments behind the method code - an array argument takes the remaining longs.
+ * The locals of the generated method are prefixed with `_`, such that they don't shadow the arguments.
+ */
+function encodeMethod(method: MethodDefinition) {
+  const body: string[] = [];
+  let hasText = false;
+  let length = `${(method.args.length + 1) * 8}`;
+  method.args.forEach(({ name, type }, i) => {
+    const index = i + 1;
+    if (isArray(type)) {
+      if (i !== method.args.length - 1) {
+        throw new Error(
+          `Array argument must be the last one: ${method.name}(${name})`,
+        );
+      }
+      const capacity = MaxMessageLongs - index;
+      body.push(
+        `if (${name}.length > ${capacity}) throw new RangeError("${name}: at most ${capacity} values");`,
+        `for (let _i = 0; _i < ${name}.length; _i++) _m[_at + ${index} + _i] = ${name}[_i]!;`,
+      );
+      length = `(${index} + ${name}.length) * 8`;
+    } else if (type === "boolean") {
+      body.push(`_m[_at + ${index}] = ${name} ? 1n : 0n;`);
+    } else if (type === "string") {
+      hasText = true;
+      body.push(`writeText(this.bytes, (_at + ${index}) * 8, ${name});`);
+    } else {
+      body.push(`_m[_at + ${index}] = ${name};`);
+    }
+  });
+  body.push(`this.lengths[_slot] = ${length};`);
+
+  const longs = method.args.some((a) => isArray(a.type))
+    ? MaxMessageLongs
+    : method.args.length + 1;
+  return { body, hasText, longs };
+}
+
+function decodeItem(
+  mapName: string,
+  item: MapItemDefinition,
+  param: string,
+  enums: { name: string; type: string; values: [string, string][] }[],
+) {
+  if (item.oneOf?.length) {
+    const names = `${toPascalCase(mapName)}${toPascalCase(item.name)}Names`;
+    const type = item.oneOf.map((o) => `"${o.name}"`).join(" | ");
+    enums.push({
+      name: names,
+      type,
+      values: item.oneOf.map((o) => [parseLong(o.value).toString(), o.name]),
+    });
+    return {
+      type: `${type} | bigint`,
+      decode: `${names}.get(BigInt(${param})) ?? BigInt(${param})`,
+    };
+  }
+  if (item.type === "boolean") {
+    return { type: "boolean", decode: `BigInt(${param}) !== 0n` };
+  }
+  if (item.type === "string") {
+    return { type: "string", decode: `readText(BigInt(${param}))` };
+  }
+  return { type: "bigint", decode: `BigInt(${param})` };
+}
+
+function decodeMap(map: MapDefinition) {
+  const enums: { name: string; type: string; values: [string, string][] }[] =
+    [];
+  // a constant key1 identifies the map, so is no part of the entries
+  const items = [
+    { item: map.key1, param: "key1" },
+    { item: map.key2, param: "key2" },
+    { item: map.value, param: "value" },
+  ].filter(
+    ({ param }) =>
+      param !== "key1" || !map.key1.constant || map.key1.value === undefined,
+  );
+  const fields = items.map(({ item, param }) => ({
+    name: item.name,
+    ...decodeItem(map.name, item, param, enums),
+  }));
+  return {
+    name: map.name,
+    entry: `${toPascalCase(map.name)}Entry`,
+    params: items.map((i) => `${i.param}: bigint | string`).join(", "),
+    fields,
+    enums,
+  };
+}
+
+/**
+ * Generates a typed TypeScript client for the contract: a codec which encodes the method calls into
+ * the messages the generated `main()` reads (method code first, the arguments in the following longs),
+ * and decoders of the map values.
+ *
+ * The codec writes into preallocated `BigInt64Array` slots, so encoding does not allocate per call -
+ * batches of calls are encoded into consecutive slots.
+ */
+export class ClientGenerator {
+  constructor(private scd: SCD) {}
+
+  generateClient(): string {
+    return renderTemplate(ClientTemplate, this.getTemplateData());
+  }
+
+  private getTemplateData() {
+    const info = this.scd.getContractInfo();
+    const methods = this.scd.getMethods();
+    let stride = 1;
+    let hasText = false;
+    const methodData = methods.map((method, i) => {
+      const { body, hasText: text, longs } = encodeMethod(method);
+      stride = Math.max(stride, longs);
+      hasText ||= text;
+      const params = method.args
+        .map((a) => `${a.name}: ${tsType(a.type)}`)
+        .join(", ");
+      return {
+        name: method.name,
+        code: parseLong(method.code).toString(),
+        params,
+        callArgs: method.args.map((_, a) => `call.args[${a}]`).join(", "),
+        body,
+        last: i === methods.length - 1,
+      };
+    });
+    const maps = this.scd.getMaps().map(decodeMap);
+    hasText ||= maps.some((m) => m.fields.some((f) => f.type === "string"));
+    return {
+      contractName: info.name,
+      name: toPascalCase(info.name),
+      stride,
+      hasText,
+      methods: methodData,
+      maps,
+    };
+  }
+}
@@ -1,30 +1,147 @@
-import { Eta } from "eta";
-import type { SCD } from "../parser";
-import {SmartCTemplate} from "./templates/smartc.eta"
+import type { SCD, VariableDefinition } from "../parser";
+import {
+  type SmartCSection,
+  SmartCSectionOrder,
+  SmartCTemplateSections,
+} from "./templates/smartc.eta";
+import {
+  type DispatchOptions,
+  type DispatchPlan,
+  planDispatch,
+} from "./dispatch";
+import { renderTemplate } from "./render";
+import { planTransactions } from "./transactions";
+
+export interface ContractSection {
+  section: SmartCSection;
+  code: string;
+}
+
+export interface GeneratorOptions {
+  /** Orders the dispatch by the call frequencies - by default the method order of the SCD */
+  dispatch?: DispatchOptions;
+}
+
+/**
+ * Receives the generated code chunk by chunk, e.g. a file sink or a Node stream
+ */
+export interface ContractSink {
+  write(chunk: string): unknown;
+}
+
+interface PackedWord {
+  name: string;
+  fields: { accessor: string; bit: number; mask: string }[];
+}
 
 /**
  * SmartCGenerator is responsible for generating contract code based on provided structured data (SCD).
  * It uses a template engine, Eta, to render the contract code dynamically using the provided data.
+ * The templates are compiled once and shared by all generator instances.
  */
 export class SmartCGenerator {
-  private eta: Eta;
+  constructor(
+    private scd: SCD,
+    private options: GeneratorOptions = {},
+  ) {}
 
-  constructor(private scd: SCD) {
-    this.eta = new Eta();
+  /**
+   * The order of the dispatch cases and the expected savings per transaction compared to the SCD order
+   */
+  getDispatchPlan(): DispatchPlan {
+    return planDispatch(this.scd.getMethods(), this.options.dispatch);
   }
 
   generateContract(): string {
-    const templateData = {
-      contractName: this.scd.getContractInfo().name,
-      description: this.scd.getContractInfo().description,
-      activationAmount: this.scd.getContractInfo().activationAmount,
-      pragmas: this.scd.getContractInfo().pragmas,
+    let code = "";
+    for (const { code: chunk } of this.generateSections()) {
+      code += chunk;
+    }
+    return code;
+  }
+
+  /**
+   * Renders the contract section by section: header (program and pragmas), defines, state (with the
+   * collections and outgoing transactions), dispatch and stubs
+   */
+  *generateSections(): Generator<ContractSection> {
+    const templateData = this.getTemplateData();
+    for (const section of SmartCSectionOrder) {
+      yield {
+        section,
+        code: renderTemplate(SmartCTemplateSections[section], templateData),
+      };
+    }
+  }
+
+  /**
+   * Writes the contract to the sink, without building the complete code in memory
+   */
+  writeContract(sink: ContractSink) {
+    for (const { code } of this.generateSections()) {
+      sink.write(code);
+    }
+  }
+
+  private getTemplateData() {
+    const contractInfo = this.scd.getContractInfo();
+    const { variables, structs, packedWords } = this.getStateData();
+    const transactions = planTransactions(this.scd.getTransactions());
+    return {
+      contractName: contractInfo.name,
+      description: contractInfo.description,
+      activationAmount: contractInfo.activationAmount,
+      pragmas: contractInfo.pragmas,
       methods: this.scd.getMethods(),
-      variables: this.scd.getVariables(),
-      structs: this.scd.getStructs(),
+      dispatchMethods: this.getDispatchPlan().methods,
+      variables,
+      structs,
+      packedWords,
       maps: this.scd.getMaps(),
+      collections: this.scd.getMaps().filter((map) => map.collection),
+      transactions,
+      batchedTransactions: transactions.filter((t) => t.delivery === "batched"),
     };
+  }
 
-    return this.eta.renderString(SmartCTemplate, templateData);
+  /**
+   * The packed variables of the layout are no longs of their own, but bits of the packed words,
+   * accessed by the `get_<name>()` and `set_<name>(value)` macros - `get_stats_flag()` for a struct field.
+   */
+  private getStateData() {
+    const variables = this.scd.getVariables();
+    const structs = this.scd.getStructs();
+    const words = new Map<string, PackedWord>();
+    const packedNames = new Set<string>();
+    for (const { name, packed } of this.scd.getVariablesLayout()) {
+      if (!packed) continue;
+      packedNames.add(name);
+      let word = words.get(packed.word);
+      if (!word) {
+        word = { name: packed.word, fields: [] };
+        words.set(packed.word, word);
+      }
+      word.fields.push({
+        accessor: name.replace(".", "_"),
+        bit: packed.bit,
+        mask: `0x${((1n << BigInt(packed.bits)) - 1n).toString(16)}`,
+      });
+    }
+    if (!words.size) return { variables, structs, packedWords: [] };
+
+    return {
+      variables: variables.filter((v) => !packedNames.has(v.name)),
+      structs: structs
+        .map(
+          (struct): VariableDefinition => ({
+            ...struct,
+            fields: struct.fields?.filter(
+              (f) => !packedNames.has(`${struct.name}.${f.name}`),
+            ),
+          }),
+        )
+        .filter((struct) => struct.fields?.length),
+      packedWords: [...words.values()],
+    };
   }
 }
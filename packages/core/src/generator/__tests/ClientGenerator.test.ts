@@ -0,0 +1,135 @@
+import { describe, expect, it } from "bun:test";
+import { mkdtempSync, writeFileSync } from "node:fs";
+import { tmpdir } from "node:os";
+import { join } from "node:path";
+import { SCD, type SCDType } from "../../parser";
+import { ClientGenerator } from "../ClientGenerator";
+import { mockSCD } from "./mock-scd";
+
+const withMethods = (methods: SCDType["methods"]) =>
+  SCD.parse({ ...mockSCD, methods: [...mockSCD.methods, ...methods] });
+
+// imports the generated client - i.e. it must transpile
+async function importClient(client: string) {
+  const file = join(mkdtempSync(join(tmpdir(), "scd-client-")), "client.ts");
+  writeFileSync(file, client);
+  return import(file);
+}
+
+// the longs of a message, as the contract reads them
+const longsOf = (message: Uint8Array) =>
+  [...new BigInt64Array(message.slice().buffer)];
+
+describe("ClientGenerator", () => {
+  it("should encode the method code and the arguments into the slot", () => {
+    const client = new ClientGenerator(SCD.parse(mockSCD)).generateClient();
+    expect(client).toContain("const Stride = 3;");
+    expect(client).toContain("export class TestContractCodec {");
+    expect(client).toContain(
+      "testMethod(param1: bigint, param2: bigint): number {",
+    );
+    expect(client).toContain("_m[_at] = 100n;");
+    expect(client).toContain("_m[_at + 2] = param2;");
+    expect(client).toContain("this.lengths[_slot] = 24;");
+    expect(client).toContain(
+      '| { method: "testMethod2"; args: [param1: bigint] };',
+    );
+    expect(client).toContain(
+      'case "testMethod":\n        return this.testMethod(call.args[0], call.args[1]);',
+    );
+    // no text arguments
+    expect(client).not.toContain("writeText");
+  });
+
+  it("should decode the map values", () => {
+    const client = new ClientGenerator(SCD.parse(mockSCD)).generateClient();
+    // the constant key1 is no part of the entry
+    expect(client).toContain(
+      "export function decodeTestMapEntry(key2: bigint | string, value: bigint | string): TestMapEntry {",
+    );
+    expect(client).toContain(
+      'const TestMapValueNames = new Map<bigint, "SOME_CONSTANT_1" | "SOME_CONSTANT_2">([',
+    );
+    expect(client).toContain(
+      "value: TestMapValueNames.get(BigInt(value)) ?? BigInt(value),",
+    );
+  });
+
+  it("should size the slots for array arguments", () => {
+    const client = new ClientGenerator(
+      withMethods([
+        {
+          name: "registerLots",
+          code: "102",
+          args: [
+            { name: "flag", type: "boolean" },
+            { name: "label", type: "string" },
+            { name: "lots", type: "long[]" },
+          ],
+        },
+      ]),
+    ).generateClient();
+    expect(client).toContain("const Stride = 125;");
+    expect(client).toContain("_m[_at + 1] = flag ? 1n : 0n;");
+    expect(client).toContain("writeText(this.bytes, (_at + 2) * 8, label);");
+    expect(client).toContain(
+      'if (lots.length > 122) throw new RangeError("lots: at most 122 values");',
+    );
+    expect(client).toContain("this.lengths[_slot] = (3 + lots.length) * 8;");
+  });
+
+  it("should reject array arguments before others", () => {
+    const generator = new ClientGenerator(
+      withMethods([
+        {
+          name: "registerLots",
+          code: "102",
+          args: [
+            { name: "lots", type: "long[]" },
+            { name: "owner", type: "address" },
+          ],
+        },
+      ]),
+    );
+    expect(() => generator.generateClient()).toThrow(
+      "Array argument must be the last one: registerLots(lots)",
+    );
+  });
+
+  it("should encode the messages the contract reads", async () => {
+    const client = new ClientGenerator(
+      withMethods([
+        {
+          name: "move",
+          code: "65_536",
+          args: [
+            { name: "slot", type: "long" },
+            { name: "at", type: "long" },
+            { name: "m", type: "long" },
+          ],
+        },
+        {
+          name: "registerLots",
+          code: "102",
+          args: [
+            { name: "i", type: "string" },
+            { name: "lots", type: "long[]" },
+          ],
+        },
+      ]),
+    ).generateClient();
+    const { TestContractCodec } = await importClient(client);
+    const codec = new TestContractCodec(3);
+
+    expect(codec.encode({ method: "testMethod", args: [5n, -7n] })).toBe(0);
+    expect(longsOf(codec.message(0))).toEqual([100n, 5n, -7n]);
+
+    // arguments named like the locals of the generated method
+    expect(codec.move(1n, 2n, 3n)).toBe(1);
+    expect(longsOf(codec.message(1))).toEqual([65536n, 1n, 2n, 3n]);
+
+    codec.registerLots("ab", [10n, 20n]);
+    expect(longsOf(codec.message(2))).toEqual([102n, 0x6261n, 10n, 20n]);
+    expect(() => codec.move(0n, 0n, 0n)).toThrow(RangeError);
+  });
+});
@@ -1,101 +1,255 @@
-import { SCD, type SCDType } from "../../parser";
+import { SCD } from "../../parser";
+import { AtMachine } from "../../vm";
 import { SmartCGenerator } from "../SmartCGenerator";
+import { compile, compilableSCD } from "./compile";
+import { mockSCD } from "./mock-scd";
 import { describe, expect, it } from "bun:test";
 
-const mockSCD: SCDType = {
-  contractName: "TestContract",
-  description: "A test contract",
-  activationAmount: "1000000",
-  pragmas: {
-    maxAuxVars: 3,
-    verboseAssembly: true,
-    optimizationLevel: 3,
-    version: "2.3.0",
-    codeStackPages: 0,
-    userStackPages: 0,
-  },
-  methods: [
-    {
-      name: "testMethod",
-      code: "100",
-      args: [
-        { name: "param1", type: "long" },
-        { name: "param2", type: "address" },
-      ],
-    },
-    {
-      name: "testMethod2",
-      code: "101",
-      args: [
-        { name: "param1", type: "long" },
-      ],
-    },
-  ],
-  variables: [
-    {
-      name: "owner",
-      type: "address",
-      initializable: true,
-      constant: true,
-    },
-    {
-      name: "stats",
-      type: "struct",
-      fields: [
-        { name: "counter", type: "long" },
-        { name: "balance", type: "amount" },
-      ],
-    },
-  ],
-  maps: [
-    {
-      name: "testMap",
-      key1: {
-        name: "key1",
-        type: "long",
-        description: "Main Key",
-        constant: true,
-        value: "1",
-      },
-      key2: {
-        name: "addr",
-        description: "Address",
-        type: "address",
-        constant: false,
-      },
-      value: {
-        name: "value",
-        description: "Value",
-        constant: false,
-        oneOf: [
-          {
-            name: "SOME_CONSTANT_1",
-            value: "1",
-          },
-          {
-            name: "SOME_CONSTANT_2",
-            value: "2",
-          },
-        ],
-      },
-    },
-  ],
-  transactions: [
-    {
-      name: "Some name",
-      kind: "sendAmount",
-    },
-    {
-      name: "Another one",
-      kind: "sendAmountAndMessage",
-    },
-  ],
-};
-
 describe("SmartCGenerator", () => {
   it("should generate SmartC code", () => {
     const generator = new SmartCGenerator(SCD.parse(mockSCD));
     const smartCCode = generator.generateContract();
     expect(smartCCode).toMatchSnapshot();
   });
+
+  it("should generate the contract in sections", () => {
+    const generator = new SmartCGenerator(SCD.parse(mockSCD));
+    const sections = [...generator.generateSections()];
+    expect(sections.map((s) => s.section)).toEqual([
+      "header",
+      "defines",
+      "state",
+      "dispatch",
+      "stubs",
+    ]);
+    expect(sections[0]!.code.startsWith("#program name TestContract")).toBe(
+      true,
+    );
+    expect(sections[4]!.code.startsWith("// Function stubs")).toBe(true);
+    expect(sections.map((s) => s.code).join("")).toBe(
+      generator.generateContract(),
+    );
+  });
+
+  it("should write the contract to a sink", () => {
+    const generator = new SmartCGenerator(SCD.parse(mockSCD));
+    const chunks: string[] = [];
+    generator.writeContract({ write: (chunk) => chunks.push(chunk) });
+    expect(chunks).toHaveLength(5);
+    expect(chunks.join("")).toBe(generator.generateContract());
+  });
+
+  it("should emit accessor macros for the packed layout", () => {
+    const scd = SCD.parse({
+      ...mockSCD,
+      packedLayout: true,
+      variables: [
+        ...mockSCD.variables,
+        { name: "isPaused", type: "boolean" },
+        {
+          name: "flags",
+          type: "struct",
+          fields: [{ name: "a", type: "boolean" }],
+        },
+      ],
+    });
+    const state = [...new SmartCGenerator(scd).generateSections()].find(
+      (s) => s.section === "state",
+    )!.code;
+    expect(state).toContain("long _packed0;\n");
+    expect(state).not.toContain("long isPaused;");
+    expect(state).not.toContain("struct FLAGS");
+    expect(state).toContain(
+      "#define get_isPaused() ((_packed0 >> 0) & 0x1)\n" +
+        "#define set_isPaused(value) _packed0 = (_packed0 & ~(0x1 << 0)) | (((value) & 0x1) << 0)\n" +
+        "#define get_flags_a() ((_packed0 >> 1) & 0x1)\n",
+    );
+  });
+
+  it("should compile the packed layout", () => {
+    const scd = SCD.parse({
+      ...compilableSCD,
+      packedLayout: true,
+      variables: [
+        ...mockSCD.variables,
+        { name: "isPaused", type: "boolean" },
+        {
+          name: "status",
+          type: "long",
+          oneOf: [
+            { name: "OPEN", value: "1" },
+            { name: "CLOSED", value: "2" },
+          ],
+        },
+      ],
+    });
+    // the accessors are macros, so compiled where they are used
+    const code =
+      new SmartCGenerator(scd).generateContract() +
+      "void toggle() {\n" +
+      "    set_isPaused(!get_isPaused());\n" +
+      "    if (get_status() == 1) set_status(2);\n" +
+      "}\n";
+    expect(compile(code).ByteCode.length).toBeGreaterThan(0);
+  });
+
+  it("should emit the operations of map collections", () => {
+    const collection = (name: string, kind: string) => ({
+      name,
+      collection: kind,
+      key1: { name: "key", constant: true, value: "1" },
+      key2: { name: "index" },
+      value: { name: "value" },
+    });
+    const scd = SCD.parse({
+      ...mockSCD,
+      maps: [
+        collection("lots", "stack"),
+        collection("incoming", "queue"),
+        collection("stock", "counter"),
+        collection("members", "set"),
+      ],
+    });
+    const state = [...new SmartCGenerator(scd).generateSections()].find(
+      (s) => s.section === "state",
+    )!.code;
+    expect(state).toContain(
+      "long lots_pop() {\n" +
+        "    if (lots_size == 0) return 0;\n" +
+        "    lots_size--;\n" +
+        "    return getMapValue(MAP_LOTS_KEY, lots_size);\n" +
+        "}\n",
+    );
+    expect(state).toContain("void incoming_enqueue(long value) {");
+    expect(state).toContain("long stock_add(long key, long amount) {");
+    expect(state).toContain("long members_count;");
+    // a single map read per operation
+    const add = state.slice(state.indexOf("void members_add"));
+    expect(add.slice(0, add.indexOf("\n}")).match(/getMapValue/g)).toHaveLength(
+      1,
+    );
+  });
+
+  it("should compile the operations of map collections", () => {
+    const scd = SCD.parse({
+      ...compilableSCD,
+      maps: ["stack", "queue", "counter", "set"].map((kind, i) => ({
+        name: `${kind}Map`,
+        collection: kind,
+        key1: { name: "key", constant: true, value: `${i + 10}` },
+        key2: { name: "index" },
+        value: { name: "value" },
+      })),
+    });
+    expect(
+      compile(new SmartCGenerator(scd).generateContract()).ByteCode.length,
+    ).toBeGreaterThan(0);
+  });
+
+  it("should send batched transactions after the transaction loop", () => {
+    const scd = SCD.parse({
+      ...mockSCD,
+      transactions: [
+        {
+          name: "certificate",
+          kind: "sendAmountAndMessage",
+          delivery: "batched",
+        },
+        {
+          name: "payout",
+          kind: "sendQuantity",
+          delivery: "batched",
+          aggregation: "perRecipient",
+          maxRecipients: 8,
+        },
+        { name: "fee", kind: "sendAmount", delivery: "immediate" },
+        { name: "unused", kind: "sendMessage" },
+      ],
+    });
+    const sections = [...new SmartCGenerator(scd).generateSections()];
+    const code = (name: string) =>
+      sections.find((s) => s.section === name)!.code;
+
+    // the quantity in the first long adds up, the activation fee is sent once
+    expect(code("state")).toContain(
+      "    if (certificate_pending) {\n" +
+        "        certificate_message[0] += message[0];\n" +
+        "    } else {\n" +
+        "        certificate_message[0] = message[0];\n" +
+        "    }\n" +
+        "    certificate_recipient = recipient;\n" +
+        "    certificate_amount = amount;\n",
+    );
+    expect(code("state")).toContain("long payout_recipient[8];");
+    expect(code("state")).toContain(
+      "if (payout_assetId[i] == assetId && payout_recipient[i] == recipient) {",
+    );
+    expect(code("state")).toContain(
+      "void fee_send(long amount, long recipient) {\n" +
+        "    sendAmount(amount, recipient);\n" +
+        "}\n",
+    );
+    expect(code("state")).not.toContain("unused");
+    expect(code("dispatch")).toContain(
+      "    }\n    certificate_flush();\n    payout_flush();\n}\n",
+    );
+
+    expect(() =>
+      new SmartCGenerator(
+        SCD.parse({
+          ...mockSCD,
+          transactions: [
+            { name: "Some name", kind: "sendAmount", delivery: "batched" },
+          ],
+        }),
+      ).generateContract(),
+    ).toThrow("no valid C name");
+  });
+
+  it("should compile and batch the transactions of a block", () => {
+    const scd = SCD.parse({
+      ...compilableSCD,
+      transactions: [
+        {
+          name: "certificate",
+          kind: "sendAmountAndMessage",
+          delivery: "batched",
+        },
+      ],
+    });
+    // testMethod(quantity, recipient) certifies the quantity to the recipient
+    const code = new SmartCGenerator(scd)
+      .generateContract()
+      .replace("// Function stubs", "long receipt[4];\n// Function stubs")
+      .replace(
+        "    // TODO: Implement testMethod\n",
+        "    receipt[0] = param1;\n" +
+          "    certificate_send(1000, receipt, param2);\n",
+      );
+    const machine = new AtMachine(compile(code), { balance: 1_0000_0000n });
+    const receive = (quantity: bigint, recipient: bigint) =>
+      machine.queueTransaction({
+        sender: 2n,
+        amount: 1_0000_0000n,
+        message: [100n, quantity, recipient],
+      });
+
+    receive(10n, 77n);
+    receive(20n, 77n);
+    receive(5n, 88n);
+    receive(30n, 88n);
+    const { outgoing, error } = machine.runBlock();
+    expect(error).toBeUndefined();
+    // one transaction per run of the same recipient - with the sum of the quantities
+    expect(
+      outgoing.map(({ recipient, amount, message }) => ({
+        recipient,
+        amount,
+        message,
+      })),
+    ).toEqual([
+      { recipient: 77n, amount: 1000n, message: [30n, 0n, 0n, 0n] },
+      { recipient: 88n, amount: 1000n, message: [35n, 0n, 0n, 0n] },
+    ]);
+  });
 });
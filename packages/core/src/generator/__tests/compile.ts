@@ -0,0 +1,18 @@
+import { SmartC } from "smartc-signum-compiler";
+import type { SCDType } from "../../parser";
+import type { MachineCode } from "../../vm";
+import { mockSCD } from "./mock-scd";
+
+const { codeStackPages, userStackPages, ...pragmas } = mockSCD.pragmas;
+
+/** The snapshot fixture without the pinned stack sizes, such that the compiler sizes the stacks */
+export const compilableSCD: SCDType = { ...mockSCD, pragmas };
+
+/**
+ * Compiles the SmartC code with the compiler the generated contracts target - throws its errors
+ */
+export function compile(sourceCode: string): MachineCode {
+  const compiler = new SmartC({ language: "C", sourceCode });
+  compiler.compile();
+  return compiler.getMachineCode();
+}
@@ -0,0 +1,69 @@
+import { describe, expect, it } from "bun:test";
+import { SCD } from "../../parser";
+import { SmartCGenerator } from "../SmartCGenerator";
+import { InstructionsPerCase, planDispatch } from "../dispatch";
+import { mockSCD } from "./mock-scd";
+
+const methods = [
+  "register",
+  "transfer",
+  "pause",
+  "registerIncomingMaterial",
+].map((name, i) => ({ name, code: String(i + 1), args: [] }));
+
+describe("planDispatch", () => {
+  it("should keep the SCD order without weights", () => {
+    const plan = planDispatch(methods);
+    expect(plan.methods).toBe(methods);
+    expect(plan.savedInstructionsPerTx).toBe(0);
+  });
+
+  it("should order the cases by the profile and report the savings", () => {
+    const plan = planDispatch(methods, {
+      profile: { registerIncomingMaterial: 90, register: 10 },
+    });
+    expect(plan.methods.map((m) => m.name)).toEqual([
+      "registerIncomingMaterial",
+      "register",
+      "transfer",
+      "pause",
+    ]);
+    const incoming = plan.entries[3]!;
+    expect(incoming.comparisons).toBe(1);
+    expect(incoming.baselineComparisons).toBe(4);
+    expect(incoming.savedInstructions).toBe(3 * InstructionsPerCase);
+    expect(plan.expectedComparisons).toBeCloseTo(0.9 * 1 + 0.1 * 2, 10);
+    expect(plan.baselineExpectedComparisons).toBeCloseTo(0.9 * 4 + 0.1, 10);
+    expect(plan.savedInstructionsPerTx).toBeCloseTo(
+      2.6 * InstructionsPerCase,
+      10,
+    );
+  });
+
+  it("should use the method weights unless profiled", () => {
+    const weighted = methods.map((m) =>
+      m.name === "pause" ? { ...m, weight: 5 } : m,
+    );
+    expect(planDispatch(weighted).methods[0]!.name).toBe("pause");
+    expect(
+      planDispatch(weighted, { profile: { transfer: 1 } }).methods[0]!.name,
+    ).toBe("transfer");
+    expect(() => planDispatch(methods, { profile: { unknown: 1 } })).toThrow(
+      "Unknown method in dispatch profile: unknown",
+    );
+  });
+
+  it("should generate the cases in the planned order", () => {
+    const generator = new SmartCGenerator(SCD.parse(mockSCD), {
+      dispatch: { profile: { testMethod2: 3, testMethod: 1 } },
+    });
+    const code = generator.generateContract();
+    expect(code.indexOf("case TESTMETHOD2:")).toBeLessThan(
+      code.indexOf("case TESTMETHOD:"),
+    );
+    // the stubs keep the SCD order
+    expect(code.indexOf("void testMethod(")).toBeLessThan(
+      code.indexOf("void testMethod2("),
+    );
+  });
+});
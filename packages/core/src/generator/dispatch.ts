@@ -0,0 +1,96 @@
+import type { MethodDefinition } from "../parser";
+
+/**
+ * Instructions SmartC emits per `case` of the dispatch switch, which are run for every case
+ * checked before the matching one: loading the magic code and the branch (`SET`, `BEQ`)
+ */
+export const InstructionsPerCase = 2;
+
+export interface DispatchOptions {
+  /**
+   * Calls per method name, e.g. counted from the transactions of a day.
+   * Replaces the `weight` of the method definitions, methods missing in it count as never called.
+   */
+  profile?: Record<string, number>;
+}
+
+export interface DispatchEntry {
+  name: string;
+  code: string;
+  weight: number;
+  /** Share of all calls, 0 if there are no weights */
+  share: number;
+  /** Cases checked to dispatch a call, including the matching one */
+  comparisons: number;
+  /** Cases checked in the order of the SCD */
+  baselineComparisons: number;
+  /** Instructions saved per call of this method */
+  savedInstructions: number;
+}
+
+export interface DispatchPlan {
+  /** Methods in the order of the generated cases */
+  methods: Readonly<MethodDefinition[]>;
+  /** In the order of the SCD */
+  entries: DispatchEntry[];
+  expectedComparisons: number;
+  baselineExpectedComparisons: number;
+  /** Instructions saved per transaction, weighted by the shares */
+  savedInstructionsPerTx: number;
+}
+
+/**
+ * Orders the dispatch cases by descending weight, such that the frequent methods are matched first.
+ * The cases are checked one after another, so this minimizes the expected comparisons per transaction.
+ * Methods of equal weight keep their order, without any weights the order of the SCD is kept.
+ */
+export function planDispatch(
+  methods: Readonly<MethodDefinition[]>,
+  { profile }: DispatchOptions = {},
+): DispatchPlan {
+  if (profile) {
+    for (const name of Object.keys(profile)) {
+      if (!methods.some((m) => m.name === name)) {
+        throw new Error(`Unknown method in dispatch profile: ${name}`);
+      }
+    }
+  }
+  const weights = methods.map((m) =>
+    Math.max(0, (profile ? profile[m.name] : m.weight) ?? 0),
+  );
+  const total = weights.reduce((sum, w) => sum + w, 0);
+  const order = total
+    ? [...methods.keys()].sort((a, b) => weights[b]! - weights[a]!)
+    : [...methods.keys()];
+  const position: number[] = [];
+  order.forEach((index, i) => (position[index] = i));
+
+  let expectedComparisons = 0;
+  let baselineExpectedComparisons = 0;
+  const entries = methods.map((method, index): DispatchEntry => {
+    const share = total ? weights[index]! / total : 0;
+    const comparisons = position[index]! + 1;
+    const baselineComparisons = index + 1;
+    expectedComparisons += share * comparisons;
+    baselineExpectedComparisons += share * baselineComparisons;
+    return {
+      name: method.name,
+      code: method.code,
+      weight: weights[index]!,
+      share,
+      comparisons,
+      baselineComparisons,
+      savedInstructions:
+        (baselineComparisons - comparisons) * InstructionsPerCase,
+    };
+  });
+
+  return {
+    methods: total ? order.map((index) => methods[index]!) : methods,
+    entries,
+    expectedComparisons,
+    baselineExpectedComparisons,
+    savedInstructionsPerTx:
+      (baselineExpectedComparisons - expectedComparisons) * InstructionsPerCase,
+  };
+}
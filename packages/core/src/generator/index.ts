@@ -1 +1,4 @@
 export * from "./SmartCGenerator.ts"
+export * from "./dispatch.ts"
+export * from "./ClientGenerator.ts"
+export * from "./transactions.ts"
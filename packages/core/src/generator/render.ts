@@ -0,0 +1,25 @@
+import { Eta } from "eta";
+
+type TemplateFunction = ReturnType<Eta["compile"]>;
+
+const eta = new Eta();
+const compiledTemplates = new Map<string, TemplateFunction>();
+
+/**
+ * Compiles a template once - `renderString` would parse and compile it on every call
+ */
+function compileTemplate(template: string) {
+  let compiled = compiledTemplates.get(template);
+  if (!compiled) {
+    compiled = eta.compile(template);
+    compiledTemplates.set(template, compiled);
+  }
+  return compiled;
+}
+
+/**
+ * Renders the template with the precompiled template function, shared by all generators
+ */
+export function renderTemplate(template: string, data: object): string {
+  return eta.render(compileTemplate(template), data);
+}
@@ -0,0 +1,128 @@
+/**
+ * The TypeScript client codec - self-contained, such that it can be copied into any project.
+ * The code lines are prepared by the ClientGenerator.
+ */
+export const ClientTemplate = `// Client codec of <%= it.contractName %> - generated from its SCD, do not edit
+
+/** Longs per slot - the longest message */
+const Stride = <%= it.stride %>;
+<% if (it.hasText) { %>
+
+// ASCII only, up to 8 characters per long
+function writeText(bytes: Uint8Array, offset: number, text: string) {
+  for (let i = 0; i < 8; i++) {
+    bytes[offset + i] = i < text.length ? text.charCodeAt(i) & 0xff : 0;
+  }
+}
+
+function readText(value: bigint) {
+  let text = "";
+  for (let v = BigInt.asUintN(64, value); v; v >>= 8n) {
+    text += String.fromCharCode(Number(v & 0xffn));
+  }
+  return text;
+}
+<% } %>
+
+export const <%= it.name %>Methods = {
+<% for (const m of it.methods) { %>
+  <%= m.name %>: <%= m.code %>n,
+<% } %>
+} as const;
+
+export type <%= it.name %>Call =
+<% for (const m of it.methods) { %>
+  | { method: "<%= m.name %>"; args: [<%~ m.params %>] }<%= m.last ? ";" : "" %>
+
+<% } %>
+
+/**
+ * Encodes method calls into preallocated messages, without allocations per call:
+ * every call takes the next slot of \`Stride\` longs in \`longs\` (resp. \`bytes\`), its message length
+ * in bytes is in \`lengths\`. A slot is sent as \`message(slot)\`, the buffers are reused after \`reset()\`.
+ */
+export class <%= it.name %>Codec {
+  readonly longs: BigInt64Array;
+  readonly bytes: Uint8Array;
+  readonly lengths: Uint16Array;
+  count = 0;
+
+  constructor(readonly capacity = 1) {
+    this.longs = new BigInt64Array(capacity * Stride);
+    this.bytes = new Uint8Array(this.longs.buffer);
+    this.lengths = new Uint16Array(capacity);
+  }
+
+  reset() {
+    this.count = 0;
+  }
+
+  /** The message of the slot - a view on \`bytes\` */
+  message(slot: number) {
+    const start = slot * Stride * 8;
+    return this.bytes.subarray(start, start + this.lengths[slot]!);
+  }
+
+  private next() {
+    if (this.count >= this.capacity) {
+      throw new RangeError("All slots are used - reset() or use a higher capacity");
+    }
+    return this.count++;
+  }
+<% for (const m of it.methods) { %>
+
+  /** Encodes the call into the next slot and returns the slot */
+  <%= m.name %>(<%~ m.params %>): number {
+    const _slot = this.next();
+    const _at = _slot * Stride;
+    const _m = this.longs;
+    _m[_at] = <%= m.code %>n;
+<% for (const line of m.body) { %>
+    <%~ line %>
+
+<% } %>
+    return _slot;
+  }
+<% } %>
+
+  encode(call: <%= it.name %>Call): number {
+    switch (call.method) {
+<% for (const m of it.methods) { %>
+      case "<%= m.name %>":
+        return this.<%= m.name %>(<%~ m.callArgs %>);
+<% } %>
+    }
+  }
+
+  /** Encodes the calls into consecutive slots and returns the number of used slots */
+  encodeAll(calls: readonly <%= it.name %>Call[]): number {
+    for (let i = 0; i < calls.length; i++) this.encode(calls[i]!);
+    return this.count;
+  }
+}
+<% for (const map of it.maps) { %>
+<% for (const e of map.enums) { %>
+
+const <%= e.name %> = new Map<bigint, <%~ e.type %>>([
+<% for (const [value, name] of e.values) { %>
+  [<%= value %>n, "<%= name %>"],
+<% } %>
+]);
+<% } %>
+
+export interface <%= map.entry %> {
+<% for (const field of map.fields) { %>
+  <%= field.name %>: <%~ field.type %>;
+<% } %>
+}
+
+/** Decodes a map value of <%= map.name %> - e.g. from the node's contract map API */
+export function decode<%= map.entry %>(<%~ map.params %>): <%= map.entry %> {
+  return {
+<% for (const field of map.fields) { %>
+    <%= field.name %>: <%~ field.decode %>,
+<% } %>
+  };
+}
+<% } %>
+`;
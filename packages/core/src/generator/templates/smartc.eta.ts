@@ -1,4 +1,9 @@
-export const SmartCTemplate =`#program name <%= it.contractName %>
+/**
+ * The contract template in sections, which are rendered (and can be emitted) independently.
+ * Every section starts at a line start - concatenated they are the complete template.
+ */
+export const SmartCTemplateSections = {
+  header: `#program name <%= it.contractName %>
 
 #program description <%= it.description %>
 
@@ -9,7 +14,8 @@ export const SmartCTemplate =`#program name <%= it.contractName %>
 
 <% }) %>
 
-// Magic codes for methods
+`,
+  defines: `// Magic codes for methods
 <% for (const m of it.methods) { %>
 #define <%= m.name.toUpperCase() %> <%= m.code %>
 
@@ -22,7 +28,8 @@ export const SmartCTemplate =`#program name <%= it.contractName %>
 <% } %>
 
 
-// State variables
+`,
+  state: `// State variables
 <% for (const svar of it.variables) { %>
 long <%= svar.name %>;
 <% } %>
@@ -36,8 +43,170 @@ struct <%= struct.name.toUpperCase() %> {
     <% } %>
 } <%= struct.name %>;
 <% } %>
+<% if (it.packedWords.length) { %>
+
+// Packed state - booleans and enums share longs
+<% for (const word of it.packedWords) { %>
+long <%= word.name %>;
+<% for (const field of word.fields) { %>
+#define get_<%= field.accessor %>() ((<%= word.name %> >> <%= field.bit %>) & <%= field.mask %>)
+#define set_<%= field.accessor %>(value) <%= word.name %> = (<%= word.name %> & ~(<%= field.mask %> << <%= field.bit %>)) | (((value) & <%= field.mask %>) << <%= field.bit %>)
+<% } %>
+<% } %>
+<% } %>
+<% if (it.collections.length) { %>
+
+// Collections - sizes and counts are kept in variables, which saves the map reads
+<% for (const c of it.collections) { %>
+<% const key = "MAP_" + c.name.toUpperCase() + "_" + c.key1.name.toUpperCase() %>
+
+// <%= c.collection %> <%= c.name %>
+
+<% if (c.collection === "stack") { %>
+long <%= c.name %>_size;
+void <%= c.name %>_push(long value) {
+    setMapValue(<%= key %>, <%= c.name %>_size, value);
+    <%= c.name %>_size++;
+}
+long <%= c.name %>_pop() {
+    if (<%= c.name %>_size == 0) return 0;
+    <%= c.name %>_size--;
+    return getMapValue(<%= key %>, <%= c.name %>_size);
+}
+long <%= c.name %>_peek() {
+    if (<%= c.name %>_size == 0) return 0;
+    return getMapValue(<%= key %>, <%= c.name %>_size - 1);
+}
+<% } else if (c.collection === "queue") { %>
+long <%= c.name %>_head;
+long <%= c.name %>_tail;
+void <%= c.name %>_enqueue(long value) {
+    setMapValue(<%= key %>, <%= c.name %>_tail, value);
+    <%= c.name %>_tail++;
+}
+long <%= c.name %>_dequeue() {
+    if (<%= c.name %>_head == <%= c.name %>_tail) return 0;
+    <%= c.name %>_head++;
+    return getMapValue(<%= key %>, <%= c.name %>_head - 1);
+}
+long <%= c.name %>_size() {
+    return <%= c.name %>_tail - <%= c.name %>_head;
+}
+<% } else if (c.collection === "counter") { %>
+long <%= c.name %>_add(long key, long amount) {
+    long value = getMapValue(<%= key %>, key) + amount;
+    setMapValue(<%= key %>, key, value);
+    return value;
+}
+long <%= c.name %>_get(long key) {
+    return getMapValue(<%= key %>, key);
+}
+<% } else if (c.collection === "set") { %>
+long <%= c.name %>_count;
+void <%= c.name %>_add(long item) {
+    if (getMapValue(<%= key %>, item) == 0) {
+        setMapValue(<%= key %>, item, 1);
+        <%= c.name %>_count++;
+    }
+}
+void <%= c.name %>_remove(long item) {
+    if (getMapValue(<%= key %>, item) != 0) {
+        setMapValue(<%= key %>, item, 0);
+        <%= c.name %>_count--;
+    }
+}
+long <%= c.name %>_has(long item) {
+    return getMapValue(<%= key %>, item);
+}
+<% } %>
+<% } %>
+<% } %>
+<% if (it.transactions.length) { %>
+
+// Outgoing transactions - batched ones are merged and sent after the transaction loop
+<% for (const t of it.transactions) { %>
+
+// <%= t.kind %> <%= t.name %><% if (t.delivery === "batched") { %>, batched (<%= t.aggregation %>)<% } %>
+
+<% if (t.delivery === "immediate") { %>
+void <%= t.name %>_send(<%= t.params %>) {
+    <%= t.call %>;
+}
+<% } else { %>
+<% for (const declaration of t.declarations) { %>
+<%= declaration %>
+
+<% } %>
+<% if (t.aggregation === "perRecipient") { %>
+void <%= t.name %>_flush() {
+    long i;
+    for (i = 0; i < <%= t.name %>_count; i++) {
+<% for (const statement of t.sendPending) { %>
+        <%= statement %>
+
+<% } %>
+    }
+    <%= t.name %>_count = 0;
+}
+void <%= t.name %>_send(<%= t.params %>) {
+    long i;
+    for (i = 0; i < <%= t.name %>_count; i++) {
+        if (<%~ t.condition %>) {
+<% for (const v of t.sums) { %>
+            <%= v.state %> += <%= v.param %>;
+<% } %>
+<% for (const v of t.lasts) { %>
+            <%= v.state %> = <%= v.param %>;
+<% } %>
+            return;
+        }
+    }
+    if (<%= t.name %>_count == <%= t.capacity %>) {
+        <%= t.name %>_flush();
+    }
+    i = <%= t.name %>_count;
+<% for (const v of [...t.keys, ...t.sums, ...t.lasts]) { %>
+    <%= v.state %> = <%= v.param %>;
+<% } %>
+    <%= t.name %>_count++;
+}
+<% } else { %>
+void <%= t.name %>_flush() {
+    if (<%= t.name %>_pending) {
+        <%= t.name %>_pending = false;
+<% for (const statement of t.sendPending) { %>
+        <%= statement %>
 
-// basic tx iteration struct
+<% } %>
+    }
+}
+void <%= t.name %>_send(<%= t.params %>) {
+    if (<%= t.name %>_pending && (<%~ t.condition %>)) {
+        <%= t.name %>_flush();
+    }
+<% if (t.sums.length) { %>
+    if (<%= t.name %>_pending) {
+<% for (const v of t.sums) { %>
+        <%= v.state %> += <%= v.param %>;
+<% } %>
+    } else {
+<% for (const v of t.sums) { %>
+        <%= v.state %> = <%= v.param %>;
+<% } %>
+    }
+<% } %>
+<% for (const v of [...t.keys, ...t.lasts]) { %>
+    <%= v.state %> = <%= v.param %>;
+<% } %>
+    <%= t.name %>_pending = true;
+}
+<% } %>
+<% } %>
+<% } %>
+<% } %>
+
+`,
+  dispatch: `// basic tx iteration struct
 struct TX {
     long txId;
     long sender;
@@ -50,22 +219,37 @@ void main() {
         readMessage(currentTx.txId, 0, currentTx.message);
 
         switch(currentTx.message[0]) {
-        <% for (const method of it.methods) { %>
+        <% for (const method of it.dispatchMethods) { %>
             case <%= method.name.toUpperCase() %>:
                 <%= method.name %>(<% for (let i = 0; i < method.args.length; i++) { %>currentTx.message[<%= i + 1 %>]<% if (i < method.args.length - 1) { %>, <% } } %>);
                 break;
         <% } %>
         }
     }
+<% for (const t of it.batchedTransactions) { %>
+    <%= t.name %>_flush();
+<% } %>
 }
 
 
 
-// Function stubs
+`,
+  stubs: `// Function stubs
 <% for (const method of it.methods) { %>
 void <%= method.name %>(<% for (let i = 0; i < method.args.length; i++) { %>long <%= method.args[i].name %><% if (i < method.args.length - 1) { %>, <% } } %>) {
     // TODO: Implement <%= method.name %>
 
 }
 <% } %>
-`
+`,
+};
+
+export type SmartCSection = keyof typeof SmartCTemplateSections;
+
+export const SmartCSectionOrder = Object.keys(
+  SmartCTemplateSections,
+) as SmartCSection[];
+
+export const SmartCTemplate = SmartCSectionOrder.map(
+  (section) => SmartCTemplateSections[section],
+).join("");
@@ -0,0 +1,156 @@
+import type {
+  TransactionAggregation,
+  TransactionDefinition,
+  TransactionDelivery,
+  TransactionKind,
+} from "../parser";
+
+export const DefaultMaxRecipients = 4;
+
+const MessageLongs = 4;
+
+/** Arguments of the SmartC API functions, `message` being the buffer of four longs */
+const KindArguments: Record<TransactionKind, string[]> = {
+  sendAmount: ["amount", "recipient"],
+  sendMessage: ["message", "recipient"],
+  sendAmountAndMessage: ["amount", "message", "recipient"],
+  sendQuantity: ["quantity", "assetId", "recipient"],
+  sendQuantityAndAmount: ["quantity", "assetId", "amount", "recipient"],
+};
+
+export interface OutgoingValue {
+  /** Parameter of `<name>_send`, e.g. `message[1]` */
+  param: string;
+  /** The pending value - with perRecipient indexed by the slot `i` */
+  state: string;
+}
+
+export interface OutgoingTransaction {
+  name: string;
+  kind: TransactionKind;
+  delivery: TransactionDelivery;
+  aggregation: TransactionAggregation;
+  /** perRecipient only: number of slots */
+  capacity: number;
+  /** Parameters of `<name>_send` - those of the API function */
+  params: string;
+  /** The API call with the parameters */
+  call: string;
+  /** Values which select the pending transaction: the recipient and the asset */
+  keys: OutgoingValue[];
+  /** Values added up */
+  sums: OutgoingValue[];
+  /** Values replaced by every call */
+  lasts: OutgoingValue[];
+  /** On the keys - sum and last: the pending transaction differs, perRecipient: slot `i` matches */
+  condition: string;
+  declarations: string[];
+  /** Statements sending the pending transaction, of slot `i` with perRecipient */
+  sendPending: string[];
+}
+
+const isIdentifier = (name: string) => /^[A-Za-z_][A-Za-z0-9_]*$/.test(name);
+
+/**
+ * The outgoing transactions the generator emits `<name>_send(...)` for, i.e. those with a delivery.
+ *
+ * A batched transaction is kept pending in state variables and merged with the following calls, as
+ * long as they go to the same recipient (and asset). It is sent by `<name>_flush()`, which `main()`
+ * calls after the transaction loop - e.g. a certificate for the quantity of all receipts of a block
+ * instead of one per receipt, which saves the fee of every other transaction.
+ */
+export function planTransactions(
+  transactions: Readonly<TransactionDefinition[]>,
+): OutgoingTransaction[] {
+  return transactions
+    .filter((t) => t.delivery)
+    .map((t) => {
+      if (!isIdentifier(t.name)) {
+        throw new Error(`Transaction name is no valid C name: ${t.name}`);
+      }
+      const aggregation = t.aggregation ?? "sum";
+      const perRecipient = aggregation === "perRecipient";
+      const capacity = t.maxRecipients ?? DefaultMaxRecipients;
+      const args = KindArguments[t.kind];
+      const hasMessage = args.includes("message");
+
+      const value = (param: string, field: string): OutgoingValue => ({
+        param,
+        state: perRecipient ? `${t.name}_${field}[i]` : `${t.name}_${param}`,
+      });
+      const keys: OutgoingValue[] = [];
+      const sums: OutgoingValue[] = [];
+      const lasts: OutgoingValue[] = [];
+      for (const arg of args) {
+        if (arg === "recipient" || arg === "assetId") {
+          keys.push(value(arg, arg));
+        } else if (arg === "message") {
+          for (let i = 0; i < MessageLongs; i++) {
+            const long = value(`message[${i}]`, `message${i}`);
+            (i === 0 ? sums : lasts).push(long);
+          }
+        } else if (arg === "amount" && hasMessage) {
+          // the activation fee of the recipient
+          lasts.push(value(arg, arg));
+        } else {
+          sums.push(value(arg, arg));
+        }
+      }
+      if (aggregation === "last") lasts.unshift(...sums.splice(0));
+
+      const declarations: string[] = [];
+      const sendPending: string[] = [];
+      const pending = (arg: string) =>
+        arg === "message"
+          ? `${t.name}_message`
+          : perRecipient
+            ? `${t.name}_${arg}[i]`
+            : `${t.name}_${arg}`;
+      if (perRecipient) {
+        declarations.push(`long ${t.name}_count;`);
+        for (const arg of args) {
+          if (arg !== "message") {
+            declarations.push(`long ${t.name}_${arg}[${capacity}];`);
+            continue;
+          }
+          for (let i = 0; i < MessageLongs; i++) {
+            declarations.push(`long ${t.name}_message${i}[${capacity}];`);
+            sendPending.push(
+              `${t.name}_message[${i}] = ${t.name}_message${i}[i];`,
+            );
+          }
+        }
+      } else {
+        declarations.push(`long ${t.name}_pending;`);
+        for (const arg of args) {
+          if (arg !== "message") declarations.push(`long ${t.name}_${arg};`);
+        }
+      }
+      if (hasMessage) {
+        declarations.push(`long ${t.name}_message[${MessageLongs}];`);
+      }
+      sendPending.push(`${t.kind}(${args.map(pending).join(", ")});`);
+
+      return {
+        name: t.name,
+        kind: t.kind,
+        delivery: t.delivery!,
+        aggregation,
+        capacity,
+        params: args
+          .map((arg) => (arg === "message" ? "long * message" : `long ${arg}`))
+          .join(", "),
+        call: `${t.kind}(${args.join(", ")})`,
+        keys,
+        sums,
+        lasts,
+        condition: keys
+          .map(({ param, state }) =>
+            perRecipient ? `${state} == ${param}` : `${state} != ${param}`,
+          )
+          .join(perRecipient ? " && " : " || "),
+        declarations,
+        sendPending,
+      };
+    });
+}
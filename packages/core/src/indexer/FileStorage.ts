@@ -0,0 +1,29 @@
+import { mkdir, readFile, rename, writeFile } from "node:fs/promises";
+import { join } from "node:path";
+import type { MapStateStorage } from "./MapStateStorage";
+
+/** One `<name>.mapstate` file per contract in the directory */
+export class FileStorage implements MapStateStorage {
+  constructor(private readonly directory: string) {}
+
+  async read(name: string) {
+    try {
+      return new Uint8Array(await readFile(this.pathOf(name)));
+    } catch (e) {
+      if ((e as { code?: string }).code === "ENOENT") return undefined;
+      throw e;
+    }
+  }
+
+  async write(name: string, bytes: Uint8Array) {
+    await mkdir(this.directory, { recursive: true });
+    // a reader never sees a partially written state
+    const path = this.pathOf(name);
+    await writeFile(`${path}.tmp`, bytes);
+    await rename(`${path}.tmp`, path);
+  }
+
+  private pathOf(name: string) {
+    return join(this.directory, `${name}.mapstate`);
+  }
+}
@@ -0,0 +1,40 @@
+/// <reference lib="dom" />
+import type { MapStateStorage } from "./MapStateStorage";
+
+const StoreName = "mapstate";
+
+function request<T>(req: IDBRequest<T>) {
+  return new Promise<T>((resolve, reject) => {
+    req.onsuccess = () => resolve(req.result);
+    req.onerror = () => reject(req.error);
+  });
+}
+
+/** One record per contract in an object store of the database */
+export class IndexedDBStorage implements MapStateStorage {
+  private db?: Promise<IDBDatabase>;
+
+  constructor(private readonly databaseName = "scd-map-state") {}
+
+  async read(name: string) {
+    const store = await this.store("readonly");
+    const bytes = await request<Uint8Array | undefined>(store.get(name));
+    return bytes ?? undefined;
+  }
+
+  async write(name: string, bytes: Uint8Array) {
+    const store = await this.store("readwrite");
+    await request(store.put(bytes, name));
+  }
+
+  private async store(mode: IDBTransactionMode) {
+    this.db ??= new Promise((resolve, reject) => {
+      const open = indexedDB.open(this.databaseName, 1);
+      open.onupgradeneeded = () => open.result.createObjectStore(StoreName);
+      open.onsuccess = () => resolve(open.result);
+      open.onerror = () => reject(open.error);
+    });
+    const db = await this.db;
+    return db.transaction(StoreName, mode).objectStore(StoreName);
+  }
+}
@@ -0,0 +1,299 @@
+import {
+  type MapDefinition,
+  type MapItemDefinition,
+  parseLong,
+  type SCD,
+} from "../parser";
+import { fetchMapState, type NodeMapStateOptions } from "./MapStateSource";
+import type { MapStateStorage } from "./MapStateStorage";
+import {
+  type KeyRange,
+  type MapAggregate,
+  type MapEntry,
+  MapStateStore,
+} from "./MapStateStore";
+
+/** A decoded key or value - the name of an enum value, a boolean, a short string or a long */
+export type MapValue = bigint | boolean | string;
+
+/** An entry by the item names of the map definition - without a constant key1 */
+export type MapRecord = Record<string, MapValue>;
+
+export interface MapQuery {
+  /** Maps without a constant key1 only - all key1 if omitted */
+  key1?: MapValue;
+  key2?: MapValue;
+  /** key2 range, both inclusive */
+  from?: MapValue;
+  to?: MapValue;
+  where?: (entry: MapRecord) => boolean;
+  limit?: number;
+}
+
+function readText(value: bigint) {
+  let text = "";
+  for (let v = BigInt.asUintN(64, value); v; v >>= 8n) {
+    text += String.fromCharCode(Number(v & 0xffn));
+  }
+  return text;
+}
+
+function writeText(text: string) {
+  if (text.length > 8) throw new RangeError(`Text exceeds 8 bytes: ${text}`);
+  let value = 0n;
+  for (let i = text.length - 1; i >= 0; i--) {
+    value = (value << 8n) | BigInt(text.charCodeAt(i) & 0xff);
+  }
+  return BigInt.asIntN(64, value);
+}
+
+class ItemCodec {
+  private readonly names = new Map<bigint, string>();
+  private readonly values = new Map<string, bigint>();
+
+  constructor(
+    readonly name: string,
+    private readonly item: MapItemDefinition,
+  ) {
+    for (const { name, value } of item.oneOf ?? []) {
+      const v = parseLong(value);
+      this.names.set(v, name);
+      this.values.set(name, v);
+    }
+  }
+
+  decode(value: bigint): MapValue {
+    if (this.names.size) return this.names.get(value) ?? value;
+    if (this.item.type === "boolean") return value !== 0n;
+    if (this.item.type === "string") return readText(value);
+    return value;
+  }
+
+  encode(value: MapValue): bigint {
+    if (typeof value === "bigint") return value;
+    if (typeof value === "boolean") return value ? 1n : 0n;
+    const named = this.values.get(value);
+    if (named !== undefined) return named;
+    if (this.item.type === "string") return writeText(value);
+    try {
+      return parseLong(value);
+    } catch {
+      throw new Error(`Invalid value of ${this.name}: ${value}`);
+    }
+  }
+}
+
+// undefined if the value is no number - e.g. an expression - as it can't be told apart then
+function constantKey1(definition: MapDefinition, codec: ItemCodec) {
+  const { constant, value } = definition.key1;
+  if (!constant || value === undefined) return undefined;
+  try {
+    return BigInt.asIntN(64, codec.encode(value));
+  } catch {
+    return undefined;
+  }
+}
+
+interface IndexedMap {
+  definition: MapDefinition;
+  /** The constant key1 which identifies the map */
+  key1?: bigint;
+  codecs: { key1: ItemCodec; key2: ItemCodec; value: ItemCodec };
+}
+
+/**
+ * Typed queries on the map state of a contract, by the map definitions of its SCD: keys and values
+ * are decoded by type, enum values by name, and query bounds are encoded alike.
+ *
+ * The state lives in a `MapStateStore`, filled with snapshots from the node (`fetchMapState`, one
+ * call per key1) or the emulator (`machineMapState`) and kept current with deltas. A map without a
+ * constant key1 owns all key1 which are no constant key1 of another map.
+ */
+export class MapIndexer {
+  private readonly maps = new Map<string, IndexedMap>();
+  private readonly constantKeys = new Set<bigint>();
+
+  constructor(
+    scd: SCD,
+    readonly store = new MapStateStore(),
+  ) {
+    for (const definition of scd.getMaps()) {
+      const codecs = {
+        key1: new ItemCodec(definition.key1.name, definition.key1),
+        key2: new ItemCodec(definition.key2.name, definition.key2),
+        value: new ItemCodec(definition.value.name, definition.value),
+      };
+      const key1 = constantKey1(definition, codecs.key1);
+      if (key1 !== undefined) this.constantKeys.add(key1);
+      this.maps.set(definition.name, { definition, key1, codecs });
+    }
+  }
+
+  get mapNames() {
+    return [...this.maps.keys()];
+  }
+
+  /** Loads the state from the node - the key1 of maps without a constant one must be given */
+  async fetchSnapshot(
+    options: Omit<NodeMapStateOptions, "key1s"> & { key1s?: bigint[] },
+  ) {
+    const key1s = [
+      ...new Set([...this.constantKeys, ...(options.key1s ?? [])]),
+    ];
+    this.store.replace(await fetchMapState({ ...options, key1s }));
+  }
+
+  replace(entries: Iterable<MapEntry>) {
+    this.store.replace(entries);
+  }
+
+  apply(entries: Iterable<MapEntry>) {
+    this.store.apply(entries);
+  }
+
+  get(mapName: string, key2: MapValue, key1?: MapValue): MapValue {
+    const map = this.mapOf(mapName);
+    const k1 = this.key1Of(map, key1);
+    if (k1 === undefined) throw new Error(`Missing key1 of map: ${mapName}`);
+    return map.codecs.value.decode(
+      this.store.get(k1, map.codecs.key2.encode(key2)),
+    );
+  }
+
+  entries(mapName: string, query: MapQuery = {}): MapRecord[] {
+    const map = this.mapOf(mapName);
+    const records: MapRecord[] = [];
+    const range = this.rangeOf(map, query);
+    const limit = query.limit ?? Infinity;
+    for (const key1 of this.key1sOf(map, query)) {
+      for (const entry of this.store.entries(key1, range)) {
+        if (records.length >= limit) return records;
+        const record = this.decode(map, entry);
+        if (!query.where || query.where(record)) records.push(record);
+      }
+    }
+    return records;
+  }
+
+  /** Count, sum, minimum and maximum of the raw values */
+  aggregate(mapName: string, query: MapQuery = {}): MapAggregate {
+    const map = this.mapOf(mapName);
+    const range = this.rangeOf(map, query);
+    const result: MapAggregate = { count: 0, sum: 0n };
+    for (const key1 of this.key1sOf(map, query)) {
+      const part = query.where
+        ? this.aggregateWhere(map, key1, range, query.where)
+        : this.store.aggregate(key1, range);
+      result.count += part.count;
+      result.sum += part.sum;
+      if (
+        part.min !== undefined &&
+        (result.min === undefined || part.min < result.min)
+      ) {
+        result.min = part.min;
+      }
+      if (
+        part.max !== undefined &&
+        (result.max === undefined || part.max > result.max)
+      ) {
+        result.max = part.max;
+      }
+    }
+    return result;
+  }
+
+  /** Number of entries per decoded item, e.g. per status of an enum value */
+  countBy(
+    mapName: string,
+    item: "key1" | "key2" | "value",
+    query: MapQuery = {},
+  ): Map<MapValue, number> {
+    const map = this.mapOf(mapName);
+    const codec = map.codecs[item];
+    const index = item === "key1" ? 0 : item === "key2" ? 1 : 2;
+    const range = this.rangeOf(map, query);
+    const counts = new Map<MapValue, number>();
+    for (const key1 of this.key1sOf(map, query)) {
+      for (const entry of this.store.entries(key1, range)) {
+        if (query.where && !query.where(this.decode(map, entry))) continue;
+        const key = codec.decode(entry[index]);
+        counts.set(key, (counts.get(key) ?? 0) + 1);
+      }
+    }
+    return counts;
+  }
+
+  async save(storage: MapStateStorage, name: string) {
+    await storage.write(name, this.store.toBytes());
+  }
+
+  /** Restores the state saved under the name - false if there is none */
+  async load(storage: MapStateStorage, name: string) {
+    const bytes = await storage.read(name);
+    if (!bytes) return false;
+    this.store.replace(MapStateStore.fromBytes(bytes).entries());
+    return true;
+  }
+
+  private mapOf(name: string) {
+    const map = this.maps.get(name);
+    if (!map) throw new Error(`Unknown map: ${name}`);
+    return map;
+  }
+
+  private key1Of(map: IndexedMap, key1?: MapValue) {
+    if (map.key1 !== undefined) return map.key1;
+    return key1 === undefined
+      ? undefined
+      : BigInt.asIntN(64, map.codecs.key1.encode(key1));
+  }
+
+  private key1sOf(map: IndexedMap, query: MapQuery) {
+    const key1 = this.key1Of(map, query.key1);
+    if (key1 !== undefined) return [key1];
+    return this.store
+      .key1Values()
+      .filter((key1) => !this.constantKeys.has(key1));
+  }
+
+  private rangeOf(map: IndexedMap, query: MapQuery): KeyRange {
+    const { key2 } = map.codecs;
+    if (query.key2 !== undefined) {
+      const value = key2.encode(query.key2);
+      return { from: value, to: value };
+    }
+    return {
+      from: query.from === undefined ? undefined : key2.encode(query.from),
+      to: query.to === undefined ? undefined : key2.encode(query.to),
+    };
+  }
+
+  private decode(map: IndexedMap, [key1, key2, value]: MapEntry): MapRecord {
+    const { codecs } = map;
+    const record: MapRecord = {};
+    if (map.key1 === undefined) {
+      record[codecs.key1.name] = codecs.key1.decode(key1);
+    }
+    record[codecs.key2.name] = codecs.key2.decode(key2);
+    record[codecs.value.name] = codecs.value.decode(value);
+    return record;
+  }
+
+  private aggregateWhere(
+    map: IndexedMap,
+    key1: bigint,
+    range: KeyRange,
+    where: (entry: MapRecord) => boolean,
+  ) {
+    const result: MapAggregate = { count: 0, sum: 0n };
+    for (const entry of this.store.entries(key1, range)) {
+      if (!where(this.decode(map, entry))) continue;
+      const value = entry[2];
+      result.count++;
+      result.sum += value;
+      if (result.min === undefined || value < result.min) result.min = value;
+      if (result.max === undefined || value > result.max) result.max = value;
+    }
+    return result;
+  }
+}
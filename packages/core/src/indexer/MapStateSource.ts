@@ -0,0 +1,54 @@
+import type { MapEntry } from "./MapStateStore";
+
+/** The map state of an emulated contract, e.g. an `AtMachine` or a simulated contract */
+export function machineMapState(machine: {
+  mapEntries(): Iterable<MapEntry>;
+}): MapEntry[] {
+  return [...machine.mapEntries()];
+}
+
+export interface NodeMapStateOptions {
+  /** e.g. `http://localhost:8125` */
+  nodeUrl: string;
+  contractId: bigint;
+  /** The node lists the entries per key1 only */
+  key1s: readonly bigint[];
+  /** Replaces the global `fetch`, e.g. with a mock node in tests */
+  fetch?: (url: string) => Promise<Response>;
+}
+
+interface MapValuesResponse {
+  keyValues?: { key2: string; value: string }[];
+  errorCode?: number;
+  errorDescription?: string;
+}
+
+/**
+ * Loads the map state of a contract with one `getATMapValues` call per key1, instead of a
+ * `getATMapValue` call per entry. The calls run concurrently.
+ */
+export async function fetchMapState(
+  options: NodeMapStateOptions,
+): Promise<MapEntry[]> {
+  const fetchJson = options.fetch ?? fetch;
+  const base = options.nodeUrl.replace(/\/+$/, "");
+  const pages = await Promise.all(
+    options.key1s.map(async (key1) => {
+      const at = BigInt.asUintN(64, options.contractId);
+      const k1 = BigInt.asUintN(64, key1);
+      const url = `${base}/api?requestType=getATMapValues&at=${at}&key1=${k1}`;
+      const response = await fetchJson(url);
+      if (!response.ok) {
+        throw new Error(`getATMapValues failed: HTTP ${response.status}`);
+      }
+      const data = (await response.json()) as MapValuesResponse;
+      if (data.errorCode !== undefined) {
+        throw new Error(`getATMapValues failed: ${data.errorDescription}`);
+      }
+      return (data.keyValues ?? []).map(
+        ({ key2, value }): MapEntry => [key1, BigInt(key2), BigInt(value)],
+      );
+    }),
+  );
+  return pages.flat();
+}
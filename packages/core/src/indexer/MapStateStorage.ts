@@ -0,0 +1,20 @@
+/**
+ * Where the indexer keeps its map state between runs - see `FileStorage` for Bun or Node.js and
+ * `IndexedDBStorage` for the browser
+ */
+export interface MapStateStorage {
+  read(name: string): Promise<Uint8Array | undefined>;
+  write(name: string, bytes: Uint8Array): Promise<void>;
+}
+
+export class MemoryStorage implements MapStateStorage {
+  private readonly files = new Map<string, Uint8Array>();
+
+  async read(name: string) {
+    return this.files.get(name);
+  }
+
+  async write(name: string, bytes: Uint8Array) {
+    this.files.set(name, bytes.slice());
+  }
+}
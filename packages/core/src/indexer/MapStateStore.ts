@@ -0,0 +1,245 @@
+export type MapEntry = [key1: bigint, key2: bigint, value: bigint];
+
+export interface MapAggregate {
+  count: number;
+  sum: bigint;
+  /** Undefined if there are no entries */
+  min?: bigint;
+  max?: bigint;
+}
+
+/** Bounds of a key2 range, both inclusive */
+export interface KeyRange {
+  from?: bigint;
+  to?: bigint;
+}
+
+const Magic = 0x4d444353; // "SCDM"
+const Version = 1;
+const HeaderBytes = 12;
+const MinLong = -(1n << 63n);
+const MaxLong = (1n << 63n) - 1n;
+
+const asLong = (value: bigint) => BigInt.asIntN(64, value);
+
+function compareKeys(a1: bigint, a2: bigint, b1: bigint, b2: bigint) {
+  if (a1 !== b1) return a1 < b1 ? -1 : 1;
+  if (a2 !== b2) return a2 < b2 ? -1 : 1;
+  return 0;
+}
+
+/**
+ * The map state of a contract as three sorted columns - key1, key2 and value - so a key1 and a
+ * key2 range are found by binary search, and aggregates run over a slice of the value column.
+ *
+ * Changes are collected in an overlay and merged into the columns on the next query, so a delta of
+ * a block costs a sort of its own entries only. As on the chain, a value of zero removes the entry.
+ * Keys are compared as signed longs, like the contract does.
+ */
+export class MapStateStore {
+  private key1s = new BigInt64Array(0);
+  private key2s = new BigInt64Array(0);
+  private values = new BigInt64Array(0);
+  private length = 0;
+  private pending = new Map<bigint, Map<bigint, bigint>>();
+
+  /** Replaces the whole state, e.g. with a snapshot of the node or the emulator */
+  replace(entries: Iterable<MapEntry>) {
+    this.length = 0;
+    this.pending.clear();
+    this.apply(entries);
+    this.compact();
+  }
+
+  /** Applies changed entries, a value of zero removes the entry */
+  apply(entries: Iterable<MapEntry>) {
+    for (const [key1, key2, value] of entries) {
+      this.set(key1, key2, value);
+    }
+  }
+
+  set(key1: bigint, key2: bigint, value: bigint) {
+    const k1 = asLong(key1);
+    let inner = this.pending.get(k1);
+    if (!inner) {
+      inner = new Map();
+      this.pending.set(k1, inner);
+    }
+    inner.set(asLong(key2), asLong(value));
+  }
+
+  get(key1: bigint, key2: bigint) {
+    this.compact();
+    const k1 = asLong(key1);
+    const k2 = asLong(key2);
+    const i = this.search(k1, k2, false);
+    return i < this.length && this.key1s[i] === k1 && this.key2s[i] === k2
+      ? this.values[i]!
+      : 0n;
+  }
+
+  get size() {
+    this.compact();
+    return this.length;
+  }
+
+  /** The distinct key1 values, ascending */
+  key1Values(): bigint[] {
+    this.compact();
+    const keys: bigint[] = [];
+    for (let i = 0; i < this.length; i++) {
+      if (i === 0 || this.key1s[i] !== this.key1s[i - 1]) {
+        keys.push(this.key1s[i]!);
+      }
+    }
+    return keys;
+  }
+
+  /** Entries of key1 in the key2 range, ascending by key2 - all entries without a key1 */
+  *entries(key1?: bigint, range: KeyRange = {}): Generator<MapEntry> {
+    const [start, end] = this.bounds(key1, range);
+    for (let i = start; i < end; i++) {
+      yield [this.key1s[i]!, this.key2s[i]!, this.values[i]!];
+    }
+  }
+
+  aggregate(key1?: bigint, range: KeyRange = {}): MapAggregate {
+    const [start, end] = this.bounds(key1, range);
+    const result: MapAggregate = { count: end - start, sum: 0n };
+    const values = this.values;
+    for (let i = start; i < end; i++) {
+      const value = values[i]!;
+      result.sum += value;
+      if (result.min === undefined || value < result.min) result.min = value;
+      if (result.max === undefined || value > result.max) result.max = value;
+    }
+    return result;
+  }
+
+  /** Little endian, the three columns after a header with their length */
+  toBytes(): Uint8Array {
+    this.compact();
+    const n = this.length;
+    const bytes = new Uint8Array(HeaderBytes + n * 24);
+    const view = new DataView(bytes.buffer);
+    view.setUint32(0, Magic, true);
+    view.setUint32(4, Version, true);
+    view.setUint32(8, n, true);
+    let at = HeaderBytes;
+    for (const column of [this.key1s, this.key2s, this.values]) {
+      for (let i = 0; i < n; i++, at += 8) {
+        view.setBigInt64(at, column[i]!, true);
+      }
+    }
+    return bytes;
+  }
+
+  static fromBytes(bytes: Uint8Array) {
+    const view = new DataView(
+      bytes.buffer,
+      bytes.byteOffset,
+      bytes.byteLength,
+    );
+    if (
+      bytes.byteLength < HeaderBytes ||
+      view.getUint32(0, true) !== Magic ||
+      view.getUint32(4, true) !== Version
+    ) {
+      throw new Error("Invalid map state");
+    }
+    const n = view.getUint32(8, true);
+    if (bytes.byteLength !== HeaderBytes + n * 24) {
+      throw new Error("Invalid map state: truncated");
+    }
+    const store = new MapStateStore();
+    const columns = [0, 1, 2].map(() => new BigInt64Array(n));
+    let at = HeaderBytes;
+    for (const column of columns) {
+      for (let i = 0; i < n; i++, at += 8) {
+        column[i] = view.getBigInt64(at, true);
+      }
+    }
+    [store.key1s, store.key2s, store.values] = columns as [
+      BigInt64Array,
+      BigInt64Array,
+      BigInt64Array,
+    ];
+    store.length = n;
+    return store;
+  }
+
+  private bounds(key1: bigint | undefined, range: KeyRange): [number, number] {
+    this.compact();
+    if (key1 === undefined) return [0, this.length];
+    const k1 = asLong(key1);
+    const from = range.from === undefined ? MinLong : asLong(range.from);
+    const to = range.to === undefined ? MaxLong : asLong(range.to);
+    if (from > to) return [0, 0];
+    return [this.search(k1, from, false), this.search(k1, to, true)];
+  }
+
+  // first index after (key1, key2) if `after`, else the first not before it
+  private search(key1: bigint, key2: bigint, after: boolean) {
+    let lo = 0;
+    let hi = this.length;
+    while (lo < hi) {
+      const mid = (lo + hi) >>> 1;
+      const k1 = this.key1s[mid]!;
+      const order = compareKeys(k1, this.key2s[mid]!, key1, key2);
+      if (order < 0 || (after && order === 0)) lo = mid + 1;
+      else hi = mid;
+    }
+    return lo;
+  }
+
+  // merges the sorted overlay into the columns, dropping the removed entries
+  private compact() {
+    if (!this.pending.size) return;
+    const changes: MapEntry[] = [];
+    for (const [key1, inner] of this.pending) {
+      for (const [key2, value] of inner) changes.push([key1, key2, value]);
+    }
+    this.pending.clear();
+    changes.sort((a, b) => compareKeys(a[0], a[1], b[0], b[1]));
+
+    const capacity = this.length + changes.length;
+    const key1s = new BigInt64Array(capacity);
+    const key2s = new BigInt64Array(capacity);
+    const values = new BigInt64Array(capacity);
+    let n = 0;
+    let i = 0;
+    let j = 0;
+    while (i < this.length || j < changes.length) {
+      const change = changes[j];
+      const order =
+        i >= this.length
+          ? 1
+          : !change
+            ? -1
+            : compareKeys(
+                this.key1s[i]!,
+                this.key2s[i]!,
+                change[0],
+                change[1],
+              );
+      if (order < 0) {
+        key1s[n] = this.key1s[i]!;
+        key2s[n] = this.key2s[i]!;
+        values[n++] = this.values[i++]!;
+        continue;
+      }
+      // the change replaces an equal entry
+      if (order === 0) i++;
+      j++;
+      if (change![2] === 0n) continue;
+      key1s[n] = change![0];
+      key2s[n] = change![1];
+      values[n++] = change![2];
+    }
+    this.key1s = key1s;
+    this.key2s = key2s;
+    this.values = values;
+    this.length = n;
+  }
+}
+
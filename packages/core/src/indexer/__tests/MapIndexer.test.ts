@@ -0,0 +1,185 @@
+import { describe, expect, it } from "bun:test";
+import { mkdtemp, rm } from "node:fs/promises";
+import { tmpdir } from "node:os";
+import { join } from "node:path";
+import { SCD, type SCDType } from "../../parser";
+import { mockSCD } from "../../generator/__tests/mock-scd";
+import { AtMachine } from "../../vm";
+import { ApiFunction as Fun } from "../../vm/api-functions";
+import { OpCode } from "../../vm/opcodes";
+import { machineCode } from "../../vm/__tests/assemble";
+import { FileStorage } from "../FileStorage";
+import { MapIndexer } from "../MapIndexer";
+import { machineMapState } from "../MapStateSource";
+import { MemoryStorage } from "../MapStateStorage";
+
+const Status = [
+  { name: "OPEN", value: "1" },
+  { name: "DONE", value: "2" },
+];
+
+const scd = SCD.parse({
+  ...mockSCD,
+  maps: [
+    {
+      name: "incoming",
+      key1: { name: "key", type: "long", constant: true, value: "1" },
+      key2: { name: "sender", type: "address" },
+      value: { name: "status", type: "enum", oneOf: Status },
+    },
+    {
+      name: "groups",
+      key1: { name: "group", type: "string" },
+      key2: { name: "member", type: "address" },
+      value: { name: "active", type: "boolean" },
+    },
+  ],
+} satisfies SCDType);
+
+const text = (s: string) =>
+  [...s].reduceRight((v, c) => (v << 8n) | BigInt(c.charCodeAt(0)), 0n);
+
+function indexer() {
+  const indexer = new MapIndexer(scd);
+  indexer.replace([
+    [1n, 10n, 1n],
+    [1n, 11n, 2n],
+    [1n, 12n, 2n],
+    [text("admins"), 10n, 1n],
+    [text("users"), 11n, 1n],
+    [text("users"), 12n, 0n],
+  ]);
+  return indexer;
+}
+
+describe("MapIndexer", () => {
+  it("should decode the entries by the map definition", () => {
+    const index = indexer();
+    expect(index.entries("incoming", { from: 11n })).toEqual([
+      { sender: 11n, status: "DONE" },
+      { sender: 12n, status: "DONE" },
+    ]);
+    expect(index.get("incoming", "10")).toBe("OPEN");
+    // the constant key1 of `incoming` is no group, the groups are ordered by their long
+    expect(index.entries("groups")).toEqual([
+      { group: "users", member: 11n, active: true },
+      { group: "admins", member: 10n, active: true },
+    ]);
+    expect(index.get("groups", 11n, "users")).toBe(true);
+    expect(() => index.get("groups", 11n)).toThrow("Missing key1");
+    expect(() => index.entries("unknown")).toThrow("Unknown map");
+  });
+
+  it("should filter, count and aggregate", () => {
+    const index = indexer();
+    expect(
+      index.entries("incoming", {
+        where: (e) => e.status === "DONE",
+        limit: 1,
+      }),
+    ).toEqual([{ sender: 11n, status: "DONE" }]);
+    expect([...index.countBy("incoming", "value")]).toEqual([
+      ["OPEN", 1],
+      ["DONE", 2],
+    ]);
+    expect(index.aggregate("incoming")).toEqual({
+      count: 3,
+      sum: 5n,
+      min: 1n,
+      max: 2n,
+    });
+    expect(
+      index.aggregate("incoming", { where: (e) => e.status === "OPEN" }).count,
+    ).toBe(1);
+    expect(index.aggregate("groups").count).toBe(2);
+    expect(index.aggregate("groups", { key1: "users" }).count).toBe(1);
+
+    index.apply([[1n, 10n, 2n]]);
+    expect(index.countBy("incoming", "value").get("DONE")).toBe(3);
+  });
+
+  it("should index the map state of the emulator", () => {
+    const machine = new AtMachine(
+      machineCode(
+        [
+          [OpCode.SET_VAL, 0, 1n],
+          [OpCode.SET_VAL, 1, 42n],
+          [OpCode.SET_VAL, 2, 2n],
+          [OpCode.EXT_FUN_DAT_2, Fun.set_A1_A2, 0, 1],
+          [OpCode.EXT_FUN_DAT, Fun.set_A4, 2],
+          [OpCode.EXT_FUN, Fun.Set_Map_Value_Keys_In_A],
+          [OpCode.FIN_IMD],
+        ],
+        ["key", "sender", "status"],
+      ),
+    );
+    machine.queueTransaction({ sender: 1n, amount: 2_0000_0000n });
+    machine.runBlock();
+
+    const index = new MapIndexer(scd);
+    index.replace(machineMapState(machine));
+    expect(index.entries("incoming")).toEqual([
+      { sender: 42n, status: "DONE" },
+    ]);
+  });
+
+  it("should load the snapshot with one call per key1", async () => {
+    const urls: string[] = [];
+    const mockNode = async (url: string) => {
+      urls.push(url);
+      const key1 = new URL(url).searchParams.get("key1");
+      const keyValues =
+        key1 === "1"
+          ? [{ key2: "18446744073709551615", value: "1" }]
+          : [{ key2: "7", value: "1" }];
+      return Response.json({ keyValues, requestProcessingTime: 0 });
+    };
+
+    const index = new MapIndexer(scd);
+    await index.fetchSnapshot({
+      nodeUrl: "http://localhost:8125/",
+      contractId: -2n,
+      key1s: [text("admins")],
+      fetch: mockNode,
+    });
+    const call = "http://localhost:8125/api?requestType=getATMapValues";
+    expect(urls).toEqual([
+      `${call}&at=18446744073709551614&key1=1`,
+      `${call}&at=18446744073709551614&key1=${text("admins")}`,
+    ]);
+    expect(index.get("incoming", -1n)).toBe("OPEN");
+    expect(index.entries("groups")).toEqual([
+      { group: "admins", member: 7n, active: true },
+    ]);
+
+    await expect(
+      index.fetchSnapshot({
+        nodeUrl: "http://localhost:8125",
+        contractId: 1n,
+        fetch: async () =>
+          Response.json({ errorCode: 5, errorDescription: "Unknown AT" }),
+      }),
+    ).rejects.toThrow("Unknown AT");
+  });
+
+  it("should save and load the state", async () => {
+    const memory = new MemoryStorage();
+    await indexer().save(memory, "contract");
+    const restored = new MapIndexer(scd);
+    expect(await restored.load(memory, "contract")).toBe(true);
+    expect(restored.aggregate("incoming").count).toBe(3);
+    expect(await restored.load(memory, "other")).toBe(false);
+
+    const directory = await mkdtemp(join(tmpdir(), "scd-indexer-"));
+    try {
+      const files = new FileStorage(directory);
+      expect(await files.read("contract")).toBeUndefined();
+      await indexer().save(files, "contract");
+      const fromFile = new MapIndexer(scd);
+      expect(await fromFile.load(files, "contract")).toBe(true);
+      expect(fromFile.entries("groups")).toHaveLength(2);
+    } finally {
+      await rm(directory, { recursive: true });
+    }
+  });
+});
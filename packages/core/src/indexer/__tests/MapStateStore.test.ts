@@ -0,0 +1,72 @@
+import { describe, expect, it } from "bun:test";
+import { type MapEntry, MapStateStore } from "../MapStateStore";
+
+describe("MapStateStore", () => {
+  it("should merge deltas and remove zero values", () => {
+    const store = new MapStateStore();
+    store.replace([
+      [2n, 1n, 10n],
+      [1n, 5n, 50n],
+      [1n, -3n, 30n],
+    ]);
+    store.apply([
+      [1n, 5n, 0n],
+      [1n, 7n, 70n],
+      [2n, 1n, 11n],
+      [3n, 0n, 0n],
+    ]);
+    expect([...store.entries()]).toEqual([
+      [1n, -3n, 30n],
+      [1n, 7n, 70n],
+      [2n, 1n, 11n],
+    ]);
+    expect(store.get(1n, 5n)).toBe(0n);
+    expect(store.get(2n, 1n)).toBe(11n);
+    expect(store.key1Values()).toEqual([1n, 2n]);
+
+    // unsigned ids wrap around as on the chain
+    store.set(2n, (1n << 64n) - 1n, 1n);
+    expect(store.get(2n, -1n)).toBe(1n);
+  });
+
+  it("should query key2 ranges and aggregate them", () => {
+    const store = new MapStateStore();
+    store.replace(
+      // a zero value is no entry
+      Array.from(
+        { length: 100 },
+        (_, i): MapEntry => [1n, BigInt(i), BigInt(i + 1)],
+      ),
+    );
+    store.set(2n, 5n, 1000n);
+
+    const range = [...store.entries(1n, { from: 10n, to: 12n })];
+    expect(range.map((e) => e[1])).toEqual([10n, 11n, 12n]);
+    expect([...store.entries(1n, { from: 98n })]).toHaveLength(2);
+    expect([...store.entries(1n, { from: 5n, to: 4n })]).toHaveLength(0);
+    expect(store.aggregate(1n)).toEqual({
+      count: 100,
+      sum: 5050n,
+      min: 1n,
+      max: 100n,
+    });
+    expect(store.aggregate(1n, { to: 9n }).sum).toBe(55n);
+    expect(store.aggregate(3n)).toEqual({ count: 0, sum: 0n });
+    expect(store.aggregate().count).toBe(101);
+  });
+
+  it("should persist the columns", () => {
+    const store = new MapStateStore();
+    store.replace([
+      [1n, 2n, -3n],
+      [-4n, 5n, 6n],
+    ]);
+    const bytes = store.toBytes();
+    expect(bytes.byteLength).toBe(12 + 2 * 24);
+    const restored = MapStateStore.fromBytes(bytes);
+    expect([...restored.entries()]).toEqual([...store.entries()]);
+    expect(() => MapStateStore.fromBytes(bytes.subarray(0, 20))).toThrow(
+      "Invalid map state",
+    );
+  });
+});
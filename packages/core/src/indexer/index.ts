@@ -0,0 +1,4 @@
+export * from "./MapStateStore";
+export * from "./MapStateStorage";
+export * from "./MapStateSource";
+export * from "./MapIndexer";
@@ -0,0 +1,338 @@
+import { parseLong } from "./parseLong";
+import {
+  type SCDCheck,
+  type SCDValidationError,
+  schemaCheckAt,
+} from "./validateSCD";
+
+type Container = Record<string, unknown>;
+
+const isContainer = (value: unknown): value is Container =>
+  !!value && typeof value === "object";
+
+const escapeKey = (key: string) =>
+  key.replaceAll("~", "~0").replaceAll("/", "~1");
+
+const toPointer = (keys: string[]) =>
+  keys.map((key) => `/${escapeKey(key)}`).join("");
+
+/** Splits a JSON pointer into its (unescaped) keys */
+export function parsePointer(pointer: string): string[] {
+  if (!pointer) return [];
+  if (!pointer.startsWith("/")) {
+    throw new Error(`Invalid JSON pointer: ${pointer}`);
+  }
+  return pointer
+    .slice(1)
+    .split("/")
+    .map((key) => key.replaceAll("~1", "/").replaceAll("~0", "~"));
+}
+
+function getIn(value: unknown, keys: string[]) {
+  for (const key of keys) {
+    if (!isContainer(value)) return undefined;
+    value = value[key];
+  }
+  return value;
+}
+
+/** Copies the path only, the other sub-trees are shared */
+function setIn(target: unknown, keys: string[], value: unknown): unknown {
+  if (!keys.length) return value;
+  const [key, ...rest] = keys as [string, ...string[]];
+  const copy: Container = Array.isArray(target)
+    ? ([...target] as unknown as Container)
+    : isContainer(target)
+      ? { ...target }
+      : {};
+  const next = setIn(copy[key], rest, value);
+  if (next === undefined) {
+    delete copy[key];
+  } else {
+    copy[key] = next;
+  }
+  return copy;
+}
+
+const text = (value: unknown) =>
+  typeof value === "string" ? value : undefined;
+
+// "1_000" and "01000" are the same code
+function normalizeNumber(value: unknown) {
+  const digits = text(value)?.replaceAll("_", "");
+  return digits && /^[0-9]+$/.test(digits)
+    ? parseLong(digits).toString()
+    : digits;
+}
+
+/**
+ * Index of a property, which must be unique in a collection of the SCD. It's updated per item,
+ * and keeps the colliding keys, such that the errors are reported without scanning the collection.
+ */
+class UniqueIndex {
+  private keys: (string | undefined)[] = [];
+  private items = new Map<string, Set<number>>();
+  private collisions = new Set<string>();
+
+  constructor(
+    readonly collection: "methods" | "variables" | "maps",
+    private property: string,
+    private keyOf: (item: Container) => string | undefined,
+    private label: string,
+  ) {}
+
+  rebuild(items: unknown) {
+    this.keys = [];
+    this.items.clear();
+    this.collisions.clear();
+    if (Array.isArray(items)) items.forEach((item, i) => this.set(i, item));
+  }
+
+  set(index: number, item: unknown) {
+    const previous = this.keys[index];
+    if (previous !== undefined) {
+      const indices = this.items.get(previous)!;
+      indices.delete(index);
+      if (indices.size < 2) this.collisions.delete(previous);
+      if (!indices.size) this.items.delete(previous);
+    }
+    const key = isContainer(item) ? this.keyOf(item) : undefined;
+    this.keys[index] = key;
+    if (key === undefined) return;
+    const indices = this.items.get(key) ?? new Set();
+    indices.add(index);
+    this.items.set(key, indices);
+    if (indices.size > 1) this.collisions.add(key);
+  }
+
+  *errors(): Generator<SCDValidationError> {
+    for (const key of this.collisions) {
+      const [first, ...duplicates] = [...this.items.get(key)!].sort(
+        (a, b) => a - b,
+      );
+      for (const index of duplicates) {
+        yield {
+          instancePath: `/${this.collection}/${index}/${this.property}`,
+          keyword: "unique",
+          message: `duplicate ${this.label} ${key} - also at /${this.collection}/${first}`,
+        };
+      }
+    }
+  }
+}
+
+function structFieldErrors(variable: unknown, index: number) {
+  const errors: SCDValidationError[] = [];
+  if (!isContainer(variable) || !Array.isArray(variable.fields)) return errors;
+  const names = new Map<string, number>();
+  variable.fields.forEach((field, i) => {
+    if (!isContainer(field) || typeof field.name !== "string") return;
+    const first = names.get(field.name);
+    if (first === undefined) {
+      names.set(field.name, i);
+      return;
+    }
+    errors.push({
+      instancePath: `/variables/${index}/fields/${i}/name`,
+      keyword: "unique",
+      message: `duplicate field name ${field.name} - also at /variables/${index}/fields/${first}`,
+    });
+  });
+  return errors;
+}
+
+/**
+ * Validates an SCD while it's edited: a change revalidates the changed sub-tree against its
+ * sub-schema only, instead of the whole document.
+ *
+ * Unlike `validateSCD` it reports all errors, and the cross references, which the schema cannot
+ * express: unique method codes and names, variable and map names, constant map keys (`key1`) and
+ * struct field names. These are kept in indexes, which are updated per changed item.
+ */
+export class IncrementalValidator {
+  private document: unknown;
+  private schemaErrors = new Map<string, SCDValidationError>();
+  private fieldErrors = new Map<number, SCDValidationError[]>();
+  private indexes = [
+    new UniqueIndex(
+      "methods",
+      "code",
+      (m) => normalizeNumber(m.code),
+      "method code",
+    ),
+    new UniqueIndex("methods", "name", (m) => text(m.name), "method name"),
+    new UniqueIndex(
+      "variables",
+      "name",
+      (v) => text(v.name),
+      "variable name",
+    ),
+    new UniqueIndex("maps", "name", (m) => text(m.name), "map name"),
+    new UniqueIndex(
+      "maps",
+      "key1/value",
+      (m) =>
+        isContainer(m.key1) && m.key1.constant
+          ? normalizeNumber(m.key1.value)
+          : undefined,
+      "constant map key",
+    ),
+  ];
+
+  constructor(document?: unknown) {
+    this.document = document;
+    this.revalidate([]);
+  }
+
+  /** The validated document - changed paths are copies, such that the passed values are not mutated */
+  get value(): unknown {
+    return this.document;
+  }
+
+  get errors(): SCDValidationError[] {
+    return [
+      ...this.schemaErrors.values(),
+      ...this.indexes.flatMap((index) => [...index.errors()]),
+      ...[...this.fieldErrors.values()].flat(),
+    ];
+  }
+
+  get isValid(): boolean {
+    return (
+      !this.schemaErrors.size &&
+      !this.fieldErrors.size &&
+      this.indexes.every((index) => index.errors().next().done)
+    );
+  }
+
+  /**
+   * Replaces the value at the JSON pointer - `undefined` removes the property - and revalidates it
+   */
+  update(pointer: string, value: unknown): SCDValidationError[] {
+    const keys = parsePointer(pointer);
+    this.document = setIn(this.document, keys, value);
+    this.revalidate(keys);
+    return this.errors;
+  }
+
+  /**
+   * Revalidates the changes to the next version of the document. Sub-trees which are the same
+   * (by reference, e.g. of immutable form state, or by value) are skipped. An array of another
+   * length is revalidated as a whole.
+   */
+  sync(next: unknown): SCDValidationError[] {
+    const changes: string[][] = [];
+    this.diff(this.document, next, [], changes);
+    this.document = next;
+    for (const keys of changes) this.revalidate(keys);
+    return this.errors;
+  }
+
+  private diff(
+    prev: unknown,
+    next: unknown,
+    keys: string[],
+    changes: string[][],
+  ) {
+    if (prev === next) return;
+    const sameShape =
+      isContainer(prev) &&
+      isContainer(next) &&
+      Array.isArray(prev) === Array.isArray(next) &&
+      (!Array.isArray(prev) || prev.length === (next as unknown[]).length);
+    if (!sameShape) {
+      changes.push(keys);
+      return;
+    }
+    for (const key of new Set([...Object.keys(prev), ...Object.keys(next)])) {
+      this.diff(prev[key], next[key], [...keys, key], changes);
+    }
+  }
+
+  private revalidate(keys: string[]) {
+    const pointer = toPointer(keys);
+    this.dropSchemaErrors(pointer);
+    const value = getIn(this.document, keys);
+    const check = schemaCheckAt(pointer);
+    if (check && value !== undefined) this.validateTree(value, check, pointer);
+
+    // the ancestors check the required properties - and a map the key1 of its collection
+    for (let depth = keys.length - 1; depth >= 0; depth--) {
+      const parentKeys = keys.slice(0, depth);
+      const parentPointer = toPointer(parentKeys);
+      const parentCheck = schemaCheckAt(parentPointer);
+      const parent = getIn(this.document, parentKeys);
+      const hadError = this.schemaErrors.delete(parentPointer);
+      const error =
+        parentCheck &&
+        (parentCheck.shallow ?? parentCheck)(parent, parentPointer);
+      if (error) {
+        this.schemaErrors.set(parentPointer, error);
+      } else if (hadError && parentCheck) {
+        // the children of an invalid parent were not validated yet
+        this.dropSchemaErrors(parentPointer);
+        this.validateTree(parent, parentCheck, parentPointer);
+      }
+    }
+    this.updateIndexes(keys);
+  }
+
+  /** Validates the value and all children, collecting all errors */
+  private validateTree(value: unknown, check: SCDCheck, path: string) {
+    const error = (check.shallow ?? check)(value, path);
+    if (error) {
+      this.schemaErrors.set(path, error);
+      return;
+    }
+    if (!check.child || !isContainer(value)) return;
+    for (const [key, child] of Object.entries(value)) {
+      const childCheck = check.child(key);
+      if (childCheck && child !== undefined) {
+        this.validateTree(child, childCheck, `${path}/${escapeKey(key)}`);
+      }
+    }
+  }
+
+  private dropSchemaErrors(pointer: string) {
+    for (const path of this.schemaErrors.keys()) {
+      if (path === pointer || path.startsWith(`${pointer}/`)) {
+        this.schemaErrors.delete(path);
+      }
+    }
+  }
+
+  private updateIndexes([collection, item]: string[]) {
+    const index = Number(item);
+    const isItem = item !== undefined && Number.isInteger(index);
+    const value = isItem ? getIn(this.document, [collection!, item]) : undefined;
+    for (const uniqueIndex of this.indexes) {
+      if (collection !== undefined && uniqueIndex.collection !== collection) {
+        continue;
+      }
+      if (isItem) {
+        uniqueIndex.set(index, value);
+      } else {
+        uniqueIndex.rebuild(getIn(this.document, [uniqueIndex.collection]));
+      }
+    }
+    if (collection !== undefined && collection !== "variables") return;
+    if (isItem) {
+      this.setFieldErrors(index, value);
+    } else {
+      this.fieldErrors.clear();
+      const variables = getIn(this.document, ["variables"]);
+      if (Array.isArray(variables)) {
+        variables.forEach((variable, i) => this.setFieldErrors(i, variable));
+      }
+    }
+  }
+
+  private setFieldErrors(index: number, variable: unknown) {
+    const errors = structFieldErrors(variable, index);
+    if (errors.length) {
+      this.fieldErrors.set(index, errors);
+    } else {
+      this.fieldErrors.delete(index);
+    }
+  }
+}
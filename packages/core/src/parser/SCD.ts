@@ -1,22 +1,56 @@
-import Ajv from "ajv";
-import schema from "./scd-schema.json";
 import type {
   MethodDefinition,
   SCDType,
   MapDefinition,
   VariableDefinition,
+  VariableLayout,
   TransactionDefinition,
 } from "./types";
+import { parseLong } from "./parseLong";
+import { type SCDValidator, validateSCD } from "./validateSCD";
+
+const BitsPerLong = 64;
+const PackedWordPrefix = "_packed";
+
+/**
+ * Bits needed by a boolean or an enum-typed long, or null if it needs a long of its own.
+ * Initializable and constant variables are set by name on deployment, so are never packed.
+ */
+function packedBits(variable: VariableDefinition) {
+  if (variable.initializable || variable.constant) return null;
+  if (variable.type === "boolean") return 1;
+  if (!variable.oneOf?.length) return null;
+  let max = 0n;
+  for (const { value } of variable.oneOf) {
+    let v: bigint;
+    try {
+      v = parseLong(value);
+    } catch {
+      return null;
+    }
+    if (v < 0n) return null;
+    if (v > max) max = v;
+  }
+  const bits = Math.max(1, max.toString(2).length);
+  // a wider enum does not share its long with much else
+  return bits < BitsPerLong / 2 ? bits : null;
+}
 
 /**
  * This is the ABI class which provides convenience functions for further tooling.
  */
 export class SCD {
-  private static ajv = new Ajv();
-  private static validate = SCD.ajv.compile<SCDType>(schema);
+  private static validate: SCDValidator = validateSCD;
 
   private constructor(private scd: SCDType) {}
 
+  /**
+   * Replaces the precompiled validator, e.g. with the Ajv based `createAjvValidator`
+   */
+  static useValidator(validator: SCDValidator) {
+    this.validate = validator;
+  }
+
   static parse(input: string | object) {
     const valid = this.validate(input);
 
@@ -29,28 +63,71 @@ export class SCD {
 
   get raw(): SCDType { return this.scd}
 
-  getVariablesLayout() {
-    let currentIndex = this.scd.pragmas.maxAuxVars + 1;
-    const layout: (VariableDefinition & { index: number })[] = [];
+  /**
+   * Copy of this SCD with the given pragmas replaced, e.g. the stack pages recommended by `advisePages`
+   */
+  withPragmas(pragmas: Partial<SCDType["pragmas"]>) {
+    return SCD.parse({
+      ...this.scd,
+      pragmas: { ...this.scd.pragmas, ...pragmas },
+    });
+  }
+
+  /**
+   * Memory layout of the variables and struct fields, starting after the auxiliary variables.
+   * With `packedLayout` booleans and enum-typed longs share longs (`packed`), placed after all others
+   * by first fit decreasing - the order of the variables is kept otherwise.
+   */
+  getVariablesLayout(): VariableLayout[] {
+    const packing = !!this.scd.packedLayout;
+    const bitsOf = (v: VariableDefinition) => (packing ? packedBits(v) : null);
+    const entries: [VariableLayout, bits: number | null][] = [];
     for (const variable of this.scd.variables) {
       if (variable.type === "struct") {
         // Handle struct fields
-        const fields =
-          variable.fields?.map((field) => ({
-            ...field,
-            name: `${variable.name}.${field.name}`,
-            index: currentIndex++,
-          })) || [];
-
-        layout.push(...fields);
+        for (const field of variable.fields ?? []) {
+          entries.push([
+            { ...field, name: `${variable.name}.${field.name}`, index: 0 },
+            bitsOf(field),
+          ]);
+        }
       } else {
-        layout.push({
-          ...variable,
-          index: currentIndex++,
-        });
+        entries.push([{ ...variable, index: 0 }, bitsOf(variable)]);
       }
     }
 
+    let currentIndex = this.scd.pragmas.maxAuxVars + 1;
+    const layout: VariableLayout[] = [];
+    const packable: [VariableLayout, number][] = [];
+    for (const [entry, bits] of entries) {
+      if (bits !== null) {
+        packable.push([entry, bits]);
+      } else {
+        entry.index = currentIndex++;
+        layout.push(entry);
+      }
+    }
+    if (!packable.length) return layout;
+
+    // stable sort, so equally wide entries keep their order
+    packable.sort((a, b) => b[1] - a[1]);
+    const words: { index: number; used: number; entries: VariableLayout[] }[] = [];
+    for (const [entry, bits] of packable) {
+      let word = words.find((w) => w.used + bits <= BitsPerLong);
+      if (!word) {
+        word = { index: currentIndex++, used: 0, entries: [] };
+        words.push(word);
+      }
+      entry.index = word.index;
+      entry.packed = {
+        word: `${PackedWordPrefix}${words.indexOf(word)}`,
+        bit: word.used,
+        bits,
+      };
+      word.used += bits;
+      word.entries.push(entry);
+    }
+    for (const word of words) layout.push(...word.entries);
     return layout;
   }
 
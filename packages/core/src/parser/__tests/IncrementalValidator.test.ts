@@ -0,0 +1,157 @@
+import { describe, expect, it } from "bun:test";
+import { IncrementalValidator, parsePointer } from "../IncrementalValidator";
+import { validateSCD } from "../validateSCD";
+
+const validSCD = {
+  contractName: "TestContract",
+  activationAmount: "1_0000_0000",
+  pragmas: { maxAuxVars: 3, verboseAssembly: true },
+  methods: [
+    {
+      name: "deposit",
+      code: "1",
+      args: [{ name: "amount", type: "amount" }],
+    },
+    { name: "withdraw", code: "2", args: [] },
+  ],
+  variables: [
+    {
+      name: "stats",
+      type: "struct",
+      fields: [
+        { name: "counter", type: "long" },
+        { name: "balance", type: "amount" },
+      ],
+    },
+  ],
+  maps: [
+    {
+      name: "balances",
+      key1: { name: "kind", constant: true, value: "1" },
+      key2: { name: "account", type: "address" },
+      value: { name: "balance", type: "amount" },
+    },
+  ],
+  transactions: [],
+};
+
+const paths = (validator: IncrementalValidator) =>
+  validator.errors.map((e) => e.instancePath);
+
+describe("IncrementalValidator", () => {
+  it("should accept a valid SCD", () => {
+    const validator = new IncrementalValidator(validSCD);
+    expect(validator.isValid).toBe(true);
+    expect(validator.errors).toEqual([]);
+  });
+
+  it("should report all errors, including the one of validateSCD", () => {
+    const invalid = {
+      ...validSCD,
+      activationAmount: "1e8",
+      methods: [{ name: "deposit", code: 1, args: [] }],
+    };
+    const validator = new IncrementalValidator(invalid);
+    validateSCD(invalid);
+    expect(validator.errors).toContainEqual(validateSCD.errors![0]!);
+    expect(paths(validator)).toEqual(["/activationAmount", "/methods/0/code"]);
+  });
+
+  it("should revalidate the updated sub-tree only", () => {
+    const validator = new IncrementalValidator(validSCD);
+    validator.update("/methods/0/args/0/type", "number");
+    expect(validator.errors).toEqual([
+      {
+        instancePath: "/methods/0/args/0/type",
+        keyword: "enum",
+        message: "must be equal to one of the allowed values",
+      },
+    ]);
+    validator.update("/methods/0/args/0/type", "long");
+    expect(validator.isValid).toBe(true);
+    // the input is not mutated
+    expect(validSCD.methods[0]!.args[0]!.type).toBe("amount");
+  });
+
+  it("should check the required properties of the parent", () => {
+    const validator = new IncrementalValidator(validSCD);
+    validator.update("/methods/1/code", undefined);
+    expect(validator.errors).toEqual([
+      {
+        instancePath: "/methods/1",
+        keyword: "required",
+        message: "must have required property 'code'",
+      },
+    ]);
+    // the children of the invalid parent are validated, once it's valid again
+    validator.update("/methods/1/args", "none");
+    validator.update("/methods/1/code", "2");
+    expect(paths(validator)).toEqual(["/methods/1/args"]);
+  });
+
+  it("should check the key1 of a collection on changes below the map", () => {
+    const validator = new IncrementalValidator(validSCD);
+    validator.update("/maps/0/collection", "counter");
+    expect(validator.isValid).toBe(true);
+    validator.update("/maps/0/key1/value", "KIND");
+    expect(validator.errors).toEqual([
+      {
+        instancePath: "/maps/0/key1/value",
+        keyword: "pattern",
+        message: 'must match pattern "^[0-9]+$"',
+      },
+    ]);
+    validator.update("/maps/0/key1/value", "2");
+    expect(validator.isValid).toBe(true);
+  });
+
+  it("should keep the cross references in indexes", () => {
+    const validator = new IncrementalValidator(validSCD);
+    validator.update("/methods/1/code", "1");
+    expect(validator.errors).toEqual([
+      {
+        instancePath: "/methods/1/code",
+        keyword: "unique",
+        message: "duplicate method code 1 - also at /methods/0",
+      },
+    ]);
+    validator.update("/methods/1/code", "3");
+    expect(validator.isValid).toBe(true);
+
+    validator.update("/variables/0/fields/1/name", "counter");
+    validator.update("/maps/1", {
+      ...validSCD.maps[0]!,
+      name: "deposits",
+      key1: { name: "kind", constant: true, value: "0_1" },
+    });
+    expect(paths(validator)).toEqual([
+      "/maps/1/key1/value",
+      "/variables/0/fields/1/name",
+    ]);
+  });
+
+  it("should sync the changed values of the next document", () => {
+    const validator = new IncrementalValidator(validSCD);
+    const next = {
+      ...validSCD,
+      pragmas: { ...validSCD.pragmas, maxAuxVars: 11 },
+      methods: [...validSCD.methods, { name: "deposit", code: "3", args: [] }],
+    };
+    expect(validator.sync(next).map((e) => e.instancePath)).toEqual([
+      "/pragmas/maxAuxVars",
+      "/methods/2/name",
+    ]);
+    expect(validator.value).toBe(next);
+    expect(validator.sync(structuredClone(validSCD))).toEqual([]);
+  });
+
+  it("should parse JSON pointers", () => {
+    expect(parsePointer("")).toEqual([]);
+    expect(parsePointer("/methods/0/a~1b~0c")).toEqual([
+      "methods",
+      "0",
+      "a/b~c",
+    ]);
+    expect(() => parsePointer("methods")).toThrow("Invalid JSON pointer");
+  });
+});
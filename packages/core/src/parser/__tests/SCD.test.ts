@@ -152,4 +152,84 @@ describe("SCD", () => {
       expect(() => SCD.parse({})).toThrow();
     });
   });
+
+  describe("withPragmas", () => {
+    it("should replace the given pragmas only", () => {
+      const abi = SCD.parse(mockSCD);
+      const changed = abi.withPragmas({ codeStackPages: 1 });
+      expect(changed.getContractInfo().pragmas).toEqual({
+        ...abi.getContractInfo().pragmas,
+        codeStackPages: 1,
+      });
+      expect(abi.getContractInfo().pragmas.codeStackPages).toBe(0);
+    });
+  });
+
+  describe("packed layout", () => {
+    const packed = {
+      ...mockSCD,
+      packedLayout: true,
+      variables: [
+        { name: "isPaused", type: "boolean" },
+        ...mockSCD.variables,
+        {
+          name: "phase",
+          type: "long",
+          oneOf: [
+            { name: "OPEN", value: "0" },
+            { name: "CLOSED", value: "2" },
+          ],
+        },
+        {
+          name: "flags",
+          type: "struct",
+          fields: [
+            { name: "isInternal", type: "boolean" },
+            { name: "count", type: "long" },
+          ],
+        },
+        { name: "isLocked", type: "boolean", initializable: true },
+      ],
+    };
+
+    it("should pack booleans and enums into shared longs", () => {
+      const layout = SCD.parse(packed).getVariablesLayout();
+      expect(
+        layout.map(({ name, index, packed }) => [name, index, packed]),
+      ).toEqual([
+        ["owner", 4, undefined],
+        ["stats.balance", 5, undefined],
+        ["flags.count", 6, undefined],
+        // initializable by name on deployment
+        ["isLocked", 7, undefined],
+        ["phase", 8, { word: "_packed0", bit: 0, bits: 2 }],
+        ["isPaused", 8, { word: "_packed0", bit: 2, bits: 1 }],
+        ["stats.counter", 8, { word: "_packed0", bit: 3, bits: 1 }],
+        ["flags.isInternal", 8, { word: "_packed0", bit: 4, bits: 1 }],
+      ]);
+    });
+
+    it("should open a new long when the bits are used up", () => {
+      const flags = Array.from({ length: 65 }, (_, i) => ({
+        name: `flag${i}`,
+        type: "boolean",
+      }));
+      const layout = SCD.parse({
+        ...packed,
+        variables: flags,
+      }).getVariablesLayout();
+      expect(layout[63]!.packed).toEqual({ word: "_packed0", bit: 63, bits: 1 });
+      expect(layout[64]!.index).toBe(5);
+      expect(layout[64]!.packed).toEqual({ word: "_packed1", bit: 0, bits: 1 });
+    });
+
+    it("should keep the slots without packedLayout", () => {
+      const layout = SCD.parse({
+        ...packed,
+        packedLayout: false,
+      }).getVariablesLayout();
+      expect(layout.every((v) => !v.packed)).toBe(true);
+      expect(layout.map((v) => v.index)).toEqual([4, 5, 6, 7, 8, 9, 10, 11]);
+    });
+  });
 });
@@ -0,0 +1,188 @@
+import { describe, expect, it } from "bun:test";
+import { validateSCD } from "../validateSCD";
+import { createAjvValidator } from "../ajv-validator";
+
+const validSCD = {
+  contractName: "TestContract",
+  description: "A test contract",
+  activationAmount: "1_0000_0000",
+  codeStackPages: 1,
+  pragmas: { maxAuxVars: 3, verboseAssembly: true, version: "2.3.0" },
+  methods: [
+    {
+      name: "deposit",
+      code: "1",
+      args: [{ name: "amount", type: "amount" }],
+    },
+  ],
+  variables: [
+    { name: "owner", type: "address", initializable: true },
+    {
+      name: "stats",
+      type: "struct",
+      fields: [
+        { name: "counter", type: "long" },
+        {
+          name: "phase",
+          type: "long",
+          oneOf: [
+            { name: "OPEN", value: "0" },
+            { name: "CLOSED", value: "1" },
+          ],
+        },
+      ],
+    },
+  ],
+  maps: [
+    {
+      name: "balances",
+      key1: { name: "account", type: "address" },
+      key2: { name: "kind", constant: true, value: "1" },
+      value: {
+        name: "state",
+        type: "enum",
+        oneOf: [{ name: "ACTIVE", value: "1" }],
+      },
+    },
+    {
+      name: "lots",
+      collection: "stack",
+      key1: { name: "key", constant: true, value: "2" },
+      key2: { name: "index" },
+      value: { name: "lot" },
+    },
+  ],
+  transactions: [{ name: "payout", kind: "sendAmount" }],
+};
+
+// pre-SCD format, as in the examples folder
+const legacyAbi = {
+  contractName: "Stock",
+  activationAmount: "1_0000_0000",
+  pragmas: { maxAuxVars: "3", verboseAssembly: true },
+  functions: [{ name: "register", code: 1, args: [] }],
+};
+
+type Mutation = [path: (string | number)[], value: unknown];
+
+// every mutation is applied on its own to the valid SCD
+const mutations: Mutation[] = [
+  [["contractName"], undefined],
+  [["contractName"], 1],
+  [["activationAmount"], "1e8"],
+  [["activationAmount"], 100000000],
+  [["codeStackPages"], -1],
+  [["codeStackPages"], 11],
+  [["codeStackPages"], "1"],
+  [["packedLayout"], "true"],
+  [["pragmas"], []],
+  [["pragmas"], null],
+  [["pragmas", "maxAuxVars"], "3"],
+  [["pragmas", "optimizationLevel"], 5],
+  [["pragmas", "verboseAssembly"], "true"],
+  [["methods"], {}],
+  [["methods", 0, "code"], 1],
+  [["methods", 0, "args"], undefined],
+  [["methods", 0, "args", 0, "type"], "number"],
+  [["methods", 0, "args", 1], { name: "second" }],
+  [["methods", 0, "weight"], -1],
+  [["methods", 0, "weight"], "high"],
+  [["variables", 0, "type"], "enum"],
+  [["variables", 0, "initializable"], 0],
+  [["variables", 1, "fields", 0, "type"], 1],
+  [["variables", 1, "fields", 0, "name"], undefined],
+  [["variables", 1, "fields", 1, "oneOf"], "OPEN"],
+  [["variables", 1, "fields", 1, "oneOf", 0, "value"], 0],
+  [["variables", 1, "fields", 1, "oneOf"], "OPEN"],
+  [["variables", 1, "fields", 1, "oneOf", 0, "value"], 0],
+  [["maps", 0, "key1"], undefined],
+  [["maps", 0, "key2", "type"], "int"],
+  [["maps", 0, "value", "oneOf", 0, "value"], 1],
+  [["maps", 0, "value", "oneOf"], "ACTIVE"],
+  [["maps", 0, "collection"], "list"],
+  [["maps", 0, "collection"], "stack"],
+  [["maps", 1, "key1"], "key"],
+  [["maps", 1, "key1", "constant"], false],
+  [["maps", 1, "key1", "value"], undefined],
+  [["maps", 1, "key1", "value"], "LOTS_KEY"],
+  [["maps", 1, "key1", "value"], "1_000"],
+  [["maps", 1, "collection"], "list"],
+  [["transactions"], undefined],
+  [["transactions", 0, "kind"], "sendAll"],
+  [["transactions", 0], "payout"],
+  [["description"], null],
+];
+
+function mutate(path: (string | number)[], value: unknown) {
+  const copy = structuredClone(validSCD);
+  let target: any = copy;
+  for (const key of path.slice(0, -1)) {
+    target = target[key];
+  }
+  const key = path[path.length - 1]!;
+  if (value === undefined) {
+    delete target[key];
+  } else {
+    target[key] = value;
+  }
+  return copy;
+}
+
+function firstError(validate: typeof validateSCD) {
+  const [error] = validate.errors ?? [];
+  return error && { instancePath: error.instancePath, message: error.message };
+}
+
+describe("validateSCD", () => {
+  const ajv = createAjvValidator();
+
+  it("should accept valid SCDs", () => {
+    expect(validateSCD(validSCD)).toBeTruthy();
+    expect(validateSCD.errors).toBeNull();
+    // the schema allows additional properties
+    expect(validateSCD(mutate(["pragmas", "unknown"], 1))).toBeTruthy();
+  });
+
+  it("should reject like the Ajv compiled schema", () => {
+    const inputs = [
+      ...mutations.map(([path, value]) => mutate(path, value)),
+      legacyAbi,
+      {},
+      [],
+      null,
+      "scd",
+    ];
+    for (const input of inputs) {
+      expect(validateSCD(input)).toBe(false);
+      expect(ajv(input)).toBe(false);
+      expect(firstError(validateSCD)).toEqual(firstError(ajv));
+    }
+  });
+
+  it("should require a constant numeric key1 of collections", () => {
+    validateSCD(mutate(["maps", 1, "key1", "value"], "LOTS_KEY"));
+    expect(validateSCD.errors).toEqual([
+      {
+        instancePath: "/maps/1/key1/value",
+        keyword: "pattern",
+        message: 'must match pattern "^[0-9]+$"',
+      },
+    ]);
+    validateSCD(mutate(["maps", 0, "collection"], "stack"));
+    expect(firstError(validateSCD)).toEqual({
+      instancePath: "/maps/0/key1",
+      message: "must have required property 'constant'",
+    });
+  });
+
+  it("should report the path of the invalid value", () => {
+    validateSCD(mutate(["methods", 0, "args", 0, "type"], "number"));
+    expect(validateSCD.errors).toEqual([
+      {
+        instancePath: "/methods/0/args/0/type",
+        keyword: "enum",
+        message: "must be equal to one of the allowed values",
+      },
+    ]);
+  });
+});
@@ -0,0 +1,12 @@
+import Ajv from "ajv";
+import schema from "./scd-schema.json";
+import type { SCDType } from "./types";
+import type { SCDValidator } from "./validateSCD";
+
+/**
+ * Runtime fallback: compiles `scd-schema.json` with Ajv, e.g. for a modified schema.
+ * Use it with `SCD.useValidator(createAjvValidator())`.
+ */
+export function createAjvValidator(): SCDValidator {
+  return new Ajv().compile<SCDType>(schema);
+}
@@ -2,5 +2,8 @@ import schema from "./scd-schema.json";
 
 export { SCD } from "./SCD";
 export * from "./types";
+export * from "./parseLong";
+export * from "./validateSCD";
+export * from "./IncrementalValidator";
 
 export const SCDJsonSchema = schema;
@@ -0,0 +1,13 @@
+/**
+ * Value of a long in the SCD, e.g. an activation amount, a method code or an enum value - like in
+ * SmartC, underscores may group the digits: "10_0000_0000"
+ */
+export function parseLong(value: string): bigint {
+  const digits = value.trim().replaceAll("_", "");
+  if (!digits) throw new SyntaxError(`Invalid long: "${value}"`);
+  try {
+    return BigInt(digits);
+  } catch {
+    throw new SyntaxError(`Invalid long: "${value}"`);
+  }
+}
@@ -33,22 +33,43 @@ export interface ValueDefinition {
   type: DataType;
 }
 
-export interface VariableDefinition extends ValueDefinition {
+export interface FieldDefinition extends ValueDefinition {
+  // the values of an enum-typed long - allows packing it with `packedLayout`
+  oneOf?: EnumTypeDefinition[];
+}
+
+export interface VariableDefinition extends FieldDefinition {
   description?: string;
   initializable?: boolean;
   constant?: boolean;
   // if constant and !initializable
   value?: string;
   // for structs only
-  fields?: ValueDefinition[];
+  fields?: FieldDefinition[];
+}
+
+export interface VariableLayout extends VariableDefinition {
+  /** Memory address of the long */
+  index: number;
+  /** Packed layout only: the bits of the long `word` at `index`, which it shares with other variables */
+  packed?: { word: string; bit: number; bits: number };
 }
 
+/**
+ * Collections on a map - key1 is the constant of the collection, key2 the position resp. item:
+ * - stack, queue: values by position, size (and head) kept in variables
+ * - counter: value per key2
+ * - set: 1 per member, number of members kept in a variable
+ */
+export type CollectionKind = "stack" | "queue" | "counter" | "set";
+
 export interface MapDefinition {
   name: string;
   description?: string;
   key1: MapItemDefinition;
   key2: MapItemDefinition;
   value: MapItemDefinition;
+  collection?: CollectionKind;
 }
 
 export interface MethodDefinition {
@@ -56,23 +77,50 @@ export interface MethodDefinition {
   description?: string;
   code: string;
   args: ValueDefinition[];
+  /** Expected share of the calls, e.g. the calls per day - orders the generated dispatch */
+  weight?: number;
 }
 
+export type TransactionKind =
+  | "sendAmountAndMessage"
+  | "sendAmount"
+  | "sendMessage"
+  | "sendQuantity"
+  | "sendQuantityAndAmount";
+
+/**
+ * immediate: sent on every call; batched: merged during the activation and sent after all incoming
+ * transactions are processed, which saves the fees of the merged transactions
+ */
+export type TransactionDelivery = "immediate" | "batched";
+
+/**
+ * How batched transactions are merged - calls to another recipient (or asset) send the pending one:
+ * - sum: adds up the quantity and the amount - with a message its first long instead of the amount,
+ *   which is then the recipient's activation fee. The other values are the last ones.
+ * - last: only the last call is sent
+ * - perRecipient: like sum, but keeps one pending transaction per recipient
+ */
+export type TransactionAggregation = "sum" | "last" | "perRecipient";
+
 export interface TransactionDefinition {
   name: string;
   description?: string;
-  kind:
-    | "sendAmountAndMessage"
-    | "sendAmount"
-    | "sendMessage"
-    | "sendQuantity"
-    | "sendQuantityAndAmount";
+  kind: TransactionKind;
+  /** The generator emits `<name>_send(...)` only if set */
+  delivery?: TransactionDelivery;
+  /** batched only - default: sum */
+  aggregation?: TransactionAggregation;
+  /** perRecipient only: pending recipients before they are sent early - default: 4 */
+  maxRecipients?: number;
 }
 
 export interface SCDType {
   contractName: string;
   description?: string;
   activationAmount: string;
+  /** Packs boolean and enum variables bitwise into shared longs, which needs less data pages */
+  packedLayout?: boolean;
   pragmas: {
     maxAuxVars: number;
     verboseAssembly: boolean;
@@ -0,0 +1,308 @@
+import type { SCDType } from "./types";
+
+/**
+ * Subset of Ajv's error object, such that Ajv's validate functions can be used interchangeably
+ */
+export interface SCDValidationError {
+  /** JSON pointer to the invalid value, e.g. `/methods/0/args/1/type` */
+  instancePath: string;
+  keyword: string;
+  message?: string;
+}
+
+export interface SCDValidator {
+  (input: unknown): input is SCDType;
+  errors?: SCDValidationError[] | null;
+}
+
+type CheckFn = (value: unknown, path: string) => SCDValidationError | null;
+
+/**
+ * Check of a (sub-)schema - objects and arrays expose their children, such that a sub-tree can be
+ * validated on its own
+ */
+export interface SCDCheck extends CheckFn {
+  /** Checks the type and the required properties only, not the children */
+  shallow?: CheckFn;
+  /** Check of a property resp. an array item */
+  child?: (key: string) => SCDCheck | undefined;
+}
+
+type Check = SCDCheck;
+
+const error = (
+  instancePath: string,
+  keyword: string,
+  message: string,
+): SCDValidationError => ({ instancePath, keyword, message });
+
+const isObject = (value: unknown): value is Record<string, unknown> =>
+  !!value && typeof value === "object" && !Array.isArray(value);
+
+function string(pattern?: RegExp): Check {
+  return (value, path) => {
+    if (typeof value !== "string") return error(path, "type", "must be string");
+    if (pattern && !pattern.test(value)) {
+      return error(path, "pattern", `must match pattern "${pattern.source}"`);
+    }
+    return null;
+  };
+}
+
+function number(minimum: number, maximum: number): Check {
+  return (value, path) => {
+    if (typeof value !== "number" || !Number.isFinite(value)) {
+      return error(path, "type", "must be number");
+    }
+    if (value < minimum) return error(path, "minimum", `must be >= ${minimum}`);
+    if (value > maximum) return error(path, "maximum", `must be <= ${maximum}`);
+    return null;
+  };
+}
+
+const boolean: Check = (value, path) =>
+  typeof value === "boolean" ? null : error(path, "type", "must be boolean");
+
+function constant(expected: unknown): Check {
+  return (value, path) =>
+    value === expected
+      ? null
+      : error(path, "const", "must be equal to constant");
+}
+
+function oneOf(values: readonly string[]): Check {
+  const allowed = new Set(values);
+  return (value, path) => {
+    if (typeof value !== "string") return error(path, "type", "must be string");
+    return allowed.has(value)
+      ? null
+      : error(path, "enum", "must be equal to one of the allowed values");
+  };
+}
+
+const ArrayIndex = /^(0|[1-9][0-9]*)$/;
+
+function array(items: Check): Check {
+  const shallow: CheckFn = (value, path) =>
+    Array.isArray(value) ? null : error(path, "type", "must be array");
+  const check: CheckFn = (value, path) => {
+    if (!Array.isArray(value)) return error(path, "type", "must be array");
+    for (let i = 0; i < value.length; i++) {
+      const result = items(value[i], `${path}/${i}`);
+      if (result) return result;
+    }
+    return null;
+  };
+  return Object.assign(check, {
+    shallow,
+    child: (key: string) => (ArrayIndex.test(key) ? items : undefined),
+  });
+}
+
+/**
+ * Same order as Ajv: type, required properties, then the properties in declaration order
+ */
+function object(required: string[], properties: Record<string, Check>): Check {
+  const entries = Object.entries(properties);
+  const shallow: CheckFn = (value, path) => {
+    if (!isObject(value)) return error(path, "type", "must be object");
+    for (const name of required) {
+      if (value[name] === undefined) {
+        return error(
+          path,
+          "required",
+          `must have required property '${name}'`,
+        );
+      }
+    }
+    return null;
+  };
+  const check: CheckFn = (value, path) => {
+    const invalid = shallow(value, path);
+    if (invalid) return invalid;
+    for (const [name, checkProperty] of entries) {
+      const property = (value as Record<string, unknown>)[name];
+      if (property === undefined) continue;
+      const result = checkProperty(property, `${path}/${name}`);
+      if (result) return result;
+    }
+    return null;
+  };
+  return Object.assign(check, {
+    shallow,
+    child: (key: string) =>
+      Object.hasOwn(properties, key) ? properties[key] : undefined,
+  });
+}
+
+// mirrors scd-schema.json - keep both in sync, the parity test compares them with Ajv
+const DataTypes = [
+  "address",
+  "string",
+  "boolean",
+  "long",
+  "amount",
+  "txId",
+  "address[]",
+  "string[]",
+  "boolean[]",
+  "long[]",
+  "amount[]",
+  "txId[]",
+  "struct",
+  "enum",
+] as const;
+
+const VariableTypes = DataTypes.filter((type) => type !== "enum");
+
+const CollectionKinds = ["stack", "queue", "counter", "set"];
+
+const TransactionKinds = [
+  "sendAmountAndMessage",
+  "sendMessage",
+  "sendAmount",
+  "sendQuantity",
+  "sendQuantityAndAmount",
+];
+
+const TransactionDeliveries = ["immediate", "batched"];
+
+const TransactionAggregations = ["sum", "last", "perRecipient"];
+
+const EnumValues = array(
+  object(["name", "value"], { name: string(), value: string() }),
+);
+
+const MapType = object(["name"], {
+  name: string(),
+  description: string(),
+  constant: boolean,
+  type: oneOf(DataTypes),
+  value: string(),
+  oneOf: EnumValues,
+});
+
+// the generator addresses a collection by its key1 as `#define`, i.e. a constant number
+const CollectionKey1 = object(["constant", "value"], {
+  constant: constant(true),
+  value: string(/^[0-9]+$/),
+});
+
+/**
+ * The `if`/`then` of a map: with a collection, key1 must be a constant number. Ajv checks it after
+ * the type and before the required properties, so it's part of the shallow check.
+ */
+function collectionMap(map: Check): Check {
+  const shallow: CheckFn = (value, path) => {
+    if (!isObject(value)) return error(path, "type", "must be object");
+    if (value.collection !== undefined && value.key1 !== undefined) {
+      const invalid = CollectionKey1(value.key1, `${path}/key1`);
+      if (invalid) return invalid;
+    }
+    return (map.shallow ?? map)(value, path);
+  };
+  const check: CheckFn = (value, path) =>
+    shallow(value, path) ?? map(value, path);
+  return Object.assign(check, { shallow, child: map.child });
+}
+
+const checkSCD = object(
+  ["contractName", "activationAmount", "pragmas", "methods", "variables", "maps"],
+  {
+    contractName: string(),
+    description: string(),
+    activationAmount: string(/^[0-9_]+$/),
+    codeStackPages: number(0, 10),
+    userStackPages: number(0, 10),
+    packedLayout: boolean,
+    pragmas: object([], {
+      maxAuxVars: number(0, 10),
+      maxConstVars: number(0, 10),
+      optimizationLevel: number(0, 4),
+      version: string(),
+      reuseAssignedVar: boolean,
+      verboseAssembly: boolean,
+      verboseScope: boolean,
+    }),
+    methods: array(
+      object(["name", "code", "args"], {
+        name: string(),
+        description: string(),
+        code: string(),
+        args: array(
+          object(["name", "type"], { name: string(), type: oneOf(DataTypes) }),
+        ),
+        weight: number(0, Number.POSITIVE_INFINITY),
+      }),
+    ),
+    variables: array(
+      object(["name", "type"], {
+        name: string(),
+        type: oneOf(VariableTypes),
+        description: string(),
+        initializable: boolean,
+        constant: boolean,
+        value: string(),
+        oneOf: EnumValues,
+        fields: array(
+          object(["name", "type"], {
+            name: string(),
+            type: string(),
+            oneOf: EnumValues,
+          }),
+        ),
+      }),
+    ),
+    maps: array(
+      collectionMap(
+        object(["name", "key1", "key2", "value"], {
+          name: string(),
+          key1: MapType,
+          key2: MapType,
+          value: MapType,
+          collection: oneOf(CollectionKinds),
+        }),
+      ),
+    ),
+    transactions: array(
+      object(["name", "kind"], {
+        name: string(),
+        description: string(),
+        kind: oneOf(TransactionKinds),
+        delivery: oneOf(TransactionDeliveries),
+        aggregation: oneOf(TransactionAggregations),
+        maxRecipients: number(1, 32),
+      }),
+    ),
+  },
+);
+
+/**
+ * Precompiled validator for `scd-schema.json`.
+ * Equivalent to the Ajv compiled schema, but without compiling the schema at load time and
+ * without shipping Ajv. Like Ajv (without `allErrors`) it stops at the first error.
+ */
+export const validateSCD: SCDValidator = Object.assign(
+  (input: unknown): input is SCDType => {
+    const result = checkSCD(input, "");
+    validateSCD.errors = result ? [result] : null;
+    return !result;
+  },
+  { errors: null },
+);
+
+const unescapeKey = (key: string) =>
+  key.replaceAll("~1", "/").replaceAll("~0", "~");
+
+/**
+ * The check of the value at the JSON pointer, e.g. `/methods/0/args` - undefined if the schema
+ * doesn't describe the value (additional properties)
+ */
+export function schemaCheckAt(pointer: string): SCDCheck | undefined {
+  let check: SCDCheck | undefined = checkSCD;
+  for (const key of pointer ? pointer.slice(1).split("/") : []) {
+    check = check.child?.(unescapeKey(key));
+    if (!check) return undefined;
+  }
+  return check;
+}
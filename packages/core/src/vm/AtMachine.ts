@@ -0,0 +1,1129 @@
+import { ApiFunction } from "./api-functions";
+import { DefaultFeeSchedule, type FeeSchedule } from "./fees";
+import { OpCode, OpCodeTable, OperandKind, OperandSizes } from "./opcodes";
+import type {
+  AtEnvironment,
+  BlockResult,
+  IncomingTransaction,
+  MachineCode,
+  MachineState,
+  OutgoingTransaction,
+  ReplayResult,
+  TransactionRecord,
+} from "./types";
+
+export const LongsPerPage = 32;
+const DefaultMaxStepsPerBlock = 1_000_000;
+const FirstTransactionId = 10_000n;
+
+// register indices - A1..A4, B1..B4
+const A1 = 0;
+const A2 = 1;
+const A3 = 2;
+const A4 = 3;
+const B1 = 4;
+const B2 = 5;
+
+export interface AtMachineOptions {
+  contractId?: bigint;
+  creator?: bigint;
+  /** Initial balance in NQT */
+  balance?: bigint;
+  /** Overrides `PActivationAmount` of the machine code */
+  activationAmount?: bigint;
+  creationHeight?: number;
+  /** Initial values of (initializable) variables by name */
+  variables?: Record<string, bigint>;
+  fees?: FeeSchedule;
+  /** Charge the execution fees from the contract balance - default: true */
+  chargeFees?: boolean;
+  /** Safety net against endless loops - default: 1_000_000 */
+  maxStepsPerBlock?: number;
+  environment?: AtEnvironment;
+}
+
+export interface ReplayOptions {
+  /** Number of transactions put into one block - default: 1 */
+  transactionsPerBlock?: number;
+  /** Collect the outgoing transactions in the result - default: false */
+  collectOutgoing?: boolean;
+}
+
+class AtRuntimeError extends Error {}
+// not recoverable by the contract's error handler
+class StepLimitError extends AtRuntimeError {}
+
+export function hexToBytes(hex: string) {
+  const bytes = new Uint8Array(hex.length >> 1);
+  for (let i = 0; i < bytes.length; i++) {
+    bytes[i] = parseInt(hex.substring(i * 2, i * 2 + 2), 16);
+  }
+  return bytes;
+}
+
+function splitMix(seed: bigint) {
+  let z = BigInt.asUintN(64, seed + 0x9e3779b97f4a7c15n);
+  z = BigInt.asUintN(64, (z ^ (z >> 30n)) * 0xbf58476d1ce4e5b9n);
+  z = BigInt.asUintN(64, (z ^ (z >> 27n)) * 0x94d049bb133111ebn);
+  return BigInt.asIntN(64, z ^ (z >> 31n));
+}
+
+function readWide(registers: BigInt64Array, offset: number) {
+  let value = 0n;
+  for (let i = 3; i >= 0; i--) {
+    value = (value << 64n) | BigInt.asUintN(64, registers[offset + i]);
+  }
+  return value;
+}
+
+function writeWide(registers: BigInt64Array, offset: number, value: bigint) {
+  let v = BigInt.asUintN(256, value);
+  for (let i = 0; i < 4; i++) {
+    registers[offset + i] = BigInt.asIntN(64, v);
+    v >>= 64n;
+  }
+}
+
+function fixedPow(base: bigint, exponent: bigint) {
+  // exponent is fixed point with 8 decimals
+  const result = Math.pow(Number(base), Number(exponent) / 1e8);
+  if (!Number.isFinite(result) || Math.abs(result) >= 2 ** 63) {
+    return 0n;
+  }
+  return BigInt(Math.trunc(result));
+}
+
+/**
+ * Deterministic Signum AT interpreter.
+ *
+ * The bytecode is decoded once into typed arrays, such that the execution loop itself does not allocate.
+ * Transactions are scripted with `queueTransaction` and processed block by block with `runBlock`
+ * (or in bulk with `replay`).
+ *
+ * ```ts
+ * const machine = new AtMachine(machineData, { creator: 1n, variables: { owner: 1n } });
+ * machine.queueTransaction({ sender: 2n, amount: 2_0000_0000n, message: [1n] });
+ * const { outgoing, steps } = machine.runBlock();
+ * ```
+ */
+export class AtMachine {
+  readonly contractId: bigint;
+  readonly creator: bigint;
+  readonly activationAmount: bigint;
+  readonly creationHeight: number;
+  readonly fees: FeeSchedule;
+  readonly memory: BigInt64Array;
+
+  height: number;
+  balance: bigint;
+  state: MachineState = "finished";
+  pc = 0;
+  pcs = 0;
+
+  private readonly code: Uint8Array;
+  private readonly ops: Uint8Array;
+  private readonly arg1: Int32Array;
+  private readonly arg2: Int32Array;
+  private readonly arg3: Int32Array;
+  private readonly fn: Uint16Array;
+  private readonly imm: BigInt64Array;
+
+  private readonly registers = new BigInt64Array(8);
+  private readonly callStack: Int32Array;
+  private readonly userStack: BigInt64Array;
+  private callSp = 0;
+  private userSp = 0;
+  private maxCallSp = 0;
+  private maxUserSp = 0;
+  private errorPc = -1;
+  private wakeHeight = 0;
+
+  private readonly chargeFees: boolean;
+  private readonly maxStepsPerBlock: number;
+  private stepLimit = 0;
+  private currentSteps = 0;
+  private previousBalance = 0n;
+
+  private readonly variableIndex = new Map<string, number>();
+  private readonly environment: AtEnvironment;
+  private readonly codeHashId: bigint;
+  private readonly maps = new Map<bigint, Map<bigint, bigint>>();
+  private readonly assetBalances = new Map<bigint, bigint>();
+  private readonly pending: IncomingTransaction[] = [];
+  private readonly transactions: TransactionRecord[] = [];
+  private readonly transactionsById = new Map<bigint, TransactionRecord>();
+  private nextTransactionId = FirstTransactionId;
+  private outgoing = new Map<string, OutgoingTransaction>();
+  private profile: Uint32Array | null = null;
+
+  constructor(machineCode: MachineCode, options: AtMachineOptions = {}) {
+    this.contractId = options.contractId ?? 1n;
+    this.creator = options.creator ?? 0n;
+    this.balance = options.balance ?? 0n;
+    this.activationAmount =
+      options.activationAmount ?? BigInt(machineCode.PActivationAmount ?? "0");
+    this.creationHeight = options.creationHeight ?? 0;
+    this.height = this.creationHeight;
+    this.fees = options.fees ?? DefaultFeeSchedule;
+    this.chargeFees = options.chargeFees ?? true;
+    this.maxStepsPerBlock = options.maxStepsPerBlock ?? DefaultMaxStepsPerBlock;
+    this.environment = options.environment ?? {};
+    this.codeHashId = BigInt.asIntN(
+      64,
+      BigInt(machineCode.MachineCodeHashId ?? "0"),
+    );
+
+    const memorySize = Math.max(
+      machineCode.DataPages * LongsPerPage,
+      machineCode.Memory.length,
+    );
+    this.memory = new BigInt64Array(memorySize);
+    if (machineCode.ByteData) {
+      const data = hexToBytes(machineCode.ByteData);
+      const view = new DataView(data.buffer);
+      for (let i = 0; i < data.length >> 3 && i < memorySize; i++) {
+        this.memory[i] = view.getBigInt64(i * 8, true);
+      }
+    }
+    machineCode.Memory.forEach((name, index) =>
+      this.variableIndex.set(name, index),
+    );
+    for (const [name, value] of Object.entries(options.variables ?? {})) {
+      this.setVariable(name, value);
+    }
+
+    this.callStack = new Int32Array(machineCode.CodeStackPages * LongsPerPage);
+    this.userStack = new BigInt64Array(
+      machineCode.UserStackPages * LongsPerPage,
+    );
+
+    this.code = hexToBytes(machineCode.ByteCode);
+    this.ops = new Uint8Array(this.code.length);
+    this.arg1 = new Int32Array(this.code.length);
+    this.arg2 = new Int32Array(this.code.length);
+    this.arg3 = new Int32Array(this.code.length);
+    this.fn = new Uint16Array(this.code.length);
+    this.imm = new BigInt64Array(this.code.length);
+    this.decode();
+  }
+
+  /**
+   * Decodes all instructions once - invalid instructions stay zero in `ops` and raise an error when executed
+   */
+  private decode() {
+    const code = this.code;
+    const view = new DataView(code.buffer);
+    let pc = 0;
+    while (pc < code.length) {
+      const info = OpCodeTable[code[pc]];
+      if (!info || pc + info.size > code.length) return;
+
+      let offset = pc + 1;
+      let valid = true;
+      const args = [0, 0, 0];
+      let argCount = 0;
+      for (const kind of info.operands) {
+        switch (kind) {
+          case OperandKind.Address: {
+            const address = view.getInt32(offset, true);
+            valid &&= address >= 0 && address < this.memory.length;
+            args[argCount++] = address;
+            break;
+          }
+          case OperandKind.Code:
+            args[argCount++] = view.getInt32(offset, true);
+            break;
+          case OperandKind.Offset:
+            args[argCount++] = view.getInt8(offset);
+            break;
+          case OperandKind.Value:
+            this.imm[pc] = view.getBigInt64(offset, true);
+            break;
+          case OperandKind.Function:
+            this.fn[pc] = view.getUint16(offset, true);
+            break;
+        }
+        offset += OperandSizes[kind];
+      }
+      if (valid) {
+        this.ops[pc] = info.code;
+        this.arg1[pc] = args[0];
+        this.arg2[pc] = args[1];
+        this.arg3[pc] = args[2];
+      }
+      pc += info.size;
+    }
+  }
+
+  /**
+   * Creates an independent copy of the current state - the decoded code is shared.
+   * Cheaper than re-running a setup sequence, e.g. for measuring many variants from the same state.
+   */
+  clone(): AtMachine {
+    const copy: AtMachine = Object.create(AtMachine.prototype);
+    const maps = new Map<bigint, Map<bigint, bigint>>();
+    for (const [key1, inner] of this.maps) {
+      maps.set(key1, new Map(inner));
+    }
+    return Object.assign(copy, this, {
+      memory: this.memory.slice(),
+      registers: this.registers.slice(),
+      callStack: this.callStack.slice(),
+      userStack: this.userStack.slice(),
+      maps,
+      assetBalances: new Map(this.assetBalances),
+      pending: [...this.pending],
+      transactions: [...this.transactions],
+      transactionsById: new Map(this.transactionsById),
+      outgoing: new Map(),
+      profile: this.profile?.slice() ?? null,
+    });
+  }
+
+  /**
+   * Starts counting the executed instructions per code address.
+   * @return the counters, indexed by the address of the instruction - updated in place while executing
+   */
+  enableProfiling() {
+    this.profile ??= new Uint32Array(this.code.length);
+    return this.profile;
+  }
+
+  /**
+   * Maximum depth of code and user stack reached so far, in entries (longs)
+   */
+  get stackUsage() {
+    return { codeStack: this.maxCallSp, userStack: this.maxUserSp };
+  }
+
+  getVariable(name: string) {
+    return this.memory[this.addressOf(name)];
+  }
+
+  setVariable(name: string, value: bigint) {
+    this.memory[this.addressOf(name)] = value;
+  }
+
+  private addressOf(name: string) {
+    const address = this.variableIndex.get(name);
+    if (address === undefined) {
+      throw new Error(`Unknown variable: ${name}`);
+    }
+    return address;
+  }
+
+  getMapValue(key1: bigint, key2: bigint) {
+    return this.maps.get(key1)?.get(key2) ?? 0n;
+  }
+
+  setMapValue(key1: bigint, key2: bigint, value: bigint) {
+    let inner = this.maps.get(key1);
+    if (value === 0n) {
+      inner?.delete(key2);
+      return;
+    }
+    if (!inner) {
+      inner = new Map();
+      this.maps.set(key1, inner);
+    }
+    inner.set(key2, value);
+  }
+
+  *mapEntries(): Generator<[key1: bigint, key2: bigint, value: bigint]> {
+    for (const [key1, inner] of this.maps) {
+      for (const [key2, value] of inner) {
+        yield [key1, key2, value];
+      }
+    }
+  }
+
+  getAssetBalance(assetId: bigint) {
+    return this.assetBalances.get(assetId) ?? 0n;
+  }
+
+  getTransaction(txId: bigint) {
+    return this.transactionsById.get(txId);
+  }
+
+  /**
+   * Queues a transaction for the next block.
+   * @return the transaction id
+   */
+  queueTransaction(transaction: IncomingTransaction) {
+    const txId = transaction.txId ?? this.nextTransactionId++;
+    this.pending.push({ ...transaction, txId });
+    return txId;
+  }
+
+  /**
+   * Forges the next block: includes the queued transactions and executes the contract, if activated.
+   */
+  runBlock(): BlockResult {
+    this.height++;
+    this.previousBalance = this.balance;
+    const timestampBase = BigInt(this.height) << 32n;
+
+    let activated = false;
+    for (let i = 0; i < this.pending.length; i++) {
+      const tx = this.pending[i];
+      const amount = tx.amount ?? 0n;
+      const record: TransactionRecord = {
+        txId: tx.txId!,
+        sender: tx.sender,
+        amount,
+        message: BigInt64Array.from(tx.message ?? []),
+        assets: tx.assets ?? [],
+        timestamp: timestampBase | BigInt(i),
+        height: this.height,
+      };
+      this.balance += amount;
+      for (const { assetId, quantity } of record.assets) {
+        this.assetBalances.set(assetId, this.getAssetBalance(assetId) + quantity);
+      }
+      activated ||= amount >= this.activationAmount;
+      this.transactions.push(record);
+      this.transactionsById.set(record.txId, record);
+    }
+    this.pending.length = 0;
+
+    const result: BlockResult = {
+      height: this.height,
+      executed: false,
+      steps: 0,
+      instructions: 0,
+      apiCalls: 0,
+      feeNQT: 0n,
+      state: this.state,
+      outgoing: [],
+    };
+
+    const runs =
+      this.state === "sleeping"
+        ? this.height >= this.wakeHeight
+        : this.state === "frozen"
+          ? this.balance > this.previousBalance
+          : activated;
+    if (!runs) {
+      return result;
+    }
+
+    result.executed = true;
+    this.state = "finished";
+    this.updateStepLimit(0);
+    this.execute(result);
+
+    result.feeNQT = this.chargeFees
+      ? BigInt(result.steps) * this.fees.stepFeeNQT
+      : 0n;
+    this.balance -= result.feeNQT;
+    result.state = this.state;
+    result.outgoing = [...this.outgoing.values()];
+    this.outgoing.clear();
+    return result;
+  }
+
+  /**
+   * Runs the given transactions through the contract, block by block.
+   */
+  replay(
+    transactions: Iterable<IncomingTransaction>,
+    { transactionsPerBlock = 1, collectOutgoing = false }: ReplayOptions = {},
+  ): ReplayResult {
+    const result: ReplayResult = {
+      blocks: 0,
+      transactions: 0,
+      steps: 0,
+      instructions: 0,
+      apiCalls: 0,
+      feeNQT: 0n,
+      errors: [],
+      outgoing: [],
+    };
+    const accumulate = (block: BlockResult) => {
+      result.blocks++;
+      result.steps += block.steps;
+      result.instructions += block.instructions;
+      result.apiCalls += block.apiCalls;
+      result.feeNQT += block.feeNQT;
+      if (block.error) {
+        result.errors.push({ height: block.height, error: block.error });
+      }
+      if (collectOutgoing) {
+        result.outgoing.push(...block.outgoing);
+      }
+    };
+
+    for (const tx of transactions) {
+      this.queueTransaction(tx);
+      result.transactions++;
+      if (this.pending.length >= transactionsPerBlock) {
+        accumulate(this.runBlock());
+      }
+    }
+    if (this.pending.length) {
+      accumulate(this.runBlock());
+    }
+    return result;
+  }
+
+  private updateStepLimit(stepsUsed: number) {
+    if (!this.chargeFees) {
+      this.stepLimit = this.maxStepsPerBlock;
+      return;
+    }
+    const affordable =
+      this.balance > 0n ? Number(this.balance / this.fees.stepFeeNQT) : 0;
+    // sent amounts already left the balance, the fees of the steps so far not yet
+    this.stepLimit = Math.min(
+      this.maxStepsPerBlock,
+      Math.max(affordable, stepsUsed),
+    );
+  }
+
+  private execute(result: BlockResult) {
+    const m = this.memory;
+    const ops = this.ops;
+    const a1 = this.arg1;
+    const a2 = this.arg2;
+    const a3 = this.arg3;
+    const fn = this.fn;
+    const imm = this.imm;
+    const apiSteps = this.fees.apiStepMultiplier;
+    const profile = this.profile;
+
+    let pc = this.pc;
+    let steps = 0;
+    let instructions = 0;
+    let apiCalls = 0;
+    let running = true;
+
+    while (running) {
+      try {
+        while (running) {
+          const op = ops[pc];
+          const cost =
+            op >= OpCode.EXT_FUN && op <= OpCode.EXT_FUN_RET_DAT_2 ? apiSteps : 1;
+          if (steps + cost > this.stepLimit) {
+            if (this.stepLimit >= this.maxStepsPerBlock) {
+              throw new StepLimitError("Step limit per block exceeded");
+            }
+            this.state = "frozen";
+            running = false;
+            break;
+          }
+          steps += cost;
+          instructions++;
+          if (profile) profile[pc]++;
+
+          switch (op) {
+            case OpCode.SET_VAL:
+              m[a1[pc]] = imm[pc];
+              pc += 13;
+              break;
+            case OpCode.SET_DAT:
+              m[a1[pc]] = m[a2[pc]];
+              pc += 9;
+              break;
+            case OpCode.CLR_DAT:
+              m[a1[pc]] = 0n;
+              pc += 5;
+              break;
+            case OpCode.INC_DAT:
+              m[a1[pc]]++;
+              pc += 5;
+              break;
+            case OpCode.DEC_DAT:
+              m[a1[pc]]--;
+              pc += 5;
+              break;
+            case OpCode.ADD_DAT:
+              m[a1[pc]] += m[a2[pc]];
+              pc += 9;
+              break;
+            case OpCode.SUB_DAT:
+              m[a1[pc]] -= m[a2[pc]];
+              pc += 9;
+              break;
+            case OpCode.MUL_DAT:
+              m[a1[pc]] *= m[a2[pc]];
+              pc += 9;
+              break;
+            case OpCode.DIV_DAT:
+              m[a1[pc]] /= this.divisor(m[a2[pc]]);
+              pc += 9;
+              break;
+            case OpCode.BOR_DAT:
+              m[a1[pc]] |= m[a2[pc]];
+              pc += 9;
+              break;
+            case OpCode.AND_DAT:
+              m[a1[pc]] &= m[a2[pc]];
+              pc += 9;
+              break;
+            case OpCode.XOR_DAT:
+              m[a1[pc]] ^= m[a2[pc]];
+              pc += 9;
+              break;
+            case OpCode.NOT_DAT:
+              m[a1[pc]] = ~m[a1[pc]];
+              pc += 5;
+              break;
+            case OpCode.SET_IND:
+              m[a1[pc]] = m[this.address(m[a2[pc]])];
+              pc += 9;
+              break;
+            case OpCode.SET_IDX:
+              m[a1[pc]] = m[this.address(m[a2[pc]] + m[a3[pc]])];
+              pc += 13;
+              break;
+            case OpCode.PSH_DAT:
+              if (this.userSp >= this.userStack.length) {
+                throw new AtRuntimeError("User stack overflow");
+              }
+              this.userStack[this.userSp++] = m[a1[pc]];
+              if (this.userSp > this.maxUserSp) this.maxUserSp = this.userSp;
+              pc += 5;
+              break;
+            case OpCode.POP_DAT:
+              if (this.userSp === 0) {
+                throw new AtRuntimeError("User stack underflow");
+              }
+              m[a1[pc]] = this.userStack[--this.userSp];
+              pc += 5;
+              break;
+            case OpCode.JMP_SUB:
+              if (this.callSp >= this.callStack.length) {
+                throw new AtRuntimeError("Code stack overflow");
+              }
+              this.callStack[this.callSp++] = pc + 5;
+              if (this.callSp > this.maxCallSp) this.maxCallSp = this.callSp;
+              pc = a1[pc];
+              break;
+            case OpCode.RET_SUB:
+              if (this.callSp === 0) {
+                throw new AtRuntimeError("Code stack underflow");
+              }
+              pc = this.callStack[--this.callSp];
+              break;
+            case OpCode.IND_DAT:
+              m[this.address(m[a1[pc]])] = m[a2[pc]];
+              pc += 9;
+              break;
+            case OpCode.IDX_DAT:
+              m[this.address(m[a1[pc]] + m[a2[pc]])] = m[a3[pc]];
+              pc += 13;
+              break;
+            case OpCode.MOD_DAT:
+              m[a1[pc]] %= this.divisor(m[a2[pc]]);
+              pc += 9;
+              break;
+            case OpCode.SHL_DAT: {
+              const shift = m[a2[pc]];
+              m[a1[pc]] = shift < 0n || shift > 63n ? 0n : m[a1[pc]] << shift;
+              pc += 9;
+              break;
+            }
+            case OpCode.SHR_DAT: {
+              const shift = m[a2[pc]];
+              m[a1[pc]] =
+                shift < 0n || shift > 63n
+                  ? 0n
+                  : BigInt.asUintN(64, m[a1[pc]]) >> shift;
+              pc += 9;
+              break;
+            }
+            case OpCode.POW_DAT:
+              m[a1[pc]] = fixedPow(m[a1[pc]], m[a2[pc]]);
+              pc += 9;
+              break;
+            case OpCode.JMP_ADR:
+              pc = a1[pc];
+              break;
+            case OpCode.BZR_DAT:
+              pc += m[a1[pc]] === 0n ? a2[pc] : 6;
+              break;
+            case OpCode.MDV_DAT:
+              m[a1[pc]] = (m[a1[pc]] * m[a2[pc]]) / this.divisor(m[a3[pc]]);
+              pc += 13;
+              break;
+            case OpCode.BNZ_DAT:
+              pc += m[a1[pc]] !== 0n ? a2[pc] : 6;
+              break;
+            case OpCode.BGT_DAT:
+              pc += m[a1[pc]] > m[a2[pc]] ? a3[pc] : 10;
+              break;
+            case OpCode.BLT_DAT:
+              pc += m[a1[pc]] < m[a2[pc]] ? a3[pc] : 10;
+              break;
+            case OpCode.BGE_DAT:
+              pc += m[a1[pc]] >= m[a2[pc]] ? a3[pc] : 10;
+              break;
+            case OpCode.BLE_DAT:
+              pc += m[a1[pc]] <= m[a2[pc]] ? a3[pc] : 10;
+              break;
+            case OpCode.BEQ_DAT:
+              pc += m[a1[pc]] === m[a2[pc]] ? a3[pc] : 10;
+              break;
+            case OpCode.BNE_DAT:
+              pc += m[a1[pc]] !== m[a2[pc]] ? a3[pc] : 10;
+              break;
+            case OpCode.SLP_DAT: {
+              const blocks = m[a1[pc]];
+              pc += 5;
+              this.sleep(blocks > 1n ? Number(blocks) : 1);
+              running = false;
+              break;
+            }
+            case OpCode.FIZ_DAT:
+              if (m[a1[pc]] === 0n) {
+                pc = this.finish();
+                running = false;
+              } else {
+                pc += 5;
+              }
+              break;
+            case OpCode.STZ_DAT:
+              pc += 5;
+              if (m[a1[pc - 5]] === 0n) {
+                this.state = "stopped";
+                running = false;
+              }
+              break;
+            case OpCode.FIN_IMD:
+              pc = this.finish();
+              running = false;
+              break;
+            case OpCode.STP_IMD:
+              pc += 1;
+              this.state = "stopped";
+              running = false;
+              break;
+            case OpCode.SLP_IMD:
+              pc += 1;
+              this.sleep(1);
+              running = false;
+              break;
+            case OpCode.ERR_ADR:
+              this.errorPc = a1[pc];
+              pc += 5;
+              break;
+            case OpCode.SET_PCS:
+              pc += 1;
+              this.pcs = pc;
+              break;
+            case OpCode.EXT_FUN:
+              apiCalls++;
+              this.currentSteps = steps;
+              this.callApi(fn[pc], 0n, 0n);
+              pc += 3;
+              break;
+            case OpCode.EXT_FUN_DAT:
+              apiCalls++;
+              this.currentSteps = steps;
+              this.callApi(fn[pc], m[a1[pc]], 0n);
+              pc += 7;
+              break;
+            case OpCode.EXT_FUN_DAT_2:
+              apiCalls++;
+              this.currentSteps = steps;
+              this.callApi(fn[pc], m[a1[pc]], m[a2[pc]]);
+              pc += 11;
+              break;
+            case OpCode.EXT_FUN_RET:
+              apiCalls++;
+              this.currentSteps = steps;
+              m[a1[pc]] = this.callApi(fn[pc], 0n, 0n);
+              pc += 7;
+              break;
+            case OpCode.EXT_FUN_RET_DAT:
+              apiCalls++;
+              this.currentSteps = steps;
+              m[a1[pc]] = this.callApi(fn[pc], m[a2[pc]], 0n);
+              pc += 11;
+              break;
+            case OpCode.EXT_FUN_RET_DAT_2:
+              apiCalls++;
+              this.currentSteps = steps;
+              m[a1[pc]] = this.callApi(fn[pc], m[a2[pc]], m[a3[pc]]);
+              pc += 15;
+              break;
+            case OpCode.NOP:
+              pc += 1;
+              break;
+            default:
+              throw new AtRuntimeError("Invalid instruction");
+          }
+        }
+      } catch (e) {
+        if (!(e instanceof AtRuntimeError)) throw e;
+        if (this.errorPc >= 0 && !(e instanceof StepLimitError)) {
+          pc = this.errorPc;
+          continue;
+        }
+        result.error = `${e.message} at 0x${pc.toString(16).padStart(4, "0")}`;
+        pc = this.finish();
+        running = false;
+      }
+    }
+
+    this.pc = pc;
+    result.steps = steps;
+    result.instructions = instructions;
+    result.apiCalls = apiCalls;
+  }
+
+  private finish() {
+    this.state = "finished";
+    this.callSp = 0;
+    this.userSp = 0;
+    return this.pcs;
+  }
+
+  private sleep(blocks: number) {
+    this.state = "sleeping";
+    this.wakeHeight = this.height + blocks;
+  }
+
+  private address(value: bigint) {
+    if (value < 0n || value >= this.memory.length) {
+      throw new AtRuntimeError(`Invalid memory address ${value}`);
+    }
+    return Number(value);
+  }
+
+  private divisor(value: bigint) {
+    if (value === 0n) {
+      throw new AtRuntimeError("Division by zero");
+    }
+    return value;
+  }
+
+  private available() {
+    return this.chargeFees
+      ? this.balance - BigInt(this.currentSteps) * this.fees.stepFeeNQT
+      : this.balance;
+  }
+
+  private findTransactionAfter(timestamp: bigint) {
+    const txs = this.transactions;
+    let low = 0;
+    let high = txs.length;
+    while (low < high) {
+      const mid = (low + high) >> 1;
+      if (txs[mid].timestamp <= timestamp) {
+        low = mid + 1;
+      } else {
+        high = mid;
+      }
+    }
+    for (let i = low; i < txs.length; i++) {
+      if (txs[i].amount >= this.activationAmount) return txs[i];
+    }
+    return undefined;
+  }
+
+  private getOutgoing(recipient: bigint) {
+    const key = recipient.toString();
+    let tx = this.outgoing.get(key);
+    if (!tx) {
+      tx = {
+        recipient,
+        amount: 0n,
+        assetId: 0n,
+        quantity: 0n,
+        message: null,
+        height: this.height,
+      };
+      this.outgoing.set(key, tx);
+    }
+    return tx;
+  }
+
+  private sendAmount(recipient: bigint, amount: bigint) {
+    const available = this.available();
+    const value = amount > available ? available : amount;
+    if (value <= 0n) return;
+    this.getOutgoing(recipient).amount += value;
+    this.balance -= value;
+    this.updateStepLimit(this.currentSteps);
+  }
+
+  private sendAsset(recipient: bigint, assetId: bigint, quantity: bigint) {
+    const balance = this.getAssetBalance(assetId);
+    const value = quantity > balance ? balance : quantity;
+    if (value <= 0n) return;
+    const key = `${recipient}:${assetId}`;
+    const tx = this.outgoing.get(key);
+    if (tx) {
+      tx.quantity += value;
+    } else {
+      this.outgoing.set(key, {
+        recipient,
+        amount: 0n,
+        assetId,
+        quantity: value,
+        message: null,
+        height: this.height,
+      });
+    }
+    this.assetBalances.set(assetId, balance - value);
+  }
+
+  private isSelf(contractId: bigint) {
+    return contractId === 0n || contractId === this.contractId;
+  }
+
+  private callApi(fn: number, x: bigint, y: bigint): bigint {
+    const r = this.registers;
+    switch (fn) {
+      case ApiFunction.get_A1:
+      case ApiFunction.get_A2:
+      case ApiFunction.get_A3:
+      case ApiFunction.get_A4:
+      case ApiFunction.get_B1:
+      case ApiFunction.get_B2:
+      case ApiFunction.get_B3:
+      case ApiFunction.get_B4:
+        return r[fn - ApiFunction.get_A1];
+      case ApiFunction.set_A1:
+      case ApiFunction.set_A2:
+      case ApiFunction.set_A3:
+      case ApiFunction.set_A4:
+        r[fn - ApiFunction.set_A1] = x;
+        return 0n;
+      case ApiFunction.set_A1_A2:
+        r[A1] = x;
+        r[A2] = y;
+        return 0n;
+      case ApiFunction.set_A3_A4:
+        r[A3] = x;
+        r[A4] = y;
+        return 0n;
+      case ApiFunction.set_B1:
+      case ApiFunction.set_B2:
+      case ApiFunction.set_B3:
+      case ApiFunction.set_B4:
+        r[B1 + fn - ApiFunction.set_B1] = x;
+        return 0n;
+      case ApiFunction.set_B1_B2:
+        r[B1] = x;
+        r[B2] = y;
+        return 0n;
+      case ApiFunction.set_B3_B4:
+        r[B1 + 2] = x;
+        r[B1 + 3] = y;
+        return 0n;
+      case ApiFunction.clear_A:
+        r.fill(0n, A1, B1);
+        return 0n;
+      case ApiFunction.clear_B:
+        r.fill(0n, B1);
+        return 0n;
+      case ApiFunction.clear_A_B:
+        r.fill(0n);
+        return 0n;
+      case ApiFunction.copy_A_From_B:
+        r.copyWithin(A1, B1);
+        return 0n;
+      case ApiFunction.copy_B_From_A:
+        r.copyWithin(B1, A1, B1);
+        return 0n;
+      case ApiFunction.check_A_Is_Zero:
+        return r[0] === 0n && r[1] === 0n && r[2] === 0n && r[3] === 0n
+          ? 1n
+          : 0n;
+      case ApiFunction.check_B_Is_Zero:
+        return r[4] === 0n && r[5] === 0n && r[6] === 0n && r[7] === 0n
+          ? 1n
+          : 0n;
+      case ApiFunction.check_A_equals_B:
+        return r[0] === r[4] && r[1] === r[5] && r[2] === r[6] && r[3] === r[7]
+          ? 1n
+          : 0n;
+      case ApiFunction.swap_A_and_B:
+        for (let i = 0; i < 4; i++) {
+          const a = r[i];
+          r[i] = r[i + 4];
+          r[i + 4] = a;
+        }
+        return 0n;
+      case ApiFunction.OR_A_with_B:
+      case ApiFunction.AND_A_with_B:
+      case ApiFunction.XOR_A_with_B:
+      case ApiFunction.OR_B_with_A:
+      case ApiFunction.AND_B_with_A:
+      case ApiFunction.XOR_B_with_A: {
+        const toA =
+          fn === ApiFunction.OR_A_with_B ||
+          fn === ApiFunction.AND_A_with_B ||
+          fn === ApiFunction.XOR_A_with_B;
+        const target = toA ? A1 : B1;
+        const source = toA ? B1 : A1;
+        for (let i = 0; i < 4; i++) {
+          const a = r[target + i];
+          const b = r[source + i];
+          r[target + i] =
+            fn === ApiFunction.OR_A_with_B || fn === ApiFunction.OR_B_with_A
+              ? a | b
+              : fn === ApiFunction.AND_A_with_B ||
+                  fn === ApiFunction.AND_B_with_A
+                ? a & b
+                : a ^ b;
+        }
+        return 0n;
+      }
+      case ApiFunction.add_A_to_B:
+        writeWide(r, B1, readWide(r, B1) + readWide(r, A1));
+        return 0n;
+      case ApiFunction.add_B_to_A:
+        writeWide(r, A1, readWide(r, A1) + readWide(r, B1));
+        return 0n;
+      case ApiFunction.sub_A_from_B:
+        writeWide(r, B1, readWide(r, B1) - readWide(r, A1));
+        return 0n;
+      case ApiFunction.sub_B_from_A:
+        writeWide(r, A1, readWide(r, A1) - readWide(r, B1));
+        return 0n;
+      case ApiFunction.mul_A_by_B:
+        writeWide(r, A1, readWide(r, A1) * readWide(r, B1));
+        return 0n;
+      case ApiFunction.mul_B_by_A:
+        writeWide(r, B1, readWide(r, B1) * readWide(r, A1));
+        return 0n;
+      case ApiFunction.div_A_by_B:
+        writeWide(r, A1, readWide(r, A1) / this.divisor(readWide(r, B1)));
+        return 0n;
+      case ApiFunction.div_B_by_A:
+        writeWide(r, B1, readWide(r, B1) / this.divisor(readWide(r, A1)));
+        return 0n;
+
+      case ApiFunction.get_Block_Timestamp:
+        return BigInt(this.height) << 32n;
+      case ApiFunction.get_Creation_Timestamp:
+        return BigInt(this.creationHeight) << 32n;
+      case ApiFunction.get_Last_Block_Timestamp:
+        return BigInt(this.height - 1) << 32n;
+      case ApiFunction.put_Last_Block_Hash_In_A:
+      case ApiFunction.Put_Last_Block_GSig_In_A:
+        for (let i = 0; i < 4; i++) {
+          r[i] = splitMix((BigInt(this.height - 1) << 8n) + BigInt(fn + i));
+        }
+        return 0n;
+      case ApiFunction.A_to_Tx_after_Timestamp: {
+        const tx = this.findTransactionAfter(x);
+        r.fill(0n, A1, B1);
+        r[A1] = tx?.txId ?? 0n;
+        return 0n;
+      }
+      case ApiFunction.get_Type_for_Tx_in_A: {
+        const tx = this.transactionsById.get(r[A1]);
+        if (!tx) return -1n;
+        return tx.message.length ? 1n : 0n;
+      }
+      case ApiFunction.get_Amount_for_Tx_in_A: {
+        const tx = this.transactionsById.get(r[A1]);
+        if (!tx) return -1n;
+        if (r[B2] !== 0n) {
+          return tx.assets.find((a) => a.assetId === r[B2])?.quantity ?? 0n;
+        }
+        return tx.amount - this.activationAmount;
+      }
+      case ApiFunction.get_Timestamp_for_Tx_in_A:
+        return this.transactionsById.get(r[A1])?.timestamp ?? -1n;
+      case ApiFunction.get_Ticket_Id_for_Tx_in_A: {
+        const tx = this.transactionsById.get(r[A1]);
+        return tx ? splitMix(tx.txId ^ tx.timestamp) : -1n;
+      }
+      case ApiFunction.message_from_Tx_in_A_to_B: {
+        const tx = this.transactionsById.get(r[A1]);
+        const start = Number(r[A2]) * 4;
+        for (let i = 0; i < 4; i++) {
+          r[B1 + i] = tx && start >= 0 ? (tx.message[start + i] ?? 0n) : 0n;
+        }
+        return 0n;
+      }
+      case ApiFunction.B_to_Address_of_Tx_in_A: {
+        const tx = this.transactionsById.get(r[A1]);
+        r.fill(0n, B1);
+        r[B1] = tx?.sender ?? 0n;
+        return 0n;
+      }
+      case ApiFunction.B_to_Address_of_Creator: {
+        const contractId = r[B2];
+        r.fill(0n, B1);
+        r[B1] = this.isSelf(contractId)
+          ? this.creator
+          : (this.environment.getCreatorOf?.(contractId) ?? 0n);
+        return 0n;
+      }
+      case ApiFunction.Get_Code_Hash_Id: {
+        const contractId = r[B2];
+        return this.isSelf(contractId)
+          ? this.codeHashId
+          : (this.environment.getCodeHashOf?.(contractId) ?? 0n);
+      }
+      case ApiFunction.B_To_Assets_Of_Tx_In_A: {
+        const tx = this.transactionsById.get(r[A1]);
+        for (let i = 0; i < 4; i++) {
+          r[B1 + i] = tx?.assets[i]?.assetId ?? 0n;
+        }
+        return 0n;
+      }
+
+      case ApiFunction.get_Current_Balance:
+        return r[B2] !== 0n ? this.getAssetBalance(r[B2]) : this.available();
+      case ApiFunction.get_Previous_Balance:
+        return this.previousBalance;
+      case ApiFunction.send_to_Address_in_B:
+        if (r[B2] !== 0n) {
+          this.sendAsset(r[B1], r[B2], x);
+        } else {
+          this.sendAmount(r[B1], x);
+        }
+        return 0n;
+      case ApiFunction.send_All_to_Address_in_B:
+        this.sendAmount(r[B1], this.available());
+        return 0n;
+      case ApiFunction.send_Old_to_Address_in_B:
+        this.sendAmount(r[B1], this.previousBalance);
+        return 0n;
+      case ApiFunction.send_A_to_Address_in_B: {
+        const tx = this.getOutgoing(r[B1]);
+        tx.message ??= [];
+        tx.message.push(r[A1], r[A2], r[A3], r[A4]);
+        return 0n;
+      }
+      case ApiFunction.add_Minutes_to_Timestamp:
+        // one block every four minutes
+        return x + ((y / 4n) << 32n);
+      case ApiFunction.Get_Map_Value_Keys_In_A:
+        return this.isSelf(r[A3])
+          ? this.getMapValue(r[A1], r[A2])
+          : (this.environment.getMapValueOf?.(r[A3], r[A1], r[A2]) ?? 0n);
+      case ApiFunction.Set_Map_Value_Keys_In_A:
+        this.setMapValue(r[A1], r[A2], r[A4]);
+        return 0n;
+      case ApiFunction.Issue_Asset:
+        return splitMix(this.contractId ^ (BigInt(this.height) << 16n));
+      case ApiFunction.Mint_Asset:
+        this.assetBalances.set(r[B2], this.getAssetBalance(r[B2]) + r[B1]);
+        return 0n;
+      case ApiFunction.Get_Asset_Holders_Count:
+        return 0n;
+      case ApiFunction.Get_Asset_Circulating:
+        return 0n;
+      case ApiFunction.Get_Activation_Fee: {
+        const contractId = r[B2];
+        return this.isSelf(contractId)
+          ? this.activationAmount
+          : (this.environment.getActivationOf?.(contractId) ?? 0n);
+      }
+      case ApiFunction.Get_Account_Balance:
+        return this.environment.getAccountBalance?.(r[B1], r[B2]) ?? 0n;
+      default:
+        throw new AtRuntimeError(
+          `Unsupported API function ${ApiFunction[fn] ?? `0x${fn.toString(16)}`}`,
+        );
+    }
+  }
+}
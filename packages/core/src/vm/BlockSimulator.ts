@@ -0,0 +1,411 @@
+import { AtMachine, type AtMachineOptions } from "./AtMachine";
+import type {
+  AssetQuantity,
+  AtEnvironment,
+  IncomingTransaction,
+  MachineCode,
+} from "./types";
+
+const FirstContractId = 1_000_000n;
+
+export interface ContractDeployment
+  extends Omit<AtMachineOptions, "environment" | "creationHeight"> {
+  /**
+   * Contracts this one interacts with - contracts referenced by the initial variables are linked
+   * anyway. Linked contracts are always hosted by the same shard.
+   */
+  links?: bigint[];
+}
+
+export interface ScheduledTransaction extends IncomingTransaction {
+  recipient: bigint;
+  /** Height of the block including the transaction first - default: the next one */
+  height?: number;
+  /** Repeats the transaction every n blocks - default: every block, if a count is given */
+  every?: number;
+  /** Number of transactions in total - default: unlimited if repeated, once otherwise */
+  count?: number;
+}
+
+/** A transaction sent by a contract, to be included in the next block */
+export interface RoutedTransaction extends IncomingTransaction {
+  recipient: bigint;
+  /** Index among the transactions of the sender in the block, for a deterministic order */
+  index: number;
+}
+
+export interface SimulatedBlock {
+  height: number;
+  /** Contracts executed in this block */
+  executed: number;
+  /** Transactions included into contracts in this block */
+  transactions: number;
+  steps: number;
+  instructions: number;
+  apiCalls: number;
+  feeNQT: bigint;
+  /** Sent to accounts, i.e. leaving the simulation */
+  paidOutNQT: bigint;
+  errors: { contractId: bigint; error: string }[];
+  /** Lookups of contracts hosted by another shard - answered with zero */
+  remoteReads: number;
+  /** Sent to contracts of other shards - to be delivered to them before the next block */
+  remote: RoutedTransaction[];
+}
+
+export interface SimulatorOptions {
+  /** Height of the block before the first simulated one - default: 0 */
+  height?: number;
+  /** Hosts the contracts of a single shard, for running the shards in parallel */
+  shard?: { index: number; count: number };
+}
+
+interface Deployment {
+  id: bigint;
+  machineCode: MachineCode;
+  options: ContractDeployment;
+}
+
+interface Schedule {
+  tx: ScheduledTransaction;
+  next: number;
+  remaining: number;
+}
+
+const compareIds = (a: bigint, b: bigint) => (a < b ? -1 : a > b ? 1 : 0);
+
+/**
+ * Assigns the contracts to shards - linked contracts stay together, the groups are balanced by
+ * their number of contracts.
+ *
+ * @return The shard index per contract id
+ */
+export function partitionContracts(
+  links: ReadonlyMap<bigint, readonly bigint[]>,
+  count: number,
+) {
+  const parent = new Map<bigint, bigint>();
+  const find = (id: bigint): bigint => {
+    const p = parent.get(id)!;
+    if (p === id) return id;
+    const root = find(p);
+    parent.set(id, root);
+    return root;
+  };
+  for (const id of links.keys()) parent.set(id, id);
+  for (const [id, linked] of links) {
+    for (const other of linked) {
+      if (!parent.has(other)) continue;
+      const [a, b] = [find(id), find(other)];
+      // the smaller id is the root, for a deterministic result
+      if (a !== b) parent.set(a < b ? b : a, a < b ? a : b);
+    }
+  }
+
+  const groups = new Map<bigint, bigint[]>();
+  for (const id of [...links.keys()].sort(compareIds)) {
+    const root = find(id);
+    const group = groups.get(root);
+    if (group) group.push(id);
+    else groups.set(root, [id]);
+  }
+
+  const loads = new Array<number>(count).fill(0);
+  const shards = new Map<bigint, number>();
+  const sorted = [...groups.values()].sort(
+    (a, b) => b.length - a.length || compareIds(a[0]!, b[0]!),
+  );
+  for (const group of sorted) {
+    const shard = loads.indexOf(Math.min(...loads));
+    loads[shard] = loads[shard]! + group.length;
+    for (const id of group) shards.set(id, shard);
+  }
+  return shards;
+}
+
+/**
+ * Sums up the blocks of all shards at the same height
+ */
+export function mergeSimulatedBlocks(blocks: SimulatedBlock[]): SimulatedBlock {
+  const merged: SimulatedBlock = {
+    height: blocks[0]?.height ?? 0,
+    executed: 0,
+    transactions: 0,
+    steps: 0,
+    instructions: 0,
+    apiCalls: 0,
+    feeNQT: 0n,
+    paidOutNQT: 0n,
+    errors: [],
+    remoteReads: 0,
+    remote: [],
+  };
+  for (const block of blocks) {
+    merged.executed += block.executed;
+    merged.transactions += block.transactions;
+    merged.steps += block.steps;
+    merged.instructions += block.instructions;
+    merged.apiCalls += block.apiCalls;
+    merged.feeNQT += block.feeNQT;
+    merged.paidOutNQT += block.paidOutNQT;
+    merged.errors.push(...block.errors);
+    merged.remoteReads += block.remoteReads;
+    merged.remote.push(...block.remote);
+  }
+  return merged;
+}
+
+/**
+ * Hosts many contract instances on a simulated chain and forges blocks for all of them.
+ *
+ * The transactions sent by the contracts are included in the next block - to contracts as
+ * incoming transactions, to accounts as balance. So the contracts of a block run independently
+ * and the simulation can be split into shards, which run in parallel and exchange the `remote`
+ * transactions of each block. The result doesn't depend on the number of shards, as long as
+ * contracts only look up the contracts they are linked with.
+ *
+ * Payments to accounts are not exchanged: a shard only knows the balances of the accounts paid by
+ * its own contracts, so `accounts` and the balance lookups of accounts are partial on a shard.
+ *
+ * ```ts
+ * const simulator = new BlockSimulator();
+ * const certification = simulator.deploy(certificationCode, { balance: 10_0000_0000n });
+ * simulator.deploy(stockCode, { variables: { certificateContractId: certification } });
+ * simulator.schedule({ sender: 1n, recipient: certification, amount: 2_0000_0000n, every: 1 });
+ * const { steps, feeNQT } = simulator.runBlock();
+ * ```
+ */
+export class BlockSimulator {
+  height: number;
+  /** Balances of the accounts paid by the contracts of this shard only */
+  readonly accounts = new Map<bigint, bigint>();
+
+  private readonly shard: { index: number; count: number };
+  private readonly deployments = new Map<bigint, Deployment>();
+  private readonly machines = new Map<bigint, AtMachine>();
+  private readonly schedules: Schedule[] = [];
+  private routed: RoutedTransaction[] = [];
+  private nextContractId = FirstContractId;
+  private started = false;
+  private remoteReads = 0;
+  private readonly environment: AtEnvironment;
+
+  constructor(options: SimulatorOptions = {}) {
+    this.height = options.height ?? 0;
+    this.shard = options.shard ?? { index: 0, count: 1 };
+
+    const local = (contractId: bigint) => {
+      const machine = this.machines.get(contractId);
+      if (!machine && this.deployments.has(contractId)) this.remoteReads++;
+      return machine;
+    };
+    this.environment = {
+      getActivationOf: (id) => {
+        const deployment = this.deployments.get(id);
+        return (
+          deployment?.options.activationAmount ??
+          BigInt(deployment?.machineCode.PActivationAmount ?? 0)
+        );
+      },
+      getCreatorOf: (id) => this.deployments.get(id)?.options.creator ?? 0n,
+      getCodeHashOf: (id) =>
+        BigInt.asIntN(
+          64,
+          BigInt(this.deployments.get(id)?.machineCode.MachineCodeHashId ?? 0),
+        ),
+      getMapValueOf: (id, key1, key2) =>
+        local(id)?.getMapValue(key1, key2) ?? 0n,
+      getAccountBalance: (id, assetId) => {
+        if (!this.deployments.has(id)) {
+          return assetId === 0n ? (this.accounts.get(id) ?? 0n) : 0n;
+        }
+        const machine = local(id);
+        if (!machine) return 0n;
+        return assetId === 0n
+          ? machine.balance
+          : machine.getAssetBalance(assetId);
+      },
+    };
+  }
+
+  /**
+   * Deploys a contract, before the first block. Every shard deploys all contracts in the same
+   * order - only the ones of its own shard are instantiated.
+   *
+   * @return The contract id
+   */
+  deploy(machineCode: MachineCode, options: ContractDeployment = {}) {
+    if (this.started) {
+      throw new Error("Contracts must be deployed before the first block");
+    }
+    const id = options.contractId ?? this.nextContractId++;
+    if (this.deployments.has(id)) {
+      throw new Error(`Contract ${id} is deployed already`);
+    }
+    this.deployments.set(id, { id, machineCode, options });
+    return id;
+  }
+
+  /** The contract instance, if hosted by this shard */
+  contract(contractId: bigint) {
+    this.start();
+    return this.machines.get(contractId);
+  }
+
+  /** Ids of the contracts hosted by this shard, ascending */
+  get contractIds() {
+    this.start();
+    return [...this.machines.keys()];
+  }
+
+  isHosted(contractId: bigint) {
+    return this.contract(contractId) !== undefined;
+  }
+
+  /**
+   * Sends a transaction to a contract, once or repeatedly - shards ignore the transactions to
+   * contracts of other shards.
+   */
+  schedule(tx: ScheduledTransaction) {
+    this.schedules.push({
+      tx,
+      next: tx.height ?? this.height + 1,
+      remaining: tx.count ?? (tx.every ? Infinity : 1),
+    });
+  }
+
+  /** Delivers transactions of other shards' contracts, sent in the last block */
+  deliver(transactions: readonly RoutedTransaction[]) {
+    this.routed.push(...transactions);
+  }
+
+  /**
+   * Forges the next block - includes the transactions sent in the last block and the scheduled
+   * ones, then runs all contracts of this shard in the order of their ids.
+   */
+  runBlock(): SimulatedBlock {
+    this.start();
+    this.height++;
+    const block: SimulatedBlock = {
+      height: this.height,
+      executed: 0,
+      transactions: 0,
+      steps: 0,
+      instructions: 0,
+      apiCalls: 0,
+      feeNQT: 0n,
+      paidOutNQT: 0n,
+      errors: [],
+      remoteReads: 0,
+      remote: [],
+    };
+
+    // the same order on all shards - by sender, then as sent
+    const routed = this.routed.sort(
+      (a, b) => compareIds(a.sender, b.sender) || a.index - b.index,
+    );
+    this.routed = [];
+    for (const { recipient, index, ...tx } of routed) {
+      this.include(recipient, tx, block);
+    }
+    for (const schedule of this.schedules) {
+      if (schedule.remaining <= 0 || schedule.next > this.height) continue;
+      const { recipient, height, every, count, ...tx } = schedule.tx;
+      this.include(recipient, tx, block);
+      schedule.remaining--;
+      schedule.next = this.height + (every ?? 1);
+    }
+
+    this.remoteReads = 0;
+    for (const [contractId, machine] of this.machines) {
+      const result = machine.runBlock();
+      if (!result.executed) continue;
+      block.executed++;
+      block.steps += result.steps;
+      block.instructions += result.instructions;
+      block.apiCalls += result.apiCalls;
+      block.feeNQT += result.feeNQT;
+      if (result.error) block.errors.push({ contractId, error: result.error });
+
+      result.outgoing.forEach((outgoing, index) => {
+        const assets: AssetQuantity[] = outgoing.quantity
+          ? [{ assetId: outgoing.assetId, quantity: outgoing.quantity }]
+          : [];
+        const tx: RoutedTransaction = {
+          recipient: outgoing.recipient,
+          sender: contractId,
+          amount: outgoing.amount,
+          message: outgoing.message ?? undefined,
+          assets,
+          index,
+        };
+        if (this.machines.has(tx.recipient)) {
+          this.routed.push(tx);
+        } else if (this.deployments.has(tx.recipient)) {
+          block.remote.push(tx);
+        } else {
+          this.accounts.set(
+            tx.recipient,
+            (this.accounts.get(tx.recipient) ?? 0n) + outgoing.amount,
+          );
+          block.paidOutNQT += outgoing.amount;
+        }
+      });
+    }
+    block.remoteReads = this.remoteReads;
+    return block;
+  }
+
+  /**
+   * Forges the given number of blocks - for a single shard, use `runBlock` and `deliver` to
+   * run several shards in lockstep
+   */
+  run(blocks: number): SimulatedBlock[] {
+    if (this.shard.count > 1) {
+      throw new Error("Shards must be run block by block");
+    }
+    return Array.from({ length: blocks }, () => this.runBlock());
+  }
+
+  private include(
+    recipient: bigint,
+    tx: IncomingTransaction,
+    block: SimulatedBlock,
+  ) {
+    const machine = this.machines.get(recipient);
+    if (!machine) return;
+    machine.queueTransaction(tx);
+    block.transactions++;
+  }
+
+  // instantiates the contracts of this shard, once all are deployed
+  private start() {
+    if (this.started) return;
+    this.started = true;
+
+    const ids = new Set(this.deployments.keys());
+    const links = new Map<bigint, bigint[]>();
+    for (const { id, options } of this.deployments.values()) {
+      const referenced = Object.values(options.variables ?? {}).filter(
+        (value) => value !== id && ids.has(value),
+      );
+      links.set(id, [...(options.links ?? []), ...referenced]);
+    }
+    const shards = partitionContracts(links, this.shard.count);
+
+    for (const id of [...ids].sort(compareIds)) {
+      if (shards.get(id) !== this.shard.index) continue;
+      const { machineCode, options } = this.deployments.get(id)!;
+      const { links: _, ...machineOptions } = options;
+      this.machines.set(
+        id,
+        new AtMachine(machineCode, {
+          ...machineOptions,
+          contractId: id,
+          creationHeight: this.height,
+          environment: this.environment,
+        }),
+      );
+    }
+  }
+}
@@ -0,0 +1,171 @@
+import { ApiFunction } from "./api-functions";
+import { hexToBytes } from "./AtMachine";
+import {
+  OpCode,
+  type OpCodeInfo,
+  OpCodeTable,
+  OperandKind,
+  OperandSizes,
+} from "./opcodes";
+
+export interface Instruction {
+  /** Code address of the opcode */
+  offset: number;
+  info: OpCodeInfo;
+  /**
+   * Operands in bytecode order - values as bigint, all others as number.
+   * Branch offsets are resolved to absolute code addresses.
+   */
+  operands: (number | bigint)[];
+}
+
+export interface FormatOptions {
+  /** Variable names by memory address, e.g. `MachineData.Memory` */
+  memory?: string[];
+  /** Label names by code address */
+  labels?: Map<number, string>;
+}
+
+/**
+ * Decoded bytecode with a lookup from any code address to the instruction covering it
+ */
+export class Disassembly {
+  /**
+   * @param instructions In code order
+   * @param indexByOffset Instruction index per code address, -1 where no instruction was decoded
+   * @param invalidOffset Address of the first byte which is no valid instruction, -1 if all bytes were decoded
+   */
+  constructor(
+    readonly instructions: Instruction[],
+    readonly indexByOffset: Int32Array,
+    readonly invalidOffset: number,
+  ) {}
+
+  /**
+   * The instruction covering the given code address, i.e. its opcode or one of its operand bytes
+   */
+  at(offset: number): Instruction | undefined {
+    const index = this.indexByOffset[offset];
+    return index === undefined || index < 0
+      ? undefined
+      : this.instructions[index];
+  }
+
+  get size() {
+    return this.indexByOffset.length;
+  }
+}
+
+/**
+ * Decodes the bytecode back into instructions, driven by the `OpCodeTable`.
+ * Decoding stops at the first invalid opcode, as code and data cannot be told apart beyond it.
+ */
+export function disassemble(byteCode: string | Uint8Array): Disassembly {
+  const code = typeof byteCode === "string" ? hexToBytes(byteCode) : byteCode;
+  const view = new DataView(code.buffer, code.byteOffset, code.byteLength);
+  const indexByOffset = new Int32Array(code.length).fill(-1);
+  const instructions: Instruction[] = [];
+
+  let pc = 0;
+  while (pc < code.length) {
+    const info = OpCodeTable[code[pc]!];
+    if (!info || pc + info.size > code.length) break;
+
+    const operands: (number | bigint)[] = [];
+    let offset = pc + 1;
+    for (const kind of info.operands) {
+      switch (kind) {
+        case OperandKind.Address:
+        case OperandKind.Code:
+          operands.push(view.getInt32(offset, true));
+          break;
+        case OperandKind.Value:
+          operands.push(view.getBigInt64(offset, true));
+          break;
+        case OperandKind.Offset:
+          operands.push(pc + view.getInt8(offset));
+          break;
+        case OperandKind.Function:
+          operands.push(view.getUint16(offset, true));
+          break;
+      }
+      offset += OperandSizes[kind];
+    }
+
+    indexByOffset.fill(instructions.length, pc, pc + info.size);
+    instructions.push({ offset: pc, info, operands });
+    pc += info.size;
+  }
+  return new Disassembly(
+    instructions,
+    indexByOffset,
+    pc < code.length ? pc : -1,
+  );
+}
+
+function formatAddress(address: number) {
+  return address.toString(16).padStart(4, "0");
+}
+
+/**
+ * Formats the instruction in the assembler syntax of SmartC, e.g. `SET @a $($b + $c)`
+ */
+export function formatInstruction(
+  { info, operands }: Instruction,
+  { memory = [], labels = new Map() }: FormatOptions = {},
+): string {
+  const name = (address: number | bigint) =>
+    memory[Number(address)] ?? `var${address}`;
+  const label = (address: number | bigint) =>
+    `:${labels.get(Number(address)) ?? `__${formatAddress(Number(address))}`}`;
+  const args = (from: number) => operands.slice(from).map((o) => `$${name(o)}`);
+  const [a = 0, b = 0, c = 0] = operands;
+  const m = info.mnemonic;
+
+  switch (info.code) {
+    case OpCode.SET_VAL:
+      return `${m} @${name(a)} #${BigInt.asUintN(64, BigInt(b)).toString(16).padStart(16, "0")}`;
+    case OpCode.SET_IND:
+      return `${m} @${name(a)} $($${name(b)})`;
+    case OpCode.SET_IDX:
+      return `${m} @${name(a)} $($${name(b)} + $${name(c)})`;
+    case OpCode.IND_DAT:
+      return `${m} @($${name(a)}) $${name(b)}`;
+    case OpCode.IDX_DAT:
+      return `${m} @($${name(a)} + $${name(b)}) $${name(c)}`;
+    case OpCode.PSH_DAT:
+    case OpCode.SLP_DAT:
+    case OpCode.FIZ_DAT:
+    case OpCode.STZ_DAT:
+      return `${m} $${name(a)}`;
+    case OpCode.JMP_SUB:
+    case OpCode.JMP_ADR:
+    case OpCode.ERR_ADR:
+      return `${m} ${label(a)}`;
+    case OpCode.BZR_DAT:
+    case OpCode.BNZ_DAT:
+      return `${m} $${name(a)} ${label(b)}`;
+    case OpCode.BGT_DAT:
+    case OpCode.BLT_DAT:
+    case OpCode.BGE_DAT:
+    case OpCode.BLE_DAT:
+    case OpCode.BEQ_DAT:
+    case OpCode.BNE_DAT:
+      return `${m} $${name(a)} $${name(b)} ${label(c)}`;
+    case OpCode.EXT_FUN:
+    case OpCode.EXT_FUN_DAT:
+    case OpCode.EXT_FUN_DAT_2:
+      return [m, ApiFunction[Number(a)] ?? a, ...args(1)].join(" ");
+    case OpCode.EXT_FUN_RET:
+    case OpCode.EXT_FUN_RET_DAT:
+    case OpCode.EXT_FUN_RET_DAT_2:
+      return [m, `@${name(b)}`, ApiFunction[Number(a)] ?? a, ...args(2)].join(
+        " ",
+      );
+    default:
+      // remaining instructions take a target variable followed by source variables
+      return operands.length
+        ? [m, `@${name(a)}`, ...args(1)].join(" ")
+        : m;
+  }
+}
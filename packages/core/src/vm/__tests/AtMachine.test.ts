@@ -0,0 +1,319 @@
+import { describe, expect, it } from "bun:test";
+import { readFileSync } from "node:fs";
+import { resolve } from "node:path";
+import { compile } from "../../generator/__tests/compile";
+import { AtMachine } from "../AtMachine";
+import { ApiFunction } from "../api-functions";
+import { OpCode } from "../opcodes";
+import { type Line, machineCode } from "./assemble";
+
+const Fun = ApiFunction;
+
+// stores map[message][sender] = amount and refunds the amount - for every incoming transaction
+const EchoMemory = ["counter", "tx", "sender", "amount", "msg"];
+const [counter, tx, sender, amount, msg] = [0, 1, 2, 3, 4];
+const EchoContract: Line[] = [
+  [OpCode.SET_PCS],
+  "loop:",
+  [OpCode.EXT_FUN_DAT, Fun.A_to_Tx_after_Timestamp, counter],
+  [OpCode.EXT_FUN_RET, Fun.get_A1, tx],
+  [OpCode.BZR_DAT, tx, "end"],
+  [OpCode.EXT_FUN_RET, Fun.get_Timestamp_for_Tx_in_A, counter],
+  [OpCode.EXT_FUN, Fun.B_to_Address_of_Tx_in_A],
+  [OpCode.EXT_FUN_RET, Fun.get_B1, sender],
+  [OpCode.EXT_FUN_RET, Fun.get_Amount_for_Tx_in_A, amount],
+  [OpCode.EXT_FUN, Fun.message_from_Tx_in_A_to_B],
+  [OpCode.EXT_FUN_RET, Fun.get_B1, msg],
+  [OpCode.EXT_FUN_DAT_2, Fun.set_A1_A2, msg, sender],
+  [OpCode.EXT_FUN_DAT, Fun.set_A4, amount],
+  [OpCode.EXT_FUN, Fun.Set_Map_Value_Keys_In_A],
+  [OpCode.EXT_FUN, Fun.clear_B],
+  [OpCode.EXT_FUN_DAT, Fun.set_B1, sender],
+  [OpCode.EXT_FUN_DAT, Fun.send_to_Address_in_B, amount],
+  [OpCode.JMP_ADR, "loop"],
+  "end:",
+  [OpCode.FIN_IMD],
+];
+
+describe("AtMachine", () => {
+  describe("instructions", () => {
+    it("should calculate", () => {
+      const machine = new AtMachine(
+        machineCode(
+          [
+            [OpCode.SET_VAL, 0, 7n],
+            [OpCode.SET_VAL, 1, 3n],
+            [OpCode.SET_DAT, 2, 0],
+            [OpCode.MUL_DAT, 2, 1],
+            [OpCode.SET_DAT, 3, 0],
+            [OpCode.DIV_DAT, 3, 1],
+            [OpCode.SET_DAT, 4, 0],
+            [OpCode.MOD_DAT, 4, 1],
+            [OpCode.SET_VAL, 5, -1n],
+            [OpCode.SHR_DAT, 5, 1],
+            [OpCode.SET_VAL, 6, 0x7fffffffffffffffn],
+            [OpCode.INC_DAT, 6],
+            [OpCode.FIN_IMD],
+          ],
+          ["a", "b", "product", "quotient", "remainder", "shifted", "overflow"],
+        ),
+      );
+      machine.queueTransaction({ sender: 1n, amount: 2_0000_0000n });
+      const result = machine.runBlock();
+      expect(result.executed).toBeTruthy();
+      expect(result.error).toBeUndefined();
+      expect(machine.getVariable("product")).toBe(21n);
+      expect(machine.getVariable("quotient")).toBe(2n);
+      expect(machine.getVariable("remainder")).toBe(1n);
+      expect(machine.getVariable("shifted")).toBe(0x1fffffffffffffffn);
+      expect(machine.getVariable("overflow")).toBe(-0x8000000000000000n);
+      expect(result.instructions).toBe(13);
+      expect(result.state).toBe("finished");
+    });
+
+    it("should branch and call subroutines", () => {
+      const machine = new AtMachine(
+        machineCode(
+          [
+            [OpCode.SET_VAL, 1, 5n],
+            "loop:",
+            [OpCode.JMP_SUB, "inc"],
+            [OpCode.DEC_DAT, 1],
+            [OpCode.BNZ_DAT, 1, "loop"],
+            [OpCode.FIN_IMD],
+            "inc:",
+            [OpCode.INC_DAT, 0],
+            [OpCode.RET_SUB],
+          ],
+          ["calls", "n"],
+        ),
+      );
+      machine.queueTransaction({ sender: 1n, amount: 2_0000_0000n });
+      machine.runBlock();
+      expect(machine.getVariable("calls")).toBe(5n);
+    });
+
+    it("should use the user stack and indirect addressing", () => {
+      const machine = new AtMachine(
+        machineCode(
+          [
+            [OpCode.SET_VAL, 0, 2n],
+            [OpCode.SET_VAL, 1, 42n],
+            [OpCode.IND_DAT, 0, 1], // @($0) = $1
+            [OpCode.PSH_DAT, 2],
+            [OpCode.POP_DAT, 3],
+            [OpCode.SET_VAL, 4, 1n],
+            [OpCode.SET_IDX, 5, 4, 0], // @5 = $($4 + $0)
+            [OpCode.FIN_IMD],
+          ],
+          ["pointer", "value", "target", "popped", "offset", "indexed"],
+        ),
+      );
+      machine.queueTransaction({ sender: 1n, amount: 2_0000_0000n });
+      machine.runBlock();
+      expect(machine.getVariable("target")).toBe(42n);
+      expect(machine.getVariable("popped")).toBe(42n);
+      expect(machine.getVariable("indexed")).toBe(42n);
+    });
+
+    it("should report runtime errors and finish", () => {
+      const machine = new AtMachine(
+        machineCode(
+          [[OpCode.DIV_DAT, 0, 1], [OpCode.FIN_IMD]],
+          ["a", "zero"],
+        ),
+      );
+      machine.queueTransaction({ sender: 1n, amount: 2_0000_0000n });
+      const result = machine.runBlock();
+      expect(result.error).toBe("Division by zero at 0x0000");
+      expect(machine.state).toBe("finished");
+    });
+
+    it("should jump to the error handler", () => {
+      const machine = new AtMachine(
+        machineCode(
+          [
+            [OpCode.ERR_ADR, "handler"],
+            [OpCode.DIV_DAT, 0, 1],
+            [OpCode.FIN_IMD],
+            "handler:",
+            [OpCode.SET_VAL, 2, 1n],
+            [OpCode.FIN_IMD],
+          ],
+          ["a", "zero", "handled"],
+        ),
+      );
+      machine.queueTransaction({ sender: 1n, amount: 2_0000_0000n });
+      const result = machine.runBlock();
+      expect(result.error).toBeUndefined();
+      expect(machine.getVariable("handled")).toBe(1n);
+    });
+
+    it("should detect stack overflows", () => {
+      const machine = new AtMachine(
+        machineCode([[OpCode.JMP_SUB, 0]], [], { CodeStackPages: 1 }),
+      );
+      machine.queueTransaction({ sender: 1n, amount: 2_0000_0000n });
+      expect(machine.runBlock().error).toBe("Code stack overflow at 0x0000");
+    });
+
+    it("should stop endless loops", () => {
+      const machine = new AtMachine(
+        machineCode([[OpCode.JMP_ADR, 0]], [], { CodeStackPages: 0 }),
+        { chargeFees: false, maxStepsPerBlock: 1000 },
+      );
+      machine.queueTransaction({ sender: 1n, amount: 2_0000_0000n });
+      const result = machine.runBlock();
+      expect(result.error).toBe("Step limit per block exceeded at 0x0000");
+      expect(result.steps).toBe(1000);
+    });
+  });
+
+  describe("transactions", () => {
+    it("should process incoming transactions and send outgoing ones", () => {
+      const machine = new AtMachine(machineCode(EchoContract, EchoMemory));
+      machine.queueTransaction({
+        sender: 100n,
+        amount: 3_0000_0000n,
+        message: [7n],
+      });
+      machine.queueTransaction({
+        sender: 200n,
+        amount: 5_0000_0000n,
+        message: [8n],
+      });
+      const result = machine.runBlock();
+
+      expect(result.error).toBeUndefined();
+      expect(machine.getMapValue(7n, 100n)).toBe(2_0000_0000n);
+      expect(machine.getMapValue(8n, 200n)).toBe(4_0000_0000n);
+      expect(
+        result.outgoing.map(({ recipient, amount }) => [recipient, amount]),
+      ).toEqual([
+        [100n, 2_0000_0000n],
+        [200n, 4_0000_0000n],
+      ]);
+      expect(result.feeNQT).toBe(
+        BigInt(result.steps) * machine.fees.stepFeeNQT,
+      );
+      expect(machine.balance).toBe(2_0000_0000n - result.feeNQT);
+      expect(machine.pc).toBe(machine.pcs);
+    });
+
+    it("should not be activated by transactions below the activation amount", () => {
+      const machine = new AtMachine(machineCode(EchoContract, EchoMemory));
+      machine.queueTransaction({ sender: 100n, amount: 5000_0000n });
+      const result = machine.runBlock();
+      expect(result.executed).toBeFalsy();
+      expect(machine.balance).toBe(5000_0000n);
+    });
+
+    it("should freeze when running out of balance", () => {
+      const machine = new AtMachine(
+        machineCode([[OpCode.INC_DAT, 0], [OpCode.JMP_ADR, 0]], ["n"]),
+        { activationAmount: 0n },
+      );
+      machine.queueTransaction({
+        sender: 100n,
+        amount: machine.fees.stepFeeNQT * 100n,
+      });
+      const result = machine.runBlock();
+      expect(result.state).toBe("frozen");
+      expect(result.steps).toBe(100);
+      expect(machine.balance).toBe(0n);
+      expect(machine.getVariable("n")).toBe(50n);
+    });
+
+    it("should resume after sleeping", () => {
+      const machine = new AtMachine(
+        machineCode(
+          [[OpCode.INC_DAT, 0], [OpCode.SLP_IMD], [OpCode.INC_DAT, 0], [OpCode.FIN_IMD]],
+          ["n"],
+        ),
+      );
+      machine.queueTransaction({ sender: 100n, amount: 2_0000_0000n });
+      expect(machine.runBlock().state).toBe("sleeping");
+      expect(machine.getVariable("n")).toBe(1n);
+      expect(machine.runBlock().state).toBe("finished");
+      expect(machine.getVariable("n")).toBe(2n);
+    });
+
+    it("should initialize variables by name", () => {
+      const machine = new AtMachine(machineCode([[OpCode.FIN_IMD]], ["owner"]), {
+        variables: { owner: 42n },
+      });
+      expect(machine.getVariable("owner")).toBe(42n);
+      expect(() => machine.setVariable("unknown", 1n)).toThrow(
+        "Unknown variable: unknown",
+      );
+    });
+
+    it("should replay many transactions", () => {
+      const machine = new AtMachine(machineCode(EchoContract, EchoMemory));
+      const count = 10_000;
+      const transactions = Array.from({ length: count }, (_, i) => ({
+        sender: BigInt(i % 100),
+        amount: 2_0000_0000n,
+        message: [BigInt(i)],
+      }));
+
+      const result = machine.replay(transactions, { transactionsPerBlock: 10 });
+
+      expect(result.transactions).toBe(count);
+      expect(result.blocks).toBe(count / 10);
+      expect(result.errors).toHaveLength(0);
+      expect(machine.getMapValue(9999n, 99n)).toBe(1_0000_0000n);
+      expect([...machine.mapEntries()]).toHaveLength(count);
+    });
+  });
+
+  describe("examples", () => {
+    const Creator = 10n;
+    const User = 20n;
+    const Signa = 1_0000_0000n;
+    const [Incoming, Stack, Errors] = [1n, 2n, 99n];
+
+    // the example pins an older compiler version, which the current compiler refuses
+    const stock = () =>
+      compile(
+        readFileSync(
+          resolve(import.meta.dir, "../../../../../examples/stock.smart.c"),
+          "utf8",
+        ).replace(/^#pragma version .*$/m, ""),
+      );
+
+    it("should run the stock contract compiled by SmartC", () => {
+      const machine = new AtMachine(stock(), {
+        creator: Creator,
+        balance: 100n * Signa,
+        variables: { owner: Creator, stockMode: BigInt("W".charCodeAt(0)) },
+      });
+
+      // registerIncomingMaterial(quantity, originId) by the creator, an admin
+      machine.queueTransaction({
+        sender: Creator,
+        amount: Signa,
+        message: [1n, 500n, 1234n],
+      });
+      expect(machine.runBlock().error).toBeUndefined();
+      expect(machine.getMapValue(Incoming, 1234n)).toBe(500n);
+      expect(machine.getMapValue(Stack, 0n)).toBe(1234n);
+      expect(machine.getVariable("stackPointer")).toBe(1n);
+      expect(machine.getVariable("usageFee")).toBe(5n * Signa);
+
+      // a user without permission pays the usage fee and gets an error entry
+      const txId = machine.queueTransaction({
+        sender: User,
+        amount: 5n * Signa,
+        message: [1n, 100n, 4321n],
+      });
+      const { outgoing, error } = machine.runBlock();
+      expect(error).toBeUndefined();
+      expect(machine.getMapValue(Errors, txId)).toBe(3n);
+      expect(machine.getMapValue(Incoming, 4321n)).toBe(0n);
+      expect(outgoing).toHaveLength(1);
+      expect(outgoing[0]!.recipient).toBe(Creator);
+      expect(outgoing[0]!.amount).toBe(5n * Signa);
+    });
+  });
+});
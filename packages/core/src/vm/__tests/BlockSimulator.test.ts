@@ -0,0 +1,153 @@
+import { describe, expect, it } from "bun:test";
+import {
+  BlockSimulator,
+  mergeSimulatedBlocks,
+  partitionContracts,
+  type SimulatedBlock,
+} from "../BlockSimulator";
+import { ApiFunction as Fun } from "../api-functions";
+import { OpCode } from "../opcodes";
+import { type Line, machineCode } from "./assemble";
+
+// forwards `forward` to the contract in the first long of each message
+const ForwarderMemory = ["counter", "tx", "target", "forward"];
+const Forwarder: Line[] = [
+  [OpCode.SET_PCS],
+  "loop:",
+  [OpCode.EXT_FUN_DAT, Fun.A_to_Tx_after_Timestamp, 0],
+  [OpCode.EXT_FUN_RET, Fun.get_A1, 1],
+  [OpCode.BZR_DAT, 1, "end"],
+  [OpCode.EXT_FUN_RET, Fun.get_Timestamp_for_Tx_in_A, 0],
+  [OpCode.EXT_FUN, Fun.message_from_Tx_in_A_to_B],
+  [OpCode.EXT_FUN_RET, Fun.get_B1, 2],
+  [OpCode.EXT_FUN, Fun.clear_B],
+  [OpCode.EXT_FUN_DAT, Fun.set_B1, 2],
+  [OpCode.EXT_FUN_DAT, Fun.send_to_Address_in_B, 3],
+  [OpCode.JMP_ADR, "loop"],
+  "end:",
+  [OpCode.FIN_IMD],
+];
+
+// counts the incoming transactions and pays `pay` to `payee` for each
+const CounterMemory = ["counter", "tx", "count", "payee", "pay"];
+const Counter: Line[] = [
+  [OpCode.SET_PCS],
+  "loop:",
+  [OpCode.EXT_FUN_DAT, Fun.A_to_Tx_after_Timestamp, 0],
+  [OpCode.EXT_FUN_RET, Fun.get_A1, 1],
+  [OpCode.BZR_DAT, 1, "end"],
+  [OpCode.EXT_FUN_RET, Fun.get_Timestamp_for_Tx_in_A, 0],
+  [OpCode.INC_DAT, 2],
+  [OpCode.EXT_FUN, Fun.clear_B],
+  [OpCode.EXT_FUN_DAT, Fun.set_B1, 3],
+  [OpCode.EXT_FUN_DAT, Fun.send_to_Address_in_B, 4],
+  [OpCode.JMP_ADR, "loop"],
+  "end:",
+  [OpCode.FIN_IMD],
+];
+
+const Signa = 1_0000_0000n;
+const Payee = 99n;
+
+function deployNetwork(simulator: BlockSimulator, pairs: number) {
+  const counters = Array.from({ length: pairs }, () =>
+    simulator.deploy(machineCode(Counter, CounterMemory), {
+      balance: 100n * Signa,
+      variables: { payee: Payee, pay: Signa / 10n },
+    }),
+  );
+  // the targets are only known from the messages, so the contracts aren't linked
+  counters.forEach((_, i) => {
+    const forwarder = simulator.deploy(machineCode(Forwarder, ForwarderMemory), {
+      balance: 100n * Signa,
+      variables: { forward: 2n * Signa },
+    });
+    simulator.schedule({
+      sender: 1n,
+      recipient: forwarder,
+      amount: 2n * Signa,
+      message: [counters[(i + 1) % pairs]!],
+      every: 1,
+      count: 3,
+    });
+  });
+  return counters;
+}
+
+// runs the shards in lockstep, like workers would
+function runShards(count: number, blocks: number) {
+  const shards = Array.from({ length: count }, (_, index) => {
+    const simulator = new BlockSimulator({ shard: { index, count } });
+    return { simulator, counters: deployNetwork(simulator, 4) };
+  });
+  const merged: Omit<SimulatedBlock, "remote">[] = [];
+  let exchanged = 0;
+  for (let i = 0; i < blocks; i++) {
+    const results = shards.map(({ simulator }) => simulator.runBlock());
+    const { remote, ...block } = mergeSimulatedBlocks(results);
+    for (const { simulator } of shards) {
+      simulator.deliver(remote.filter((tx) => simulator.isHosted(tx.recipient)));
+    }
+    merged.push(block);
+    exchanged += remote.length;
+  }
+  const counts = shards[0]!.counters.map((id) => {
+    const { simulator } = shards.find((s) => s.simulator.isHosted(id))!;
+    return simulator.contract(id)!.getVariable("count");
+  });
+  return { merged, counts, exchanged };
+}
+
+describe("BlockSimulator", () => {
+  it("should include the sent transactions in the next block", () => {
+    const simulator = new BlockSimulator();
+    const [counter] = deployNetwork(simulator, 1);
+    const blocks = simulator.run(4);
+
+    expect(blocks.map((b) => b.executed)).toEqual([1, 2, 2, 1]);
+    expect(blocks.map((b) => b.transactions)).toEqual([1, 2, 2, 1]);
+    expect(simulator.contract(counter!)!.getVariable("count")).toBe(3n);
+    expect(simulator.accounts.get(Payee)).toBe(3n * (Signa / 10n));
+    expect(blocks[3]!.paidOutNQT).toBe(Signa / 10n);
+    expect(blocks.every((b) => b.errors.length === 0)).toBe(true);
+    expect(blocks.every((b) => b.feeNQT > 0n)).toBe(true);
+    expect(simulator.height).toBe(4);
+  });
+
+  it("should give the same result on any number of shards", () => {
+    const single = runShards(1, 5);
+    expect(single.counts).toEqual([3n, 3n, 3n, 3n]);
+    expect(single.exchanged).toBe(0);
+    for (const count of [2, 3]) {
+      const sharded = runShards(count, 5);
+      expect(sharded.exchanged).toBeGreaterThan(0);
+      expect(sharded.merged).toEqual(single.merged);
+      expect(sharded.counts).toEqual(single.counts);
+    }
+  });
+
+  it("should keep linked contracts on the same shard", () => {
+    const links = new Map<bigint, bigint[]>([
+      [1n, [2n]],
+      [2n, []],
+      [3n, []],
+      [4n, [3n]],
+      [5n, []],
+    ]);
+    expect([...partitionContracts(links, 2)]).toEqual([
+      [1n, 0],
+      [2n, 0],
+      [3n, 1],
+      [4n, 1],
+      [5n, 0],
+    ]);
+
+    const simulator = new BlockSimulator({ shard: { index: 1, count: 2 } });
+    const code = machineCode(Counter, CounterMemory);
+    const certification = simulator.deploy(code);
+    simulator.deploy(code, { variables: { payee: certification } });
+    const other = simulator.deploy(code);
+    expect(simulator.contractIds).toEqual([other]);
+    expect(() => simulator.deploy(code)).toThrow("before the first block");
+  });
+});
@@ -0,0 +1,83 @@
+import { describe, expect, it } from "bun:test";
+import { disassemble, formatInstruction } from "../Disassembler";
+import { ApiFunction } from "../api-functions";
+import { OpCode } from "../opcodes";
+import { assemble } from "./assemble";
+
+const Memory = ["a", "b", "c"];
+const [a, b, c] = Memory.keys();
+
+describe("Disassembler", () => {
+  it("should decode instructions and operands", () => {
+    const { instructions, invalidOffset } = disassemble(
+      assemble([
+        [OpCode.SET_VAL, a, -1n],
+        "loop:",
+        [OpCode.IDX_DAT, a, b, c],
+        [OpCode.BNE_DAT, a, b, "loop"],
+        [OpCode.EXT_FUN_RET_DAT, ApiFunction.get_A1, c, a],
+        [OpCode.FIN_IMD],
+      ]),
+    );
+
+    expect(invalidOffset).toBe(-1);
+    expect(
+      instructions.map(({ offset, info, operands }) => [offset, info.code, operands]),
+    ).toEqual([
+      [0, OpCode.SET_VAL, [a, -1n]],
+      [13, OpCode.IDX_DAT, [a, b, c]],
+      // branch offsets are resolved to absolute addresses
+      [26, OpCode.BNE_DAT, [a, b, 13]],
+      [36, OpCode.EXT_FUN_RET_DAT, [ApiFunction.get_A1, c, a]],
+      [47, OpCode.FIN_IMD, []],
+    ]);
+  });
+
+  it("should find the instruction covering any code address", () => {
+    const disassembly = disassemble(
+      assemble([[OpCode.INC_DAT, a], [OpCode.FIN_IMD]]) + "ff00",
+    );
+    expect(disassembly.at(0)?.offset).toBe(0);
+    expect(disassembly.at(4)?.offset).toBe(0);
+    expect(disassembly.at(5)?.info.code).toBe(OpCode.FIN_IMD);
+    // decoding stops at the invalid opcode
+    expect(disassembly.invalidOffset).toBe(6);
+    expect(disassembly.at(6)).toBeUndefined();
+    expect(disassembly.at(100)).toBeUndefined();
+  });
+
+  it("should format instructions in assembler syntax", () => {
+    const { instructions } = disassemble(
+      assemble([
+        [OpCode.SET_VAL, a, 10n],
+        [OpCode.SET_IND, a, b],
+        [OpCode.IDX_DAT, a, b, c],
+        [OpCode.PSH_DAT, c],
+        "end:",
+        [OpCode.BZR_DAT, a, "end"],
+        [OpCode.JMP_ADR, "end"],
+        [OpCode.EXT_FUN_DAT_2, ApiFunction.set_A1_A2, a, b],
+        [OpCode.EXT_FUN_RET, ApiFunction.get_B1, c],
+        [OpCode.ADD_DAT, a, b],
+        [OpCode.FIN_IMD],
+      ]),
+    );
+    const labels = new Map([[instructions[4]!.offset, "end"]]);
+
+    expect(
+      instructions.map((i) => formatInstruction(i, { memory: Memory, labels })),
+    ).toEqual([
+      "SET @a #000000000000000a",
+      "SET @a $($b)",
+      "SET @($a + $b) $c",
+      "PSH $c",
+      "BZR $a :end",
+      "JMP :end",
+      "FUN set_A1_A2 $a $b",
+      "FUN @c get_B1",
+      "ADD @a $b",
+      "FIN",
+    ]);
+    expect(formatInstruction(instructions[5]!)).toBe("JMP :__0028");
+  });
+});
@@ -0,0 +1,69 @@
+import { OpCode, OpCodeTable, OperandKind } from "../opcodes";
+import type { MachineCode } from "../types";
+
+export type Operand = number | bigint | string;
+export type Line = string | [OpCode, ...Operand[]];
+
+/**
+ * Minimal assembler for the tests - strings ending with ':' are labels,
+ * string operands refer to labels (absolute for jumps, relative for branches).
+ */
+export function assemble(lines: Line[]) {
+  const labels = new Map<string, number>();
+  let pc = 0;
+  for (const line of lines) {
+    if (typeof line === "string") {
+      labels.set(line.slice(0, -1), pc);
+    } else {
+      pc += OpCodeTable[line[0]]!.size;
+    }
+  }
+
+  const bytes: number[] = [];
+  const push = (value: bigint, size: number) => {
+    const v = BigInt.asUintN(size * 8, value);
+    for (let i = 0; i < size; i++) {
+      bytes.push(Number((v >> BigInt(i * 8)) & 0xffn));
+    }
+  };
+  for (const line of lines) {
+    if (typeof line === "string") continue;
+    const [code, ...operands] = line;
+    const start = bytes.length;
+    const info = OpCodeTable[code]!;
+    bytes.push(code);
+    info.operands.forEach((kind, i) => {
+      const operand = operands[i];
+      let value =
+        typeof operand === "string" ? BigInt(labels.get(operand)!) : BigInt(operand);
+      switch (kind) {
+        case OperandKind.Value:
+          return push(value, 8);
+        case OperandKind.Function:
+          return push(value, 2);
+        case OperandKind.Offset:
+          if (typeof operand === "string") value -= BigInt(start);
+          return push(value, 1);
+        default:
+          return push(value, 4);
+      }
+    });
+  }
+  return bytes.map((b) => b.toString(16).padStart(2, "0")).join("");
+}
+
+export function machineCode(
+  lines: Line[],
+  memory: string[],
+  overrides: Partial<MachineCode> = {},
+): MachineCode {
+  return {
+    ByteCode: assemble(lines),
+    Memory: memory,
+    DataPages: 1,
+    CodeStackPages: 1,
+    UserStackPages: 1,
+    PActivationAmount: "100000000",
+    ...overrides,
+  };
+}
@@ -0,0 +1,87 @@
+/**
+ * Signum AT API function codes as used with the `FUN` (EXT_FUN*) instructions.
+ * Member names follow the assembler names, so `ApiFunction[code]` yields the name.
+ */
+export enum ApiFunction {
+  get_A1 = 0x0100,
+  get_A2 = 0x0101,
+  get_A3 = 0x0102,
+  get_A4 = 0x0103,
+  get_B1 = 0x0104,
+  get_B2 = 0x0105,
+  get_B3 = 0x0106,
+  get_B4 = 0x0107,
+  set_A1 = 0x0110,
+  set_A2 = 0x0111,
+  set_A3 = 0x0112,
+  set_A4 = 0x0113,
+  set_A1_A2 = 0x0114,
+  set_A3_A4 = 0x0115,
+  set_B1 = 0x0116,
+  set_B2 = 0x0117,
+  set_B3 = 0x0118,
+  set_B4 = 0x0119,
+  set_B1_B2 = 0x011a,
+  set_B3_B4 = 0x011b,
+  clear_A = 0x0120,
+  clear_B = 0x0121,
+  clear_A_B = 0x0122,
+  copy_A_From_B = 0x0123,
+  copy_B_From_A = 0x0124,
+  check_A_Is_Zero = 0x0125,
+  check_B_Is_Zero = 0x0126,
+  check_A_equals_B = 0x0127,
+  swap_A_and_B = 0x0128,
+  OR_A_with_B = 0x0129,
+  OR_B_with_A = 0x012a,
+  AND_A_with_B = 0x012b,
+  AND_B_with_A = 0x012c,
+  XOR_A_with_B = 0x012d,
+  XOR_B_with_A = 0x012e,
+  add_A_to_B = 0x0140,
+  add_B_to_A = 0x0141,
+  sub_A_from_B = 0x0142,
+  sub_B_from_A = 0x0143,
+  mul_A_by_B = 0x0144,
+  mul_B_by_A = 0x0145,
+  div_A_by_B = 0x0146,
+  div_B_by_A = 0x0147,
+  MD5_A_to_B = 0x0200,
+  check_MD5_A_with_B = 0x0201,
+  HASH160_A_to_B = 0x0202,
+  check_HASH160_A_with_B = 0x0203,
+  SHA256_A_to_B = 0x0204,
+  check_SHA256_A_with_B = 0x0205,
+  Check_Sig_B_With_A = 0x0206,
+  get_Block_Timestamp = 0x0300,
+  get_Creation_Timestamp = 0x0301,
+  get_Last_Block_Timestamp = 0x0302,
+  put_Last_Block_Hash_In_A = 0x0303,
+  A_to_Tx_after_Timestamp = 0x0304,
+  get_Type_for_Tx_in_A = 0x0305,
+  get_Amount_for_Tx_in_A = 0x0306,
+  get_Timestamp_for_Tx_in_A = 0x0307,
+  get_Ticket_Id_for_Tx_in_A = 0x0308,
+  message_from_Tx_in_A_to_B = 0x0309,
+  B_to_Address_of_Tx_in_A = 0x030a,
+  B_to_Address_of_Creator = 0x030b,
+  Get_Code_Hash_Id = 0x030c,
+  B_To_Assets_Of_Tx_In_A = 0x030d,
+  get_Current_Balance = 0x0400,
+  get_Previous_Balance = 0x0401,
+  send_to_Address_in_B = 0x0402,
+  send_All_to_Address_in_B = 0x0403,
+  send_Old_to_Address_in_B = 0x0404,
+  send_A_to_Address_in_B = 0x0405,
+  add_Minutes_to_Timestamp = 0x0406,
+  Get_Map_Value_Keys_In_A = 0x0407,
+  Set_Map_Value_Keys_In_A = 0x0408,
+  Issue_Asset = 0x0409,
+  Mint_Asset = 0x040a,
+  Distribute_To_Asset_Holders = 0x040b,
+  Get_Asset_Holders_Count = 0x040c,
+  Get_Activation_Fee = 0x040d,
+  Put_Last_Block_GSig_In_A = 0x040e,
+  Get_Asset_Circulating = 0x040f,
+  Get_Account_Balance = 0x0410,
+}
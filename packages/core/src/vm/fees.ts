@@ -0,0 +1,24 @@
+/**
+ * Fee parameters of the AT execution. Defaults are the Signum mainnet values,
+ * pass your own schedule to the machine for other networks.
+ */
+export interface FeeSchedule {
+  /** Fee per execution step in NQT */
+  stepFeeNQT: bigint;
+  /** API function calls cost this many steps */
+  apiStepMultiplier: number;
+  /** Deployment cost per code/data/stack page in NQT */
+  pageFeeNQT: bigint;
+}
+
+export const FeeQuantNQT = 735_000n;
+
+export const DefaultFeeSchedule: Readonly<FeeSchedule> = {
+  stepFeeNQT: FeeQuantNQT / 10n,
+  apiStepMultiplier: 10,
+  pageFeeNQT: FeeQuantNQT * 10n,
+};
+
+export function stepsToFee(steps: number, schedule = DefaultFeeSchedule) {
+  return BigInt(steps) * schedule.stepFeeNQT;
+}
@@ -0,0 +1,7 @@
+export * from "./AtMachine";
+export * from "./Disassembler";
+export * from "./api-functions";
+export * from "./fees";
+export * from "./opcodes";
+export * from "./types";
+export * from "./BlockSimulator";
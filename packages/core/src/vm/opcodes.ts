@@ -0,0 +1,176 @@
+/**
+ * Signum AT instruction set, based on the work from
+ * ciyam: https://github.com/ciyam/AT/blob/master/docs/at.html
+ * deleterium: https://github.com/deleterium/SmartC/blob/main/src/assembler/assembler.ts
+ */
+export enum OpCode {
+  SET_VAL = 0x01,
+  SET_DAT = 0x02,
+  CLR_DAT = 0x03,
+  INC_DAT = 0x04,
+  DEC_DAT = 0x05,
+  ADD_DAT = 0x06,
+  SUB_DAT = 0x07,
+  MUL_DAT = 0x08,
+  DIV_DAT = 0x09,
+  BOR_DAT = 0x0a,
+  AND_DAT = 0x0b,
+  XOR_DAT = 0x0c,
+  NOT_DAT = 0x0d,
+  SET_IND = 0x0e,
+  SET_IDX = 0x0f,
+  PSH_DAT = 0x10,
+  POP_DAT = 0x11,
+  JMP_SUB = 0x12,
+  RET_SUB = 0x13,
+  IND_DAT = 0x14,
+  IDX_DAT = 0x15,
+  MOD_DAT = 0x16,
+  SHL_DAT = 0x17,
+  SHR_DAT = 0x18,
+  POW_DAT = 0x19,
+  JMP_ADR = 0x1a,
+  BZR_DAT = 0x1b,
+  MDV_DAT = 0x1c,
+  BNZ_DAT = 0x1e,
+  BGT_DAT = 0x1f,
+  BLT_DAT = 0x20,
+  BGE_DAT = 0x21,
+  BLE_DAT = 0x22,
+  BEQ_DAT = 0x23,
+  BNE_DAT = 0x24,
+  SLP_DAT = 0x25,
+  FIZ_DAT = 0x26,
+  STZ_DAT = 0x27,
+  FIN_IMD = 0x28,
+  STP_IMD = 0x29,
+  SLP_IMD = 0x2a,
+  ERR_ADR = 0x2b,
+  SET_PCS = 0x30,
+  EXT_FUN = 0x32,
+  EXT_FUN_DAT = 0x33,
+  EXT_FUN_DAT_2 = 0x34,
+  EXT_FUN_RET = 0x35,
+  EXT_FUN_RET_DAT = 0x36,
+  EXT_FUN_RET_DAT_2 = 0x37,
+  NOP = 0x7f,
+}
+
+export enum OperandKind {
+  /** 4 bytes - memory address (long index) */
+  Address,
+  /** 8 bytes - immediate value */
+  Value,
+  /** 4 bytes - absolute code address */
+  Code,
+  /** 1 byte - signed branch offset relative to the instruction */
+  Offset,
+  /** 2 bytes - API function code */
+  Function,
+}
+
+export const OperandSizes: Record<OperandKind, number> = {
+  [OperandKind.Address]: 4,
+  [OperandKind.Value]: 8,
+  [OperandKind.Code]: 4,
+  [OperandKind.Offset]: 1,
+  [OperandKind.Function]: 2,
+};
+
+export interface OpCodeInfo {
+  code: OpCode;
+  mnemonic: string;
+  size: number;
+  operands: OperandKind[];
+}
+
+const A = OperandKind.Address;
+const V = OperandKind.Value;
+const C = OperandKind.Code;
+const O = OperandKind.Offset;
+const F = OperandKind.Function;
+
+function op(code: OpCode, mnemonic: string, operands: OperandKind[]): OpCodeInfo {
+  return {
+    code,
+    mnemonic,
+    operands,
+    size: operands.reduce((size, kind) => size + OperandSizes[kind], 1),
+  };
+}
+
+export const OpCodes: OpCodeInfo[] = [
+  op(OpCode.SET_VAL, "SET", [A, V]),
+  op(OpCode.SET_DAT, "SET", [A, A]),
+  op(OpCode.CLR_DAT, "CLR", [A]),
+  op(OpCode.INC_DAT, "INC", [A]),
+  op(OpCode.DEC_DAT, "DEC", [A]),
+  op(OpCode.ADD_DAT, "ADD", [A, A]),
+  op(OpCode.SUB_DAT, "SUB", [A, A]),
+  op(OpCode.MUL_DAT, "MUL", [A, A]),
+  op(OpCode.DIV_DAT, "DIV", [A, A]),
+  op(OpCode.BOR_DAT, "BOR", [A, A]),
+  op(OpCode.AND_DAT, "AND", [A, A]),
+  op(OpCode.XOR_DAT, "XOR", [A, A]),
+  op(OpCode.NOT_DAT, "NOT", [A]),
+  op(OpCode.SET_IND, "SET", [A, A]),
+  op(OpCode.SET_IDX, "SET", [A, A, A]),
+  op(OpCode.PSH_DAT, "PSH", [A]),
+  op(OpCode.POP_DAT, "POP", [A]),
+  op(OpCode.JMP_SUB, "JSR", [C]),
+  op(OpCode.RET_SUB, "RET", []),
+  op(OpCode.IND_DAT, "SET", [A, A]),
+  op(OpCode.IDX_DAT, "SET", [A, A, A]),
+  op(OpCode.MOD_DAT, "MOD", [A, A]),
+  op(OpCode.SHL_DAT, "SHL", [A, A]),
+  op(OpCode.SHR_DAT, "SHR", [A, A]),
+  op(OpCode.POW_DAT, "POW", [A, A]),
+  op(OpCode.JMP_ADR, "JMP", [C]),
+  op(OpCode.BZR_DAT, "BZR", [A, O]),
+  op(OpCode.MDV_DAT, "MDV", [A, A, A]),
+  op(OpCode.BNZ_DAT, "BNZ", [A, O]),
+  op(OpCode.BGT_DAT, "BGT", [A, A, O]),
+  op(OpCode.BLT_DAT, "BLT", [A, A, O]),
+  op(OpCode.BGE_DAT, "BGE", [A, A, O]),
+  op(OpCode.BLE_DAT, "BLE", [A, A, O]),
+  op(OpCode.BEQ_DAT, "BEQ", [A, A, O]),
+  op(OpCode.BNE_DAT, "BNE", [A, A, O]),
+  op(OpCode.SLP_DAT, "SLP", [A]),
+  op(OpCode.FIZ_DAT, "FIZ", [A]),
+  op(OpCode.STZ_DAT, "STZ", [A]),
+  op(OpCode.FIN_IMD, "FIN", []),
+  op(OpCode.STP_IMD, "STP", []),
+  op(OpCode.SLP_IMD, "SLP", []),
+  op(OpCode.ERR_ADR, "ERR", [C]),
+  op(OpCode.SET_PCS, "PCS", []),
+  op(OpCode.EXT_FUN, "FUN", [F]),
+  op(OpCode.EXT_FUN_DAT, "FUN", [F, A]),
+  op(OpCode.EXT_FUN_DAT_2, "FUN", [F, A, A]),
+  op(OpCode.EXT_FUN_RET, "FUN", [F, A]),
+  op(OpCode.EXT_FUN_RET_DAT, "FUN", [F, A, A]),
+  op(OpCode.EXT_FUN_RET_DAT_2, "FUN", [F, A, A, A]),
+  op(OpCode.NOP, "NOP", []),
+];
+
+/**
+ * Lookup table opcode -> info, `undefined` for invalid opcodes
+ */
+export const OpCodeTable: (OpCodeInfo | undefined)[] = (() => {
+  const table = new Array<OpCodeInfo | undefined>(256).fill(undefined);
+  for (const info of OpCodes) {
+    table[info.code] = info;
+  }
+  return table;
+})();
+
+export function isApiCall(code: number) {
+  return code >= OpCode.EXT_FUN && code <= OpCode.EXT_FUN_RET_DAT_2;
+}
+
+export function isBranch(code: number) {
+  return (
+    code === OpCode.BZR_DAT ||
+    code === OpCode.BNZ_DAT ||
+    (code >= OpCode.BGT_DAT && code <= OpCode.BNE_DAT)
+  );
+}
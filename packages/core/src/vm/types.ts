@@ -0,0 +1,104 @@
+/**
+ * Subset of SmartC's `MachineData` (as produced by the assembler) the VM needs.
+ */
+export interface MachineCode {
+  /** Hex encoded bytecode */
+  ByteCode: string;
+  /** Hex encoded initial data segment (constants), optional */
+  ByteData?: string;
+  /** Variable names - the index is the memory address */
+  Memory: string[];
+  Labels?: { label: string; address: number }[];
+  DataPages: number;
+  CodePages?: number;
+  CodeStackPages: number;
+  UserStackPages: number;
+  MinimumFeeNQT?: string;
+  PActivationAmount?: string;
+  MachineCodeHashId?: string;
+}
+
+export interface AssetQuantity {
+  assetId: bigint;
+  quantity: bigint;
+}
+
+export interface IncomingTransaction {
+  /** Assigned by the machine if omitted */
+  txId?: bigint;
+  sender: bigint;
+  /** Amount in NQT (Planck) */
+  amount?: bigint;
+  /** Message as longs, four longs per page (32 bytes) */
+  message?: readonly bigint[] | BigInt64Array;
+  assets?: AssetQuantity[];
+}
+
+export interface TransactionRecord {
+  txId: bigint;
+  sender: bigint;
+  amount: bigint;
+  message: BigInt64Array;
+  assets: AssetQuantity[];
+  timestamp: bigint;
+  height: number;
+}
+
+export interface OutgoingTransaction {
+  recipient: bigint;
+  /** Amount in NQT (Planck) */
+  amount: bigint;
+  /** Asset transfer, if any */
+  assetId: bigint;
+  quantity: bigint;
+  /** Message as longs, null if no message was sent */
+  message: bigint[] | null;
+  height: number;
+}
+
+/**
+ * Lookups for other accounts and contracts - all optional, default to zero.
+ */
+export interface AtEnvironment {
+  getActivationOf?(contractId: bigint): bigint;
+  getCreatorOf?(contractId: bigint): bigint;
+  getCodeHashOf?(contractId: bigint): bigint;
+  getMapValueOf?(contractId: bigint, key1: bigint, key2: bigint): bigint;
+  getAccountBalance?(accountId: bigint, assetId: bigint): bigint;
+}
+
+export type MachineState =
+  /** waits for the next (qualifying) transaction, resumes at `pcs` */
+  | "finished"
+  /** waits for the next (qualifying) transaction, resumes where it stopped */
+  | "stopped"
+  /** resumes at a given block height */
+  | "sleeping"
+  /** out of balance, resumes once it got funded again */
+  | "frozen";
+
+export interface BlockResult {
+  height: number;
+  /** false, if the contract was not activated in this block */
+  executed: boolean;
+  /** Fee relevant steps, i.e. API calls are weighted */
+  steps: number;
+  instructions: number;
+  apiCalls: number;
+  feeNQT: bigint;
+  state: MachineState;
+  /** Runtime error, if any was raised and not handled by an `ERR` handler */
+  error?: string;
+  outgoing: OutgoingTransaction[];
+}
+
+export interface ReplayResult {
+  blocks: number;
+  transactions: number;
+  steps: number;
+  instructions: number;
+  apiCalls: number;
+  feeNQT: bigint;
+  errors: { height: number; error: string }[];
+  outgoing: OutgoingTransaction[];
+}